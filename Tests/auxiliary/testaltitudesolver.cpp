@@ -0,0 +1,125 @@
+/*  Altitude Solver Tests
+    Copyright (C) 2026 KStars Developers
+
+    This application is free software; you can redistribute it and/or
+    modify it under the terms of the GNU General Public
+    License as published by the Free Software Foundation; either
+    version 2 of the License, or (at your option) any later version.
+*/
+
+#include "testaltitudesolver.h"
+
+#include "auxiliary/altitudesolver.h"
+#include "auxiliary/geolocation.h"
+#include "skyobjects/skypoint.h"
+
+#include <QtTest/QtTest>
+
+namespace
+{
+double altitudeAt(const SkyPoint &target, const GeoLocation &geo, long double jd)
+{
+    return SkyPoint::findAltitude(&target, KStarsDateTime(jd), &geo).Degrees();
+}
+}
+
+void TestAltitudeSolver::aboveAltitude_data()
+{
+    QTest::addColumn<double>("latitude");
+    QTest::addColumn<double>("dec");
+    QTest::addColumn<double>("altitude");
+    QTest::addColumn<int>("ranges");
+
+    QTest::newRow("Rising and setting") << 45.0 << 20.0 << 30.0 << 2;
+    QTest::newRow("Southern sky") << -33.0 << -60.0 << 40.0 << 2;
+    QTest::newRow("Below horizon") << 52.0 << -10.0 << -18.0 << 2;
+    QTest::newRow("Circumpolar") << 60.0 << 80.0 << 0.0 << 1;
+    QTest::newRow("Never rising") << 60.0 << -40.0 << 0.0 << 0;
+    QTest::newRow("Never high enough") << 45.0 << -30.0 << 20.0 << 0;
+}
+
+void TestAltitudeSolver::aboveAltitude()
+{
+    QFETCH(double, latitude);
+    QFETCH(double, dec);
+    QFETCH(double, altitude);
+    QFETCH(int, ranges);
+
+    const GeoLocation geo(dms(-3.7), dms(latitude));
+    const SkyPoint target(dms(83.8), dms(dec));
+    const KStarsDateTime from(QDate(2017, 11, 4), QTime(18, 0));
+    const KStarsDateTime to = from.addDays(2);
+
+    const QVector<AltitudeSolver::TimeRange> result = AltitudeSolver::aboveAltitude(target, &geo, altitude, from, to);
+    QCOMPARE(result.count(), ranges);
+
+    // Each crossing is within a minute of where the sampled altitude crosses
+    const long double minute = 1.0L / 1440.0L;
+    for (const AltitudeSolver::TimeRange &range : result)
+    {
+        QVERIFY(range.start < range.end);
+        QVERIFY(altitudeAt(target, geo, (range.start.djd() + range.end.djd()) / 2) > altitude);
+
+        if (range.start > from)
+        {
+            QVERIFY(altitudeAt(target, geo, range.start.djd() - minute) < altitude);
+            QVERIFY(altitudeAt(target, geo, range.start.djd() + minute) > altitude);
+        }
+        if (range.end < to)
+        {
+            QVERIFY(altitudeAt(target, geo, range.end.djd() - minute) > altitude);
+            QVERIFY(altitudeAt(target, geo, range.end.djd() + minute) < altitude);
+        }
+    }
+
+    // Results are cached
+    QCOMPARE(AltitudeSolver::aboveAltitude(target, &geo, altitude, from, to).count(), ranges);
+}
+
+void TestAltitudeSolver::nextTransit()
+{
+    const GeoLocation geo(dms(2.35), dms(48.85));
+    const SkyPoint target(dms(201.3), dms(-11.2));
+    const KStarsDateTime from(QDate(2017, 11, 4), QTime(21, 30));
+
+    const KStarsDateTime transit = AltitudeSolver::nextTransit(target, &geo, from);
+
+    QVERIFY(transit > from);
+    QVERIFY(transit.djd() - from.djd() < 1.0L);
+
+    // Culmination is the highest altitude, within a few seconds
+    const long double seconds = 5.0L / 86400.0L;
+    const double culmination  = altitudeAt(target, geo, transit.djd());
+    QVERIFY(culmination >= altitudeAt(target, geo, transit.djd() - seconds));
+    QVERIFY(culmination >= altitudeAt(target, geo, transit.djd() + seconds));
+    QVERIFY(fabs(culmination - target.maxAlt(*geo.lat())) < 1e-3);
+}
+
+void TestAltitudeSolver::findFirst()
+{
+    const KStarsDateTime from(QDate(2017, 11, 4), QTime(18, 0));
+    const KStarsDateTime to    = from.addDays(1);
+    const long double expected = from.djd() + 0.3172L;
+    int calls                  = 0;
+
+    KStarsDateTime found;
+    QVERIFY(AltitudeSolver::findFirst(
+        [&](const KStarsDateTime &when) {
+            calls++;
+            return when.djd() >= expected;
+        },
+        from, to, 900, 60, found));
+
+    // Found within the precision, after the condition is met, with far fewer calls than a scan per minute
+    QVERIFY(found.djd() >= expected);
+    QVERIFY(found.djd() - expected <= 60.0L / 86400.0L);
+    QVERIFY(calls < 50);
+
+    QVERIFY(AltitudeSolver::findFirst([](const KStarsDateTime &) { return true; }, from, to, 900, 60, found));
+    QVERIFY(found == from);
+
+    QVERIFY(AltitudeSolver::findFirst([](const KStarsDateTime &) { return false; }, from, to, 900, 60, found) ==
+            false);
+}
+
+QTEST_GUILESS_MAIN(TestAltitudeSolver)
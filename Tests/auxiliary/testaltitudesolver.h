@@ -0,0 +1,31 @@
+/*  Altitude Solver Tests
+    Copyright (C) 2026 KStars Developers
+
+    This application is free software; you can redistribute it and/or
+    modify it under the terms of the GNU General Public
+    License as published by the Free Software Foundation; either
+    version 2 of the License, or (at your option) any later version.
+*/
+
+#pragma once
+
+#include <QObject>
+
+/**
+ * @class TestAltitudeSolver
+ * @short Tests for AltitudeSolver, against altitudes computed by SkyPoint
+ */
+class TestAltitudeSolver : public QObject
+{
+    Q_OBJECT
+
+  public:
+    TestAltitudeSolver() = default;
+    ~TestAltitudeSolver() override = default;
+
+  private slots:
+    void aboveAltitude_data();
+    void aboveAltitude();
+    void nextTransit();
+    void findFirst();
+};
@@ -0,0 +1,177 @@
+/*  Local Astrometry Parser Tests
+    Copyright (C) 2026 KStars Developers
+
+    This application is free software; you can redistribute it and/or
+    modify it under the terms of the GNU General Public
+    License as published by the Free Software Foundation; either
+    version 2 of the License, or (at your option) any later version.
+*/
+
+#include "testlocalastrometryparser.h"
+
+#include "localastrometryparser.h"
+
+#include <QtTest/QtTest>
+
+#include <cmath>
+#include <random>
+
+using Ekos::LocalAstrometryParser;
+
+namespace
+{
+const double DEG_TO_RAD = M_PI / 180.0;
+
+const int WIDTH  = 1280;
+const int HEIGHT = 1024;
+
+/* Catalog of stars spread uniformly within radius degrees of ra, dec, brightest first */
+QVector<LocalAstrometryParser::CatalogStar> makeCatalog(unsigned int seed, double ra, double dec, double radius,
+                                                        int count)
+{
+    std::mt19937 generator(seed);
+    std::uniform_real_distribution<double> uniform(0.0, 1.0);
+    QVector<LocalAstrometryParser::CatalogStar> stars;
+
+    while (stars.count() < count)
+    {
+        const double x = (2 * uniform(generator) - 1) * radius, y = (2 * uniform(generator) - 1) * radius;
+        if (x * x + y * y > radius * radius)
+            continue;
+
+        // Small offsets on the sphere, accurate enough for a synthetic field
+        stars.append({ ra + x / cos((dec + y) * DEG_TO_RAD), dec + y, 6 + 6 * sqrt(uniform(generator)) });
+    }
+
+    std::sort(stars.begin(), stars.end(), [](const LocalAstrometryParser::CatalogStar &s1,
+                                             const LocalAstrometryParser::CatalogStar &s2) { return s1.mag < s2.mag; });
+    return stars;
+}
+
+/* Image of the catalog centered on ra, dec, missing some stars and with a few spurious ones, brightest first */
+QVector<LocalAstrometryParser::ImageStar> makeImage(const QVector<LocalAstrometryParser::CatalogStar> &catalog,
+                                                    double ra, double dec, double scale, double orientation,
+                                                    bool mirrored)
+{
+    std::mt19937 generator(42);
+    std::uniform_real_distribution<double> uniform(0.0, 1.0);
+    std::normal_distribution<double> noise(0.0, 0.3);
+    QVector<LocalAstrometryParser::ImageStar> stars;
+
+    const double c = cos(orientation * DEG_TO_RAD), s = sin(orientation * DEG_TO_RAD);
+    const double sd0 = sin(dec * DEG_TO_RAD), cd0 = cos(dec * DEG_TO_RAD);
+
+    for (const LocalAstrometryParser::CatalogStar &star : catalog)
+    {
+        // Gnomonic projection in arcseconds
+        const double dra = (star.ra - ra) * DEG_TO_RAD;
+        const double sd = sin(star.dec * DEG_TO_RAD), cd = cos(star.dec * DEG_TO_RAD);
+        const double denominator = sd * sd0 + cd * cd0 * cos(dra);
+        const double xi  = cd * sin(dra) / denominator / DEG_TO_RAD * 3600.0;
+        const double eta = (sd * cd0 - cd * sd0 * cos(dra)) / denominator / DEG_TO_RAD * 3600.0;
+
+        // Up is orientation degrees east of north, east is left unless mirrored
+        const double dx = (mirrored ? (c * xi - s * eta) : (-c * xi + s * eta)) / scale;
+        const double dy = (s * xi + c * eta) / scale;
+        const double x = WIDTH / 2.0 + dx, y = HEIGHT / 2.0 + dy;
+
+        if (x < 0 || x >= WIDTH || y < 0 || y >= HEIGHT || uniform(generator) < 0.15)
+            continue;
+
+        stars.append({ x + noise(generator), y + noise(generator), pow(10, -0.4 * star.mag) });
+    }
+
+    for (int i = 0; i < 5; i++)
+    {
+        const double x = uniform(generator) * WIDTH, y = uniform(generator) * HEIGHT;
+        stars.append({ x, y, pow(10, -0.4 * (8 + 4 * uniform(generator))) });
+    }
+
+    std::sort(stars.begin(), stars.end(), [](const LocalAstrometryParser::ImageStar &s1,
+                                             const LocalAstrometryParser::ImageStar &s2) { return s1.flux > s2.flux; });
+    return stars;
+}
+}
+
+void TestLocalAstrometryParser::solve_data()
+{
+    QTest::addColumn<double>("ra");
+    QTest::addColumn<double>("dec");
+    QTest::addColumn<double>("orientation");
+    QTest::addColumn<bool>("mirrored");
+
+    QTest::newRow("North up") << 150.4 << 45.3 << 0.0 << false;
+    QTest::newRow("Rotated") << 149.2 << 44.5 << 37.0 << false;
+    QTest::newRow("Rotated west") << 150.9 << 46.1 << -121.0 << false;
+    QTest::newRow("Mirrored") << 149.6 << 45.8 << 72.0 << true;
+}
+
+void TestLocalAstrometryParser::solve()
+{
+    QFETCH(double, ra);
+    QFETCH(double, dec);
+    QFETCH(double, orientation);
+    QFETCH(bool, mirrored);
+
+    // About 30 stars per field, the field being up to 1.5 degrees from the estimated position
+    const QVector<LocalAstrometryParser::CatalogStar> catalog = makeCatalog(1, 150, 45, 2.0, 1000);
+    const QVector<LocalAstrometryParser::ImageStar> image     = makeImage(catalog, ra, dec, 2.0, orientation, mirrored);
+
+    LocalAstrometryParser::Solution solution;
+    QVERIFY(LocalAstrometryParser::solve(image, catalog, WIDTH, HEIGHT, 150, 45, 1.8, 2.2, solution));
+
+    const double raError  = (solution.ra - ra) * cos(dec * DEG_TO_RAD) * 3600.0;
+    const double decError = (solution.dec - dec) * 3600.0;
+    const double centerError = std::hypot(raError, decError);
+    QVERIFY2(centerError < 1.0, qPrintable(QString("Center is %1\" away").arg(centerError)));
+    QVERIFY(fabs(solution.pixscale - 2.0) < 0.005);
+
+    const double orientationError = fmod(solution.orientation - orientation + 540.0, 360.0) - 180.0;
+    QVERIFY2(fabs(orientationError) < 0.05, qPrintable(QString("Orientation is %1").arg(solution.orientation)));
+
+    QCOMPARE(solution.mirrored, mirrored);
+    QVERIFY(solution.matches >= 15);
+}
+
+void TestLocalAstrometryParser::unrelatedField()
+{
+    const QVector<LocalAstrometryParser::CatalogStar> catalog = makeCatalog(1, 150, 45, 2.0, 1000);
+    const QVector<LocalAstrometryParser::ImageStar> image =
+        makeImage(makeCatalog(2, 150, 45, 2.0, 1000), 150.2, 45.1, 2.0, 20.0, false);
+
+    LocalAstrometryParser::Solution solution;
+    QVERIFY(LocalAstrometryParser::solve(image, catalog, WIDTH, HEIGHT, 150, 45, 1.8, 2.2, solution) == false);
+}
+
+void TestLocalAstrometryParser::randomField_data()
+{
+    QTest::addColumn<unsigned int>("seed");
+    QTest::addColumn<int>("count");
+
+    QTest::newRow("Sparse") << 1u << 40;
+    QTest::newRow("Dense") << 2u << 80;
+    QTest::newRow("Crowded") << 4u << 200;
+}
+
+void TestLocalAstrometryParser::randomField()
+{
+    QFETCH(unsigned int, seed);
+    QFETCH(int, count);
+
+    // Stars spread uniformly over the image, matching the catalog only by chance
+    std::mt19937 generator(seed);
+    std::uniform_real_distribution<double> uniform(0.0, 1.0);
+    QVector<LocalAstrometryParser::ImageStar> image;
+    for (int i = 0; i < count; i++)
+        image.append({ uniform(generator) * WIDTH, uniform(generator) * HEIGHT, uniform(generator) });
+
+    std::sort(image.begin(), image.end(), [](const LocalAstrometryParser::ImageStar &s1,
+                                             const LocalAstrometryParser::ImageStar &s2) { return s1.flux > s2.flux; });
+
+    const QVector<LocalAstrometryParser::CatalogStar> catalog = makeCatalog(1, 150, 45, 2.0, 1000);
+
+    LocalAstrometryParser::Solution solution;
+    QVERIFY(LocalAstrometryParser::solve(image, catalog, WIDTH, HEIGHT, 150, 45, 1.8, 2.2, solution) == false);
+}
+
+QTEST_GUILESS_MAIN(TestLocalAstrometryParser)
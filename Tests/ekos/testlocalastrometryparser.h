@@ -0,0 +1,32 @@
+/*  Local Astrometry Parser Tests
+    Copyright (C) 2026 KStars Developers
+
+    This application is free software; you can redistribute it and/or
+    modify it under the terms of the GNU General Public
+    License as published by the Free Software Foundation; either
+    version 2 of the License, or (at your option) any later version.
+*/
+
+#pragma once
+
+#include <QObject>
+
+/**
+ * @class TestLocalAstrometryParser
+ * @short Tests for the star matching of LocalAstrometryParser, on synthetic fields of known solution
+ */
+class TestLocalAstrometryParser : public QObject
+{
+    Q_OBJECT
+
+  public:
+    TestLocalAstrometryParser() = default;
+    ~TestLocalAstrometryParser() override = default;
+
+  private slots:
+    void solve_data();
+    void solve();
+    void unrelatedField();
+    void randomField_data();
+    void randomField();
+};
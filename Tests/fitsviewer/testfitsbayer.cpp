@@ -0,0 +1,200 @@
+/***************************************************************************
+                          testfitsbayer.cpp  -
+                             -------------------
+    begin                : Sun 18 Oct 2026
+    copyright            : (c) 2026 by KStars Developers
+***************************************************************************/
+
+/***************************************************************************
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ ***************************************************************************/
+
+#include "testfitsbayer.h"
+
+#include "fitsbayer.h"
+
+#include <QtTest>
+
+Q_DECLARE_METATYPE(dc1394bayer_method_t)
+
+namespace
+{
+// A 16 megapixel frame, the size of a common CMOS sensor
+const uint32_t benchWidth = 4656, benchHeight = 3520;
+
+const QList<QPair<dc1394color_filter_t, QString>> filters = { { DC1394_COLOR_FILTER_RGGB, "RGGB" },
+                                                              { DC1394_COLOR_FILTER_GBRG, "GBRG" },
+                                                              { DC1394_COLOR_FILTER_GRBG, "GRBG" },
+                                                              { DC1394_COLOR_FILTER_BGGR, "BGGR" } };
+
+template <typename T>
+QVector<T> randomImage(uint32_t width, uint32_t height, int range)
+{
+    QVector<T> image(width * height);
+    qsrand(42);
+    for (auto &sample : image)
+        sample = static_cast<T>(qrand() % range);
+    return image;
+}
+
+/** Decodes the image with libdc1394 on a single thread, into an interleaved buffer */
+template <typename T>
+QVector<T> referenceDebayer(const QVector<T> &bayer, uint32_t width, uint32_t height, dc1394color_filter_t filter,
+                            dc1394bayer_method_t method)
+{
+    QVector<T> rgb(bayer.size() * 3, 0);
+    FITSBayer::dc1394Decode(bayer.constData(), rgb.data(), width, height, filter, method);
+    return rgb;
+}
+
+/**
+ * Compares the planes with libdc1394, up to border samples from the edges of the image, which libdc1394 leaves
+ * black or undefined for the native methods
+ */
+template <typename T>
+void checkMethod(dc1394bayer_method_t method, uint32_t border)
+{
+    // Odd widths exercise the scalar tails of the vector kernels, enough rows for several bands
+    const uint32_t width = 67, height = 301;
+    const QVector<T> bayer = randomImage<T>(width, height, std::numeric_limits<T>::max() + 1);
+
+    for (const auto &filter : filters)
+    {
+        QVector<T> planes(bayer.size() * 3);
+        const dc1394error_t error =
+            FITSBayer::debayer(bayer.constData(), width, height, filter.first, method, planes.data(),
+                               planes.data() + bayer.size(), planes.data() + 2 * bayer.size());
+        QCOMPARE(error, DC1394_SUCCESS);
+
+        const QVector<T> rgb = referenceDebayer(bayer, width, height, filter.first, method);
+
+        for (uint32_t y = border; y + border < height; y++)
+            for (uint32_t x = border; x + border < width; x++)
+                for (int c = 0; c < 3; c++)
+                {
+                    const uint32_t i = y * width + x;
+                    if (planes[c * bayer.size() + i] != rgb[i * 3 + c])
+                        QFAIL(qPrintable(QString("%1: sample %2 of channel %3 at %4, %5 instead of %6")
+                                             .arg(filter.second)
+                                             .arg(planes[c * bayer.size() + i])
+                                             .arg(c)
+                                             .arg(x)
+                                             .arg(y)
+                                             .arg(rgb[i * 3 + c])));
+                }
+    }
+}
+
+template <typename T>
+void benchmark(dc1394bayer_method_t method, bool native)
+{
+    const QVector<T> bayer = randomImage<T>(benchWidth, benchHeight, std::numeric_limits<T>::max() + 1);
+    QVector<T> planes(bayer.size() * 3);
+    T *red = planes.data(), *green = red + bayer.size(), *blue = green + bayer.size();
+
+    if (native)
+    {
+        QBENCHMARK
+        {
+            FITSBayer::debayer(bayer.constData(), benchWidth, benchHeight, DC1394_COLOR_FILTER_RGGB, method, red,
+                               green, blue);
+        }
+    }
+    else
+    {
+        // What FITSData used to do: decode to a temporary buffer on one thread, then copy it to the planes
+        QBENCHMARK
+        {
+            const QVector<T> rgb = referenceDebayer(bayer, benchWidth, benchHeight, DC1394_COLOR_FILTER_RGGB, method);
+            FITSBayer::deinterleave(rgb.constData(), bayer.size(), red, green, blue);
+        }
+    }
+}
+}
+
+void TestFITSBayer::testMethods_data()
+{
+    QTest::addColumn<dc1394bayer_method_t>("method");
+    QTest::addColumn<int>("border");
+
+    // Native methods differ on the borders of the image
+    QTest::newRow("Nearest") << DC1394_BAYER_METHOD_NEAREST << 1;
+    QTest::newRow("Bilinear") << DC1394_BAYER_METHOD_BILINEAR << 1;
+    // Others are decoded by libdc1394 on bands, which must give the same image
+    QTest::newRow("Simple") << DC1394_BAYER_METHOD_SIMPLE << 0;
+    QTest::newRow("HQ Linear") << DC1394_BAYER_METHOD_HQLINEAR << 0;
+    QTest::newRow("Edge Sense") << DC1394_BAYER_METHOD_EDGESENSE << 0;
+    QTest::newRow("VNG") << DC1394_BAYER_METHOD_VNG << 0;
+}
+
+void TestFITSBayer::testMethods()
+{
+    QFETCH(dc1394bayer_method_t, method);
+    QFETCH(int, border);
+
+    checkMethod<uint8_t>(method, border);
+    checkMethod<uint16_t>(method, border);
+}
+
+void TestFITSBayer::testSuperpixel()
+{
+    // Every cell has the same samples, odd sizes repeat the last complete cell
+    const uint32_t width = 7, height = 5;
+    QVector<uint16_t> bayer(width * height);
+    for (uint32_t y = 0; y < height; y++)
+        for (uint32_t x = 0; x < width; x++)
+            bayer[y * width + x] = (y % 2) ? ((x % 2) ? 300 : 201) : ((x % 2) ? 200 : 100);
+
+    QVector<uint16_t> planes(bayer.size() * 3);
+    QCOMPARE(FITSBayer::debayer(bayer.constData(), width, height, DC1394_COLOR_FILTER_RGGB,
+                                DC1394_BAYER_METHOD_DOWNSAMPLE, planes.data(), planes.data() + bayer.size(),
+                                planes.data() + 2 * bayer.size()),
+             DC1394_SUCCESS);
+
+    for (int i = 0; i < bayer.size(); i++)
+    {
+        QCOMPARE(planes[i], uint16_t(100));
+        QCOMPARE(planes[bayer.size() + i], uint16_t(201));
+        QCOMPARE(planes[2 * bayer.size() + i], uint16_t(300));
+    }
+}
+
+void TestFITSBayer::testShiftFilter()
+{
+    QCOMPARE(FITSBayer::shiftFilter(DC1394_COLOR_FILTER_RGGB, 0, 0), DC1394_COLOR_FILTER_RGGB);
+    QCOMPARE(FITSBayer::shiftFilter(DC1394_COLOR_FILTER_RGGB, 1, 0), DC1394_COLOR_FILTER_GRBG);
+    QCOMPARE(FITSBayer::shiftFilter(DC1394_COLOR_FILTER_RGGB, 0, 1), DC1394_COLOR_FILTER_GBRG);
+    QCOMPARE(FITSBayer::shiftFilter(DC1394_COLOR_FILTER_RGGB, 1, 1), DC1394_COLOR_FILTER_BGGR);
+    QCOMPARE(FITSBayer::shiftFilter(DC1394_COLOR_FILTER_GBRG, 1, 1), DC1394_COLOR_FILTER_GRBG);
+}
+
+void TestFITSBayer::benchmarkDebayer_data()
+{
+    QTest::addColumn<dc1394bayer_method_t>("method");
+    QTest::addColumn<bool>("native");
+
+    const QList<QPair<dc1394bayer_method_t, QString>> methods = { { DC1394_BAYER_METHOD_NEAREST, "Nearest" },
+                                                                  { DC1394_BAYER_METHOD_BILINEAR, "Bilinear" },
+                                                                  { DC1394_BAYER_METHOD_VNG, "VNG" } };
+
+    for (const auto &method : methods)
+    {
+        QTest::newRow(QString("%1 libdc1394").arg(method.second).toLatin1()) << method.first << false;
+        QTest::newRow(QString("%1 planar").arg(method.second).toLatin1()) << method.first << true;
+    }
+}
+
+void TestFITSBayer::benchmarkDebayer()
+{
+    QFETCH(dc1394bayer_method_t, method);
+    QFETCH(bool, native);
+
+    benchmark<uint16_t>(method, native);
+}
+
+QTEST_GUILESS_MAIN(TestFITSBayer)
@@ -0,0 +1,41 @@
+/***************************************************************************
+                          testfitsbayer.h  -
+                             -------------------
+    begin                : Sun 18 Oct 2026
+    copyright            : (c) 2026 by KStars Developers
+***************************************************************************/
+
+/***************************************************************************
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ ***************************************************************************/
+
+#pragma once
+
+#include <QObject>
+
+/**
+ * @class TestFITSBayer
+ * @short Tests and benchmarks for the debayering of FITS images, against libdc1394
+ */
+class TestFITSBayer : public QObject
+{
+    Q_OBJECT
+
+  public:
+    TestFITSBayer() = default;
+    ~TestFITSBayer() override = default;
+
+  private slots:
+    void testMethods_data();
+    void testMethods();
+    void testSuperpixel();
+    void testShiftFilter();
+
+    void benchmarkDebayer_data();
+    void benchmarkDebayer();
+};
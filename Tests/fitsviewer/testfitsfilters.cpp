@@ -0,0 +1,367 @@
+/***************************************************************************
+                          testfitsfilters.cpp  -
+                             -------------------
+    begin                : Sun 18 Oct 2026
+    copyright            : (c) 2026 by KStars Developers
+***************************************************************************/
+
+/***************************************************************************
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ ***************************************************************************/
+
+#include "testfitsfilters.h"
+
+#include "fitsfilters.h"
+
+#include <QtTest>
+
+#include <fitsio.h>
+
+namespace
+{
+// A 16 megapixel frame, the size of a common CMOS sensor
+const uint32_t benchWidth = 4656, benchHeight = 3520;
+
+template <typename T>
+QVector<T> randomImage(uint32_t width, uint32_t height, int range)
+{
+    QVector<T> image(width * height);
+    qsrand(42);
+    for (auto &sample : image)
+        sample = static_cast<T>(qrand() % range);
+    return image;
+}
+
+template <typename T>
+void runFilter(const QString &filter, QVector<T> &image, uint32_t width, uint32_t height)
+{
+    const T min = 10, max = 100;
+
+    if (filter == "clamp")
+        FITSFilters::clampChannel(image.data(), width, height, min, max);
+    else if (filter == "log")
+        FITSFilters::logChannel(image.data(), width, height, min, max);
+    else if (filter == "sqrt")
+        FITSFilters::sqrtChannel(image.data(), width, height, min, max);
+    else if (filter == "equalize")
+        FITSFilters::equalizeChannel(image.data(), width, height, min, max,
+                                     FITSFilters::histogramChannel(image.constData(), width, height, min, max));
+    else if (filter == "median")
+        FITSFilters::medianChannel(image.data(), width, height);
+}
+
+template <typename T>
+void benchmark(const QString &filter)
+{
+    QVector<T> source = randomImage<T>(benchWidth, benchHeight, 120);
+    QVector<T> image;
+
+    QBENCHMARK
+    {
+        image = source;
+        image.detach();
+        runFilter(filter, image, benchWidth, benchHeight);
+    }
+}
+
+template <typename T>
+void checkMedian()
+{
+    const uint32_t width = 37, height = 23;
+    QVector<T> source = randomImage<T>(width, height, 100);
+    QVector<T> image  = source;
+
+    FITSFilters::medianChannel(image.data(), width, height);
+
+    for (uint32_t y = 0; y < height; y++)
+    {
+        for (uint32_t x = 0; x < width; x++)
+        {
+            QVector<T> window;
+            for (int dy = -1; dy <= 1; dy++)
+                for (int dx = -1; dx <= 1; dx++)
+                {
+                    int yy = qBound(0, int(y) + dy, int(height) - 1);
+                    int xx = qBound(0, int(x) + dx, int(width) - 1);
+                    window.append(source[yy * width + xx]);
+                }
+            std::sort(window.begin(), window.end());
+            QCOMPARE(image[y * width + x], window[4]);
+        }
+    }
+}
+
+template <typename T>
+void checkClamp()
+{
+    // Odd sizes exercise the scalar tails of the vector kernels
+    const uint32_t width = 31, height = 7;
+    QVector<T> source = randomImage<T>(width, height, 100);
+    QVector<T> image  = source;
+
+    FITSFilters::clampChannel(image.data(), width, height, T(20), T(70));
+
+    for (int i = 0; i < source.size(); i++)
+        QCOMPARE(image[i], qBound(T(20), source[i], T(70)));
+}
+
+template <typename T>
+void checkStatistics()
+{
+    // Enough rows for every thread to fill and merge its own bins
+    const uint32_t width = 37, height = 101;
+    QVector<T> image = randomImage<T>(width, height, 100);
+
+    QVector<T> sorted = image;
+    std::sort(sorted.begin(), sorted.end());
+    const T min = sorted.first(), max = sorted.last();
+
+    const QVector<uint32_t> histogram = FITSFilters::histogramChannel(image.constData(), width, height, min, max);
+    QCOMPARE(static_cast<uint32_t>(histogram.size()), FITSFilters::histogramBins<T>());
+
+    // Every sample is counted once, in the bin of its value
+    QVector<uint32_t> expected(histogram.size(), 0);
+    const double scale = FITSFilters::histogramScale(min, max, histogram.size());
+    for (T value : image)
+        expected[FITSFilters::histogramBin(value, min, scale, histogram.size(), FITSFilters::UsesLUT<T>())]++;
+    QCOMPARE(histogram, expected);
+
+    const uint64_t rank = FITSFilters::medianRank(image.size());
+    const double median = FITSFilters::medianOfChannel(image.constData(), width, height, min, max, histogram);
+    QCOMPARE(median, static_cast<double>(sorted[rank]));
+
+    QVector<double> deviations;
+    for (T value : image)
+        deviations.append(std::fabs(static_cast<double>(value) - median));
+    std::sort(deviations.begin(), deviations.end());
+
+    QCOMPARE(FITSFilters::madOfChannel(image.constData(), width, height, min, max, histogram, median), deviations[rank]);
+}
+
+// FITSData stores the channels of a colour image one after the other, and filters each of them
+const int channels = 3;
+
+template <typename T>
+void filterChannels(const QString &filter, QVector<T> &image, uint32_t width, uint32_t height, T min, T max)
+{
+    const uint32_t samples = width * height;
+    for (int n = 0; n < channels; n++)
+    {
+        T *channel = image.data() + n * samples;
+
+        if (filter == "log")
+            FITSFilters::logChannel(channel, width, height, min, max);
+        else if (filter == "sqrt")
+            FITSFilters::sqrtChannel(channel, width, height, min, max);
+        else if (filter == "equalize")
+            FITSFilters::equalizeChannel(channel, width, height, min, max,
+                                         FITSFilters::histogramChannel(channel, width, height, min, max));
+    }
+}
+
+template <typename T>
+void compareSample(T sample, double expected)
+{
+    // Integer samples are rounded, float sqrt uses single precision
+    if (std::is_integral<T>::value)
+        QCOMPARE(sample, static_cast<T>(std::round(expected)));
+    else
+        QVERIFY2(std::fabs(sample - expected) <= 1e-4 * std::max(1.0, std::fabs(expected)),
+                 qPrintable(QString("%1 != %2").arg(static_cast<double>(sample)).arg(expected)));
+}
+
+template <typename T>
+void checkStretch()
+{
+    const uint32_t width = 13, height = 5;
+    const T min = 10, max = 150;
+    const QVector<T> source = randomImage<T>(width, height * channels, 200);
+
+    for (const QString filter : { "log", "sqrt" })
+    {
+        QVector<T> image = source;
+        filterChannels(filter, image, width, height, min, max);
+
+        for (int i = 0; i < source.size(); i++)
+        {
+            const double a = qBound<double>(min, source[i], max);
+            const double stretched = (filter == "log") ? max / std::log(1.0 + max) * std::log(1.0 + a) :
+                                                         max / std::sqrt(double(max)) * std::sqrt(a);
+            compareSample(image[i], qBound<double>(min, stretched, max));
+        }
+    }
+}
+
+template <typename T>
+void checkEqualize()
+{
+    const uint32_t width = 13, height = 5, samples = width * height;
+    const T min = 10, max = 150;
+    const QVector<T> source = randomImage<T>(width, height * channels, 200);
+
+    QVector<T> image = source;
+    filterChannels("equalize", image, width, height, min, max);
+
+    // Every integer value has its own bin, a sample becomes the share of samples of its channel not above it. Only
+    // types without lookup tables put the samples out of [min, max] in the bins of min and max.
+    auto binned = [=](T value) { return FITSFilters::UsesLUT<T>::value ? value : qBound(min, value, max); };
+
+    for (int n = 0; n < channels; n++)
+    {
+        for (uint32_t i = n * samples; i < (n + 1) * samples; i++)
+        {
+            uint32_t below = 0;
+            for (uint32_t j = n * samples; j < (n + 1) * samples; j++)
+            {
+                if (binned(source[j]) <= binned(source[i]))
+                    below++;
+            }
+            compareSample(image[i], qBound<double>(min, 255.0 * below / samples, max));
+        }
+    }
+}
+
+template <typename T>
+void checkEqualizeValues()
+{
+    // Two samples in each of four bins, then all in the last bin but one, then uneven bins
+    QVector<T> image = { 0, 0, 1, 1, 2, 2, 3, 3, 3, 3, 3, 3, 3, 3, 3, 0, 2, 0, 2, 0, 1, 1, 1, 1 };
+    const QVector<double> expected = { 63.75,  63.75, 127.5, 127.5, 191.25, 191.25, 255,   255,
+                                       255,    255,   255,   255,   255,    255,    255,   31.875,
+                                       255,    63.75, 255,   63.75, 191.25, 191.25, 191.25, 191.25 };
+
+    filterChannels("equalize", image, 4, 2, T(0), T(255));
+
+    for (int i = 0; i < image.size(); i++)
+        compareSample(image[i], expected[i]);
+}
+}
+
+void TestFITSFilters::testMedian()
+{
+    checkMedian<uint8_t>();
+    checkMedian<int16_t>();
+    checkMedian<uint16_t>();
+    checkMedian<int32_t>();
+    checkMedian<uint32_t>();
+    checkMedian<float>();
+    checkMedian<int64_t>();
+    checkMedian<double>();
+}
+
+void TestFITSFilters::testClamp()
+{
+    checkClamp<uint8_t>();
+    checkClamp<int16_t>();
+    checkClamp<uint16_t>();
+    checkClamp<int32_t>();
+    checkClamp<uint32_t>();
+    checkClamp<float>();
+    checkClamp<int64_t>();
+    checkClamp<double>();
+}
+
+void TestFITSFilters::testStatistics()
+{
+    checkStatistics<uint8_t>();
+    checkStatistics<int16_t>();
+    checkStatistics<uint16_t>();
+    checkStatistics<int32_t>();
+    checkStatistics<uint32_t>();
+    checkStatistics<float>();
+    checkStatistics<int64_t>();
+    checkStatistics<double>();
+}
+
+void TestFITSFilters::testStretch()
+{
+    // Reference values with min 0 and max 100, sqrt(x) used to be computed as x
+    QVector<uint16_t> image = { 0, 4, 9, 25, 100, 100, 25, 9, 4, 0, 120, 50, 1, 16, 64 };
+    QVector<uint16_t> logImage = image, sqrtImage = image;
+
+    filterChannels<uint16_t>("log", logImage, 5, 1, 0, 100);
+    filterChannels<uint16_t>("sqrt", sqrtImage, 5, 1, 0, 100);
+
+    QCOMPARE(logImage, QVector<uint16_t>({ 0, 35, 50, 71, 100, 100, 71, 50, 35, 0, 100, 85, 15, 61, 90 }));
+    QCOMPARE(sqrtImage, QVector<uint16_t>({ 0, 20, 30, 50, 100, 100, 50, 30, 20, 0, 100, 71, 10, 40, 80 }));
+
+    checkStretch<uint8_t>();
+    checkStretch<int16_t>();
+    checkStretch<uint16_t>();
+    checkStretch<int32_t>();
+    checkStretch<uint32_t>();
+    checkStretch<float>();
+    checkStretch<int64_t>();
+    checkStretch<double>();
+}
+
+void TestFITSFilters::testEqualize()
+{
+    // 8 bit data is equalized through one bin per value, float data through binned values
+    checkEqualizeValues<uint8_t>();
+    checkEqualizeValues<float>();
+
+    checkEqualize<uint8_t>();
+    checkEqualize<int16_t>();
+    checkEqualize<uint16_t>();
+    checkEqualize<int32_t>();
+    checkEqualize<uint32_t>();
+    checkEqualize<float>();
+    checkEqualize<int64_t>();
+    checkEqualize<double>();
+}
+
+void TestFITSFilters::benchmarkFilters_data()
+{
+    QTest::addColumn<int>("dataType");
+    QTest::addColumn<QString>("filter");
+
+    const QList<QPair<int, QString>> types = { { TBYTE, "BYTE" },  { TSHORT, "SHORT" },        { TUSHORT, "USHORT" },
+                                               { TLONG, "LONG" },  { TULONG, "ULONG" },        { TFLOAT, "FLOAT" },
+                                               { TLONGLONG, "LONGLONG" }, { TDOUBLE, "DOUBLE" } };
+
+    for (const auto &type : types)
+        for (const QString filter : { "clamp", "log", "sqrt", "equalize", "median" })
+            QTest::newRow(QString("%1 %2").arg(type.second, filter).toLatin1()) << type.first << filter;
+}
+
+void TestFITSFilters::benchmarkFilters()
+{
+    QFETCH(int, dataType);
+    QFETCH(QString, filter);
+
+    switch (dataType)
+    {
+        case TBYTE:
+            benchmark<uint8_t>(filter);
+            break;
+        case TSHORT:
+            benchmark<int16_t>(filter);
+            break;
+        case TUSHORT:
+            benchmark<uint16_t>(filter);
+            break;
+        case TLONG:
+            benchmark<int32_t>(filter);
+            break;
+        case TULONG:
+            benchmark<uint32_t>(filter);
+            break;
+        case TFLOAT:
+            benchmark<float>(filter);
+            break;
+        case TLONGLONG:
+            benchmark<int64_t>(filter);
+            break;
+        case TDOUBLE:
+            benchmark<double>(filter);
+            break;
+    }
+}
+
+QTEST_GUILESS_MAIN(TestFITSFilters)
@@ -0,0 +1,42 @@
+/***************************************************************************
+                          testfitsfilters.h  -
+                             -------------------
+    begin                : Sun 18 Oct 2026
+    copyright            : (c) 2026 by KStars Developers
+***************************************************************************/
+
+/***************************************************************************
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ ***************************************************************************/
+
+#pragma once
+
+#include <QObject>
+
+/**
+ * @class TestFITSFilters
+ * @short Tests and benchmarks for the FITS filter kernels, for all FITS data types
+ */
+class TestFITSFilters : public QObject
+{
+    Q_OBJECT
+
+  public:
+    TestFITSFilters() = default;
+    ~TestFITSFilters() override = default;
+
+  private slots:
+    void testMedian();
+    void testClamp();
+    void testStatistics();
+    void testStretch();
+    void testEqualize();
+
+    void benchmarkFilters_data();
+    void benchmarkFilters();
+};
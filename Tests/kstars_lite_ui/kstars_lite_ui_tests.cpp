@@ -12,8 +12,12 @@
 
 #include "auxiliary/kspaths.h"
 #include "kstarslite.h"
+#include "skymaplite.h"
 
+#include <QAtomicInt>
+#include <QElapsedTimer>
 #include <QFuture>
+#include <QQuickWindow>
 #include <QtConcurrentRun>
 #include <QtTest/QtTest>
 
@@ -98,4 +102,54 @@ void KStarsLiteUiTests::openToolbars()
     }
 }
 
+void KStarsLiteUiTests::starFrameTime()
+{
+    QFuture<void> waitFuture = QtConcurrent::run(waitForKStars);
+
+    while (!waitFuture.isFinished())
+    {
+        QCoreApplication::instance()->processEvents();
+        usleep(20*1000);
+    }
+
+    QQuickWindow *window = kstarsLiteInstance->getMainWindow();
+    SkyMapLite *map      = kstarsLiteInstance->map();
+
+    QCOMPARE(window != nullptr, true);
+    QCOMPARE(map != nullptr, true);
+
+    // Frames are swapped on the render thread
+    QAtomicInt frames;
+    QMetaObject::Connection connection = QObject::connect(
+        window, &QQuickWindow::frameSwapped, window, [&frames]() { frames.ref(); }, Qt::DirectConnection);
+
+    // A wide field down to faint stars, so that most trixels of the star catalogs are drawn
+    map->setZoomFactor(MINZOOM * 2);
+
+    const int frameCount = 100;
+    QElapsedTimer timer;
+    timer.start();
+
+    // Pan along the equator, every frame moves all the stars and shows new trixels
+    for (int i = 0; i < frameCount; ++i)
+    {
+        const int swapped = frames.load();
+
+        map->setFocus(dms(3.6 * i), dms(0.0));
+        map->forceUpdate();
+
+        QElapsedTimer frameTimer;
+        frameTimer.start();
+        while (frames.load() == swapped && frameTimer.elapsed() < 5000)
+            QCoreApplication::instance()->processEvents(QEventLoop::AllEvents, 5);
+
+        QCOMPARE(frames.load() != swapped, true);
+    }
+
+    const double frameTime = double(timer.elapsed()) / frameCount;
+    QObject::disconnect(connection);
+
+    QTest::setBenchmarkResult(frameTime, QTest::WalltimeMilliseconds);
+}
+
 QTEST_MAIN(KStarsLiteUiTests);
@@ -26,4 +26,5 @@ class KStarsLiteUiTests : public QObject
     void initTestCase();
     void cleanupTestCase();
     void openToolbars();
+    void starFrameTime();
 };
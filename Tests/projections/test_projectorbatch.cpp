@@ -0,0 +1,189 @@
+/***************************************************************************
+               test_projectorbatch.cpp  -  KStars Planetarium
+                             -------------------
+    begin                : Sun 18 Oct 2026
+    copyright            : (c) 2026 by KStars Developers
+ ***************************************************************************/
+
+/***************************************************************************
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ ***************************************************************************/
+
+/* Project Includes */
+#include "test_projectorbatch.h"
+#include "projections/azimuthalequidistantprojector.h"
+#include "projections/equirectangularprojector.h"
+#include "projections/gnomonicprojector.h"
+#include "projections/lambertprojector.h"
+#include "projections/orthographicprojector.h"
+#include "projections/stereographicprojector.h"
+
+#include <cmath>
+#include <limits>
+#include <memory>
+
+namespace
+{
+// Enough points to fill several chunks of the batch, and to leave a tail that is not a whole SIMD pack
+const int POINT_COUNT = 100003;
+
+std::unique_ptr<Projector> createProjector(Projector::Projection type, bool useAltAz, SkyPoint *focus)
+{
+    ViewParams p;
+    p.width         = 1920;
+    p.height        = 1080;
+    p.zoomFactor    = 400;
+    p.useRefraction = true;
+    p.useAltAz      = useAltAz;
+    p.fillGround    = false;
+    p.focus         = focus;
+
+    switch (type)
+    {
+        case Projector::Lambert:
+            return std::unique_ptr<Projector>(new LambertProjector(p));
+        case Projector::AzimuthalEquidistant:
+            return std::unique_ptr<Projector>(new AzimuthalEquidistantProjector(p));
+        case Projector::Orthographic:
+            return std::unique_ptr<Projector>(new OrthographicProjector(p));
+        case Projector::Equirectangular:
+            return std::unique_ptr<Projector>(new EquirectangularProjector(p));
+        case Projector::Stereographic:
+            return std::unique_ptr<Projector>(new StereographicProjector(p));
+        case Projector::Gnomonic:
+            return std::unique_ptr<Projector>(new GnomonicProjector(p));
+        default:
+            return std::unique_ptr<Projector>();
+    }
+}
+}
+
+void TestProjectorBatch::initTestCase()
+{
+    m_focus = SkyPoint(5.0, 30.0);
+    m_focus.setAlt(40.0);
+    m_focus.setAz(120.0);
+
+    // The horizontal coordinates are drawn independently of the equatorial ones, the projector uses only one pair
+    qsrand(42);
+    m_points.reserve(POINT_COUNT);
+    for (int i = 0; i < POINT_COUNT - 1; ++i)
+    {
+        SkyPoint p(24.0 * (qrand() % 100000) / 100000.0, 180.0 * (qrand() % 100000) / 100000.0 - 90.0);
+        p.setAz(360.0 * (qrand() % 100000) / 100000.0);
+        p.setAlt(180.0 * (qrand() % 100000) / 100000.0 - 90.0);
+        m_points.push_back(p);
+    }
+
+    // A point without coordinates is projected at the origin and not visible
+    const double NaN = std::numeric_limits<double>::quiet_NaN();
+    SkyPoint invalid(NaN, NaN);
+    invalid.setAz(NaN);
+    invalid.setAlt(NaN);
+    m_points.push_back(invalid);
+
+    for (SkyPoint &p : m_points)
+        m_pointers.append(&p);
+}
+
+void TestProjectorBatch::projections()
+{
+    QTest::addColumn<Projector::Projection>("type");
+    QTest::addColumn<bool>("useAltAz");
+
+    const QList<Projector::Projection> types = { Projector::Lambert,         Projector::AzimuthalEquidistant,
+                                                 Projector::Orthographic,    Projector::Equirectangular,
+                                                 Projector::Stereographic,   Projector::Gnomonic };
+    const QMetaEnum projection = QMetaEnum::fromType<Projector::Projection>();
+    for (Projector::Projection type : types)
+    {
+        QTest::newRow(QString("%1 equatorial").arg(projection.valueToKey(type)).toLatin1().constData()) << type << false;
+        QTest::newRow(QString("%1 horizontal").arg(projection.valueToKey(type)).toLatin1().constData()) << type << true;
+    }
+}
+
+void TestProjectorBatch::testBatch_data()
+{
+    projections();
+}
+
+void TestProjectorBatch::testBatch()
+{
+    QFETCH(Projector::Projection, type);
+    QFETCH(bool, useAltAz);
+
+    std::unique_ptr<Projector> proj = createProjector(type, useAltAz, &m_focus);
+    QVERIFY(proj);
+
+    QVector<Vector2f> screen(m_pointers.size());
+    QVector<bool> visible(m_pointers.size());
+    proj->toScreenBatch(m_pointers.constData(), m_pointers.size(), screen.data(), visible.data());
+
+    for (int i = 0; i < m_pointers.size(); ++i)
+    {
+        bool onVisibleHemisphere = false;
+        Vector2f expected        = proj->toScreenVec(m_pointers[i], true, &onVisibleHemisphere);
+
+        QCOMPARE(visible[i], onVisibleHemisphere);
+        // The equirectangular projection keeps NaN where the others return the origin
+        if (!(std::isfinite(expected.x()) && std::isfinite(expected.y())))
+            continue;
+
+        // Only the rounding of the sines and cosines differs, the tolerance is relative for the far side of the
+        // sphere that some projections send far off screen
+        QVERIFY(fabs(screen[i].x() - expected.x()) <= 1e-3 * (1 + fabs(expected.x())));
+        QVERIFY(fabs(screen[i].y() - expected.y()) <= 1e-3 * (1 + fabs(expected.y())));
+    }
+}
+
+void TestProjectorBatch::benchmarkPerPoint_data()
+{
+    projections();
+}
+
+void TestProjectorBatch::benchmarkPerPoint()
+{
+    QFETCH(Projector::Projection, type);
+    QFETCH(bool, useAltAz);
+
+    std::unique_ptr<Projector> proj = createProjector(type, useAltAz, &m_focus);
+    QVector<Vector2f> screen(m_pointers.size());
+    QVector<bool> visible(m_pointers.size());
+
+    QBENCHMARK
+    {
+        for (int i = 0; i < m_pointers.size(); ++i)
+        {
+            bool onVisibleHemisphere = false;
+            screen[i]                = proj->toScreenVec(m_pointers[i], true, &onVisibleHemisphere);
+            visible[i]               = onVisibleHemisphere;
+        }
+    }
+}
+
+void TestProjectorBatch::benchmarkBatch_data()
+{
+    projections();
+}
+
+void TestProjectorBatch::benchmarkBatch()
+{
+    QFETCH(Projector::Projection, type);
+    QFETCH(bool, useAltAz);
+
+    std::unique_ptr<Projector> proj = createProjector(type, useAltAz, &m_focus);
+    QVector<Vector2f> screen(m_pointers.size());
+    QVector<bool> visible(m_pointers.size());
+
+    QBENCHMARK
+    {
+        proj->toScreenBatch(m_pointers.constData(), m_pointers.size(), screen.data(), visible.data());
+    }
+}
+
+QTEST_GUILESS_MAIN(TestProjectorBatch)
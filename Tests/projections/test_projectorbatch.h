@@ -0,0 +1,55 @@
+/***************************************************************************
+                test_projectorbatch.h  -  KStars Planetarium
+                             -------------------
+    begin                : Sun 18 Oct 2026
+    copyright            : (c) 2026 by KStars Developers
+***************************************************************************/
+
+/***************************************************************************
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ ***************************************************************************/
+
+#pragma once
+
+#include "skyobjects/skypoint.h"
+
+#include <QtTest/QtTest>
+
+#include <vector>
+
+/**
+ * @class TestProjectorBatch
+ * @short Tests and benchmarks of the batch projection against Projector::toScreenVec()
+ */
+class TestProjectorBatch : public QObject
+{
+    Q_OBJECT
+
+  public:
+    TestProjectorBatch() : QObject(){};
+    ~TestProjectorBatch() override{};
+
+  private slots:
+    void initTestCase();
+
+    void testBatch_data();
+    void testBatch();
+
+    void benchmarkPerPoint_data();
+    void benchmarkPerPoint();
+
+    void benchmarkBatch_data();
+    void benchmarkBatch();
+
+  private:
+    void projections();
+
+    SkyPoint m_focus;
+    std::vector<SkyPoint> m_points;
+    QVector<SkyPoint *> m_pointers;
+};
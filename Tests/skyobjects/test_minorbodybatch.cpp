@@ -0,0 +1,110 @@
+/***************************************************************************
+               test_minorbodybatch.cpp  -  KStars Planetarium
+                             -------------------
+    begin                : Sun 18 Oct 2026
+    copyright            : (c) 2026 by KStars Developers
+ ***************************************************************************/
+
+/***************************************************************************
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ ***************************************************************************/
+
+/* Project Includes */
+#include "test_minorbodybatch.h"
+#include "ksnumbers.h"
+#include "auxiliary/dms.h"
+#include "skyobjects/ksasteroid.h"
+#include "skyobjects/kscomet.h"
+#include "skyobjects/minorbodybatch.h"
+
+#include <cmath>
+#include <memory>
+#include <vector>
+
+void TestMinorBodyBatch::testPositions()
+{
+    const long double epoch = 2458600.5;
+    std::vector<std::unique_ptr<KSAsteroid>> asteroids;
+    MinorBodyBatch batch;
+
+    // Enough bodies to fill several SIMD chunks, with eccentricities up to 0.95 to exercise the scalar refinement
+    qsrand(42);
+    for (int k = 0; k < 500; ++k)
+    {
+        const double e = 0.95 * (qrand() % 1000) / 1000.0;
+        const double a = 0.5 + 40.0 * (qrand() % 1000) / 1000.0;
+        asteroids.emplace_back(new KSAsteroid(k, QString::number(k), QString(), epoch, a, e, dms(qrand() % 180),
+                                              dms(qrand() % 360), dms(qrand() % 360), dms(qrand() % 360), 3.0, 0.15));
+        QVERIFY(batch.append(asteroids.back().get()));
+    }
+    QCOMPARE(batch.count(), 500);
+
+    // Without the Earth, the batch gives heliocentric directions like KSAsteroid::findPosition()
+    const long double jd = epoch + 1234.5;
+    KSNumbers num(jd);
+    batch.update(jd, nullptr);
+
+    for (int k = 0; k < batch.count(); ++k)
+    {
+        KSAsteroid *asteroid = asteroids[k].get();
+
+        // A zero distance to the Earth skips the phase, which needs the Earth of the sky composite
+        asteroid->setRearth(0.0);
+        asteroid->findPosition(&num);
+
+        double ra, dec;
+        batch.position(k, ra, dec);
+        QVERIFY(batch.isHandled(k));
+        QVERIFY(fabs(batch.rsun(k) - asteroid->rsun()) < 1e-6 * asteroid->rsun());
+        QVERIFY(fabs(batch.rearth(k) - batch.rsun(k)) < 1e-9 * batch.rsun(k));
+
+        // KSAsteroid rotates with the obliquity of date instead of J2000, a few arcseconds apart
+        const double dRA = fabs(remainder(ra - asteroid->ra0().Degrees(), 360.0));
+        QVERIFY(dRA * cos(dec * dms::DegToRad) < 0.01);
+        QVERIFY(fabs(dec - asteroid->dec0().Degrees()) < 0.01);
+
+        QVERIFY(fabs(batch.magnitude(k) - (3.0 + 10.0 * log10(batch.rsun(k)))) < 1e-9);
+    }
+}
+
+void TestMinorBodyBatch::testUnhandled()
+{
+    MinorBodyBatch batch;
+
+    // Slope parameter outside [0, 1]: the position is computed but the magnitude has no bound
+    KSAsteroid bright(1, "Bright", QString(), 2458600.5, 2.5, 0.1, dms(10), dms(20), dms(30), dms(40), 5.0, 1.5);
+    // Near-parabolic and hyperbolic comets
+    KSComet parabolic("Parabolic", QString(), 2458600.5, 1.0, 0.99, dms(10), dms(20), dms(30), 20190501.0, 10, 15,
+                      4, 5);
+    KSComet hyperbolic("Hyperbolic", QString(), 2458600.5, 1.0, 1.1, dms(10), dms(20), dms(30), 20190501.0, 10, 15,
+                       4, 5);
+    // Short period comet
+    KSComet periodic("Periodic", QString(), 2458600.5, 1.0, 0.6, dms(10), dms(20), dms(30), 20190501.0, 10, 15, 4,
+                     5);
+
+    QVERIFY(batch.append(&bright));
+    QVERIFY(!batch.append(&parabolic));
+    QVERIFY(!batch.append(&hyperbolic));
+    QVERIFY(batch.append(&periodic));
+    batch.update(2458700.5, nullptr);
+
+    QVERIFY(batch.isHandled(0));
+    QVERIFY(std::isnan(batch.magnitude(0)));
+    QVERIFY(batch.rsun(0) > 2.0 && batch.rsun(0) < 3.0);
+
+    QVERIFY(!batch.isHandled(1));
+    QVERIFY(!batch.isHandled(2));
+    QVERIFY(std::isnan(batch.rsun(1)));
+
+    // Comets have no magnitude bound, the perihelion distance bounds the distance to the Sun
+    QVERIFY(batch.isHandled(3));
+    QVERIFY(std::isnan(batch.magnitude(3)));
+    QVERIFY(batch.rsun(3) >= 1.0 - 1e-9 && batch.rsun(3) <= 4.0 + 1e-9);
+}
+
+QTEST_GUILESS_MAIN(TestMinorBodyBatch)
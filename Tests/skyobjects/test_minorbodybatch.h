@@ -0,0 +1,36 @@
+/***************************************************************************
+                test_minorbodybatch.h  -  KStars Planetarium
+                             -------------------
+    begin                : Sun 18 Oct 2026
+    copyright            : (c) 2026 by KStars Developers
+***************************************************************************/
+
+/***************************************************************************
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ ***************************************************************************/
+
+#pragma once
+
+#include <QtTest/QtTest>
+
+/**
+ * @class TestMinorBodyBatch
+ * @short Tests for the batch Kepler solution of asteroids and comets
+ */
+class TestMinorBodyBatch : public QObject
+{
+    Q_OBJECT
+
+  public:
+    TestMinorBodyBatch() : QObject(){};
+    ~TestMinorBodyBatch() override{};
+
+  private slots:
+    void testPositions();
+    void testUnhandled();
+};
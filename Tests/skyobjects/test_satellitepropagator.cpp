@@ -0,0 +1,255 @@
+/***************************************************************************
+             test_satellitepropagator.cpp  -  KStars Planetarium
+                             -------------------
+    begin                : Sun 18 Oct 2026
+    copyright            : (c) 2026 by KStars Developers
+ ***************************************************************************/
+
+/***************************************************************************
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ ***************************************************************************/
+
+/* Project Includes */
+#include "test_satellitepropagator.h"
+#include "auxiliary/dms.h"
+#include "auxiliary/geolocation.h"
+#include "kstarsdata.h"
+#include "skyobjects/satellite.h"
+#include "skyobjects/satellitepropagator.h"
+#include "time/kstarsdatetime.h"
+#include "time/simclock.h"
+
+#include <cmath>
+
+namespace
+{
+// Low orbit, and the eccentric orbit of the SGP4 verification test cases
+const char *ISS[]   = { "1 25544U 98067A   20001.50000000  .00001000  00000-0  25000-4 0  9990",
+                        "2 25544  51.6400 100.0000 0005000  90.0000 270.0000 15.49000000    05" };
+const char *SAT05[] = { "1 00005U 58002B   00179.78495062  .00000023  00000-0  28098-4 0  4753",
+                        "2 00005  34.2682 348.7242 1859667 331.7664  19.3264 10.82419157413667" };
+
+// Epochs of the TLEs
+const double ISS_EPOCH   = 2458849.5 + 1.5;
+const double SAT05_EPOCH = 2451543.5 + 179.78495062;
+
+double elevation(const Satellite &satellite, GeoLocation *geo, double jd)
+{
+    double position[3], velocity[3], azimuth, elevation, range;
+
+    satellite.propagate(jd, position, velocity);
+    Satellite::Observer(geo, jd).toHorizontal(position, azimuth, elevation, range);
+    return elevation * 180.0 / M_PI;
+}
+
+// Satellite::updatePos() reads the time of the clock, the propagator is given the same Julian date
+double setClock(KStarsData *data, double jd)
+{
+    data->clock()->setUTC(KStarsDateTime(static_cast<long double>(jd)));
+    data->syncLST();
+    return data->clock()->utc().djd();
+}
+
+// Angle between the horizontal coordinates of two satellites, in degrees
+double separation(const Satellite &a, const Satellite &b)
+{
+    const double cosine = sin(a.alt().radians()) * sin(b.alt().radians()) +
+                          cos(a.alt().radians()) * cos(b.alt().radians()) * cos(a.az().radians() - b.az().radians());
+    return acos(qBound(-1.0, cosine, 1.0)) * 180.0 / M_PI;
+}
+
+// Positions interpolated between the nodes stay within a few meters of SGP4, even for the eccentric orbit
+void compareInterpolated(Satellite &satellite, Satellite &reference)
+{
+    QVERIFY(separation(satellite, reference) < 1e-3);
+    QVERIFY(fabs(satellite.range() - reference.range()) < 0.01);
+    QVERIFY(fabs(satellite.altitude() - reference.altitude()) < 0.01);
+    QVERIFY(fabs(satellite.velocity() - reference.velocity()) < 0.002);
+}
+
+// Positions propagated directly are the ones of Satellite::updatePos()
+void compareDirect(Satellite &satellite, Satellite &reference)
+{
+    QCOMPARE(satellite.alt().Degrees(), reference.alt().Degrees());
+    QCOMPARE(satellite.az().Degrees(), reference.az().Degrees());
+    QCOMPARE(satellite.range(), reference.range());
+    QCOMPARE(satellite.velocity(), reference.velocity());
+}
+}
+
+void TestSatellitePropagator::testPropagate()
+{
+    Satellite satellite("00005", SAT05[0], SAT05[1]);
+    double position[3], velocity[3];
+
+    // Reference values from "Revisiting Spacetrack Report #3", Vallado et al., 2006
+    QCOMPARE(satellite.propagate(SAT05_EPOCH, position, velocity), 0);
+    QVERIFY(fabs(position[0] - 7022.46529266) < 1e-3);
+    QVERIFY(fabs(position[1] + 1400.08296755) < 1e-3);
+    QVERIFY(fabs(position[2] - 0.03995155) < 1e-3);
+    QVERIFY(fabs(velocity[0] - 1.893841015) < 1e-6);
+    QVERIFY(fabs(velocity[1] - 6.405893759) < 1e-6);
+    QVERIFY(fabs(velocity[2] - 4.534807250) < 1e-6);
+
+    QCOMPARE(satellite.propagate(SAT05_EPOCH + 360.0 / 1440.0, position, velocity), 0);
+    QVERIFY(fabs(position[0] + 7154.03120202) < 1e-3);
+    QVERIFY(fabs(position[1] + 3783.17682504) < 1e-3);
+    QVERIFY(fabs(position[2] + 3536.19412294) < 1e-3);
+    QVERIFY(fabs(velocity[0] - 4.741887409) < 1e-6);
+    QVERIFY(fabs(velocity[1] + 4.151817765) < 1e-6);
+    QVERIFY(fabs(velocity[2] + 2.093935425) < 1e-6);
+}
+
+void TestSatellitePropagator::testPasses()
+{
+    Satellite satellite("ISS", ISS[0], ISS[1]);
+    GeoLocation geo(dms(2.0), dms(48.0));
+
+    const QVector<SatellitePropagator::Pass> passes =
+        SatellitePropagator::predictPasses(&satellite, &geo, ISS_EPOCH, ISS_EPOCH + 1);
+    QVERIFY(passes.count() >= 4);
+
+    // Sample the elevation every 10 seconds, a second away from the predicted rises and sets
+    const double second = 1.0 / 86400;
+    int pass            = 0;
+    for (double jd = ISS_EPOCH; jd < ISS_EPOCH + 1; jd += 10 * second)
+    {
+        while (pass < passes.count() && jd > passes[pass].los + second)
+            pass++;
+
+        if (pass < passes.count() && jd > passes[pass].aos - second && jd < passes[pass].los + second)
+        {
+            if (jd > passes[pass].aos + second && jd < passes[pass].los - second)
+                QVERIFY(elevation(satellite, &geo, jd) > 0);
+            QVERIFY(elevation(satellite, &geo, jd) < passes[pass].maxElevation + 1e-6);
+        }
+        else
+        {
+            QVERIFY(elevation(satellite, &geo, jd) < 0);
+        }
+    }
+
+    for (const SatellitePropagator::Pass &p : passes)
+    {
+        QVERIFY(p.aos < p.culmination && p.culmination < p.los);
+        QVERIFY(fabs(elevation(satellite, &geo, p.culmination) - p.maxElevation) < 1e-9);
+    }
+}
+
+void TestSatellitePropagator::testBatchPasses()
+{
+    Satellite iss("ISS", ISS[0], ISS[1]), sat05("00005", SAT05[0], SAT05[1]);
+    GeoLocation geo(dms(-70.0), dms(-30.0));
+
+    SatellitePropagator propagator;
+    propagator.setSatellites(QVector<Satellite *>() << &iss << &sat05);
+
+    const QVector<QVector<SatellitePropagator::Pass>> passes = propagator.predictPasses(&geo, ISS_EPOCH, ISS_EPOCH + 1);
+    QCOMPARE(passes.count(), 2);
+
+    for (int i = 0; i < 2; i++)
+    {
+        const QVector<SatellitePropagator::Pass> single =
+            SatellitePropagator::predictPasses(propagator.satellites()[i], &geo, ISS_EPOCH, ISS_EPOCH + 1);
+        QCOMPARE(passes[i].count(), single.count());
+        for (int j = 0; j < single.count(); j++)
+        {
+            QCOMPARE(passes[i][j].aos, single[j].aos);
+            QCOMPARE(passes[i][j].los, single[j].los);
+            QCOMPARE(passes[i][j].maxElevation, single[j].maxElevation);
+        }
+    }
+}
+
+void TestSatellitePropagator::testUpdate()
+{
+    KStarsData *data = KStarsData::Instance() ? KStarsData::Instance() : KStarsData::Create();
+    data->setLocation(GeoLocation(dms(2.0), dms(48.0)));
+
+    Satellite iss("ISS", ISS[0], ISS[1]), sat05("00005", SAT05[0], SAT05[1]);
+    Satellite issReference("ISS", ISS[0], ISS[1]), sat05Reference("00005", SAT05[0], SAT05[1]);
+    Satellite *satellites[] = { &iss, &sat05 }, *references[] = { &issReference, &sat05Reference };
+
+    SatellitePropagator propagator;
+    propagator.setSatellites(QVector<Satellite *>() << &iss << &sat05);
+
+    auto update = [&](double jd, bool skipBelowHorizon) {
+        jd = setClock(data, jd);
+        QVERIFY(propagator.update(data->geo(), jd, skipBelowHorizon).isEmpty());
+        for (Satellite *reference : references)
+            QCOMPARE(reference->updatePos(), 0);
+    };
+
+    // The first update is far from the nodes of the cache, satellites are propagated directly
+    const double second = 1.0 / 86400, minute = 1.0 / 1440;
+    const double start  = (floor(ISS_EPOCH * 1440) + 0.5) / 1440;
+    update(start, false);
+    for (int i = 0; i < 2; i++)
+        compareDirect(*satellites[i], *references[i]);
+
+    // Within the interval, and after steps of one minute that keep one node, in both directions
+    for (double jd : { start + 10 * second, start + 25 * second, start + minute, start + minute + 50 * second,
+                       start + 2 * minute, start + minute, start, start - minute + 5 * second })
+    {
+        update(jd, false);
+        for (int i = 0; i < 2; i++)
+            compareInterpolated(*satellites[i], *references[i]);
+    }
+
+    // A jump of the clock propagates directly, the next update in the same interval interpolates again
+    update(start + 1, false);
+    for (int i = 0; i < 2; i++)
+        compareDirect(*satellites[i], *references[i]);
+
+    update(start + 1 + 20 * second, false);
+    for (int i = 0; i < 2; i++)
+        compareInterpolated(*satellites[i], *references[i]);
+
+    // Start below the horizon for the ISS and above it for the eccentric orbit
+    double jd = ISS_EPOCH;
+    while (jd < ISS_EPOCH + 1 && (elevation(iss, data->geo(), jd) > -10 || elevation(sat05, data->geo(), jd) < 10))
+        jd += minute;
+    QVERIFY(jd < ISS_EPOCH + 1);
+
+    // A skipped satellite keeps its position below the horizon, others are updated
+    int skipped = 0;
+    for (const double end = jd + 2.0 / 24; jd < end; jd += 20 * second)
+    {
+        const double issAlt = iss.alt().Degrees(), issAz = iss.az().Degrees();
+        update(jd, true);
+
+        if (iss.alt().Degrees() == issAlt && iss.az().Degrees() == issAz)
+        {
+            skipped++;
+            QVERIFY(iss.alt().Degrees() < 0);
+            QVERIFY(issReference.alt().Degrees() < -1);
+        }
+        else
+        {
+            compareInterpolated(iss, issReference);
+        }
+
+        if (sat05Reference.alt().Degrees() > 0)
+            compareInterpolated(sat05, sat05Reference);
+    }
+    QVERIFY(skipped > 0);
+
+    // Satellites are looked at again before they rise
+    const QVector<SatellitePropagator::Pass> passes =
+        SatellitePropagator::predictPasses(&iss, data->geo(), jd, jd + 1);
+    QVERIFY(!passes.isEmpty());
+
+    for (double t = passes[0].aos - 10 * minute; t < passes[0].los; t += 20 * second)
+    {
+        update(t, true);
+        if (issReference.alt().Degrees() > -1)
+            compareInterpolated(iss, issReference);
+    }
+}
+
+QTEST_GUILESS_MAIN(TestSatellitePropagator)
@@ -0,0 +1,38 @@
+/***************************************************************************
+              test_satellitepropagator.h  -  KStars Planetarium
+                             -------------------
+    begin                : Sun 18 Oct 2026
+    copyright            : (c) 2026 by KStars Developers
+***************************************************************************/
+
+/***************************************************************************
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ ***************************************************************************/
+
+#pragma once
+
+#include <QtTest/QtTest>
+
+/**
+ * @class TestSatellitePropagator
+ * @short Tests for SGP4 propagation and pass prediction of satellites
+ */
+class TestSatellitePropagator : public QObject
+{
+    Q_OBJECT
+
+  public:
+    TestSatellitePropagator() : QObject(){};
+    ~TestSatellitePropagator() override{};
+
+  private slots:
+    void testPropagate();
+    void testPasses();
+    void testBatchPasses();
+    void testUpdate();
+};
@@ -20,6 +20,7 @@
 #include "ksnumbers.h"
 #include "time/kstarsdatetime.h"
 #include "auxiliary/dms.h"
+#include "skyobjects/apparentplacebatch.h"
 
 void TestSkyPoint::testPrecession()
 {
@@ -93,4 +94,45 @@ void TestSkyPoint::testPrecession()
     verify(p, 169.71785991, 45.30132855, arcsecPrecision);
 }
 
+void TestSkyPoint::testBatchApparentPlace()
+{
+    // The batch kernel must agree with the per-point computation away from the poles
+    constexpr int n = 13;
+    constexpr double arcsecPrecision = 0.2 / 3600.;
+
+    KSNumbers num(KStarsDateTime::epochToJd(2017.3));
+    dms LST(123.4), lat(48.2);
+
+    float ra0[n], dec0[n], ra[n], dec[n], alt[n], az[n], alt2[n], az2[n];
+    for (int i = 0; i < n; ++i)
+    {
+        ra0[i]  = 360. * i / n + 3.7;
+        dec0[i] = -75. + 150. * i / (n - 1);
+    }
+
+    ApparentPlaceBatch batch(&num);
+    batch.setLocation(&LST, &lat);
+    batch.apply(n, ra0, dec0, nullptr, nullptr, ra, dec, alt, az);
+    batch.toHorizontal(n, ra, dec, alt2, az2);
+
+    for (int i = 0; i < n; ++i)
+    {
+        SkyPoint p(ra0[i] / 15., dec0[i]);
+        p.precess(&num);
+        p.nutate(&num);
+        p.aberrate(&num);
+        p.EquatorialToHorizontal(&LST, &lat);
+
+        double dRA = fabs(ra[i] - p.ra().Degrees());
+        dRA        = qMin(dRA, 360. - dRA) * cos(p.dec().radians());
+        double dAz = fabs(az[i] - p.az().Degrees());
+        dAz        = qMin(dAz, 360. - dAz) * cos(p.alt().radians());
+        QVERIFY(dRA < arcsecPrecision);
+        QVERIFY(fabs(dec[i] - p.dec().Degrees()) < arcsecPrecision);
+        QVERIFY(dAz < arcsecPrecision);
+        QVERIFY(fabs(alt[i] - p.alt().Degrees()) < arcsecPrecision);
+        QVERIFY(fabs(alt2[i] - alt[i]) < arcsecPrecision);
+    }
+}
+
 QTEST_GUILESS_MAIN(TestSkyPoint)
@@ -19,11 +19,13 @@
 
 #include "catalogdata.h"
 #include "catalogentrydata.h"
+#include "catalogsnapshot.h"
 #include "kstars/version.h"
 #include "../kstars/auxiliary/kspaths.h"
 #include "starobject.h"
 #include "deepskyobject.h"
 #include "skycomponent.h"
+#include "skymesh.h"
 
 #include <QSqlTableModel>
 #include <QSqlRecord>
@@ -116,6 +118,9 @@ void CatalogDB::FirstRun()
             qCWarning(KSTARS_CATALOG) << query.lastError();
         }
     }
+
+    // Snapshots were written from the rows of another database
+    CatalogSnapshot::removeAll();
     return;
 }
 
@@ -184,6 +189,8 @@ int CatalogDB::FindCatalog(const QString &catalog_name)
 
 void CatalogDB::AddCatalog(const CatalogData &catalog_data)
 {
+    CatalogSnapshot(catalog_data.catalog_name).remove();
+
     skydb_.open();
     QSqlTableModel cat_entry(nullptr, skydb_);
     cat_entry.setTable("Catalog");
@@ -210,6 +217,7 @@ void CatalogDB::RemoveCatalog(const QString &catalog_name)
 {
     // Part 1 Clear DSO Entries
     ClearDSOEntries(FindCatalog(catalog_name));
+    CatalogSnapshot(catalog_name).remove();
 
     skydb_.open();
     QSqlTableModel catalog(nullptr, skydb_);
@@ -241,6 +249,8 @@ void CatalogDB::ClearDSOEntries(int catalog_id)
 
     del_query.append("DELETE FROM ObjectDesignation WHERE id_Catalog = " + QString::number(catalog_id));
 
+    RemoveSnapshot(catalog_id);
+
     for (int i = 0; i < del_query.count(); ++i)
     {
         QSqlQuery query(skydb_);
@@ -297,6 +307,8 @@ bool CatalogDB::AddEntry(const CatalogEntryData &catalog_entry, int catid)
         return false;
     }
     bool retVal = _AddEntry(catalog_entry, catid);
+    if (retVal)
+        RemoveSnapshot(catid);
     skydb_.close();
     return retVal;
 }
@@ -510,6 +522,7 @@ bool CatalogDB::AddCatalogContents(const QString &fname)
             _AddEntry(catalog_entry, catid);
         }
 
+        RemoveSnapshot(catid);
         skydb_.commit();
         skydb_.close();
     }
@@ -828,46 +841,39 @@ void CatalogDB::GetCatalogData(const QString &catalog_name, CatalogData &load_ca
 
 void CatalogDB::GetAllObjects(const QString &catalog, QList<SkyObject *> &sky_list,
                               QList<QPair<int, QString>> &object_names, CatalogComponent *catalog_ptr,
-                              bool includeCatalogDesignation)
+                              bool includeCatalogDesignation, QVector<Trixel> *trixels)
 {
     qDeleteAll(sky_list);
     sky_list.clear();
-    QString selected_catalog = QString::number(FindCatalog(catalog));
-
-    skydb_.open();
-    QSqlQuery get_query(skydb_);
-    get_query.prepare("SELECT Epoch, Type, RA, Dec, Magnitude, Prefix, "
-                      "IDNumber, LongName, MajorAxis, MinorAxis, "
-                      "PositionAngle, Flux FROM ObjectDesignation JOIN DSO "
-                      "JOIN Catalog WHERE Catalog.id = :catID AND "
-                      "ObjectDesignation.id_Catalog = Catalog.id AND "
-                      "ObjectDesignation.UID_DSO = DSO.UID");
-    get_query.bindValue(":catID", selected_catalog);
+    if (trixels)
+        trixels->clear();
+    int catalog_id = FindCatalog(catalog);
 
-    //     qWarning() << get_query.lastQuery();
-    //     qWarning() << get_query.lastError();
-    //     qWarning() << FindCatalog(catalog);
+    // Objects are read from the snapshot of the catalog, removed when its rows are written
+    CatalogSnapshot snapshot(catalog);
+    SkyMesh *mesh = SkyMesh::Instance();
 
-    if (!get_query.exec())
+    if (!snapshot.load(mesh ? mesh->level() : -1))
     {
-        qWarning() << get_query.lastQuery();
-        qWarning() << get_query.lastError();
+        qCInfo(KSTARS_CATALOG) << "Writing snapshot of catalog" << catalog;
+        skydb_.open();
+        WriteSnapshot(catalog_id, mesh, snapshot);
+        skydb_.close();
     }
 
-    while (get_query.next())
+    QString catPrefix = snapshot.prefix();
+    if (trixels)
+        trixels->reserve(snapshot.count());
+
+    for (int i = 0; i < snapshot.count(); ++i)
     {
-        int cat_epoch       = get_query.value(0).toInt();
-        unsigned char iType = get_query.value(1).toInt();
-        dms RA(get_query.value(2).toDouble());
-        dms Dec(get_query.value(3).toDouble());
-        float mag                = get_query.value(4).toFloat();
-        QString catPrefix        = get_query.value(5).toString();
-        int id_number_in_catalog = get_query.value(6).toInt();
-        QString lname            = get_query.value(7).toString();
-        float a                  = get_query.value(8).toFloat();
-        float b                  = get_query.value(9).toFloat();
-        float PA                 = get_query.value(10).toFloat();
-        float flux               = get_query.value(11).toFloat();
+        const CatalogSnapshot::Record &record = snapshot.record(i);
+        if (trixels)
+            trixels->append(record.trixel);
+        unsigned char iType                   = record.type;
+        dms RA(record.ra);
+        dms Dec(record.dec);
+        QString lname = snapshot.longName(record);
         QString name;
 
         if (!includeCatalogDesignation && !lname.isEmpty())
@@ -876,35 +882,7 @@ void CatalogDB::GetAllObjects(const QString &catalog, QList<SkyObject *> &sky_li
             lname = QString();
         }
         else
-            name = catPrefix + ' ' + QString::number(id_number_in_catalog);
-
-        SkyPoint t;
-        t.set(RA, Dec);
-
-        if (cat_epoch == 1950)
-        {
-            // Assume B1950 epoch
-            t.B1950ToJ2000(); // t.ra() and t.dec() are now J2000.0
-            // coordinates
-        }
-        else if (cat_epoch == 2000)
-        {
-            // Do nothing
-            {
-            }
-        }
-        else
-        {
-            // FIXME: What should we do?
-            // FIXME: This warning will be printed for each line in the
-            //        catalog rather than once for the entire catalog
-            qWarning() << "Unknown epoch while dealing with custom "
-                          "catalog. Will ignore the epoch and assume"
-                          " J2000.0";
-        }
-
-        RA  = t.ra();
-        Dec = t.dec();
+            name = catPrefix + ' ' + QString::number(record.idNumber);
 
         // FIXME: It is a bad idea to create objects in one class
         // (using new) and delete them in another! The objects created
@@ -913,15 +891,16 @@ void CatalogDB::GetAllObjects(const QString &catalog, QList<SkyObject *> &sky_li
 
         if (iType == 0) // Add a star
         {
-            StarObject *o = new StarObject(RA, Dec, mag, lname);
+            StarObject *o = new StarObject(RA, Dec, record.magnitude, lname);
 
             sky_list.append(o);
         }
         else // Add a deep-sky object
         {
-            DeepSkyObject *o = new DeepSkyObject(iType, RA, Dec, mag, name, QString(), lname, catPrefix, a, b, -PA);
+            DeepSkyObject *o = new DeepSkyObject(iType, RA, Dec, record.magnitude, name, QString(), lname, catPrefix,
+                                                 record.majorAxis, record.minorAxis, -record.positionAngle);
 
-            o->setFlux(flux);
+            o->setFlux(record.flux);
             o->setCustomCatalog(catalog_ptr);
 
             sky_list.append(o);
@@ -938,9 +917,97 @@ void CatalogDB::GetAllObjects(const QString &catalog, QList<SkyObject *> &sky_li
             object_names.append(qMakePair<int, QString>(iType, lname));
         }
     }
+}
+
+void CatalogDB::RemoveSnapshot(int catalog_id)
+{
+    QSqlQuery get_query(skydb_);
+    get_query.prepare("SELECT Name FROM Catalog WHERE id = :catID");
+    get_query.bindValue(":catID", catalog_id);
+
+    if (!get_query.exec())
+    {
+        qCWarning(KSTARS_CATALOG) << get_query.lastError();
+        return;
+    }
+
+    while (get_query.next())
+        CatalogSnapshot(get_query.value(0).toString()).remove();
+}
+
+bool CatalogDB::WriteSnapshot(int catalog_id, SkyMesh *mesh, CatalogSnapshot &snapshot)
+{
+    QSqlQuery get_query(skydb_);
+    get_query.setForwardOnly(true);
+    get_query.prepare("SELECT Epoch, Type, RA, Dec, Magnitude, Prefix, "
+                      "IDNumber, LongName, MajorAxis, MinorAxis, "
+                      "PositionAngle, Flux FROM ObjectDesignation JOIN DSO "
+                      "JOIN Catalog WHERE Catalog.id = :catID AND "
+                      "ObjectDesignation.id_Catalog = Catalog.id AND "
+                      "ObjectDesignation.UID_DSO = DSO.UID");
+    get_query.bindValue(":catID", catalog_id);
+
+    //     qWarning() << get_query.lastQuery();
+    //     qWarning() << get_query.lastError();
+
+    if (!get_query.exec())
+    {
+        qWarning() << get_query.lastQuery();
+        qWarning() << get_query.lastError();
+    }
+
+    QVector<CatalogSnapshot::Record> records;
+    QStringList long_names;
+    QString catPrefix;
+    bool unknown_epoch = false;
+
+    while (get_query.next())
+    {
+        CatalogSnapshot::Record record;
+        int cat_epoch         = get_query.value(0).toInt();
+        record.type           = get_query.value(1).toInt();
+        dms RA(get_query.value(2).toDouble());
+        dms Dec(get_query.value(3).toDouble());
+        record.magnitude     = get_query.value(4).toFloat();
+        catPrefix            = get_query.value(5).toString();
+        record.idNumber      = get_query.value(6).toInt();
+        QString lname        = get_query.value(7).toString();
+        record.majorAxis     = get_query.value(8).toFloat();
+        record.minorAxis     = get_query.value(9).toFloat();
+        record.positionAngle = get_query.value(10).toFloat();
+        record.flux          = get_query.value(11).toFloat();
+
+        SkyPoint t;
+        t.set(RA, Dec);
+
+        if (cat_epoch == 1950)
+        {
+            // Assume B1950 epoch
+            t.B1950ToJ2000(); // t.ra() and t.dec() are now J2000.0
+            // coordinates
+        }
+        else if (cat_epoch != 2000)
+        {
+            // FIXME: What should we do?
+            unknown_epoch = true;
+        }
+
+        record.ra     = t.ra().Degrees();
+        record.dec    = t.dec().Degrees();
+        record.trixel = mesh ? mesh->HTMesh::index(record.ra, record.dec) : 0;
+
+        records.append(record);
+        long_names.append(lname);
+    }
+
+    if (unknown_epoch)
+        qWarning() << "Unknown epoch while dealing with custom "
+                      "catalog. Will ignore the epoch and assume"
+                      " J2000.0";
 
     get_query.clear();
-    skydb_.close();
+
+    return snapshot.save(mesh ? mesh->level() : -1, catPrefix, records, long_names);
 }
 
 QList<QPair<QString, KSParser::DataTypes>> CatalogDB::buildParserSequence(const QStringList &Columns)
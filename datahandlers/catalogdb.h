@@ -17,7 +17,9 @@
 
 #pragma once
 
+#include "catalogsnapshot.h"
 #include "ksparser.h"
+#include "skycomponents/typedef.h"
 
 #include <KLocalizedString>
 #ifndef KSTARS_LITE
@@ -31,6 +33,7 @@ class SkyObject;
 class CatalogComponent;
 class CatalogData;
 class CatalogEntryData;
+class SkyMesh;
 
 /*
  * Some notes about the database. (skycomponents.sqlite)
@@ -125,12 +128,13 @@ class CatalogDB
      * the designations "Misc 1", "Misc 2" etc. So the only proper designations are the
      * long name. When this is the case, this flag is set to false, and the catalog designation
      * (cat_prefix + cat_id) will not be included in the object_names returned.
+     * @param trixels If not null, trixel of the sky mesh containing each object of sky_list (assigns)
      *
      * @return void
      **/
     void GetAllObjects(const QString &catalog_name, QList<SkyObject *> &sky_list,
                        QList<QPair<int, QString>> &object_names, CatalogComponent *catalog_pointer,
-                       bool includeCatalogDesignation = true);
+                       bool includeCatalogDesignation = true, QVector<Trixel> *trixels = nullptr);
 
     /**
      * @brief Get information about the catalog like Prefix etc
@@ -230,6 +234,28 @@ class CatalogDB
      **/
     void ClearDSOEntries(int catalog_id);
 
+    /**
+     * @brief Removes the snapshot of a catalog, its rows being written
+     *
+     * @note The database must be open.
+     *
+     * @param catalog_id DB generated catalog ID
+     * @return void
+     **/
+    void RemoveSnapshot(int catalog_id);
+
+    /**
+     * @brief Reads the rows of a catalog and writes them to its snapshot
+     *
+     * @note The database must be open.
+     *
+     * @param catalog_id DB generated catalog ID
+     * @param mesh Sky mesh indexing the objects, may be null
+     * @param snapshot Snapshot of the catalog, usable even if it could not be written
+     * @return false if the snapshot could not be written
+     **/
+    bool WriteSnapshot(int catalog_id, SkyMesh *mesh, CatalogSnapshot &snapshot);
+
     /**
      * @brief Contains setup routines to intitialize a database for catalog storage
      *
@@ -0,0 +1,215 @@
+/***************************************************************************
+                catalogsnapshot.cpp  -  K Desktop Planetarium
+                             -------------------
+    begin                : 2026/10/18
+    copyright            : (C) 2026 by KStars Developers
+ ***************************************************************************/
+
+/***************************************************************************
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ ***************************************************************************/
+
+#include "catalogsnapshot.h"
+
+#include "../kstars/auxiliary/kspaths.h"
+
+#include <QCryptographicHash>
+#include <QDir>
+#include <QFileInfo>
+#include <QSaveFile>
+
+#include <algorithm>
+#include <cstring>
+#include <numeric>
+
+#include <catalog_debug.h>
+
+// "KSCS", read in another byte order it does not match
+#define SNAPSHOT_MAGIC 0x4B534353
+// Increase when the layout of the snapshot changes
+#define SNAPSHOT_VERSION 2
+
+struct CatalogSnapshot::Header
+{
+    quint32 magic;
+    quint32 version;
+    quint32 count;
+    qint32 htmLevel;
+    /// Catalog prefix, as an offset and a length in characters in the string table
+    quint32 prefix;
+    quint32 prefixLength;
+    /// Length of the string table in characters
+    quint32 stringsLength;
+    quint32 reserved;
+};
+
+// Records follow the header and are read in place, they must stay aligned
+static_assert(sizeof(CatalogSnapshot::Record) % 8 == 0, "Snapshot records must be 8-byte aligned");
+
+CatalogSnapshot::CatalogSnapshot(const QString &catalogName) : file(path(catalogName))
+{
+}
+
+CatalogSnapshot::~CatalogSnapshot()
+{
+    if (mappedData)
+        file.unmap(mappedData);
+}
+
+QString CatalogSnapshot::path(const QString &catalogName)
+{
+    // Catalog names are free text, hash them into file names
+    const QByteArray hash = QCryptographicHash::hash(catalogName.toUtf8(), QCryptographicHash::Md5).toHex();
+
+    return KSPaths::writableLocation(QStandardPaths::GenericCacheLocation) + "catalogs/" + QString::fromLatin1(hash) +
+           ".bin";
+}
+
+void CatalogSnapshot::removeAll()
+{
+    QDir(KSPaths::writableLocation(QStandardPaths::GenericCacheLocation) + "catalogs").removeRecursively();
+}
+
+bool CatalogSnapshot::setData(const uchar *data, qint64 size, int htmLevel)
+{
+    header  = nullptr;
+    records = nullptr;
+    strings = nullptr;
+
+    if (size < static_cast<qint64>(sizeof(Header)))
+        return false;
+
+    const Header *candidate = reinterpret_cast<const Header *>(data);
+
+    if (candidate->magic != SNAPSHOT_MAGIC || candidate->version != SNAPSHOT_VERSION || candidate->htmLevel != htmLevel)
+        return false;
+
+    const qint64 recordsSize = static_cast<qint64>(candidate->count) * sizeof(Record);
+    if (size != static_cast<qint64>(sizeof(Header)) + recordsSize + candidate->stringsLength * sizeof(QChar) ||
+        candidate->prefix + candidate->prefixLength > candidate->stringsLength)
+        return false;
+
+    const Record *candidateRecords = reinterpret_cast<const Record *>(data + sizeof(Header));
+    for (quint32 i = 0; i < candidate->count; ++i)
+    {
+        if (candidateRecords[i].longName + candidateRecords[i].longNameLength > candidate->stringsLength)
+            return false;
+    }
+
+    header  = candidate;
+    records = candidateRecords;
+    strings = reinterpret_cast<const QChar *>(data + sizeof(Header) + recordsSize);
+    return true;
+}
+
+bool CatalogSnapshot::load(int htmLevel)
+{
+    if (!file.open(QIODevice::ReadOnly))
+        return false;
+
+    mappedData = file.map(0, file.size());
+
+    if (mappedData && setData(mappedData, file.size(), htmLevel))
+        return true;
+
+    if (mappedData)
+        file.unmap(mappedData);
+    mappedData = nullptr;
+    file.close();
+
+    return false;
+}
+
+bool CatalogSnapshot::save(int htmLevel, const QString &prefix, const QVector<Record> &objects,
+                           const QStringList &longNames)
+{
+    Q_ASSERT(objects.count() == longNames.count());
+
+    if (mappedData)
+        file.unmap(mappedData);
+    mappedData = nullptr;
+    file.close();
+
+    // Objects are written by trixel, so that a trixel is a range of records
+    QVector<int> order(objects.count());
+    std::iota(order.begin(), order.end(), 0);
+    std::stable_sort(order.begin(), order.end(),
+                     [&objects](int i, int j) { return objects[i].trixel < objects[j].trixel; });
+
+    QString table = prefix;
+    QVector<Record> sorted;
+    sorted.reserve(objects.count());
+    for (int i : order)
+    {
+        Record record = objects[i];
+        memset(record.reserved, 0, sizeof(record.reserved));
+        record.longName       = table.length();
+        record.longNameLength = qMin(longNames[i].length(), 0xFFFF);
+        table.append(longNames[i].leftRef(record.longNameLength));
+        sorted.append(record);
+    }
+
+    Header fileHeader;
+    memset(&fileHeader, 0, sizeof(fileHeader));
+    fileHeader.magic         = SNAPSHOT_MAGIC;
+    fileHeader.version       = SNAPSHOT_VERSION;
+    fileHeader.count         = sorted.count();
+    fileHeader.htmLevel      = htmLevel;
+    fileHeader.prefix        = 0;
+    fileHeader.prefixLength  = prefix.length();
+    fileHeader.stringsLength = table.length();
+
+    savedData.clear();
+    savedData.reserve(sizeof(Header) + sorted.count() * sizeof(Record) + table.length() * sizeof(QChar));
+    savedData.append(reinterpret_cast<const char *>(&fileHeader), sizeof(Header));
+    savedData.append(reinterpret_cast<const char *>(sorted.constData()), sorted.count() * sizeof(Record));
+    savedData.append(reinterpret_cast<const char *>(table.constData()), table.length() * sizeof(QChar));
+
+    setData(reinterpret_cast<const uchar *>(savedData.constData()), savedData.size(), htmLevel);
+
+    QDir().mkpath(QFileInfo(file.fileName()).absolutePath());
+
+    QSaveFile output(file.fileName());
+    if (!output.open(QIODevice::WriteOnly) || output.write(savedData) != savedData.size() || !output.commit())
+    {
+        qCWarning(KSTARS_CATALOG) << "Unable to write catalog snapshot" << file.fileName() << output.errorString();
+        return false;
+    }
+
+    return true;
+}
+
+void CatalogSnapshot::remove()
+{
+    if (mappedData)
+        file.unmap(mappedData);
+    mappedData = nullptr;
+    file.close();
+
+    header  = nullptr;
+    records = nullptr;
+    strings = nullptr;
+    savedData.clear();
+
+    file.remove();
+}
+
+int CatalogSnapshot::count() const
+{
+    return header ? header->count : 0;
+}
+
+QString CatalogSnapshot::prefix() const
+{
+    return header ? QString(strings + header->prefix, header->prefixLength) : QString();
+}
+
+QString CatalogSnapshot::longName(const Record &record) const
+{
+    return QString(strings + record.longName, record.longNameLength);
+}
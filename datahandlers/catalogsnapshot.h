@@ -0,0 +1,119 @@
+/***************************************************************************
+                catalogsnapshot.h  -  K Desktop Planetarium
+                             -------------------
+    begin                : 2026/10/18
+    copyright            : (C) 2026 by KStars Developers
+ ***************************************************************************/
+
+/***************************************************************************
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ ***************************************************************************/
+
+#pragma once
+
+#include <QByteArray>
+#include <QFile>
+#include <QStringList>
+#include <QVector>
+
+/**
+ * @class CatalogSnapshot
+ * @short Binary snapshot of the objects of a catalog of the DSO database
+ *
+ * Reading a catalog from the database joins three tables, converts every value from a QVariant and precesses
+ * B1950 coordinates. The snapshot keeps the result in a file of the cache directory, which is mapped in memory
+ * when the catalog is loaded again: J2000 coordinates, the trixel of each object, records being sorted by trixel,
+ * and the long names in a string table.
+ *
+ * A snapshot is only used with the same sky mesh level. CatalogDB removes the snapshot of a catalog whenever it
+ * writes to the catalog, the next load writes it again. Snapshots are stored in the byte order of the machine, the
+ * header tells them apart.
+ */
+class CatalogSnapshot
+{
+  public:
+    /** Object of the catalog */
+    struct Record
+    {
+        /// J2000 coordinates in degrees
+        double ra;
+        double dec;
+        float magnitude;
+        float majorAxis;
+        float minorAxis;
+        float positionAngle;
+        float flux;
+        qint32 idNumber;
+        /// Trixel containing the J2000 coordinates
+        quint32 trixel;
+        /// Long name, as an offset and a length in characters in the string table
+        quint32 longName;
+        quint16 longNameLength;
+        quint8 type;
+        quint8 reserved[5];
+    };
+
+    /**
+     * @param catalogName Name of the catalog in the database
+     */
+    explicit CatalogSnapshot(const QString &catalogName);
+    ~CatalogSnapshot();
+
+    /**
+     * @brief load Map the snapshot of the catalog
+     * @param htmLevel Level of the sky mesh indexing the objects, -1 if there is none
+     * @return False if there is no snapshot, or if it is outdated
+     */
+    bool load(int htmLevel);
+
+    /**
+     * @brief save Write the snapshot of the catalog, then use it
+     * @param htmLevel Level of the sky mesh the trixels belong to, -1 if there is none
+     * @param prefix Designation prefix of the catalog
+     * @param records Objects of the catalog, their longName offsets are ignored
+     * @param longNames Long names of the objects, in the order of records
+     * @return False if the snapshot could not be written, it is still used until destroyed
+     */
+    bool save(int htmLevel, const QString &prefix, const QVector<Record> &records, const QStringList &longNames);
+
+    /** Delete the snapshot file */
+    void remove();
+
+    /** @return number of objects, 0 until loaded or saved */
+    int count() const;
+
+    /** @return object at index, objects are sorted by trixel */
+    const Record &record(int index) const { return records[index]; }
+
+    /** @return designation prefix of the catalog */
+    QString prefix() const;
+
+    /** @return long name of an object */
+    QString longName(const Record &record) const;
+
+    /** @return path of the snapshot of the catalog */
+    static QString path(const QString &catalogName);
+
+    /** Delete the snapshots of all catalogs */
+    static void removeAll();
+
+  private:
+    struct Header;
+
+    /// Check the snapshot pointed at by data
+    bool setData(const uchar *data, qint64 size, int htmLevel);
+
+    QFile file;
+    uchar *mappedData { nullptr };
+    /// Contents of the file when it was written by save()
+    QByteArray savedData;
+
+    const Header *header { nullptr };
+    const Record *records { nullptr };
+    const QChar *strings { nullptr };
+};
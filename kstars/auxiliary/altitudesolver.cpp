@@ -0,0 +1,194 @@
+/*  Altitude Solver
+    Copyright (C) 2026 KStars Developers
+
+    This application is free software; you can redistribute it and/or
+    modify it under the terms of the GNU General Public
+    License as published by the Free Software Foundation; either
+    version 2 of the License, or (at your option) any later version.
+*/
+
+#include "altitudesolver.h"
+
+#include "geolocation.h"
+#include "skyobjects/skypoint.h"
+
+#include <QHash>
+#include <QMutex>
+
+#include <cmath>
+
+// Cached results are dropped all at once past this count, a night of scheduling uses a few hundreds
+#define MAX_CACHED_RESULTS 4096
+
+namespace
+{
+struct CacheKey
+{
+    double ra;
+    double dec;
+    double altitude;
+    double longitude;
+    double latitude;
+    long double from;
+    long double to;
+
+    bool operator==(const CacheKey &other) const
+    {
+        return ra == other.ra && dec == other.dec && altitude == other.altitude && longitude == other.longitude &&
+               latitude == other.latitude && from == other.from && to == other.to;
+    }
+};
+
+uint qHash(const CacheKey &key, uint seed = 0)
+{
+    return ::qHash(key.ra, seed) ^ ::qHash(key.dec, seed) ^ ::qHash(key.altitude, seed) ^
+           ::qHash(key.longitude, seed) ^ ::qHash(key.latitude, seed) ^ ::qHash(static_cast<double>(key.from), seed) ^
+           ::qHash(static_cast<double>(key.to), seed);
+}
+
+QHash<CacheKey, QVector<AltitudeSolver::TimeRange>> cache;
+QMutex cacheMutex;
+
+/* Hour angle of target at time, in sidereal hours in [-12, 12[ */
+double hourAngle(const SkyPoint &target, const GeoLocation *geo, const KStarsDateTime &time)
+{
+    double ha = geo->GSTtoLST(time.gst()).Hours() - target.ra().Hours();
+
+    while (ha < -12.0)
+        ha += 24.0;
+    while (ha >= 12.0)
+        ha -= 24.0;
+
+    return ha;
+}
+
+/* Solar days elapsed while the sidereal time advances by the given sidereal hours */
+long double siderealHoursToDays(double hours)
+{
+    return hours / SIDEREALSECOND / 24.0L;
+}
+}
+
+double AltitudeSolver::hourAngleAtAltitude(const dms &dec, const dms &lat, double altitude)
+{
+    double sinDec, cosDec, sinLat, cosLat;
+    dec.SinCos(sinDec, cosDec);
+    lat.SinCos(sinLat, cosLat);
+
+    const double denominator = cosDec * cosLat;
+
+    // At the poles the altitude does not change over the day
+    if (denominator == 0)
+        return (asin(sinDec * sinLat) * 180.0 / dms::PI > altitude) ? 12.0 : 0.0;
+
+    const double cosHA = (sin(altitude * dms::DegToRad) - sinDec * sinLat) / denominator;
+
+    if (cosHA >= 1.0)
+        return 0.0;
+    if (cosHA <= -1.0)
+        return 12.0;
+
+    return acos(cosHA) * 12.0 / dms::PI;
+}
+
+QVector<AltitudeSolver::TimeRange> AltitudeSolver::aboveAltitude(const SkyPoint &target, const GeoLocation *geo,
+                                                                 double altitude, const KStarsDateTime &from,
+                                                                 const KStarsDateTime &to)
+{
+    const CacheKey key { target.ra().Degrees(), target.dec().Degrees(), altitude, geo->lng()->Degrees(),
+                         geo->lat()->Degrees(), from.djd(), to.djd() };
+
+    {
+        QMutexLocker locker(&cacheMutex);
+        auto cached = cache.constFind(key);
+        if (cached != cache.constEnd())
+            return cached.value();
+    }
+
+    QVector<TimeRange> ranges;
+    const double limit = hourAngleAtAltitude(target.dec(), *geo->lat(), altitude);
+
+    if (limit >= 12.0)
+        ranges.append({ from, to });
+    else if (limit > 0)
+    {
+        const long double halfRange = siderealHoursToDays(limit);
+        const long double day       = siderealHoursToDays(24.0);
+
+        // Start from the transit closest to the start of the period, the one before cannot overlap it
+        for (long double transit = from.djd() - siderealHoursToDays(hourAngle(target, geo, from));
+             transit - halfRange < to.djd(); transit += day)
+        {
+            const long double start = qMax(transit - halfRange, from.djd());
+            const long double end   = qMin(transit + halfRange, to.djd());
+
+            if (start < end)
+                ranges.append({ KStarsDateTime(start), KStarsDateTime(end) });
+        }
+    }
+
+    QMutexLocker locker(&cacheMutex);
+    if (cache.count() >= MAX_CACHED_RESULTS)
+        cache.clear();
+    cache.insert(key, ranges);
+
+    return ranges;
+}
+
+KStarsDateTime AltitudeSolver::nextTransit(const SkyPoint &target, const GeoLocation *geo, const KStarsDateTime &from)
+{
+    const double ha = hourAngle(target, geo, from);
+
+    return KStarsDateTime(from.djd() + siderealHoursToDays(ha < 0 ? -ha : 24.0 - ha));
+}
+
+bool AltitudeSolver::findFirst(const std::function<bool(const KStarsDateTime &)> &condition,
+                               const KStarsDateTime &from, const KStarsDateTime &to, uint32_t step,
+                               uint32_t precision, KStarsDateTime &found)
+{
+    if (to < from)
+        return false;
+
+    if (condition(from))
+    {
+        found = from;
+        return true;
+    }
+
+    const long double stepDays      = step / 86400.0L;
+    const long double precisionDays = qMax<uint32_t>(precision, 1) / 86400.0L;
+
+    long double failed = from.djd();
+    while (failed < to.djd())
+    {
+        long double met = qMin(failed + stepDays, to.djd());
+
+        if (condition(KStarsDateTime(met)) == false)
+        {
+            failed = met;
+            continue;
+        }
+
+        // The condition changed between the two samples, bisect the change
+        while (met - failed > precisionDays)
+        {
+            const long double middle = (failed + met) / 2;
+
+            if (condition(KStarsDateTime(middle)))
+                met = middle;
+            else
+                failed = middle;
+        }
+
+        found = KStarsDateTime(met);
+        return true;
+    }
+
+    return false;
+}
+
+void AltitudeSolver::clearCache()
+{
+    QMutexLocker locker(&cacheMutex);
+    cache.clear();
+}
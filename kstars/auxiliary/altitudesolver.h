@@ -0,0 +1,101 @@
+/*  Altitude Solver
+    Copyright (C) 2026 KStars Developers
+
+    This application is free software; you can redistribute it and/or
+    modify it under the terms of the GNU General Public
+    License as published by the Free Software Foundation; either
+    version 2 of the License, or (at your option) any later version.
+*/
+
+#pragma once
+
+#include "kstarsdatetime.h"
+
+#include <QVector>
+
+#include <functional>
+
+class dms;
+class GeoLocation;
+class SkyPoint;
+
+/**
+ * @class AltitudeSolver
+ *
+ * Times at which a point of fixed equatorial coordinates crosses an altitude, or culminates.
+ *
+ * Over a day the altitude of such a point only depends on its hour angle, so the crossings are
+ * solved analytically instead of sampling the altitude. The coordinates are those of the point
+ * when the solver is called, precession and nutation over the searched period are neglected,
+ * as is refraction, like in SkyPoint::EquatorialToHorizontal().
+ *
+ * Results of aboveAltitude() are cached per point, altitude, location and searched period, so
+ * evaluating the same targets again during a night costs a hash lookup. The cache is shared by
+ * all callers.
+ *
+ * For conditions that cannot be solved analytically, such as the separation from the moon,
+ * findFirst() brackets the first time a condition is met with coarse samples then bisects it.
+ *
+ * (it is impossible to instantiate an AltitudeSolver object; just use the static functions).
+ *
+ * @short Analytic rise, set and transit times of fixed points
+ */
+class AltitudeSolver
+{
+  public:
+    /** A period of time, in UT */
+    struct TimeRange
+    {
+        KStarsDateTime start;
+        KStarsDateTime end;
+    };
+
+    /**
+     * @brief aboveAltitude Find when a point is above an altitude
+     * @param target Point, with its current equatorial coordinates set
+     * @param geo Location of the observer
+     * @param altitude Altitude in degrees
+     * @param from Start of the searched period, in UT
+     * @param to End of the searched period, in UT
+     * @return Ordered periods during which the altitude of target is above altitude, clipped to the searched period
+     */
+    static QVector<TimeRange> aboveAltitude(const SkyPoint &target, const GeoLocation *geo, double altitude,
+                                            const KStarsDateTime &from, const KStarsDateTime &to);
+
+    /**
+     * @brief nextTransit Find when a point next crosses the meridian, culminating
+     * @param target Point, with its current equatorial coordinates set
+     * @param geo Location of the observer
+     * @param from Time after which the transit is searched, in UT
+     * @return Time of the transit, in UT
+     */
+    static KStarsDateTime nextTransit(const SkyPoint &target, const GeoLocation *geo, const KStarsDateTime &from);
+
+    /**
+     * @brief hourAngleAtAltitude Find the hour angle at which a declination crosses an altitude
+     * @param dec Declination
+     * @param lat Latitude of the observer
+     * @param altitude Altitude in degrees
+     * @return Hour angle in sidereal hours, 0 if the declination is never above the altitude, 12 if it is always above
+     */
+    static double hourAngleAtAltitude(const dms &dec, const dms &lat, double altitude);
+
+    /**
+     * @brief findFirst Find the first time at which a condition is met
+     * @param condition Condition to meet, called with times in UT
+     * @param from Start of the searched period, in UT
+     * @param to End of the searched period, in UT
+     * @param step Interval between the samples, in seconds. Periods shorter than this may be missed.
+     * @param precision Precision of the found time, in seconds
+     * @param found Set to the first time at which condition is met
+     * @return False if condition is not met at any of the samples
+     */
+    static bool findFirst(const std::function<bool(const KStarsDateTime &)> &condition, const KStarsDateTime &from,
+                          const KStarsDateTime &to, uint32_t step, uint32_t precision, KStarsDateTime &found);
+
+    /** Forget all cached results */
+    static void clearCache();
+
+  private:
+    AltitudeSolver() = default;
+};
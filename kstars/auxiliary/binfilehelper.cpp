@@ -40,6 +40,7 @@ BinFileHelper::~BinFileHelper()
 
 void BinFileHelper::init()
 {
+    unmapFile();
     if (fileHandle)
         fclose(fileHandle);
 
@@ -95,9 +96,44 @@ FILE *BinFileHelper::openFile(const QString &fileName)
         errnum = ERR_FILEOPEN;
         return nullptr;
     }
+    filePath = FilePath;
     return fileHandle;
 }
 
+bool BinFileHelper::mapFile()
+{
+    if (mappedData)
+        return true;
+    if (!fileHandle || filePath.isEmpty())
+        return false;
+
+    mappedFile.setFileName(filePath);
+    if (!mappedFile.open(QIODevice::ReadOnly))
+        return false;
+
+    mappedSize = mappedFile.size();
+    mappedData = (mappedSize > 0) ? mappedFile.map(0, mappedSize) : nullptr;
+
+    if (!mappedData)
+    {
+        mappedSize = 0;
+        mappedFile.close();
+        return false;
+    }
+    return true;
+}
+
+void BinFileHelper::unmapFile()
+{
+    if (!mappedData)
+        return;
+
+    mappedFile.unmap(mappedData);
+    mappedFile.close();
+    mappedData = nullptr;
+    mappedSize = 0;
+}
+
 enum BinFileHelper::Errors BinFileHelper::__readHeader()
 {
     qint16 endian_id, i;
@@ -287,8 +323,10 @@ bool BinFileHelper::readHeader()
 
 void BinFileHelper::closeFile()
 {
+    unmapFile();
     fclose(fileHandle);
     fileHandle = nullptr;
+    filePath.clear();
 }
 
 int BinFileHelper::getErrorNumber()
@@ -18,6 +18,7 @@
 
 #pragma once
 
+#include <QFile>
 #include <QString>
 #include <QVector>
 
@@ -81,6 +82,44 @@ class BinFileHelper
      */
     void closeFile();
 
+    /**
+     * @short  Map the currently open file read-only into the address space of the process
+     *
+     * Once mapped, records can be accessed through getMappedData() without any seeking
+     * or copying. The stdio handle stays open, so that callers which still use fread()
+     * keep working. The mapping is released by closeFile() or unmapFile().
+     *
+     * @return true if the file could be mapped, false otherwise (no file open, or the
+     *         platform refused the mapping). The caller should fall back to stdio.
+     */
+    bool mapFile();
+
+    /**
+     * @short  Release the memory mapping of the file, if any
+     */
+    void unmapFile();
+
+    /**
+     * @return true if the file is currently memory-mapped
+     */
+    inline bool isMapped() const { return mappedData != nullptr; }
+
+    /**
+     * @short  Returns a pointer into the memory-mapped file
+     * @param  offset  Offset in bytes from the beginning of the file
+     * @return Pointer to the byte at the given offset, or nullptr if the file is not
+     *         mapped or the offset lies beyond the end of the file
+     */
+    inline const uchar *getMappedData(quint64 offset) const
+    {
+        return ((mappedData && offset < mappedSize) ? mappedData + offset : nullptr);
+    }
+
+    /**
+     * @return Size of the mapped region in bytes, or zero if the file is not mapped
+     */
+    inline quint64 getMappedSize() const { return (mappedData ? mappedSize : 0); }
+
     /**
      * @short   Get error number
      * @return  A number corresponding to the error
@@ -241,6 +280,14 @@ class BinFileHelper
 
     /// Handle to the file.
     FILE *fileHandle { nullptr};
+    /// Full path of the currently open file, used to create the memory mapping
+    QString filePath;
+    /// Device backing the memory mapping
+    QFile mappedFile;
+    /// Start of the memory-mapped file, nullptr if the file is not mapped
+    uchar *mappedData { nullptr };
+    /// Size of the memory-mapped region in bytes
+    quint64 mappedSize { 0 };
     /// Stores offsets corresponding to each index table entry
     QVector<unsigned long> indexOffset;
     /// Stores number of records under each index table entry
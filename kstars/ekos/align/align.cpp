@@ -15,6 +15,7 @@
 #include "fov.h"
 #include "kstars.h"
 #include "kstarsdata.h"
+#include "localastrometryparser.h"
 #include "offlineastrometryparser.h"
 #include "onlineastrometryparser.h"
 #include "opsalign.h"
@@ -225,6 +226,13 @@ Align::Align()
         connect(parser, SIGNAL(solverFailed()), this, SLOT(solverFailed()), Qt::UniqueConnection);
     }
 
+    localParser.reset(new LocalAstrometryParser());
+    localParser->setAlign(this);
+    localParser->setImageView(alignView);
+    connect(localParser.get(), SIGNAL(solverFinished(double,double,double,double)), this,
+            SLOT(solverFinished(double,double,double,double)));
+    connect(localParser.get(), SIGNAL(solverFailed()), this, SLOT(localSolverFailed()));
+
     //solverOptions->setText(Options::solverOptions());
 
     // Which telescope info to use for FOV calculations
@@ -1772,6 +1780,7 @@ void Align::checkAlignmentTimeout()
     else if (loadSlewState == IPS_IDLE)
     {
         appendLogText(i18n("Solver timed out"));
+        localParser->stopSolver();
         parser->stopSolver();
         captureAndSolve();
     }
@@ -2769,9 +2778,27 @@ void Align::startSolving(const QString &filename, bool isGenerated)
     state = ALIGN_PROGRESS;
     emit newStatus(state);
 
+    // Captured FITS images are first solved locally near the mount position, the solver only runs if that fails
+    if (Options::astrometryUseLocalSolver() && solverTypeGroup->checkedId() != SOLVER_REMOTE &&
+        blobType == ISD::CCD::BLOB_FITS && localParser->startSovler(filename, solverArgs, isGenerated))
+    {
+        localSolverFile = filename;
+        localSolverArgs = solverArgs;
+        return;
+    }
+
     parser->startSovler(filename, solverArgs, isGenerated);
 }
 
+void Align::localSolverFailed()
+{
+    if (state != ALIGN_PROGRESS)
+        return;
+
+    appendLogText(i18n("Solving with astrometry.net..."));
+    parser->startSovler(localSolverFile, localSolverArgs, true);
+}
+
 void Align::solverFinished(double orientation, double ra, double dec, double pixscale)
 {
     pi->stopAnimation();
@@ -3141,6 +3168,7 @@ void Align::solverFailed()
 
 void Align::abort()
 {
+    localParser->stopSolver();
     parser->stopSolver();
     pi->stopAnimation();
     stopB->setEnabled(false);
@@ -40,6 +40,7 @@ namespace Ekos
 class AstrometryParser;
 class OnlineAstrometryParser;
 class OfflineAstrometryParser;
+class LocalAstrometryParser;
 class RemoteAstrometryParser;
 class OpsAstrometry;
 class OpsAlign;
@@ -367,6 +368,11 @@ class Align : public QWidget, public Ui::Align
          */
     void solverFailed();
 
+    /**
+         * @brief Process local solver failure, solve the same image with the configured solver.
+         */
+    void localSolverFailed();
+
     /**
          * @brief We received new telescope info, process them and update FOV.
          */
@@ -625,6 +631,11 @@ class Align : public QWidget, public Ui::Align
     std::unique_ptr<OnlineAstrometryParser> onlineParser;
     std::unique_ptr<OfflineAstrometryParser> offlineParser;
 
+    // Local solver, tried before the parsers above when the position is known
+    std::unique_ptr<LocalAstrometryParser> localParser;
+    QString localSolverFile;
+    QStringList localSolverArgs;
+
     std::unique_ptr<RemoteAstrometryParser> remoteParser;
     ISD::GDInterface *remoteParserDevice { nullptr };
 
@@ -672,7 +683,7 @@ class Align : public QWidget, public Ui::Align
     QTimer alignTimer;
 
     // BLOB Type
-    ISD::CCD::BlobType blobType;
+    ISD::CCD::BlobType blobType { ISD::CCD::BLOB_OTHER };
     QString blobFileName;
 
     // Align Frame
@@ -0,0 +1,702 @@
+/*  Local Astrometry Parser
+    Copyright (C) 2026 KStars Developers
+
+    This application is free software; you can redistribute it and/or
+    modify it under the terms of the GNU General Public
+    License as published by the Free Software Foundation; either
+    version 2 of the License, or (at your option) any later version.
+*/
+
+#include "localastrometryparser.h"
+
+#include "align.h"
+#include "dms.h"
+#include "Options.h"
+#include "fitsviewer/fitsdata.h"
+#include "fitsviewer/fitsview.h"
+#include "skycomponents/starcomponent.h"
+#include "skyobjects/starobject.h"
+
+#include <KLocalizedString>
+
+#include <QSet>
+#include <QtConcurrent>
+
+#include <algorithm>
+#include <cmath>
+
+#include <ekos_align_debug.h>
+
+// Brightest image stars forming triangles, and used to verify and refine a solution
+#define SOLVER_PATTERN_STARS 30
+#define SOLVER_VERIFY_STARS  80
+// Each star forms triangles with pairs of its nearest neighbours
+#define SOLVER_NEIGHBOURS 6
+// Catalog stars are limited to about as many stars per field as in the image, and to this count
+#define SOLVER_MAX_CATALOG_STARS 4000
+#define SOLVER_MIN_MATCHES       6
+// A solution is only accepted with this many matches, matching this fraction of the stars expected in the field,
+// and with a residual below this fraction of the final match tolerance
+#define SOLVER_ACCEPT_MATCHES  10
+#define SOLVER_ACCEPT_FRACTION 0.4
+#define SOLVER_ACCEPT_RESIDUAL 0.33
+// Triangle shapes are hashed in bins of this size, and compared with this tolerance
+#define SOLVER_SHAPE_BINS      100
+#define SOLVER_SHAPE_TOLERANCE 0.01
+
+namespace
+{
+const double RAD_TO_ARCSEC = 180.0 * 3600.0 / dms::PI;
+
+/* Affine transformation from centered image pixels to standard coordinates in arcseconds */
+struct Affine
+{
+    double a, b, c;
+    double d, e, f;
+
+    void map(double x, double y, double &xi, double &eta) const
+    {
+        xi  = a * x + b * y + c;
+        eta = d * x + e * y + f;
+    }
+};
+
+struct Pair
+{
+    double x, y;
+    double xi, eta;
+};
+
+/* Star forming triangles, in pixels for the image and arcseconds for the catalog */
+struct Point
+{
+    double x, y;
+};
+
+/* Triangle with vertices ordered by decreasing opposite side, and its shape as ratios of its sides */
+struct Triangle
+{
+    int v[3];
+    double r1, r2;
+    double size;
+};
+
+/* Gnomonic projection of ra, dec around ra0, dec0, all in degrees, to standard coordinates in arcseconds */
+bool project(double ra, double dec, double ra0, double dec0, double &xi, double &eta)
+{
+    const double dra = (ra - ra0) * dms::DegToRad;
+    const double sd = sin(dec * dms::DegToRad), cd = cos(dec * dms::DegToRad);
+    const double sd0 = sin(dec0 * dms::DegToRad), cd0 = cos(dec0 * dms::DegToRad);
+    const double denominator = sd * sd0 + cd * cd0 * cos(dra);
+
+    if (denominator <= 0)
+        return false;
+
+    xi  = cd * sin(dra) / denominator * RAD_TO_ARCSEC;
+    eta = (sd * cd0 - cd * sd0 * cos(dra)) / denominator * RAD_TO_ARCSEC;
+    return true;
+}
+
+void deproject(double xi, double eta, double ra0, double dec0, double &ra, double &dec)
+{
+    const double x = xi / RAD_TO_ARCSEC, y = eta / RAD_TO_ARCSEC;
+    const double sd0 = sin(dec0 * dms::DegToRad), cd0 = cos(dec0 * dms::DegToRad);
+
+    dec = atan2(sd0 + y * cd0, sqrt(x * x + (cd0 - y * sd0) * (cd0 - y * sd0))) / dms::DegToRad;
+    ra  = fmod(ra0 + atan2(x, cd0 - y * sd0) / dms::DegToRad + 360.0, 360.0);
+}
+
+/* Least squares affine transformation mapping the pixels of pairs to their standard coordinates */
+bool fitAffine(const Pair *pairs, int count, Affine &affine)
+{
+    if (count < 3)
+        return false;
+
+    double sxx = 0, sxy = 0, syy = 0, sx = 0, sy = 0;
+    double sxXi = 0, syXi = 0, sXi = 0, sxEta = 0, syEta = 0, sEta = 0;
+
+    for (int i = 0; i < count; i++)
+    {
+        const Pair &p = pairs[i];
+        sxx += p.x * p.x;
+        sxy += p.x * p.y;
+        syy += p.y * p.y;
+        sx += p.x;
+        sy += p.y;
+        sxXi += p.x * p.xi;
+        syXi += p.y * p.xi;
+        sXi += p.xi;
+        sxEta += p.x * p.eta;
+        syEta += p.y * p.eta;
+        sEta += p.eta;
+    }
+
+    // Normal equations [sxx sxy sx; sxy syy sy; sx sy n], solved by Cramer's rule
+    const double n   = count;
+    const double c00 = syy * n - sy * sy, c01 = sx * sy - sxy * n, c02 = sxy * sy - syy * sx;
+    const double c11 = sxx * n - sx * sx, c12 = sxy * sx - sxx * sy, c22 = sxx * syy - sxy * sxy;
+    const double determinant = sxx * c00 + sxy * c01 + sx * c02;
+
+    if (fabs(determinant) < 1e-12 * (fabs(sxx * syy * n) + 1))
+        return false;
+
+    affine.a = (c00 * sxXi + c01 * syXi + c02 * sXi) / determinant;
+    affine.b = (c01 * sxXi + c11 * syXi + c12 * sXi) / determinant;
+    affine.c = (c02 * sxXi + c12 * syXi + c22 * sXi) / determinant;
+    affine.d = (c00 * sxEta + c01 * syEta + c02 * sEta) / determinant;
+    affine.e = (c01 * sxEta + c11 * syEta + c12 * sEta) / determinant;
+    affine.f = (c02 * sxEta + c12 * syEta + c22 * sEta) / determinant;
+    return true;
+}
+
+/* Triangles formed by each point and pairs of its nearest neighbours, at least minSize long */
+QVector<Triangle> buildTriangles(const QVector<Point> &points, double minSize)
+{
+    QVector<Triangle> triangles;
+    QSet<quint64> formed;
+    QVector<QPair<double, int>> distances(points.count());
+
+    auto distance = [&](int i, int j) { return hypot(points[i].x - points[j].x, points[i].y - points[j].y); };
+
+    for (int i = 0; i < points.count(); i++)
+    {
+        for (int j = 0; j < points.count(); j++)
+            distances[j] = qMakePair(j == i ? HUGE_VAL : distance(i, j), j);
+
+        const int neighbours = qMin(SOLVER_NEIGHBOURS, points.count() - 1);
+        std::partial_sort(distances.begin(), distances.begin() + neighbours, distances.end());
+
+        for (int j = 0; j < neighbours; j++)
+        {
+            for (int k = j + 1; k < neighbours; k++)
+            {
+                int v[3] = { i, distances[j].second, distances[k].second };
+                std::sort(v, v + 3);
+
+                const quint64 key = (quint64(v[0]) << 42) | (quint64(v[1]) << 21) | quint64(v[2]);
+                if (formed.contains(key))
+                    continue;
+                formed.insert(key);
+
+                // Sides opposite to each vertex, longest first
+                QPair<double, int> sides[3] = { qMakePair(distance(v[1], v[2]), v[0]),
+                                                qMakePair(distance(v[0], v[2]), v[1]),
+                                                qMakePair(distance(v[0], v[1]), v[2]) };
+                std::sort(sides, sides + 3, [](const QPair<double, int> &s1, const QPair<double, int> &s2) {
+                    return s1.first > s2.first;
+                });
+
+                if (sides[0].first < minSize)
+                    continue;
+
+                Triangle triangle;
+                triangle.v[0] = sides[0].second;
+                triangle.v[1] = sides[1].second;
+                triangle.v[2] = sides[2].second;
+                triangle.size = sides[0].first;
+                triangle.r1   = sides[1].first / sides[0].first;
+                triangle.r2   = sides[2].first / sides[0].first;
+
+                // Flat triangles do not constrain the transformation
+                if (triangle.r1 + triangle.r2 < 1.05)
+                    continue;
+
+                triangles.append(triangle);
+            }
+        }
+    }
+
+    return triangles;
+}
+
+/*
+ * Whether the stars matched by a refined transformation are unlikely to be a false match: a false match leads the
+ * mount to a wrong position. Enough stars must be matched, a good fraction of the stars expected in the field, and
+ * the residual in pixels must be well below the tolerance, random matches being spread over the whole tolerance.
+ */
+bool acceptSolution(const QVector<Point> &image, const QVector<Point> &catalog, const QVector<Pair> &pairs,
+                    const Affine &affine, double scale, double tolerance, int width, int height)
+{
+    // Catalog stars falling in the image, by the inverse transformation
+    const double determinant = affine.a * affine.e - affine.b * affine.d;
+    int inField = 0;
+    for (const Point &star : catalog)
+    {
+        const double xi = star.x - affine.c, eta = star.y - affine.f;
+        const double x = (affine.e * xi - affine.b * eta) / determinant;
+        const double y = (affine.a * eta - affine.d * xi) / determinant;
+        if (fabs(x) <= width / 2.0 && fabs(y) <= height / 2.0)
+            inField++;
+    }
+
+    double sum = 0;
+    for (const Pair &pair : pairs)
+    {
+        double xi, eta;
+        affine.map(pair.x, pair.y, xi, eta);
+        sum += (xi - pair.xi) * (xi - pair.xi) + (eta - pair.eta) * (eta - pair.eta);
+    }
+    const double residual = sqrt(sum / pairs.count()) / scale;
+
+    const int expected = qMin(image.count(), inField);
+
+    qCDebug(KSTARS_EKOS_ALIGN) << "Local solver matched" << pairs.count() << "stars out of" << expected
+                               << "expected, residual" << residual << "pixels";
+
+    return pairs.count() >= SOLVER_ACCEPT_MATCHES && pairs.count() >= SOLVER_ACCEPT_FRACTION * expected &&
+           residual <= SOLVER_ACCEPT_RESIDUAL * tolerance;
+}
+
+/* Uniform grid of catalog stars in standard coordinates, for nearest neighbour lookups */
+class StarGrid
+{
+  public:
+    explicit StarGrid(const QVector<Point> &points) : points(points)
+    {
+        double maxX = -HUGE_VAL, maxY = -HUGE_VAL;
+        minX = minY = HUGE_VAL;
+        for (const Point &p : points)
+        {
+            minX = qMin(minX, p.x);
+            minY = qMin(minY, p.y);
+            maxX = qMax(maxX, p.x);
+            maxY = qMax(maxY, p.y);
+        }
+
+        cellSize = qMax(maxX - minX, maxY - minY) / 64 + 1;
+        columns  = static_cast<int>((maxX - minX) / cellSize) + 1;
+        rows     = static_cast<int>((maxY - minY) / cellSize) + 1;
+        cells.resize(columns * rows);
+
+        for (int i = 0; i < points.count(); i++)
+            cells[cell(points[i].y, minY, rows) * columns + cell(points[i].x, minX, columns)].append(i);
+    }
+
+    /* Index of the nearest point within radius of x, y, or -1 */
+    int nearest(double x, double y, double radius) const
+    {
+        int found      = -1;
+        double closest = radius * radius;
+
+        const int column0 = cell(x - radius, minX, columns), column1 = cell(x + radius, minX, columns);
+        const int row0 = cell(y - radius, minY, rows), row1 = cell(y + radius, minY, rows);
+
+        for (int row = row0; row <= row1; row++)
+        {
+            for (int column = column0; column <= column1; column++)
+            {
+                for (int i : cells[row * columns + column])
+                {
+                    const double dx = points[i].x - x, dy = points[i].y - y;
+                    if (dx * dx + dy * dy <= closest)
+                    {
+                        closest = dx * dx + dy * dy;
+                        found   = i;
+                    }
+                }
+            }
+        }
+
+        return found;
+    }
+
+  private:
+    int cell(double value, double origin, int count) const
+    {
+        return qBound(0, static_cast<int>((value - origin) / cellSize), count - 1);
+    }
+
+    const QVector<Point> &points;
+    QVector<QVector<int>> cells;
+    double minX, minY, cellSize;
+    int columns, rows;
+};
+
+/* Pairs of image and catalog stars matched by affine within tolerance, in arcseconds */
+QVector<Pair> matchStars(const QVector<Point> &image, const QVector<Point> &catalog, const StarGrid &grid,
+                         const Affine &affine, double tolerance, QVector<int> *matched = nullptr)
+{
+    QVector<Pair> pairs;
+
+    if (matched)
+        matched->clear();
+
+    for (const Point &star : image)
+    {
+        double xi, eta;
+        affine.map(star.x, star.y, xi, eta);
+
+        const int found = grid.nearest(xi, eta, tolerance);
+        if (found >= 0)
+        {
+            pairs.append({ star.x, star.y, catalog[found].x, catalog[found].y });
+            if (matched)
+                matched->append(found);
+        }
+    }
+
+    return pairs;
+}
+}
+
+namespace Ekos
+{
+LocalAstrometryParser::LocalAstrometryParser() : AstrometryParser()
+{
+    connect(&detectionWatcher, &QFutureWatcher<int>::finished, this, &LocalAstrometryParser::starsDetected);
+    connect(&solverWatcher, &QFutureWatcher<Solution>::finished, this, &LocalAstrometryParser::solverComplete);
+}
+
+LocalAstrometryParser::~LocalAstrometryParser()
+{
+    stopSolver();
+}
+
+bool LocalAstrometryParser::init()
+{
+    return true;
+}
+
+void LocalAstrometryParser::verifyIndexFiles(double, double)
+{
+}
+
+bool LocalAstrometryParser::startSovler(const QString &filename, const QStringList &args, bool generated)
+{
+    Q_UNUSED(filename);
+
+    // Only captured images are in the view, loaded files are left to astrometry.net
+    if (generated == false || imageView == nullptr || imageView->getImageData() == nullptr ||
+        StarComponent::Instance() == nullptr)
+        return false;
+
+    imageWidth  = imageView->getImageData()->getWidth();
+    imageHeight = imageView->getImageData()->getHeight();
+
+    if (parseArguments(args, imageWidth) == false)
+        return false;
+
+    const double fieldRadius = hypot(imageWidth, imageHeight) / 2 * scaleHigh / 3600.0;
+    catalogStars             = getCatalogStars(fieldRadius);
+
+    if (catalogStars.count() < SOLVER_MIN_MATCHES)
+    {
+        qCDebug(KSTARS_EKOS_ALIGN) << "Local solver found" << catalogStars.count() << "catalog stars only";
+        return false;
+    }
+
+    stopSolver();
+    aborted.reset(new std::atomic<bool>(false));
+    solverTimer.start();
+    align->appendLogText(i18n("Starting local solver..."));
+
+    detectionWatcher.setFuture(imageView->findStarsAsync(ALGORITHM_SEP));
+    return true;
+}
+
+bool LocalAstrometryParser::stopSolver()
+{
+    if (aborted)
+        *aborted = true;
+
+    // Drop the results of the running search, if any
+    detectionWatcher.setFuture(QFuture<int>());
+    solverWatcher.setFuture(QFuture<Solution>());
+
+    return true;
+}
+
+bool LocalAstrometryParser::parseArguments(const QStringList &args, int width)
+{
+    // Arguments may hold several options, such as "-5 15"
+    const QStringList options = args.join(' ').split(' ', QString::SkipEmptyParts);
+
+    bool hasRA = false, hasDE = false;
+    double low = 0, high = 0;
+    QString units;
+
+    for (int i = 0; i + 1 < options.count(); i++)
+    {
+        if (options[i] == "-3")
+            searchRA = options[++i].toDouble(&hasRA);
+        else if (options[i] == "-4")
+            searchDE = options[++i].toDouble(&hasDE);
+        else if (options[i] == "-L")
+            low = options[++i].toDouble();
+        else if (options[i] == "-H")
+            high = options[++i].toDouble();
+        else if (options[i] == "-u")
+            units = options[++i];
+    }
+
+    if (hasRA == false || hasDE == false || low <= 0 || high < low || width <= 0)
+        return false;
+
+    // Scales in arcseconds per pixel
+    if (units == "app")
+    {
+        scaleLow  = low;
+        scaleHigh = high;
+    }
+    else if (units == "aw")
+    {
+        scaleLow  = low * 60.0 / width;
+        scaleHigh = high * 60.0 / width;
+    }
+    else if (units == "degw")
+    {
+        scaleLow  = low * 3600.0 / width;
+        scaleHigh = high * 3600.0 / width;
+    }
+    else
+        return false;
+
+    return true;
+}
+
+QVector<LocalAstrometryParser::CatalogStar> LocalAstrometryParser::getCatalogStars(double fieldRadius) const
+{
+    QVector<CatalogStar> stars;
+
+    const double searchRadius = fieldRadius + Options::astrometryLocalSolverRadius();
+    const double scale        = (scaleLow + scaleHigh) / 2 / 3600.0;
+    const double fieldArea    = imageWidth * scale * imageHeight * scale;
+
+    // About as many catalog stars per field as image stars forming triangles
+    const int wanted = qMin<double>(SOLVER_MAX_CATALOG_STARS,
+                                    ceil(SOLVER_PATTERN_STARS * dms::PI * searchRadius * searchRadius / fieldArea));
+
+    SkyPoint center(searchRA / 15.0, searchDE);
+
+    // Deeper catalogs are only searched when the field is too small for brighter stars
+    for (float maglim = 9; maglim <= 16; maglim++)
+    {
+        QList<StarObject *> list;
+        StarComponent::Instance()->starsInAperture(list, center, searchRadius, maglim);
+
+        stars.clear();
+        for (StarObject *star : list)
+        {
+            if (star->mag() <= maglim)
+                stars.append({ star->ra0().Degrees(), star->dec0().Degrees(), star->mag() });
+        }
+
+        if (stars.count() >= wanted)
+            break;
+    }
+
+    std::sort(stars.begin(), stars.end(),
+              [](const CatalogStar &s1, const CatalogStar &s2) { return s1.mag < s2.mag; });
+
+    if (stars.count() > wanted)
+        stars.resize(wanted);
+
+    return stars;
+}
+
+void LocalAstrometryParser::starsDetected()
+{
+    // Ignore stopped searches
+    if (detectionWatcher.isFinished() == false || detectionWatcher.isCanceled() || !aborted || *aborted)
+        return;
+
+    QList<Edge *> centers = imageView->getImageData()->getStarCenters();
+
+    QVector<ImageStar> imageStars;
+    imageStars.reserve(centers.count());
+    for (Edge *center : centers)
+        imageStars.append({ center->x, center->y, center->sum });
+
+    std::sort(imageStars.begin(), imageStars.end(),
+              [](const ImageStar &s1, const ImageStar &s2) { return s1.flux > s2.flux; });
+
+    if (imageStars.count() < SOLVER_MIN_MATCHES)
+    {
+        align->appendLogText(i18n("Local solver failed, %1 stars detected.", imageStars.count()));
+        emit solverFailed();
+        return;
+    }
+
+    // The search only uses copies, it may outlive this parser once stopped
+    const QVector<CatalogStar> stars = catalogStars;
+    const int width = imageWidth, height = imageHeight;
+    const double ra = searchRA, dec = searchDE, low = scaleLow, high = scaleHigh;
+    std::shared_ptr<std::atomic<bool>> abort = aborted;
+
+    solverWatcher.setFuture(QtConcurrent::run([=]() {
+        Solution solution;
+        if (solve(imageStars, stars, width, height, ra, dec, low, high, solution, abort.get()) == false)
+            solution.matches = 0;
+        return solution;
+    }));
+}
+
+void LocalAstrometryParser::solverComplete()
+{
+    if (solverWatcher.isFinished() == false || solverWatcher.isCanceled() || !aborted || *aborted)
+        return;
+
+    const Solution solution = solverWatcher.result();
+
+    if (solution.matches == 0)
+    {
+        align->appendLogText(i18n("Local solver failed."));
+        emit solverFailed();
+        return;
+    }
+
+    qCDebug(KSTARS_EKOS_ALIGN) << "Local solver matched" << solution.matches << "stars, mirrored:" << solution.mirrored;
+
+    align->appendLogText(i18n("Local solver completed in %1 ms.", solverTimer.elapsed()));
+
+    emit solverFinished(solution.orientation, solution.ra, solution.dec, solution.pixscale);
+}
+
+bool LocalAstrometryParser::solve(const QVector<ImageStar> &imageStars, const QVector<CatalogStar> &catalogStars,
+                                  int width, int height, double ra, double dec, double scaleLow, double scaleHigh,
+                                  Solution &solution, const std::atomic<bool> *abort)
+{
+    // Image stars are centered on the image, catalog stars projected around the estimated position
+    QVector<Point> image, catalog;
+
+    for (int i = 0; i < qMin(imageStars.count(), SOLVER_VERIFY_STARS); i++)
+        image.append({ imageStars[i].x - width / 2.0, imageStars[i].y - height / 2.0 });
+
+    QVector<int> catalogIndexes;
+    for (int i = 0; i < catalogStars.count(); i++)
+    {
+        Point p;
+        if (project(catalogStars[i].ra, catalogStars[i].dec, ra, dec, p.x, p.y))
+        {
+            catalog.append(p);
+            catalogIndexes.append(i);
+        }
+    }
+
+    if (image.count() < SOLVER_MIN_MATCHES || catalog.count() < SOLVER_MIN_MATCHES)
+        return false;
+
+    const QVector<Point> pattern = image.mid(0, SOLVER_PATTERN_STARS);
+    const QVector<Triangle> imageTriangles   = buildTriangles(pattern, 0.05 * hypot(width, height));
+    const QVector<Triangle> catalogTriangles = buildTriangles(catalog, 0);
+
+    // Catalog triangles hashed by shape
+    QVector<QVector<int>> shapes((SOLVER_SHAPE_BINS + 1) * (SOLVER_SHAPE_BINS + 1));
+    auto bin = [](double ratio) { return qBound(0, static_cast<int>(ratio * SOLVER_SHAPE_BINS), SOLVER_SHAPE_BINS); };
+    for (int i = 0; i < catalogTriangles.count(); i++)
+        shapes[bin(catalogTriangles[i].r1) * (SOLVER_SHAPE_BINS + 1) + bin(catalogTriangles[i].r2)].append(i);
+
+    const StarGrid grid(catalog);
+
+    // Star positions along the candidate transformations are only known to a fraction of the field
+    const double tolerance = qMax(3.0, 0.01 * qMax(width, height));
+
+    Affine best;
+    int bestMatches = 0;
+    double bestScale = 0;
+
+    for (const Triangle &imageTriangle : imageTriangles)
+    {
+        if (abort && *abort)
+            return false;
+
+        const int bin1 = bin(imageTriangle.r1), bin2 = bin(imageTriangle.r2);
+
+        for (int b1 = qMax(0, bin1 - 1); b1 <= qMin(SOLVER_SHAPE_BINS, bin1 + 1); b1++)
+        {
+            for (int b2 = qMax(0, bin2 - 1); b2 <= qMin(SOLVER_SHAPE_BINS, bin2 + 1); b2++)
+            {
+                for (int index : shapes[b1 * (SOLVER_SHAPE_BINS + 1) + b2])
+                {
+                    const Triangle &catalogTriangle = catalogTriangles[index];
+
+                    if (fabs(catalogTriangle.r1 - imageTriangle.r1) > SOLVER_SHAPE_TOLERANCE ||
+                        fabs(catalogTriangle.r2 - imageTriangle.r2) > SOLVER_SHAPE_TOLERANCE)
+                        continue;
+
+                    const double scale = catalogTriangle.size / imageTriangle.size;
+                    if (scaleLow > 0 && (scale < scaleLow * 0.9 || scale > scaleHigh * 1.1))
+                        continue;
+
+                    Pair pairs[3];
+                    for (int v = 0; v < 3; v++)
+                    {
+                        const Point &p = pattern[imageTriangle.v[v]];
+                        const Point &q = catalog[catalogTriangle.v[v]];
+                        pairs[v]       = { p.x, p.y, q.x, q.y };
+                    }
+
+                    Affine affine;
+                    if (fitAffine(pairs, 3, affine) == false)
+                        continue;
+
+                    // The transformation must be a rotation and a scale, possibly mirrored
+                    const double norm1 = hypot(affine.a, affine.d), norm2 = hypot(affine.b, affine.e);
+                    if (fabs(norm1 - norm2) > 0.05 * norm1 ||
+                        fabs(affine.a * affine.b + affine.d * affine.e) > 0.05 * norm1 * norm2)
+                        continue;
+
+                    const int matches = matchStars(image, catalog, grid, affine, tolerance * scale).count();
+                    if (matches > bestMatches)
+                    {
+                        best        = affine;
+                        bestMatches = matches;
+                        bestScale   = scale;
+                    }
+                }
+            }
+        }
+
+        // Random matches are unlikely past a few stars, stop once half the stars are matched
+        if (bestMatches >= qMax(2 * SOLVER_MIN_MATCHES, image.count() / 2))
+            break;
+    }
+
+    if (bestMatches < SOLVER_MIN_MATCHES)
+        return false;
+
+    // Refine with all the matched stars, tightening the tolerance as the transformation improves
+    QVector<Pair> pairs;
+    QVector<int> matched;
+    double finalTolerance = 0;
+    for (double factor : { 1.0, 0.5, 0.25 })
+    {
+        finalTolerance = qMax(2.0, tolerance * factor);
+        pairs = matchStars(image, catalog, grid, best, finalTolerance * bestScale, &matched);
+        if (pairs.count() < SOLVER_MIN_MATCHES || fitAffine(pairs.constData(), pairs.count(), best) == false)
+            return false;
+        bestScale = sqrt(fabs(best.a * best.e - best.b * best.d));
+    }
+
+    if (acceptSolution(image, catalog, pairs, best, bestScale, finalTolerance, width, height) == false)
+        return false;
+
+    // Project the matched stars again around the center found, so that the transformation is accurate at the center
+    double centerRA, centerDE;
+    deproject(best.c, best.f, ra, dec, centerRA, centerDE);
+
+    for (int i = 0; i < pairs.count(); i++)
+    {
+        const CatalogStar &star = catalogStars[catalogIndexes[matched[i]]];
+        if (project(star.ra, star.dec, centerRA, centerDE, pairs[i].xi, pairs[i].eta) == false)
+            return false;
+    }
+
+    if (fitAffine(pairs.constData(), pairs.count(), best) == false)
+        return false;
+
+    deproject(best.c, best.f, centerRA, centerDE, solution.ra, solution.dec);
+
+    // CD matrix in degrees per pixel, orientation as computed by astrometry.net from it
+    const double cd11 = best.a / 3600.0, cd12 = best.b / 3600.0, cd21 = best.d / 3600.0, cd22 = best.e / 3600.0;
+    const double determinant = cd11 * cd22 - cd12 * cd21;
+    const double parity      = determinant >= 0 ? 1.0 : -1.0;
+
+    solution.orientation = -atan2(parity * cd21 - cd12, parity * cd11 + cd22) / dms::DegToRad;
+    solution.pixscale    = sqrt(fabs(determinant)) * 3600.0;
+    solution.mirrored    = determinant > 0;
+    solution.matches     = pairs.count();
+
+    return true;
+}
+}
@@ -0,0 +1,142 @@
+/*  Local Astrometry Parser
+    Copyright (C) 2026 KStars Developers
+
+    This application is free software; you can redistribute it and/or
+    modify it under the terms of the GNU General Public
+    License as published by the Free Software Foundation; either
+    version 2 of the License, or (at your option) any later version.
+*/
+
+#pragma once
+
+#include "astrometryparser.h"
+
+#include <QFutureWatcher>
+#include <QTime>
+#include <QVector>
+
+#include <atomic>
+#include <memory>
+
+class FITSView;
+
+namespace Ekos
+{
+class Align;
+
+/**
+ * @class LocalAstrometryParser
+ * LocalAstrometryParser solves images in process, near the position given to the solver, by matching the stars
+ * detected in the image with the stars of the catalogs loaded by KStars.
+ *
+ * Stars detected by SEP and catalog stars around the position are both reduced to triangles formed by each star
+ * and pairs of its nearest neighbours. Triangles of similar shapes, and of a size compatible with the scale given
+ * to the solver, propose a transformation from image to sky which is then verified against all the stars. The
+ * transformation matching most stars is refined by least squares, and reported like the solution of astrometry.net.
+ * It is only accepted when it matches enough of the stars expected in the field with a small residual, as a false
+ * solution would sync or slew the mount to a wrong position.
+ *
+ * It does not replace astrometry.net: startSovler() returns false when the image or the arguments do not allow a
+ * local solution, and solverFailed() is emitted when no solution is found, so that Align falls back to its
+ * configured solver.
+ *
+ * @author KStars Developers
+ */
+class LocalAstrometryParser : public AstrometryParser
+{
+    Q_OBJECT
+
+  public:
+    /** Star detected in the image, in pixels */
+    struct ImageStar
+    {
+        double x;
+        double y;
+        double flux;
+    };
+
+    /** Catalog star, J2000 coordinates in degrees */
+    struct CatalogStar
+    {
+        double ra;
+        double dec;
+        double mag;
+    };
+
+    /** Solution of an image */
+    struct Solution
+    {
+        /// J2000 coordinates of the center of the image, in degrees
+        double ra { 0 };
+        double dec { 0 };
+        /// Orientation of the image in degrees, with the convention of astrometry.net
+        double orientation { 0 };
+        /// Scale in arcseconds per pixel
+        double pixscale { 0 };
+        /// Whether the image is mirrored, east being right of north as seen with FITS rows going up
+        bool mirrored { false };
+        /// Number of image stars matched with catalog stars
+        int matches { 0 };
+    };
+
+    LocalAstrometryParser();
+    virtual ~LocalAstrometryParser();
+
+    virtual void setAlign(Align *_align) { align = _align; }
+    virtual bool init();
+    virtual void verifyIndexFiles(double fov_x, double fov_y);
+    virtual bool startSovler(const QString &filename, const QStringList &args, bool generated = true);
+    virtual bool stopSolver();
+
+    /**
+     * @brief setImageView Set the view holding the image to solve, stars are detected in it
+     * @param view View of the captured image
+     */
+    void setImageView(FITSView *view) { imageView = view; }
+
+    /**
+     * @brief solve Match image stars with catalog stars
+     * @param imageStars Stars of the image, brightest first
+     * @param catalogStars Stars around the estimated center, brightest first
+     * @param width Width of the image in pixels
+     * @param height Height of the image in pixels
+     * @param ra Estimated J2000 right ascension of the center of the image, in degrees
+     * @param dec Estimated J2000 declination of the center of the image, in degrees
+     * @param scaleLow Lowest scale of the image in arcseconds per pixel, 0 if unknown
+     * @param scaleHigh Highest scale of the image in arcseconds per pixel, 0 if unknown
+     * @param solution Set to the solution of the image if found
+     * @param abort Optional flag interrupting the search when set
+     * @return True if a solution was found
+     */
+    static bool solve(const QVector<ImageStar> &imageStars, const QVector<CatalogStar> &catalogStars, int width,
+                      int height, double ra, double dec, double scaleLow, double scaleHigh, Solution &solution,
+                      const std::atomic<bool> *abort = nullptr);
+
+  private slots:
+    void starsDetected();
+    void solverComplete();
+
+  private:
+    bool parseArguments(const QStringList &args, int width);
+    QVector<CatalogStar> getCatalogStars(double fieldRadius) const;
+
+    Align *align { nullptr };
+    FITSView *imageView { nullptr };
+    QTime solverTimer;
+
+    /// Position and scale given to the solver
+    double searchRA { 0 };
+    double searchDE { 0 };
+    double scaleLow { 0 };
+    double scaleHigh { 0 };
+
+    int imageWidth { 0 };
+    int imageHeight { 0 };
+    QVector<CatalogStar> catalogStars;
+
+    QFutureWatcher<int> detectionWatcher;
+    QFutureWatcher<Solution> solverWatcher;
+    /// Set to interrupt the current search, each search has its own
+    std::shared_ptr<std::atomic<bool>> aborted;
+};
+}
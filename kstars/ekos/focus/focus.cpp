@@ -247,6 +247,8 @@ Focus::Focus()
 
     focusView->setStarsEnabled(true);
 
+    connect(&starDetectionWatcher, SIGNAL(finished()), this, SLOT(setStarsDetected()));
+
     // Reset star center on auto star check toggle
     connect(useAutoStar, &QCheckBox::toggled, this, [&](bool enabled) {
         if (enabled)
@@ -774,6 +776,8 @@ void Focus::stop(bool aborted)
 
     inAutoFocus        = false;
     inFocusLoop        = false;
+    // Stars still being detected are not processed anymore
+    starDetectionWatcher.setFuture(QFuture<int>());
     // Why starSelected is set to false below? We should retain star selection status under:
     // 1. Autostar is off, or
     // 2. Toggle subframe, or
@@ -1067,10 +1071,6 @@ void Focus::setCaptureComplete()
 {
     DarkLibrary::Instance()->disconnect(this);
 
-    ISD::CCDChip *targetChip = currentCCD->getChip(ISD::CCDChip::PRIMARY_CCD);
-    int subBinX = 1, subBinY = 1;
-    targetChip->getBinning(&subBinX, &subBinY);
-
     // Always reset capture mode to NORMAL
     // JM 2016-09-28: Disable setting back to FITS_NORMAL as it might be causing issues. Each module should set capture module separately.
     //targetChip->setCaptureMode(FITS_NORMAL);
@@ -1111,35 +1111,41 @@ void Focus::setCaptureComplete()
 
             currentHFR = -1;
 
-            if (Options::focusUseFullField())
-            {                
-                if (focusDetection != ALGORITHM_CENTROID && focusDetection != ALGORITHM_SEP)
-                    focusView->findStars(ALGORITHM_CENTROID);
-                else
-                    focusView->findStars(focusDetection);
-                focusView->updateFrame();
-                currentHFR = image_data->getHFR(HFR_AVERAGE);
-            }
-            else
-            {
-                if (starSelected)
-                {
-                    focusView->findStars(focusDetection);
-                    focusView->updateFrame();
-                    currentHFR = image_data->getHFR(HFR_MAX);
-                }
-                else
-                {
-                    if (focusDetection != ALGORITHM_CENTROID && focusDetection != ALGORITHM_SEP)
-                        focusView->findStars(ALGORITHM_CENTROID);
-                    else
-                        focusView->findStars(focusDetection);
-                    focusView->updateFrame();
-                    currentHFR = image_data->getHFR(HFR_MAX);
-                }
-            }
+            StarAlgorithm algorithm = focusDetection;
+            if ((Options::focusUseFullField() || starSelected == false) && focusDetection != ALGORITHM_CENTROID &&
+                focusDetection != ALGORITHM_SEP)
+                algorithm = ALGORITHM_CENTROID;
+
+            // Stars are detected in the background, setStarsDetected() carries on once they are found
+            starDetectionWatcher.setFuture(focusView->findStarsAsync(algorithm));
+            return;
         }
+    }
 
+    setHFRComplete();
+}
+
+void Focus::setStarsDetected()
+{
+    if (starDetectionWatcher.isCanceled())
+        return;
+
+    focusView->updateFrame();
+    currentHFR = focusView->getImageData()->getHFR(Options::focusUseFullField() ? HFR_AVERAGE : HFR_MAX);
+
+    setHFRComplete();
+}
+
+void Focus::setHFRComplete()
+{
+    ISD::CCDChip *targetChip = currentCCD->getChip(ISD::CCDChip::PRIMARY_CCD);
+    int subBinX = 1, subBinY = 1;
+    targetChip->getBinning(&subBinX, &subBinY);
+
+    FITSData *image_data = focusView->getImageData();
+
+    if (inFocusLoop == false || (inFocusLoop && (focusView->isTrackingBoxEnabled() || Options::focusUseFullField())))
+    {
         qCDebug(KSTARS_EKOS_FOCUS) << "Focus newFITS #" << HFRFrames.count() + 1 << ": Current HFR " << currentHFR;
 
         HFRFrames.append(currentHFR);
@@ -2637,7 +2643,12 @@ void Focus::showFITSViewer()
     FITSData *data = focusView->getImageData();
     if (data)
     {
-        QUrl url = QUrl::fromLocalFile(data->getFilename());
+        // Frames are received in memory, so they only get a file once they are shown in the viewer
+        QString filename = data->getOrSaveFilename();
+        if (filename.isEmpty())
+            return;
+
+        QUrl url = QUrl::fromLocalFile(filename);
 
         if (fv.isNull())
         {
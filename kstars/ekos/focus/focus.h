@@ -18,6 +18,7 @@
 #include "indi/indistd.h"
 #include "indi/inditelescope.h"
 
+#include <QFutureWatcher>
 #include <QtDBus/QtDBus>
 
 namespace Ekos
@@ -308,6 +309,7 @@ class Focus : public QWidget, public Ui::Focus
     //void setFrames(int value);
 
     void setCaptureComplete();
+    void setStarsDetected();
 
     void showFITSViewer();
 
@@ -326,6 +328,9 @@ class Focus : public QWidget, public Ui::Focus
     void focusPositionAdjusted();
 
   private:
+    /* Process the HFR of the stars detected in the last frame */
+    void setHFRComplete();
+
     void drawHFRPlot();
     void drawProfilePlot();
     void getAbsFocusPosition();
@@ -495,6 +500,8 @@ class Focus : public QWidget, public Ui::Focus
 
     /// Focus Frame
     FITSView *focusView { nullptr };
+    /// Stars detected in the background in the last frame
+    QFutureWatcher<int> starDetectionWatcher;
 
     /// Star Select Timer
     QTimer waitStarSelectTimer;
@@ -3017,7 +3017,12 @@ void Guide::showFITSViewer()
     FITSData *data = guideView->getImageData();
     if (data)
     {
-        QUrl url = QUrl::fromLocalFile(data->getFilename());
+        // Frames are received in memory, so they only get a file once they are shown in the viewer
+        QString filename = data->getOrSaveFilename();
+        if (filename.isEmpty())
+            return;
+
+        QUrl url = QUrl::fromLocalFile(filename);
 
         if (fv.isNull())
         {
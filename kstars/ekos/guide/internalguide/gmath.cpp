@@ -20,8 +20,17 @@
 #include "ekos_guide_debug.h"
 
 #include <cmath>
+#include <cstring>
 #include <set>
 
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define GMATH_SSE2
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+#include <arm_neon.h>
+#define GMATH_NEON
+#endif
+
 #define DEF_SQR_0 (8 - 0)
 #define DEF_SQR_1 (16 - 0)
 #define DEF_SQR_2 (32 - 0)
@@ -58,6 +67,130 @@ typedef struct
     int x, y;
 } point_t;
 
+// Pixel conversion kernels for createFloatImage. 8 and 16 bit data, which is what guide cameras send,
+// is widened and converted several pixels at a time. Other types are left to the compiler.
+template <typename T>
+static void convertToFloat(const T *src, float *dst, uint32_t count)
+{
+    for (uint32_t i = 0; i < count; i++)
+        dst[i] = src[i];
+}
+
+#if defined(GMATH_SSE2)
+template <>
+void convertToFloat(const uint8_t *src, float *dst, uint32_t count)
+{
+    const __m128i zero = _mm_setzero_si128();
+    uint32_t i         = 0;
+
+    for (; i + 16 <= count; i += 16)
+    {
+        __m128i v  = _mm_loadu_si128(reinterpret_cast<const __m128i *>(src + i));
+        __m128i lo = _mm_unpacklo_epi8(v, zero);
+        __m128i hi = _mm_unpackhi_epi8(v, zero);
+
+        _mm_storeu_ps(dst + i, _mm_cvtepi32_ps(_mm_unpacklo_epi16(lo, zero)));
+        _mm_storeu_ps(dst + i + 4, _mm_cvtepi32_ps(_mm_unpackhi_epi16(lo, zero)));
+        _mm_storeu_ps(dst + i + 8, _mm_cvtepi32_ps(_mm_unpacklo_epi16(hi, zero)));
+        _mm_storeu_ps(dst + i + 12, _mm_cvtepi32_ps(_mm_unpackhi_epi16(hi, zero)));
+    }
+
+    for (; i < count; i++)
+        dst[i] = src[i];
+}
+
+template <>
+void convertToFloat(const uint16_t *src, float *dst, uint32_t count)
+{
+    const __m128i zero = _mm_setzero_si128();
+    uint32_t i         = 0;
+
+    for (; i + 8 <= count; i += 8)
+    {
+        __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i *>(src + i));
+
+        _mm_storeu_ps(dst + i, _mm_cvtepi32_ps(_mm_unpacklo_epi16(v, zero)));
+        _mm_storeu_ps(dst + i + 4, _mm_cvtepi32_ps(_mm_unpackhi_epi16(v, zero)));
+    }
+
+    for (; i < count; i++)
+        dst[i] = src[i];
+}
+
+template <>
+void convertToFloat(const int16_t *src, float *dst, uint32_t count)
+{
+    uint32_t i = 0;
+
+    for (; i + 8 <= count; i += 8)
+    {
+        __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i *>(src + i));
+
+        // Put each sample in the upper half of a 32 bit lane and shift it back to extend the sign
+        _mm_storeu_ps(dst + i, _mm_cvtepi32_ps(_mm_srai_epi32(_mm_unpacklo_epi16(v, v), 16)));
+        _mm_storeu_ps(dst + i + 4, _mm_cvtepi32_ps(_mm_srai_epi32(_mm_unpackhi_epi16(v, v), 16)));
+    }
+
+    for (; i < count; i++)
+        dst[i] = src[i];
+}
+#elif defined(GMATH_NEON)
+template <>
+void convertToFloat(const uint8_t *src, float *dst, uint32_t count)
+{
+    uint32_t i = 0;
+
+    for (; i + 16 <= count; i += 16)
+    {
+        uint8x16_t v  = vld1q_u8(src + i);
+        uint16x8_t lo = vmovl_u8(vget_low_u8(v));
+        uint16x8_t hi = vmovl_u8(vget_high_u8(v));
+
+        vst1q_f32(dst + i, vcvtq_f32_u32(vmovl_u16(vget_low_u16(lo))));
+        vst1q_f32(dst + i + 4, vcvtq_f32_u32(vmovl_u16(vget_high_u16(lo))));
+        vst1q_f32(dst + i + 8, vcvtq_f32_u32(vmovl_u16(vget_low_u16(hi))));
+        vst1q_f32(dst + i + 12, vcvtq_f32_u32(vmovl_u16(vget_high_u16(hi))));
+    }
+
+    for (; i < count; i++)
+        dst[i] = src[i];
+}
+
+template <>
+void convertToFloat(const uint16_t *src, float *dst, uint32_t count)
+{
+    uint32_t i = 0;
+
+    for (; i + 8 <= count; i += 8)
+    {
+        uint16x8_t v = vld1q_u16(src + i);
+
+        vst1q_f32(dst + i, vcvtq_f32_u32(vmovl_u16(vget_low_u16(v))));
+        vst1q_f32(dst + i + 4, vcvtq_f32_u32(vmovl_u16(vget_high_u16(v))));
+    }
+
+    for (; i < count; i++)
+        dst[i] = src[i];
+}
+
+template <>
+void convertToFloat(const int16_t *src, float *dst, uint32_t count)
+{
+    uint32_t i = 0;
+
+    for (; i + 8 <= count; i += 8)
+    {
+        int16x8_t v = vld1q_s16(src + i);
+
+        vst1q_f32(dst + i, vcvtq_f32_s32(vmovl_s16(vget_low_s16(v))));
+        vst1q_f32(dst + i + 4, vcvtq_f32_s32(vmovl_s16(vget_high_s16(v))));
+    }
+
+    for (; i < count; i++)
+        dst[i] = src[i];
+}
+#endif
+
 cgmath::cgmath() : QObject()
 {
     // sys...
@@ -92,11 +225,6 @@ cgmath::~cgmath()
 {
     delete[] drift[GUIDE_RA];
     delete[] drift[GUIDE_DEC];
-
-    foreach (float *region, referenceRegions)
-        delete[] region;
-
-    referenceRegions.clear();
 }
 
 bool cgmath::setVideoParameters(int vid_wd, int vid_ht, int binX, int binY)
@@ -510,12 +638,16 @@ void cgmath::start(void)
     // Create reference Image
     if (imageGuideEnabled)
     {
-        foreach (float *region, referenceRegions)
-            delete[] region;
-
-        referenceRegions.clear();
+        referenceImage.clear();
+        referenceWidth = referenceHeight = 0;
 
-        referenceRegions = partitionImage();
+        if (createFloatImage() != nullptr)
+        {
+            // Keep the converted frame as reference, the workspace is allocated again on the next frame
+            referenceImage.swap(floatImage);
+            referenceWidth  = guideView->getImageData()->getWidth();
+            referenceHeight = guideView->getImageData()->getHeight();
+        }
 
         reticle_pos = Vector(0, 0, 0);
     }
@@ -546,7 +678,7 @@ void cgmath::setLostStar(bool is_lost)
     lost_star = is_lost;
 }
 
-float *cgmath::createFloatImage(FITSData *target) const
+const float *cgmath::createFloatImage(FITSData *target) const
 {
     FITSData *imageData = target;
     if (imageData == nullptr)
@@ -555,136 +687,69 @@ float *cgmath::createFloatImage(FITSData *target) const
     // #1 Convert to float array
     // We only process 1st plane if it is a color image
     uint32_t imgSize = imageData->getSize();
-    float *imgFloat  = new float[imgSize];
 
-    if (imgFloat == nullptr)
-    {
-        qCritical() << "Not enough memory for float image array!";
-        return nullptr;
-    }
+    // Does not release memory when shrinking, so the workspace is only allocated when the frame gets bigger
+    floatImage.resize(imgSize);
+    float *imgFloat = floatImage.data();
 
     switch (imageData->getDataType())
     {
         case TBYTE:
-        {
-            uint8_t *buffer = imageData->getImageBuffer();
-            for (uint32_t i = 0; i < imgSize; i++)
-                imgFloat[i] = buffer[i];
-        }
-        break;
+            convertToFloat(imageData->getImageBuffer(), imgFloat, imgSize);
+            break;
 
         case TSHORT:
-        {
-            int16_t *buffer = reinterpret_cast<int16_t *>(imageData->getImageBuffer());
-            for (uint32_t i = 0; i < imgSize; i++)
-                imgFloat[i] = buffer[i];
-        }
-        break;
+            convertToFloat(reinterpret_cast<int16_t *>(imageData->getImageBuffer()), imgFloat, imgSize);
+            break;
 
         case TUSHORT:
-        {
-            uint16_t *buffer = reinterpret_cast<uint16_t *>(imageData->getImageBuffer());
-            for (uint32_t i = 0; i < imgSize; i++)
-                imgFloat[i] = buffer[i];
-        }
-        break;
+            convertToFloat(reinterpret_cast<uint16_t *>(imageData->getImageBuffer()), imgFloat, imgSize);
+            break;
 
         case TLONG:
-        {
-            int32_t *buffer = reinterpret_cast<int32_t *>(imageData->getImageBuffer());
-            for (uint32_t i = 0; i < imgSize; i++)
-                imgFloat[i] = buffer[i];
-        }
-        break;
+            convertToFloat(reinterpret_cast<int32_t *>(imageData->getImageBuffer()), imgFloat, imgSize);
+            break;
 
         case TULONG:
-        {
-            uint32_t *buffer = reinterpret_cast<uint32_t *>(imageData->getImageBuffer());
-            for (uint32_t i = 0; i < imgSize; i++)
-                imgFloat[i] = buffer[i];
-        }
-        break;
+            convertToFloat(reinterpret_cast<uint32_t *>(imageData->getImageBuffer()), imgFloat, imgSize);
+            break;
 
         case TFLOAT:
-        {
-            float *buffer = reinterpret_cast<float *>(imageData->getImageBuffer());
-            for (uint32_t i = 0; i < imgSize; i++)
-                imgFloat[i] = buffer[i];
-        }
-        break;
+            memcpy(imgFloat, imageData->getImageBuffer(), imgSize * sizeof(float));
+            break;
 
         case TLONGLONG:
-        {
-            int64_t *buffer = reinterpret_cast<int64_t *>(imageData->getImageBuffer());
-            for (uint32_t i = 0; i < imgSize; i++)
-                imgFloat[i] = buffer[i];
-        }
-        break;
+            convertToFloat(reinterpret_cast<int64_t *>(imageData->getImageBuffer()), imgFloat, imgSize);
+            break;
 
         case TDOUBLE:
-        {
-            double *buffer = reinterpret_cast<double *>(imageData->getImageBuffer());
-            for (uint32_t i = 0; i < imgSize; i++)
-                imgFloat[i] = buffer[i];
-        }
-        break;
+            convertToFloat(reinterpret_cast<double *>(imageData->getImageBuffer()), imgFloat, imgSize);
+            break;
 
         default:
-            delete[] imgFloat;
             return nullptr;
     }
 
     return imgFloat;
 }
 
-QVector<float *> cgmath::partitionImage() const
+QVector<uint32_t> cgmath::partitionImage(uint32_t width, uint32_t height) const
 {
-    QVector<float *> regions;
-
-    FITSData *imageData = guideView->getImageData();
-
-    float *imgFloat = createFloatImage();
-
-    if (imgFloat == nullptr)
-        return regions;
-
-    const uint32_t width  = imageData->getWidth();
-    const uint32_t height = imageData->getHeight();
+    QVector<uint32_t> regions;
 
     uint8_t xRegions = floor(width / regionAxis);
     uint8_t yRegions = floor(height / regionAxis);
     // Find number of regions to divide the image
     //uint8_t regions =  xRegions * yRegions;
 
-    float *regionPtr = imgFloat;
+    regions.reserve(xRegions * yRegions);
 
     for (uint8_t i = 0; i < yRegions; i++)
     {
         for (uint8_t j = 0; j < xRegions; j++)
-        {
-            // Allocate space for one region
-            float *oneRegion = new float[regionAxis * regionAxis];
-            // Create points to region and current location of the source image in the desired region
-            float *oneRegionPtr = oneRegion, *imgFloatPtr = regionPtr + j * regionAxis;
-
-            // copy from image to region line by line
-            for (uint32_t line = 0; line < regionAxis; line++)
-            {
-                memcpy(oneRegionPtr, imgFloatPtr, regionAxis);
-                oneRegionPtr += regionAxis;
-                imgFloatPtr += width;
-            }
-
-            regions.append(oneRegion);
-        }
-
-        // Move regionPtr block by (width * regionAxis) elements
-        regionPtr += width * regionAxis;
+            regions.append(i * regionAxis * width + j * regionAxis);
     }
 
-    // We're done with imgFloat
-    delete[] imgFloat;
-
     return regions;
 }
 
@@ -709,30 +774,29 @@ Vector cgmath::findLocalStarPosition(void) const
         QVector<Vector> shifts;
         float xsum = 0, ysum = 0;
 
-        QVector<float *> imageParition = partitionImage();
+        const uint32_t width  = imageData->getWidth();
+        const uint32_t height = imageData->getHeight();
 
-        if (imageParition.isEmpty())
+        if (width != referenceWidth || height != referenceHeight)
         {
-            qWarning() << "Failed to partiion regions in image!";
+            qWarning() << "Mismatch between reference image" << referenceWidth << "x" << referenceHeight
+                       << "and guide image" << width << "x" << height;
             return Vector(-1, -1, -1);
         }
 
-        if (imageParition.count() != referenceRegions.count())
-        {
-            qWarning() << "Mismatch between reference regions #" << referenceRegions.count()
-                       << "and image parition regions #" << imageParition.count();
-            // Clear memory in case of mis-match
-            foreach (float *region, imageParition)
-            {
-                delete[] region;
-            }
+        const float *imgFloat = createFloatImage();
+        QVector<uint32_t> regions = partitionImage(width, height);
 
+        if (imgFloat == nullptr || regions.isEmpty())
+        {
+            qWarning() << "Failed to partiion regions in image!";
             return Vector(-1, -1, -1);
         }
 
-        for (uint8_t i = 0; i < imageParition.count(); i++)
+        for (int i = 0; i < regions.count(); i++)
         {
-            ImageAutoGuiding::ImageAutoGuiding1(referenceRegions[i], imageParition[i], regionAxis, &xshift, &yshift);
+            ImageAutoGuiding::ImageAutoGuiding1(referenceImage.constData() + regions[i], imgFloat + regions[i],
+                                                regionAxis, width, &xshift, &yshift);
             Vector shift(xshift, yshift, -1);
             qCDebug(KSTARS_EKOS_GUIDE) << "Region #" << i << ": X-Shift=" << xshift << "Y-Shift=" << yshift;
 
@@ -741,18 +805,11 @@ Vector cgmath::findLocalStarPosition(void) const
             shifts.append(shift);
         }
 
-        // Delete partitions
-        foreach (float *region, imageParition)
-        {
-            delete[] region;
-        }
-        imageParition.clear();
+        float average_x = xsum / regions.count();
+        float average_y = ysum / regions.count();
 
-        float average_x = xsum / referenceRegions.count();
-        float average_y = ysum / referenceRegions.count();
-
-        float median_x = shifts[referenceRegions.count() / 2 - 1].x;
-        float median_y = shifts[referenceRegions.count() / 2 - 1].y;
+        float median_x = shifts[(regions.count() - 1) / 2].x;
+        float median_y = shifts[(regions.count() - 1) / 2].y;
 
         qCDebug(KSTARS_EKOS_GUIDE) << "Average : X-Shift=" << average_x << "Y-Shift=" << average_y;
         qCDebug(KSTARS_EKOS_GUIDE) << "Median  : X-Shift=" << median_x << "Y-Shift=" << median_y;
@@ -1571,18 +1628,18 @@ QList<Edge*> cgmath::PSFAutoFind(int extraEdgeAllowance)
     int subH = smoothed->getHeight();
 
     // convert to floating point
-    float *conv = createFloatImage(smoothed);
-
-    // run the PSF convolution
+    const float *smoothedFloat = createFloatImage(smoothed);
+    if (smoothedFloat == nullptr)
     {
-        float *tmp = new float[smoothed->getSize()];
-        memset(tmp, 0, smoothed->getSize()*sizeof(float));
-        psf_conv(tmp, conv, subW, subH);
-        delete [] conv;
-        // Swap
-        conv = tmp;
+        delete (smoothed);
+        return QList<Edge*>();
     }
 
+    // run the PSF convolution
+    QVector<float> convImage(smoothed->getSize(), 0);
+    psf_conv(convImage.data(), smoothedFloat, subW, subH);
+    const float *conv = convImage.constData();
+
     enum { CONV_RADIUS = 4 };
     int dw = subW;      // width of the downsampled image
     int dh = subH;     // height of the downsampled image
@@ -1749,7 +1806,6 @@ QList<Edge*> cgmath::PSFAutoFind(int extraEdgeAllowance)
         centers.append(center);
     }
 
-    delete [] conv;
     delete (smoothed);
 
     return centers;
@@ -180,8 +180,9 @@ class cgmath : public QObject
     template <typename T>
     Vector findLocalStarPosition(void) const;
 
-    // Creates a new float image from the guideView image data. The returned image MUST be deleted later or memory will leak.
-    float *createFloatImage(FITSData *target=nullptr) const;
+    // Converts the first plane of the guideView image data to float. The returned image is owned by cgmath and is
+    // only valid until the next call, as the same workspace is reused for every frame.
+    const float *createFloatImage(FITSData *target=nullptr) const;
 
     void do_ticks(void);
     Vector point2arcsec(const Vector &p) const;
@@ -245,11 +246,16 @@ class cgmath : public QObject
 
     // Image Guide
     bool imageGuideEnabled { false };
-    // Partition guideView image into NxN square regions each of size axis*axis. The returned vector contains pointers to
-    // the newly allocated square images. It MUST be deleted later by delete[] or memory will leak.
-    QVector<float *> partitionImage() const;
+    // Partition a width x height image into NxN square regions each of size axis*axis. The returned vector contains the
+    // offsets of the top left pixel of each region. Regions are used in place, with the image width as their stride.
+    QVector<uint32_t> partitionImage(uint32_t width, uint32_t height) const;
     uint32_t regionAxis { 64 };
-    QVector<float *> referenceRegions;
+    /// Reference frame in float, captured when guiding starts
+    QVector<float> referenceImage;
+    uint32_t referenceWidth { 0 };
+    uint32_t referenceHeight { 0 };
+    /// Float image workspace reused for every frame
+    mutable QVector<float> floatImage;
 
     // dithering
     double ditherRate[2];
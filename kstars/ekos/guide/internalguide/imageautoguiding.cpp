@@ -23,7 +23,7 @@
 #define TWOPI   6.28318530717959
 #define FFITMAX 0.05
 
-//void ImageAutoGuiding1(float *ref,float *im,int n,float *xshift,float *yshift);
+//void ImageAutoGuiding1(const float *ref,const float *im,int n,int stride,float *xshift,float *yshift);
 
 float ***f3tensorSP(long nrl, long nrh, long ncl, long nch, long ndl, long ndh);
 void free_f3tensorSP(float ***t, long nrl, long nrh, long ncl, long nch, long ndl, long ndh);
@@ -41,7 +41,7 @@ void ShiftEST(float ***testimage, float ***refimage, int n, float *xshift, float
 
 namespace ImageAutoGuiding
 {
-void ImageAutoGuiding1(float *ref, float *im, int n, float *xshift, float *yshift)
+void ImageAutoGuiding1(const float *ref, const float *im, int n, int stride, float *xshift, float *yshift)
 {
     float ***RefImage, ***TestImage;
     int i, j, k;
@@ -54,10 +54,10 @@ void ImageAutoGuiding1(float *ref, float *im, int n, float *xshift, float *yshif
 
     /* Load Data */
 
-    k = 0;
-
     for (j = 1; j <= n; ++j)
     {
+        k = (j - 1) * stride;
+
         for (i = 1; i <= n; ++i)
         {
             RefImage[1][j][i]  = ref[k];
@@ -21,8 +21,9 @@
 // n MUST be a Power of 2  use 128,256,512
 // 256 X 256 is A good Choice
 // These should be portions of the camera imagery
+// stride is the distance between rows, so portions are read in place from the full images
 
 namespace ImageAutoGuiding
 {
-void ImageAutoGuiding1(float *ref, float *im, int n, float *xshift, float *yshift);
+void ImageAutoGuiding1(const float *ref, const float *im, int n, int stride, float *xshift, float *yshift);
 }
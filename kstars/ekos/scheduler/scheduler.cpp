@@ -11,6 +11,7 @@
 
 #include "scheduler.h"
 
+#include "altitudesolver.h"
 #include "ksalmanac.h"
 #include "ksnotification.h"
 #include "kstars.h"
@@ -171,9 +172,25 @@ Scheduler::Scheduler()
 
     connect(twilightCheck, SIGNAL(toggled(bool)), this, SLOT(checkTwilightWarning(bool)));
 
+    connect(&capturedFilesWatcher, &QFileSystemWatcher::directoryChanged, this, &Scheduler::invalidateCapturedFiles);
+
+    // Moon positions and scores depend on the location, altitude ranges are already cached per location
+    connect(KStarsData::Instance(), &KStarsData::geoChanged, this, [this]()
+    {
+        moonState = MoonState();
+        for (JobCache &cache : jobCaches)
+            cache.scoreTime = QDateTime();
+    });
+
     loadProfiles();
 }
 
+Scheduler::~Scheduler()
+{
+    for (JobCache &cache : jobCaches)
+        qDeleteAll(cache.sequence);
+}
+
 QString Scheduler::getCurrentJobName()
 {
     return (currentJob != nullptr ? currentJob->getName() : "");
@@ -396,7 +413,10 @@ void Scheduler::saveJob()
     SchedulerJob *job = nullptr;
 
     if (jobUnderEdit >= 0)
+    {
         job = jobs.at(queueTable->currentRow());
+        invalidateJobCache(job);
+    }
     else
         job = new SchedulerJob();
 
@@ -411,7 +431,10 @@ void Scheduler::saveJob()
     if (raOk == false)
     {
         if(jobUnderEdit < 0)
+        {
+            invalidateJobCache(job);
             delete job;
+        }
         appendLogText(i18n("RA value %1 is invalid.", raBox->text()));
         return;
     }
@@ -419,7 +442,10 @@ void Scheduler::saveJob()
     if (decOk == false)
     {
         if(jobUnderEdit < 0)
+        {
+            invalidateJobCache(job);
             delete job;
+        }
         appendLogText(i18n("DEC value %1 is invalid.", decBox->text()));
         return;
     }
@@ -776,6 +802,7 @@ void Scheduler::removeJob()
 
     SchedulerJob *job = jobs.at(currentRow);
     jobs.removeOne(job);
+    invalidateJobCache(job);
     delete (job);
 
     if (queueTable->rowCount() == 0)
@@ -1614,7 +1641,6 @@ bool Scheduler::calculateAltitudeTime(SchedulerJob *job, double minAltitude, dou
 {
     // We wouldn't stat observation 30 mins (default) before dawn.
     double earlyDawn = Dawn - Options::preDawnTime() / (60.0 * 24.0);
-    double altitude  = 0;
     QDateTime lt(KStarsData::Instance()->lt().date(), QTime());
     KStarsDateTime ut = geo->LTtoUT(KStarsDateTime(lt));
 
@@ -1623,40 +1649,70 @@ bool Scheduler::calculateAltitudeTime(SchedulerJob *job, double minAltitude, dou
     QTime now       = KStarsData::Instance()->lt().time();
     double fraction = now.hour() + now.minute() / 60.0 + now.second() / 3600;
 
-    for (double hour = fraction; hour < (fraction + 24); hour += 1.0 / 60.0)
-    {
-        double rawFrac      = 0;
-        KStarsDateTime myUT = ut.addSecs(hour * 3600.0);
+    // The altitude was historically checked every minute from now, keep start times on the same grid
+    auto onMinute = [fraction](double hour) { return fraction + ceil((hour - fraction) * 60.0 - 1e-6) / 60.0; };
 
-        rawFrac = (hour > 24 ? (hour - 24) : hour) / 24.0;
+    // Hours since midnight at which the target is above the minimum altitude, today and tomorrow.
+    // Ranges are cached per target, night and location, so evaluating the job again is cheap.
+    QList<QPair<double, double>> aboveRanges;
+    for (const AltitudeSolver::TimeRange &range :
+         AltitudeSolver::aboveAltitude(target, geo, minAltitude, ut, ut.addDays(2)))
+        aboveRanges.append(qMakePair(static_cast<double>((range.start.djd() - ut.djd()) * 24.0),
+                                     static_cast<double>((range.end.djd() - ut.djd()) * 24.0)));
 
-        if (rawFrac < Dawn || rawFrac > Dusk)
-        {
-            CachingDms LST = geo->GSTtoLST(myUT.gst());
-            target.EquatorialToHorizontal(&LST, geo->lat());
-            altitude = target.alt().Degrees();
+    // Night time over the next 24 hours, with the time after which a job is too close to dawn
+    const double preDawn = (Dawn - earlyDawn) * 24;
+    const QList<QPair<double, double>> nightRanges = { qMakePair(0.0, Dawn * 24), qMakePair(Dusk * 24, 24 + Dawn * 24),
+                                                       qMakePair(24 + Dusk * 24, 48.0) };
+    const double earlyDawnHours[] = { Dawn * 24 - preDawn, 24 + Dawn * 24 - preDawn, 48.0 };
 
-            if (altitude > minAltitude)
-            {
-                QDateTime startTime = geo->UTtoLT(myUT);
+    for (int i = 0; i < nightRanges.count(); i++)
+    {
+        const double earlyDawnHour = preDawn > 0 ? earlyDawnHours[i] : 48.0;
 
-                if (rawFrac > earlyDawn && rawFrac < Dawn)
-                {
-                    appendLogText(i18n("%1 reaches an altitude of %2 degrees at %3 but will not be scheduled due to "
-                                       "close proximity to astronomical twilight rise.",
-                                       job->getName(), QString::number(minAltitude, 'g', 3), startTime.toString()));
-                    return false;
-                }
+        for (const QPair<double, double> &above : aboveRanges)
+        {
+            double first = onMinute(qMax(qMax(nightRanges[i].first, above.first), fraction));
+            double last  = qMin(qMin(nightRanges[i].second, above.second), fraction + 24);
 
-                if (minMoonAngle > 0 && getMoonSeparationScore(job, startTime) < 0)
+            if (first > last)
+                continue;
+
+            if (minMoonAngle > 0 && first <= earlyDawnHour)
+            {
+                // The moon moves slowly enough not to miss a separation change within a quarter of an hour
+                KStarsDateTime moonTime;
+                bool found = AltitudeSolver::findFirst(
+                    [&](const KStarsDateTime &when) { return getMoonSeparationScore(job, geo->UTtoLT(when)) >= 0; },
+                    ut.addSecs(first * 3600.0), ut.addSecs(qMin(last, earlyDawnHour) * 3600.0), 15 * 60, 60,
+                    moonTime);
+
+                if (found)
+                    first = onMinute((moonTime.djd() - ut.djd()) * 24.0);
+                else if (last > earlyDawnHour)
+                    first = onMinute(earlyDawnHour + 1e-3);
+                else
                     continue;
+            }
 
-                job->setStartupTime(startTime);
-                job->setStartupCondition(SchedulerJob::START_AT);
-                qCInfo(KSTARS_EKOS_SCHEDULER) << job->getName() << "is scheduled to start at" << startTime.toString() <<
-                                                 "where its altitude is" << QString::number(altitude, 'g', 3) << "degrees.";
-                return true;
+            KStarsDateTime myUT = ut.addSecs(first * 3600.0);
+            QDateTime startTime = geo->UTtoLT(myUT);
+
+            if (first > earlyDawnHour)
+            {
+                appendLogText(i18n("%1 reaches an altitude of %2 degrees at %3 but will not be scheduled due to "
+                                   "close proximity to astronomical twilight rise.",
+                                   job->getName(), QString::number(minAltitude, 'g', 3), startTime.toString()));
+                return false;
             }
+
+            double altitude = SkyPoint::findAltitude(&target, myUT, geo).Degrees();
+
+            job->setStartupTime(startTime);
+            job->setStartupCondition(SchedulerJob::START_AT);
+            qCInfo(KSTARS_EKOS_SCHEDULER) << job->getName() << "is scheduled to start at" << startTime.toString() <<
+                                             "where its altitude is" << QString::number(altitude, 'g', 3) << "degrees.";
+            return true;
         }
     }
 
@@ -1675,26 +1731,12 @@ bool Scheduler::calculateCulmination(SchedulerJob *job)
 {
     SkyPoint target = job->getTargetCoords();
 
-    SkyObject o;
+    KStarsDateTime transit = AltitudeSolver::nextTransit(target, geo, geo->LTtoUT(KStarsData::Instance()->lt()));
+    QDateTime transitTime  = geo->UTtoLT(transit);
 
-    o.setRA0(target.ra0());
-    o.setDec0(target.dec0());
-
-    o.EquatorialToHorizontal(KStarsData::Instance()->lst(), KStarsData::Instance()->geo()->lat());
-
-    QDateTime midnight(KStarsData::Instance()->lt().date(), QTime());
-    KStarsDateTime dt = geo->LTtoUT(KStarsDateTime(midnight));
+    appendLogText(i18n("%1 Transit time is %2", job->getName(), transitTime.time().toString()));
 
-    QTime transitTime = o.transitTime(dt, geo);
-
-    appendLogText(i18n("%1 Transit time is %2", job->getName(), transitTime.toString()));
-
-    int dayOffset = 0;
-    if (KStarsData::Instance()->lt().time() > transitTime)
-        dayOffset = 1;
-
-    QDateTime observationDateTime(QDate::currentDate().addDays(dayOffset),
-                                  transitTime.addSecs(job->getCulminationOffset() * 60));
+    QDateTime observationDateTime = transitTime.addSecs(job->getCulminationOffset() * 60);
 
     appendLogText(i18np("%1 Observation time is %2 adjusted for %3 minute.",
                         "%1 Observation time is %2 adjusted for %3 minutes.", job->getName(),
@@ -1853,6 +1895,11 @@ int16_t Scheduler::getDarkSkyScore(const QDateTime &observationDateTime)
 
 int16_t Scheduler::calculateJobScore(SchedulerJob *job, QDateTime when)
 {
+    // Jobs far in the future are scored at their startup time on every evaluation
+    JobCache &cache = jobCaches[job];
+    if (cache.scoreTime.isValid() && cache.scoreTime == when)
+        return cache.score;
+
     int16_t total = 0;
 
     if (job->getEnforceTwilight())
@@ -1861,6 +1908,9 @@ int16_t Scheduler::calculateJobScore(SchedulerJob *job, QDateTime when)
         total += getAltitudeScore(job, when);
     total += getMoonSeparationScore(job, when);
 
+    cache.scoreTime = when;
+    cache.score     = total;
+
     return total;
 }
 
@@ -1880,7 +1930,9 @@ int16_t Scheduler::getAltitudeScore(SchedulerJob *job, QDateTime when)
         else
         {
             // Get HA of actual object, and not of the mount as was done below
-            double HA = KStars::Instance()->data()->lst()->Hours() - job->getTargetCoords().ra().Hours();
+            // The HA is taken at the scored time, so that the score does not depend on when it is computed
+            double HA = geo->GSTtoLST(geo->LTtoUT(KStarsDateTime(when)).gst()).Hours() -
+                        job->getTargetCoords().ra().Hours();
 
 #if 0
             if (indiState == INDI_READY)
@@ -1924,13 +1976,28 @@ double Scheduler::getCurrentMoonSeparation(SchedulerJob *job)
     p.EquatorialToHorizontal(&LST, geo->lat());
 
     // Update moon
-    ut = geo->LTtoUT(KStarsData::Instance()->lt());
+    updateMoon(geo->LTtoUT(KStarsData::Instance()->lt()));
+
+    // Moon/Sky separation p
+    SkyPoint moonPoint(dms(moonState.ra), dms(moonState.dec));
+    return moonPoint.angularDistanceTo(&p).Degrees();
+}
+
+void Scheduler::updateMoon(const KStarsDateTime &ut)
+{
+    // All jobs are scored at the same time during an evaluation, so the moon is computed once for all of them
+    if (moonState.time.isValid() && moonState.time == ut)
+        return;
+
     KSNumbers ksnum(ut.djd());
-    LST = geo->GSTtoLST(ut.gst());
+    CachingDms LST = geo->GSTtoLST(ut.gst());
     moon->updateCoords(&ksnum, true, geo->lat(), &LST, true);
 
-    // Moon/Sky separation p
-    return moon->angularDistanceTo(&p).Degrees();
+    moonState.time         = ut;
+    moonState.ra           = moon->ra().Degrees();
+    moonState.dec          = moon->dec().Degrees();
+    moonState.altitude     = moon->alt().Degrees();
+    moonState.illumination = moon->illum();
 }
 
 int16_t Scheduler::getMoonSeparationScore(SchedulerJob *job, QDateTime when)
@@ -1947,18 +2014,16 @@ int16_t Scheduler::getMoonSeparationScore(SchedulerJob *job, QDateTime when)
     double currentAlt = p.alt().Degrees();
 
     // Update moon
-    ut = geo->LTtoUT(KStarsDateTime(when));
-    KSNumbers ksnum(ut.djd());
-    LST = geo->GSTtoLST(ut.gst());
-    moon->updateCoords(&ksnum, true, geo->lat(), &LST, true);
+    updateMoon(geo->LTtoUT(KStarsDateTime(when)));
 
-    double moonAltitude = moon->alt().Degrees();
+    double moonAltitude = moonState.altitude;
 
     // Lunar illumination %
-    double illum = moon->illum() * 100.0;
+    double illum = moonState.illumination * 100.0;
 
     // Moon/Sky separation p
-    double separation = moon->angularDistanceTo(&p).Degrees();
+    SkyPoint moonPoint(dms(moonState.ra), dms(moonState.dec));
+    double separation = moonPoint.angularDistanceTo(&p).Degrees();
 
     // Zenith distance of the moon
     double zMoon = (90 - moonAltitude);
@@ -2001,6 +2066,10 @@ void Scheduler::calculateDawnDusk()
     Dawn = ksal.getDawnAstronomicalTwilight();
     Dusk = ksal.getDuskAstronomicalTwilight();
 
+    // Dark sky scores depend on twilight
+    for (JobCache &cache : jobCaches)
+        cache.scoreTime = QDateTime();
+
     QTime now  = KStarsData::Instance()->lt().time();
     QTime dawn = QTime(0, 0, 0).addSecs(Dawn * 24 * 3600);
     QTime dusk = QTime(0, 0, 0).addSecs(Dusk * 24 * 3600);
@@ -3228,6 +3297,8 @@ bool Scheduler::loadScheduler(const QString &fileURL)
     if (jobUnderEdit >= 0)
         resetJobEdit();
 
+    for (SchedulerJob *job : jobs)
+        invalidateJobCache(job);
     qDeleteAll(jobs);
     jobs.clear();
     while (queueTable->rowCount() > 0)
@@ -4003,7 +4074,7 @@ void Scheduler::updateCompletedJobsCount()
 
     for (SchedulerJob *oneJob : jobs)
     {
-        if (loadSequenceQueue(oneJob->getSequenceFile().toLocalFile(), oneJob, seqjobs, hasAutoFocus) == false)
+        if (getSequenceQueue(oneJob, seqjobs, hasAutoFocus) == false)
             continue;
 
         foreach (SequenceJob *oneSeqJob, seqjobs)
@@ -4020,9 +4091,6 @@ void Scheduler::updateCompletedJobsCount()
             if (oneJob->getState() == SchedulerJob::JOB_COMPLETE)
                 finishedFramesCount[signature] += oneSeqJob->getCount();
         }
-
-        qDeleteAll(seqjobs);
-        seqjobs.clear();
     }
 }
 
@@ -4033,7 +4101,7 @@ bool Scheduler::estimateJobTime(SchedulerJob *schedJob)
     QList<SequenceJob *> jobs;
     bool hasAutoFocus = false;
 
-    if (loadSequenceQueue(schedJob->getSequenceFile().toLocalFile(), schedJob, jobs, hasAutoFocus) == false)
+    if (getSequenceQueue(schedJob, jobs, hasAutoFocus) == false)
         return false;
 
     schedJob->setInSequenceFocus(hasAutoFocus);
@@ -4060,7 +4128,6 @@ bool Scheduler::estimateJobTime(SchedulerJob *schedJob)
             }
 
             schedJob->setLightFramesRequired(lightFramesRequired);
-            qDeleteAll(jobs);
             return true;
         }
 
@@ -4114,8 +4181,6 @@ bool Scheduler::estimateJobTime(SchedulerJob *schedJob)
     schedJob->setSequenceCount(totalSequenceCount);
     schedJob->setCompletedCount(totalCompletedCount);
 
-    qDeleteAll(jobs);
-
     // We can't estimate times that do not finish when sequence is done
     if (schedJob->getCompletionCondition() == SchedulerJob::FINISH_LOOP)
     {
@@ -4680,7 +4745,10 @@ void Scheduler::startMosaicTool()
         // Delete any prior jobs before saving
         for (int i = 0; i < currentJobsCount; i++)
         {
-            delete (jobs.takeFirst());
+            SchedulerJob *job = jobs.takeFirst();
+            // A new job may be allocated at the same address, it must not find the cache of this one
+            invalidateJobCache(job);
+            delete (job);
             queueTable->removeRow(0);
         }
 
@@ -5034,13 +5102,50 @@ bool Scheduler::loadSequenceQueue(const QString &fileURL, SchedulerJob *schedJob
             appendLogText(QString(errmsg));
             delLilXML(xmlParser);
             qDeleteAll(jobs);
+            jobs.clear();
             return false;
         }
     }
 
+    delLilXML(xmlParser);
+    return true;
+}
+
+bool Scheduler::getSequenceQueue(SchedulerJob *schedJob, QList<SequenceJob *> &jobs, bool &hasAutoFocus)
+{
+    const QString fileURL    = schedJob->getSequenceFile().toLocalFile();
+    const QDateTime modified = QFileInfo(fileURL).lastModified();
+
+    JobCache &cache = jobCaches[schedJob];
+
+    if (cache.sequence.isEmpty() || cache.sequenceFile != fileURL || cache.sequenceModified != modified)
+    {
+        qDeleteAll(cache.sequence);
+        cache.sequence.clear();
+        cache.hasAutoFocus = false;
+
+        if (loadSequenceQueue(fileURL, schedJob, cache.sequence, cache.hasAutoFocus) == false)
+            return false;
+
+        cache.sequenceFile     = fileURL;
+        cache.sequenceModified = modified;
+    }
+
+    jobs         = cache.sequence;
+    hasAutoFocus = cache.hasAutoFocus;
     return true;
 }
 
+void Scheduler::invalidateJobCache(SchedulerJob *job)
+{
+    auto cache = jobCaches.find(job);
+    if (cache == jobCaches.end())
+        return;
+
+    qDeleteAll(cache.value().sequence);
+    jobCaches.erase(cache);
+}
+
 SequenceJob *Scheduler::processJobInfo(XMLEle *root, SchedulerJob *schedJob)
 {
     XMLEle *ep    = nullptr;
@@ -5155,24 +5260,45 @@ SequenceJob *Scheduler::processJobInfo(XMLEle *root, SchedulerJob *schedJob)
 
 int Scheduler::getCompletedFiles(const QString &path, const QString &seqPrefix)
 {
-    QString tempName;
-    int seqFileCount = 0;
+    QStringList baseNames;
+    auto cached = capturedFiles.constFind(path);
 
-    QDirIterator it(path, QDir::Files);
-
-    while (it.hasNext())
+    if (cached != capturedFiles.constEnd())
+        baseNames = cached.value();
+    else
     {
-        tempName = it.next();
-        QFileInfo info(tempName);
-        tempName = info.baseName();
+        // Watch before listing, so that files captured meanwhile are not missed
+        bool watched = capturedFilesWatcher.directories().contains(path);
+        if (watched == false && QFileInfo(path).isDir())
+            watched = capturedFilesWatcher.addPath(path);
 
-        // find the prefix first
-        if (tempName.startsWith(seqPrefix) == false)
-            continue;
+        QDirIterator it(path, QDir::Files);
+
+        while (it.hasNext())
+        {
+            it.next();
+            baseNames.append(it.fileInfo().baseName());
+        }
 
-        seqFileCount++;
+        // A directory that does not exist yet cannot be watched, it is listed again until it is created
+        if (watched)
+            capturedFiles.insert(path, baseNames);
+    }
+
+    int seqFileCount = 0;
+
+    for (const QString &baseName : baseNames)
+    {
+        // find the prefix first
+        if (baseName.startsWith(seqPrefix))
+            seqFileCount++;
     }
 
     return seqFileCount;
 }
+
+void Scheduler::invalidateCapturedFiles(const QString &path)
+{
+    capturedFiles.remove(path);
+}
 }
@@ -16,6 +16,8 @@
 
 #include <lilxml.h>
 
+#include <QFileSystemWatcher>
+#include <QHash>
 #include <QProcess>
 #include <QTime>
 #include <QTimer>
@@ -28,6 +30,7 @@ class QProgressIndicator;
 
 class GeoLocation;
 class KSMoon;
+class KStarsDateTime;
 class SchedulerJob;
 class SkyObject;
 
@@ -105,7 +108,7 @@ class Scheduler : public QWidget, public Ui::Scheduler
     } SchedulerColumns;
 
     Scheduler();
-    ~Scheduler() = default;
+    ~Scheduler();
 
     QString getCurrentJobName();
     void appendLogText(const QString &);
@@ -212,6 +215,12 @@ class Scheduler : public QWidget, public Ui::Scheduler
          */
     void selectObject();
 
+    /**
+         * @brief invalidateCapturedFiles Forget the files listed in a capture directory, after they changed
+         * @param path Capture directory
+         */
+    void invalidateCapturedFiles(const QString &path);
+
     /**
          * @brief Selects FITS file for solving.
          */
@@ -553,8 +562,31 @@ class Scheduler : public QWidget, public Ui::Scheduler
     SequenceJob *processJobInfo(XMLEle *root, SchedulerJob *schedJob);
     bool loadSequenceQueue(const QString &fileURL, SchedulerJob *schedJob, QList<SequenceJob *> &jobs,
                            bool &hasAutoFocus);
+
+    /**
+         * @brief getSequenceQueue Get the sequence jobs of a scheduler job, loading its sequence file only if it changed
+         * @param schedJob Scheduler job
+         * @param jobs Set to the sequence jobs, which remain owned by the scheduler and must not be deleted
+         * @param hasAutoFocus Set to true if the sequence uses in-sequence autofocus
+         * @return False if the sequence file cannot be loaded
+         */
+    bool getSequenceQueue(SchedulerJob *schedJob, QList<SequenceJob *> &jobs, bool &hasAutoFocus);
+
+    /**
+         * @brief getCompletedFiles Count the files of a capture directory starting with a prefix
+         * @note The files of each directory are listed once, then again only after the directory changed
+         */
     int getCompletedFiles(const QString &path, const QString &seqPrefix);
 
+    /**
+         * @brief updateMoon Compute the position of the moon at a time, unless it was already computed for it
+         * @param ut Time in UT
+         */
+    void updateMoon(const KStarsDateTime &ut);
+
+    /** Drop the cached sequence and score of a job, before it is modified or deleted */
+    void invalidateJobCache(SchedulerJob *job);
+
     Ekos::Scheduler *ui { nullptr };
     //DBus interfaces
     QDBusInterface *focusInterface { nullptr };
@@ -648,5 +680,33 @@ class Scheduler : public QWidget, public Ui::Scheduler
     QUrl dirPath;
 
     QMap<QString,uint16_t> capturedFramesCount;
+
+    /// Data derived from a job, kept until what it depends on changes
+    struct JobCache
+    {
+        /// Sequence jobs loaded from the sequence file, and its modification time when loaded
+        QList<SequenceJob *> sequence;
+        QString sequenceFile;
+        QDateTime sequenceModified;
+        bool hasAutoFocus { false };
+        /// Score of the job at scoreTime, invalid if not computed
+        QDateTime scoreTime;
+        int16_t score { 0 };
+    };
+    QHash<SchedulerJob *, JobCache> jobCaches;
+
+    /// Base names of the files in each capture directory, dropped when the directory changes
+    QHash<QString, QStringList> capturedFiles;
+    QFileSystemWatcher capturedFilesWatcher;
+
+    /// Position of the moon at time, in UT. The moon itself is also moved by the sky map, so it is kept apart.
+    struct MoonState
+    {
+        QDateTime time;
+        double ra { 0 };
+        double dec { 0 };
+        double altitude { 0 };
+        double illumination { 0 };
+    } moonState;
 };
 }
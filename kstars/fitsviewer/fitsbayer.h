@@ -0,0 +1,520 @@
+/***************************************************************************
+                          fitsbayer.h  -  FITS Image
+                             -------------------
+    begin                : Sun Oct 18 2026
+    copyright            : (C) 2026 by KStars Developers
+ ***************************************************************************/
+
+/***************************************************************************
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ ***************************************************************************/
+
+#pragma once
+
+#include "bayer.h"
+#include "fitsfilters.h"
+
+#include <atomic>
+#include <vector>
+
+/**
+ * Debayering used by FITSData::debayer(), from a bayered channel of width x height samples of type T (8 or 16 bit)
+ * straight into the three planes of a FITS color image.
+ *
+ * Nearest neighbour, bilinear and superpixel are computed natively on bands of rows in the global thread pool,
+ * bilinear using SSE2 when available. Their results match libdc1394 except on the borders of the image, which are
+ * interpolated from mirrored samples instead of being left black. Superpixel replaces DC1394_BAYER_METHOD_DOWNSAMPLE:
+ * each 2x2 cell gives one color, repeated over the cell so that the image keeps its size.
+ *
+ * Other methods are decoded by libdc1394 on bands overlapping by a few rows, and each band is copied to the planes.
+ * AHD is not thread safe and decodes the whole image at once.
+ */
+namespace FITSBayer
+{
+enum Channel
+{
+    RED,
+    GREEN,
+    BLUE
+};
+
+/** Rows decoded above and below a band by libdc1394, enough for the support of all its methods but AHD */
+const uint32_t bandMargin = 8;
+
+/** Sets the channels of the cells (0, 0), (1, 0), (0, 1) and (1, 1) of a pattern, false if the pattern is unknown */
+inline bool cellChannels(dc1394color_filter_t filter, int channels[4])
+{
+    switch (filter)
+    {
+        case DC1394_COLOR_FILTER_RGGB:
+            channels[0] = RED, channels[1] = GREEN, channels[2] = GREEN, channels[3] = BLUE;
+            return true;
+        case DC1394_COLOR_FILTER_GBRG:
+            channels[0] = GREEN, channels[1] = BLUE, channels[2] = RED, channels[3] = GREEN;
+            return true;
+        case DC1394_COLOR_FILTER_GRBG:
+            channels[0] = GREEN, channels[1] = RED, channels[2] = BLUE, channels[3] = GREEN;
+            return true;
+        case DC1394_COLOR_FILTER_BGGR:
+            channels[0] = BLUE, channels[1] = GREEN, channels[2] = GREEN, channels[3] = RED;
+            return true;
+        default:
+            return false;
+    }
+}
+
+/** @return the pattern of an image whose first sample is at offsetX, offsetY of filter */
+inline dc1394color_filter_t shiftFilter(dc1394color_filter_t filter, int offsetX, int offsetY)
+{
+    // Patterns in the order of dc1394color_filter_t, with their columns or rows swapped
+    static const dc1394color_filter_t swappedColumns[DC1394_COLOR_FILTER_NUM] = {
+        DC1394_COLOR_FILTER_GRBG, DC1394_COLOR_FILTER_BGGR, DC1394_COLOR_FILTER_RGGB, DC1394_COLOR_FILTER_GBRG
+    };
+    static const dc1394color_filter_t swappedRows[DC1394_COLOR_FILTER_NUM] = {
+        DC1394_COLOR_FILTER_GBRG, DC1394_COLOR_FILTER_RGGB, DC1394_COLOR_FILTER_BGGR, DC1394_COLOR_FILTER_GRBG
+    };
+
+    if (filter < DC1394_COLOR_FILTER_MIN || filter > DC1394_COLOR_FILTER_MAX)
+        return filter;
+    if (offsetX % 2)
+        filter = swappedColumns[filter - DC1394_COLOR_FILTER_MIN];
+    if (offsetY % 2)
+        filter = swappedRows[filter - DC1394_COLOR_FILTER_MIN];
+    return filter;
+}
+
+/** Index of a sample mirrored into [0, size[, which keeps its color */
+inline uint32_t mirror(int64_t i, uint32_t size)
+{
+    return static_cast<uint32_t>(i < 0 ? -i : (i >= size ? 2 * (int64_t(size) - 1) - i : i));
+}
+
+/**
+ * Bilinear interpolation of a channel at a sample, in quarters of the sample, of its horizontal and vertical
+ * neighbours and of its diagonal neighbours: (center * C + horizontal * H + vertical * V + diagonal * D + 2) / 4.
+ */
+struct Weights
+{
+    int center { 0 };
+    int horizontal { 0 };
+    int vertical { 0 };
+    int diagonal { 0 };
+};
+
+/** Sets the weights of the three channels for the four cells of a pattern */
+inline void bilinearWeights(const int channels[4], Weights weights[4][3])
+{
+    for (int cell = 0; cell < 4; cell++)
+    {
+        const int x = cell & 1, y = cell >> 1;
+        for (int c = 0; c < 3; c++)
+        {
+            Weights &w = weights[cell][c];
+            w          = Weights();
+            if (channels[cell] == c)
+                w.center = 4;
+            else if (channels[cell] == GREEN)
+                (channels[y * 2 + (1 - x)] == c ? w.horizontal : w.vertical) = 2;
+            else if (c == GREEN)
+                w.horizontal = w.vertical = 1;
+            else
+                w.diagonal = 1;
+        }
+    }
+}
+
+template <typename T>
+inline T bilinearSample(const Weights &w, int center, int horizontal, int vertical, int diagonal)
+{
+    return static_cast<T>((w.center * center + w.horizontal * horizontal + w.vertical * vertical +
+                           w.diagonal * diagonal + 2) >> 2);
+}
+
+/** Bilinear interpolation of the three channels at x, y, mirroring samples outside of the image */
+template <typename T>
+inline void bilinearEdge(const T *bayer, uint32_t width, uint32_t height, const Weights weights[4][3], uint32_t x,
+                         uint32_t y, T *const planes[3])
+{
+    const T *up = bayer + size_t(mirror(int64_t(y) - 1, height)) * width;
+    const T *row = bayer + size_t(y) * width;
+    const T *down = bayer + size_t(mirror(int64_t(y) + 1, height)) * width;
+    const uint32_t left = mirror(int64_t(x) - 1, width), right = mirror(int64_t(x) + 1, width);
+
+    const int horizontal = row[left] + row[right];
+    const int vertical   = up[x] + down[x];
+    const int diagonal   = up[left] + up[right] + down[left] + down[right];
+    const size_t offset  = size_t(y) * width + x;
+
+    const Weights *cellWeights = weights[(y & 1) * 2 + (x & 1)];
+
+    for (int c = 0; c < 3; c++)
+        planes[c][offset] = bilinearSample<T>(cellWeights[c], row[x], horizontal, vertical, diagonal);
+}
+
+/** Bilinear interpolation of the three channels from x to end of a row, all neighbours being in the image */
+template <typename T>
+inline void bilinearInterior(const T *up, const T *row, const T *down, const Weights rowWeights[2][3], uint32_t x,
+                             uint32_t end, T *const rowPlanes[3])
+{
+    for (; x < end; x++)
+    {
+        const int horizontal = row[x - 1] + row[x + 1];
+        const int vertical   = up[x] + down[x];
+        const int diagonal   = up[x - 1] + up[x + 1] + down[x - 1] + down[x + 1];
+
+        for (int c = 0; c < 3; c++)
+            rowPlanes[c][x] = bilinearSample<T>(rowWeights[x & 1][c], row[x], horizontal, vertical, diagonal);
+    }
+}
+
+#ifdef FITS_FILTERS_SSE2
+/**
+ * Samples of T widened to lanes holding sums of four samples: 8 bit samples in 16 bit lanes,
+ * 16 bit samples in 32 bit lanes.
+ */
+template <typename T>
+struct Lanes;
+
+template <>
+struct Lanes<uint8_t>
+{
+    static const uint32_t count = 8;
+
+    static __m128i load(const uint8_t *p)
+    {
+        return _mm_unpacklo_epi8(_mm_loadl_epi64(reinterpret_cast<const __m128i *>(p)), _mm_setzero_si128());
+    }
+    static void store(uint8_t *p, __m128i v)
+    {
+        _mm_storel_epi64(reinterpret_cast<__m128i *>(p), _mm_packus_epi16(v, v));
+    }
+    static __m128i add(__m128i a, __m128i b) { return _mm_add_epi16(a, b); }
+    static __m128i times4(__m128i v) { return _mm_slli_epi16(v, 2); }
+    static __m128i quarter(__m128i v) { return _mm_srli_epi16(_mm_add_epi16(v, _mm_set1_epi16(2)), 2); }
+    /** Mask selecting the lanes of even or odd columns, lane 0 being an odd column */
+    static __m128i mask(bool even, bool odd)
+    {
+        const short e = even ? -1 : 0, o = odd ? -1 : 0;
+        return _mm_set_epi16(e, o, e, o, e, o, e, o);
+    }
+};
+
+template <>
+struct Lanes<uint16_t>
+{
+    static const uint32_t count = 4;
+
+    static __m128i load(const uint16_t *p)
+    {
+        return _mm_unpacklo_epi16(_mm_loadl_epi64(reinterpret_cast<const __m128i *>(p)), _mm_setzero_si128());
+    }
+    static void store(uint16_t *p, __m128i v)
+    {
+        // SSE2 only packs signed 32 bit values, the bias brings them into range and back
+        v = _mm_packs_epi32(_mm_sub_epi32(v, _mm_set1_epi32(32768)), _mm_setzero_si128());
+        _mm_storel_epi64(reinterpret_cast<__m128i *>(p), _mm_xor_si128(v, _mm_set1_epi16(static_cast<short>(0x8000))));
+    }
+    static __m128i add(__m128i a, __m128i b) { return _mm_add_epi32(a, b); }
+    static __m128i times4(__m128i v) { return _mm_slli_epi32(v, 2); }
+    static __m128i quarter(__m128i v) { return _mm_srli_epi32(_mm_add_epi32(v, _mm_set1_epi32(2)), 2); }
+    static __m128i mask(bool even, bool odd)
+    {
+        const int e = even ? -1 : 0, o = odd ? -1 : 0;
+        return _mm_set_epi32(e, o, e, o);
+    }
+};
+
+/**
+ * Bilinear interpolation of the interior of a row, Lanes<T>::count samples at a time, starting with the odd column x.
+ * The weights of each channel become lane masks, a weight of 2 being the sum of two masks. Returns the first column
+ * left to the scalar version.
+ */
+template <typename T>
+inline uint32_t bilinearLanes(const T *up, const T *row, const T *down, const Weights rowWeights[2][3], uint32_t x,
+                              uint32_t end, T *const rowPlanes[3])
+{
+    typedef Lanes<T> L;
+
+    __m128i center[3], horizontal1[3], horizontal2[3], vertical1[3], vertical2[3], diagonal[3];
+    for (int c = 0; c < 3; c++)
+    {
+        const Weights &even = rowWeights[0][c], &odd = rowWeights[1][c];
+        center[c]      = L::mask(even.center > 0, odd.center > 0);
+        horizontal1[c] = L::mask(even.horizontal > 0, odd.horizontal > 0);
+        horizontal2[c] = L::mask(even.horizontal > 1, odd.horizontal > 1);
+        vertical1[c]   = L::mask(even.vertical > 0, odd.vertical > 0);
+        vertical2[c]   = L::mask(even.vertical > 1, odd.vertical > 1);
+        diagonal[c]    = L::mask(even.diagonal > 0, odd.diagonal > 0);
+    }
+
+    for (; x + L::count <= end; x += L::count)
+    {
+        const __m128i vCenter = L::times4(L::load(row + x));
+        const __m128i vHorizontal = L::add(L::load(row + x - 1), L::load(row + x + 1));
+        const __m128i vVertical   = L::add(L::load(up + x), L::load(down + x));
+        const __m128i vDiagonal   = L::add(L::add(L::load(up + x - 1), L::load(up + x + 1)),
+                                         L::add(L::load(down + x - 1), L::load(down + x + 1)));
+
+        for (int c = 0; c < 3; c++)
+        {
+            __m128i sum = _mm_and_si128(vCenter, center[c]);
+            sum         = L::add(sum, _mm_and_si128(vHorizontal, horizontal1[c]));
+            sum         = L::add(sum, _mm_and_si128(vHorizontal, horizontal2[c]));
+            sum         = L::add(sum, _mm_and_si128(vVertical, vertical1[c]));
+            sum         = L::add(sum, _mm_and_si128(vVertical, vertical2[c]));
+            sum         = L::add(sum, _mm_and_si128(vDiagonal, diagonal[c]));
+            L::store(rowPlanes[c] + x, L::quarter(sum));
+        }
+    }
+    return x;
+}
+#endif
+
+/** Bilinear interpolation of rows first to last */
+template <typename T>
+void bilinearBand(const T *bayer, uint32_t width, uint32_t height, const Weights weights[4][3], uint32_t first,
+                  uint32_t last, T *const planes[3])
+{
+    for (uint32_t y = first; y < last; y++)
+    {
+        if (y == 0 || y == height - 1 || width < 3)
+        {
+            for (uint32_t x = 0; x < width; x++)
+                bilinearEdge(bayer, width, height, weights, x, y, planes);
+            continue;
+        }
+
+        const T *row = bayer + size_t(y) * width;
+        T *const rowPlanes[3] = { planes[0] + size_t(y) * width, planes[1] + size_t(y) * width,
+                                  planes[2] + size_t(y) * width };
+        const Weights(*rowWeights)[3] = weights + (y & 1) * 2;
+
+        uint32_t x = 1;
+#ifdef FITS_FILTERS_SSE2
+        x = bilinearLanes(row - width, row, row + width, rowWeights, x, width - 1, rowPlanes);
+#endif
+        bilinearInterior(row - width, row, row + width, rowWeights, x, width - 1, rowPlanes);
+
+        bilinearEdge(bayer, width, height, weights, 0, y, planes);
+        bilinearEdge(bayer, width, height, weights, width - 1, y, planes);
+    }
+}
+
+/** Nearest neighbour of libdc1394: each channel is taken from the 2x2 cell starting at the sample */
+template <typename T>
+void nearestBand(const T *bayer, uint32_t width, uint32_t height, const int channels[4], uint32_t first,
+                 uint32_t last, T *const planes[3])
+{
+    // Offsets within the cell of each channel, for the four cells of the pattern. Green samples take the other
+    // green of the cell.
+    static const int order[4] = { 3, 1, 2, 0 };
+    int dx[4][3], dy[4][3];
+    for (int cell = 0; cell < 4; cell++)
+    {
+        for (int c = 0; c < 3; c++)
+        {
+            for (int o : order)
+            {
+                const int x = (cell & 1) + (o & 1), y = (cell >> 1) + (o >> 1);
+                if (channels[(y & 1) * 2 + (x & 1)] == c)
+                {
+                    dx[cell][c] = o & 1;
+                    dy[cell][c] = o >> 1;
+                    break;
+                }
+            }
+        }
+    }
+
+    for (uint32_t y = first; y < last; y++)
+    {
+        const T *rows[2] = { bayer + size_t(y) * width, bayer + size_t(mirror(int64_t(y) + 1, height)) * width };
+        const int cell   = (y & 1) * 2;
+
+        for (int c = 0; c < 3; c++)
+        {
+            T *out = planes[c] + size_t(y) * width;
+            const T *even = rows[dy[cell][c]] + dx[cell][c], *odd = rows[dy[cell + 1][c]] + dx[cell + 1][c];
+
+            uint32_t x = 0;
+            for (; x + 2 < width; x += 2)
+            {
+                out[x]     = even[x];
+                out[x + 1] = odd[x + 1];
+            }
+            for (; x < width; x++)
+            {
+                const int parity = x & 1;
+                out[x] = rows[dy[cell + parity][c]][mirror(int64_t(x) + dx[cell + parity][c], width)];
+            }
+        }
+    }
+}
+
+/** One color per 2x2 cell, the average of its greens, repeated over the cell */
+template <typename T>
+void superpixelBand(const T *bayer, uint32_t width, uint32_t height, const int channels[4], uint32_t first,
+                    uint32_t last, T *const planes[3])
+{
+    for (uint32_t y = first; y < last; y++)
+    {
+        // Odd sizes repeat the last complete cell
+        const uint32_t cellY = std::min(y & ~1u, (height - 2) & ~1u);
+        const T *rows[2]     = { bayer + size_t(cellY) * width, bayer + size_t(cellY + 1) * width };
+        T *const rowPlanes[3] = { planes[0] + size_t(y) * width, planes[1] + size_t(y) * width,
+                                  planes[2] + size_t(y) * width };
+
+        for (uint32_t x = 0; x < width; x += 2)
+        {
+            const uint32_t cellX = std::min(x, (width - 2) & ~1u);
+            int green = 0;
+            for (int i = 0; i < 4; i++)
+            {
+                const T sample = rows[i >> 1][cellX + (i & 1)];
+                if (channels[i] == GREEN)
+                    green += sample;
+                else
+                    rowPlanes[channels[i]][x] = sample;
+            }
+            rowPlanes[GREEN][x] = static_cast<T>((green + 1) >> 1);
+
+            if (x + 1 < width)
+            {
+                for (int c = 0; c < 3; c++)
+                    rowPlanes[c][x + 1] = rowPlanes[c][x];
+            }
+        }
+    }
+}
+
+inline dc1394error_t dc1394Decode(const uint8_t *bayer, uint8_t *rgb, uint32_t width, uint32_t height,
+                                  dc1394color_filter_t filter, dc1394bayer_method_t method)
+{
+    return dc1394_bayer_decoding_8bit(bayer, rgb, width, height, filter, method);
+}
+
+inline dc1394error_t dc1394Decode(const uint16_t *bayer, uint16_t *rgb, uint32_t width, uint32_t height,
+                                  dc1394color_filter_t filter, dc1394bayer_method_t method)
+{
+    return dc1394_bayer_decoding_16bit(bayer, rgb, width, height, filter, method, 16);
+}
+
+/** Copies count interleaved RGB samples into the planes */
+template <typename T>
+inline void deinterleave(const T *rgb, size_t count, T *red, T *green, T *blue)
+{
+    for (size_t i = 0; i < count; i++)
+    {
+        red[i]   = rgb[i * 3];
+        green[i] = rgb[i * 3 + 1];
+        blue[i]  = rgb[i * 3 + 2];
+    }
+}
+
+/** Runs function(first, last) on bands of rows starting on even rows, so that they all start with the same colors */
+template <typename Function>
+void forEachBandOfCells(uint32_t height, Function function)
+{
+    FITSFilters::forEachBand((height + 1) / 2, [height, &function](uint32_t first, uint32_t last) {
+        function(first * 2, std::min(last * 2, height));
+    });
+}
+
+/** Decodes the image with a method of libdc1394, on bands when the method allows it */
+template <typename T>
+dc1394error_t dc1394Debayer(const T *bayer, uint32_t width, uint32_t height, dc1394color_filter_t filter,
+                            dc1394bayer_method_t method, T *const planes[3])
+{
+    if (method == DC1394_BAYER_METHOD_AHD)
+    {
+        std::vector<T> rgb(size_t(width) * height * 3);
+        const dc1394error_t error = dc1394Decode(bayer, rgb.data(), width, height, filter, method);
+        if (error != DC1394_SUCCESS)
+            return error;
+
+        forEachBandOfCells(height, [&](uint32_t first, uint32_t last) {
+            const size_t offset = size_t(first) * width;
+            deinterleave(rgb.data() + offset * 3, size_t(last - first) * width, planes[0] + offset,
+                         planes[1] + offset, planes[2] + offset);
+        });
+        return DC1394_SUCCESS;
+    }
+
+    std::atomic<int> error { DC1394_SUCCESS };
+    forEachBandOfCells(height, [&](uint32_t first, uint32_t last) {
+        const uint32_t top = first > bandMargin ? first - bandMargin : 0;
+        const uint32_t bottom = std::min(last + bandMargin, height);
+
+        std::vector<T> rgb(size_t(width) * (bottom - top) * 3);
+        const dc1394error_t bandError =
+            dc1394Decode(bayer + size_t(top) * width, rgb.data(), width, bottom - top, filter, method);
+        if (bandError != DC1394_SUCCESS)
+        {
+            error = bandError;
+            return;
+        }
+
+        const size_t offset = size_t(first) * width;
+        deinterleave(rgb.data() + size_t(first - top) * width * 3, size_t(last - first) * width, planes[0] + offset,
+                     planes[1] + offset, planes[2] + offset);
+    });
+    return static_cast<dc1394error_t>(error.load());
+}
+
+/**
+ * @brief debayer Decodes a bayered image into three planes
+ * @param bayer width x height samples
+ * @param filter Pattern of the image, starting at its first sample
+ * @param method Method, DC1394_BAYER_METHOD_DOWNSAMPLE being superpixel
+ * @param red, green, blue Planes of width x height samples each, which must not overlap bayer
+ * @return DC1394_SUCCESS or the error of libdc1394
+ */
+template <typename T>
+dc1394error_t debayer(const T *bayer, uint32_t width, uint32_t height, dc1394color_filter_t filter,
+                      dc1394bayer_method_t method, T *red, T *green, T *blue)
+{
+    static_assert(std::is_same<T, uint8_t>::value || std::is_same<T, uint16_t>::value,
+                  "Only 8 and 16 bit images are bayered");
+
+    int channels[4];
+    if (!cellChannels(filter, channels))
+        return DC1394_INVALID_COLOR_FILTER;
+    if (width < 2 || height < 2)
+        return DC1394_FAILURE;
+
+    T *const planes[3] = { red, green, blue };
+
+    switch (method)
+    {
+        case DC1394_BAYER_METHOD_NEAREST:
+            forEachBandOfCells(height, [&](uint32_t first, uint32_t last) {
+                nearestBand(bayer, width, height, channels, first, last, planes);
+            });
+            return DC1394_SUCCESS;
+
+        case DC1394_BAYER_METHOD_BILINEAR:
+        {
+            Weights weights[4][3];
+            bilinearWeights(channels, weights);
+            forEachBandOfCells(height, [&](uint32_t first, uint32_t last) {
+                bilinearBand(bayer, width, height, weights, first, last, planes);
+            });
+            return DC1394_SUCCESS;
+        }
+
+        case DC1394_BAYER_METHOD_DOWNSAMPLE:
+            forEachBandOfCells(height, [&](uint32_t first, uint32_t last) {
+                superpixelBand(bayer, width, height, channels, first, last, planes);
+            });
+            return DC1394_SUCCESS;
+
+        default:
+            return dc1394Debayer(bayer, width, height, filter, method, planes);
+    }
+}
+}
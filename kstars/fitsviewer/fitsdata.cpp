@@ -18,6 +18,8 @@
  ***************************************************************************/
 
 #include "fitsdata.h"
+#include "fitsbayer.h"
+#include "fitsfilters.h"
 
 #include "sep/sep.h"
 
@@ -28,7 +30,10 @@
 #include "auxiliary/ksnotification.h"
 
 #include <QApplication>
+#include <QDir>
+#include <QElapsedTimer>
 #include <QImage>
+#include <QTemporaryFile>
 #include <QtConcurrent>
 
 #if !defined(KSTARS_LITE) && defined(HAVE_WCSLIB)
@@ -37,6 +42,7 @@
 #endif
 
 #include <float.h>
+#include <new>
 
 #include <fits_debug.h>
 
@@ -55,6 +61,18 @@ const int MINIMUM_ROWS_PER_CENTER = 3;
 #define LOW_EDGE_CUTOFF_2  10
 #define MINIMUM_EDGE_LIMIT 2
 
+//#define PROFILE_FILTERS
+//#define PROFILE_HISTOGRAM
+
+// Rows shared by neighbouring strips when SEP extracts full frames in parallel, more than the radius of the stars
+#define SEP_STRIP_OVERLAP 64
+
+// Number of intervals of the grid used to find the sky area covered by an image with WCS
+#define WCS_GRID_SIZE 32
+
+// Size in bytes of the bands of rows read at once
+#define FITS_TILE_SIZE 4194304
+
 bool greaterThan(Edge *s1, Edge *s2)
 {
     //return s1->width > s2->width;
@@ -88,12 +106,15 @@ FITSData::~FITSData()
 {
     int status = 0;
 
+    starFuture.waitForFinished();
+
     clearImageBuffers();
 
     if (starCenters.count() > 0)
         qDeleteAll(starCenters);
 
     delete[] wcs_coord;
+    clearWCS();
 
     if (objList.count() > 0)
         qDeleteAll(objList);
@@ -109,21 +130,14 @@ FITSData::~FITSData()
 
 bool FITSData::loadFITS(const QString &inFilename, bool silent)
 {
-    int status = 0, anynull = 0;
-    long naxes[3];
+    int status = 0;
     char error_status[512];
     QString errMessage;
+    QElapsedTimer loadTimer;
 
-    qDeleteAll(starCenters);
-    starCenters.clear();
+    loadTimer.start();
 
-    if (fptr)
-    {
-        fits_close_file(fptr, &status);
-
-        if (tempFile && autoRemoveTemporaryFITS)
-            QFile::remove(filename);
-    }
+    closeFITS();
 
     filename = inFilename;
 
@@ -134,8 +148,9 @@ bool FITSData::loadFITS(const QString &inFilename, bool silent)
     else
         tempFile = false;
 
-#if 0
-    if (fits_open_image(&fptr, filename.toLatin1(), READONLY, &status))
+    // Use open diskfile as it does not use extended file names which has problems opening
+    // files with [ ] or ( ) in their names.
+    if (fits_open_diskfile(&fptr, filename.toLatin1(), READONLY, &status))
     {
         fits_report_error(stderr, status);
         fits_get_errstatus(status, error_status);
@@ -143,23 +158,80 @@ bool FITSData::loadFITS(const QString &inFilename, bool silent)
         if (silent == false)
             KSNotification::error(errMessage, i18n("FITS Open"));
         qCCritical(KSTARS_FITS) << errMessage;
+        fptr = nullptr;
         return false;
     }
-#endif
 
-    // Use open diskfile as it does not use extended file names which has problems opening
-    // files with [ ] or ( ) in their names.
-    if (fits_open_diskfile(&fptr, filename.toLatin1(), READONLY, &status))
+    return readFITS(silent, loadTimer);
+}
+
+bool FITSData::loadFITSFromMemory(const QByteArray &buffer, bool silent)
+{
+    int status = 0;
+    char error_status[512];
+    QString errMessage;
+    QElapsedTimer loadTimer;
+
+    loadTimer.start();
+
+    closeFITS();
+
+    filename.clear();
+    tempFile = false;
+
+    qCInfo(KSTARS_FITS) << "Loading FITS image of" << buffer.size() << "bytes from memory";
+
+    // The buffer is shared, not copied. It is opened read-only so CFITSIO never writes to or reallocates it.
+    fitsMemory     = buffer;
+    fitsMemoryPtr  = const_cast<char *>(fitsMemory.constData());
+    fitsMemorySize = fitsMemory.size();
+
+    if (fits_open_memfile(&fptr, "memory", READONLY, &fitsMemoryPtr, &fitsMemorySize, 0, nullptr, &status))
     {
         fits_report_error(stderr, status);
         fits_get_errstatus(status, error_status);
-        errMessage = i18n("Could not open file %1. Error %2", filename, QString::fromUtf8(error_status));
+        errMessage = i18n("Could not open FITS image from memory. Error %1", QString::fromUtf8(error_status));
         if (silent == false)
             KSNotification::error(errMessage, i18n("FITS Open"));
         qCCritical(KSTARS_FITS) << errMessage;
+        fptr = nullptr;
+        fitsMemory.clear();
         return false;
     }
 
+    return readFITS(silent, loadTimer);
+}
+
+void FITSData::closeFITS()
+{
+    int status = 0;
+
+    invalidateCaches();
+
+    qDeleteAll(starCenters);
+    starCenters.clear();
+
+    if (fptr)
+    {
+        fits_close_file(fptr, &status);
+        fptr = nullptr;
+
+        if (tempFile && autoRemoveTemporaryFITS)
+            QFile::remove(filename);
+    }
+
+    fitsMemory.clear();
+    fitsMemoryPtr  = nullptr;
+    fitsMemorySize = 0;
+}
+
+bool FITSData::readFITS(bool silent, QElapsedTimer &loadTimer)
+{
+    int status = 0;
+    long naxes[3];
+    char error_status[512];
+    QString errMessage;
+
     if (fits_movabs_hdu(fptr, 1, IMAGE_HDU, &status))
     {
         fits_report_error(stderr, status);
@@ -274,28 +346,29 @@ bool FITSData::loadFITS(const QString &inFilename, bool silent)
     rotCounter     = 0;
     flipHCounter   = 0;
     flipVCounter   = 0;
-    long nelements = stats.samples_per_channel * channels;
 
-    if (fits_read_img(fptr, data_type, 1, nelements, 0, imageBuffer, &anynull, &status))
+    qint64 openTime = loadTimer.restart();
+
+    // Statistics are computed while reading, unless the image is debayered first
+    bool doDebayer = Options::autoDebayer() && checkDebayer();
+
+    if (readImageTiles(doDebayer == false, errMessage) == false)
     {
-        char errmsg[512];
-        fits_get_errstatus(status, errmsg);
-        errMessage = i18n("Error reading image: %1", QString(errmsg));
         if (silent == false)
             KSNotification::error(errMessage, i18n("FITS Open"));
-        fits_report_error(stderr, status);
         qCCritical(KSTARS_FITS) << errMessage;
         return false;
     }
 
-    if (Options::autoDebayer() && checkDebayer())
+    qint64 readTime = loadTimer.restart(), debayerTime = 0;
+
+    if (doDebayer)
     {
         bayerBuffer = imageBuffer;
         if (debayer())
             calculateStats();
+        debayerTime = loadTimer.restart();
     }
-    else
-        calculateStats();
 
     WCSLoaded = false;
 
@@ -304,6 +377,104 @@ bool FITSData::loadFITS(const QString &inFilename, bool silent)
 
     starsSearched = false;
 
+    qCInfo(KSTARS_FITS) << (filename.isEmpty() ? QStringLiteral("Memory image") : filename) << "timings: open" << openTime << "ms, read and statistics" << readTime
+                        << "ms, debayer" << debayerTime << "ms, WCS check" << loadTimer.elapsed() << "ms";
+
+    return true;
+}
+
+bool FITSData::readImageTiles(bool computeStats, QString &errMessage)
+{
+    int status = 0, anynull = 0;
+
+    // Bands of rows of about FITS_TILE_SIZE bytes. CFITSIO converts each band to the native data type
+    // while the statistics of the previous bands are computed in the global thread pool.
+    const uint32_t rowSize     = stats.width * stats.bytesPerPixel;
+    const uint32_t rowsPerTile = qBound<uint32_t>(1, FITS_TILE_SIZE / rowSize, stats.height);
+    const uint32_t tilesPerChannel = (stats.height + rowsPerTile - 1) / rowsPerTile;
+
+    // For 8 and 16 bit data, a frequency table per band gives the histogram, hence the exact median, at little cost
+    const bool computeHistogram = computeStats && (data_type == TBYTE || data_type == TSHORT || data_type == TUSHORT);
+    const uint32_t histogramSize = (data_type == TBYTE) ? 0x100 : 0x10000;
+
+    QVector<QVector<uint32_t>> histograms;
+    QList<QFuture<SampleStats>> futures;
+
+    invalidateCaches();
+
+    if (computeHistogram)
+        histograms.resize(tilesPerChannel * channels);
+
+    for (uint8_t n = 0; n < channels; n++)
+    {
+        for (uint32_t tile = 0; tile < tilesPerChannel; tile++)
+        {
+            uint32_t row   = tile * rowsPerTile;
+            uint32_t start = n * stats.samples_per_channel + row * stats.width;
+            uint32_t count = qMin(rowsPerTile, stats.height - row) * stats.width;
+
+            if (fits_read_img(fptr, data_type, start + 1, count, 0, imageBuffer + static_cast<size_t>(start) * stats.bytesPerPixel,
+                              &anynull, &status))
+            {
+                char errmsg[512];
+                fits_get_errstatus(status, errmsg);
+                errMessage = i18n("Error reading image: %1", QString(errmsg));
+                fits_report_error(stderr, status);
+                // Do not leave any job behind working on the buffer
+                for (auto &future : futures)
+                    future.waitForFinished();
+                return false;
+            }
+
+            if (computeStats)
+            {
+                uint32_t *histogram = nullptr;
+                if (computeHistogram)
+                {
+                    QVector<uint32_t> &tileHistogram = histograms[n * tilesPerChannel + tile];
+                    tileHistogram.fill(0, histogramSize);
+                    histogram = tileHistogram.data();
+                }
+                futures.append(runSampleStats(start, count, histogram));
+            }
+        }
+    }
+
+    if (computeStats == false)
+        return true;
+
+    for (uint8_t n = 0; n < channels; n++)
+    {
+        SampleStats result;
+        for (uint32_t tile = 0; tile < tilesPerChannel; tile++)
+            result.merge(futures[n * tilesPerChannel + tile].result());
+
+        stats.min[n]    = result.min;
+        stats.max[n]    = result.max;
+        stats.mean[n]   = result.mean;
+        stats.stddev[n] = sqrt(result.m2 / result.count);
+
+        if (computeHistogram)
+        {
+            QVector<uint32_t> &histogram = histograms[n * tilesPerChannel];
+            for (uint32_t tile = 1; tile < tilesPerChannel; tile++)
+            {
+                const QVector<uint32_t> &tileHistogram = histograms[n * tilesPerChannel + tile];
+                for (uint32_t i = 0; i < histogramSize; i++)
+                    histogram[i] += tileHistogram[i];
+            }
+
+            histogramCache.frequency[n] = histogram;
+        }
+    }
+
+    histogramCache.valid = computeHistogram;
+
+    readDataMinMax();
+
+    // FIXME That's not really SNR, must implement a proper solution for this value
+    stats.SNR = stats.mean[0] / stats.stddev[0];
+
     return true;
 }
 
@@ -333,7 +504,23 @@ int FITSData::saveFITS(const QString &newFilename)
         // Remove first otherwise copy will fail below if file exists
         QFile::remove(finalFileName);
 
-        if (QFile::copy(filename, finalFileName) == false)
+        if (filename.isEmpty())
+        {
+            // Image was loaded from memory, so write the original FITS file out
+            QFile finalFile(finalFileName);
+
+            if (finalFile.open(QIODevice::WriteOnly) == false ||
+                finalFile.write(fitsMemory) != fitsMemory.size())
+            {
+                qCCritical(KSTARS_FITS()) << "FITS: Failed to write " << finalFileName;
+                fptr = nullptr;
+                fitsMemory.clear();
+                return -1;
+            }
+
+            fitsMemory.clear();
+        }
+        else if (QFile::copy(filename, finalFileName) == false)
         {
             qCCritical(KSTARS_FITS()) << "FITS: Failed to copy " << filename << " to " << finalFileName;
             fptr = nullptr;
@@ -394,6 +581,7 @@ int FITSData::saveFITS(const QString &newFilename)
     }
 
     status = 0;
+    fitsMemory.clear();
 
     fptr = new_fptr;
 
@@ -495,48 +683,48 @@ void FITSData::clearImageBuffers()
 
 void FITSData::calculateStats(bool refresh)
 {
-    // Calculate min max
-    calculateMinMax(refresh);
-
-    // Get standard deviation and mean in one run
+    // Get min, max, standard deviation and mean in one run
     switch (data_type)
     {
     case TBYTE:
-        runningAverageStdDev<uint8_t>();
+        calculateChannelStats<uint8_t>();
         break;
 
     case TSHORT:
-        runningAverageStdDev<int16_t>();
+        calculateChannelStats<int16_t>();
         break;
 
     case TUSHORT:
-        runningAverageStdDev<uint16_t>();
+        calculateChannelStats<uint16_t>();
         break;
 
     case TLONG:
-        runningAverageStdDev<int32_t>();
+        calculateChannelStats<int32_t>();
         break;
 
     case TULONG:
-        runningAverageStdDev<uint32_t>();
+        calculateChannelStats<uint32_t>();
         break;
 
     case TFLOAT:
-        runningAverageStdDev<float>();
+        calculateChannelStats<float>();
         break;
 
     case TLONGLONG:
-        runningAverageStdDev<int64_t>();
+        calculateChannelStats<int64_t>();
         break;
 
     case TDOUBLE:
-        runningAverageStdDev<double>();
+        calculateChannelStats<double>();
         break;
 
     default:
         return;
     }
 
+    if (refresh == false)
+        readDataMinMax();
+
     // FIXME That's not really SNR, must implement a proper solution for this value
     stats.SNR = stats.mean[0] / stats.stddev[0];
 
@@ -545,336 +733,364 @@ void FITSData::calculateStats(bool refresh)
         starsSearched = false;
 }
 
-int FITSData::calculateMinMax(bool refresh)
+bool FITSData::readDataMinMax()
 {
-    int status, nfound = 0;
-
-    status = 0;
+    int status = 0;
+    double min = 0, max = 0;
 
-    if (fptr && refresh == false)
-    {
-        if (fits_read_key_dbl(fptr, "DATAMIN", &(stats.min[0]), nullptr, &status) == 0)
-            nfound++;
+    if (fptr == nullptr)
+        return false;
 
-        if (fits_read_key_dbl(fptr, "DATAMAX", &(stats.max[0]), nullptr, &status) == 0)
-            nfound++;
+    if (fits_read_key_dbl(fptr, "DATAMIN", &min, nullptr, &status) ||
+        fits_read_key_dbl(fptr, "DATAMAX", &max, nullptr, &status))
+        return false;
 
-        // If we found both keywords, no need to calculate them, unless they are both zeros
-        if (nfound == 2 && !(stats.min[0] == 0 && stats.max[0] == 0))
-            return 0;
-    }
+    // If we found both keywords, they take precedence over the calculated values, unless they are both zeros
+    if (min == 0 && max == 0)
+        return false;
 
-    stats.min[0] = 1.0E30;
-    stats.max[0] = -1.0E30;
+    stats.min[0] = min;
+    stats.max[0] = max;
 
-    stats.min[1] = 1.0E30;
-    stats.max[1] = -1.0E30;
+    //qDebug() << "DATAMIN: " << stats.min << " - DATAMAX: " << stats.max;
+    return true;
+}
 
-    stats.min[2] = 1.0E30;
-    stats.max[2] = -1.0E30;
+void FITSData::SampleStats::merge(const SampleStats &other)
+{
+    if (other.count == 0)
+        return;
 
-    switch (data_type)
+    if (count == 0)
     {
-    case TBYTE:
-        calculateMinMax<uint8_t>();
-        break;
+        *this = other;
+        return;
+    }
 
-    case TSHORT:
-        calculateMinMax<int16_t>();
-        break;
+    // Chan et al. formula to combine the variances of two sets
+    double total = double(count) + other.count;
+    double delta = other.mean - mean;
 
-    case TUSHORT:
-        calculateMinMax<uint16_t>();
-        break;
+    mean += delta * other.count / total;
+    m2 += other.m2 + delta * delta * count * other.count / total;
+    count += other.count;
 
-    case TLONG:
-        calculateMinMax<int32_t>();
-        break;
+    min = qMin(min, other.min);
+    max = qMax(max, other.max);
+}
 
-    case TULONG:
-        calculateMinMax<uint32_t>();
-        break;
+template <typename T>
+FITSData::SampleStats FITSData::getSampleStats(uint32_t start, uint32_t count, uint32_t *histogram) const
+{
+    SampleStats result;
 
-    case TFLOAT:
-        calculateMinMax<float>();
-        break;
+    if (count == 0)
+        return result;
 
-    case TLONGLONG:
-        calculateMinMax<int64_t>();
-        break;
+    const T *buffer = reinterpret_cast<const T *>(imageBuffer) + start;
+    T min = buffer[0], max = buffer[0];
 
-    case TDOUBLE:
-        calculateMinMax<double>();
-        break;
-
-    default:
-        break;
-    }
+    // Sums are shifted by the first sample, which keeps the variance accurate for data far from zero
+    const double shift = buffer[0];
+    double sum = 0, squaredSum = 0;
 
-    //qDebug() << "DATAMIN: " << stats.min << " - DATAMAX: " << stats.max;
-    return 0;
-}
+    for (uint32_t i = 0; i < count; i++)
+    {
+        const T value = buffer[i];
 
-template <typename T>
-QPair<T,T> FITSData::getParitionMinMax(uint32_t start, uint32_t stride)
-{
-    T *buffer = reinterpret_cast<T *>(imageBuffer);
-    T min = std::numeric_limits<T>::max();
-    T max = std::numeric_limits<T>::min();
+        if (value < min)
+            min = value;
+        if (value > max)
+            max = value;
 
-    uint32_t end = start+stride;
+        const double delta = value - shift;
+        sum += delta;
+        squaredSum += delta * delta;
 
-    for (uint32_t i = start; i < end; i++)
-    {
-        if (buffer[i] < min)
-            min = buffer[i];
-        else if (buffer[i] > max)
-            max = buffer[i];
+        if (histogram)
+            histogram[FITSFilters::lutIndex(value)]++;
     }
 
-    return qMakePair(min,max);
+    result.min   = min;
+    result.max   = max;
+    result.count = count;
+    result.mean  = shift + sum / count;
+    result.m2    = qMax(0.0, squaredSum - sum * sum / count);
+
+    return result;
 }
 
 template <typename T>
-void FITSData::calculateMinMax()
+FITSData::SampleStats FITSData::getChannelStats(uint8_t channel, QVector<uint32_t> *histogram) const
 {
-    //QTime timer;
-    //timer.start();
-    //if (filename.contains("thread"))
-    //{
-    T min = std::numeric_limits<T>::max();
-    T max = std::numeric_limits<T>::min();
+    // A few ranges per thread, so that threads finishing early can pick up more work.
+    // With a histogram, one range per thread keeps the number of frequency tables to merge low.
+    const uint32_t nRanges = qBound<uint32_t>(1, QThreadPool::globalInstance()->maxThreadCount() * (histogram ? 1 : 4),
+                                              stats.samples_per_channel);
+    const uint32_t stride  = stats.samples_per_channel / nRanges;
+    const uint32_t cStart  = channel * stats.samples_per_channel;
+    const uint32_t histogramSize = FITSFilters::histogramBins<T>();
 
-    // Create N threads
-    const uint8_t nThreads = 16;
+    QVector<QVector<uint32_t>> histograms(histogram ? nRanges : 0);
+    QList<QFuture<SampleStats>> futures;
 
-    for (int n=0; n < channels; n++)
+    for (uint32_t i = 0; i < nRanges; i++)
     {
-        uint32_t cStart = n * stats.samples_per_channel;
-
-        // Calculate how many elements we process per thread
-        uint32_t tStride = stats.samples_per_channel / nThreads;
-
-        // Calculate the final stride since we can have some left over due to division above
-        uint32_t fStride = tStride + (stats.samples_per_channel - (tStride * nThreads));
-
-        // Start location for inspecting elements
-        uint32_t tStart = cStart;
-
-        // List of futures
-        QList<QFuture<QPair<T,T>>> futures;
-
-        for (int i=0; i < nThreads; i++)
+        uint32_t *rangeHistogram = nullptr;
+        if (histogram)
         {
-            // Run threads
-            futures.append(QtConcurrent::run(this, &FITSData::getParitionMinMax<T>, tStart, (i == (nThreads-1)) ? fStride : tStride));
-            tStart += tStride;
+            histograms[i].fill(0, histogramSize);
+            rangeHistogram = histograms[i].data();
         }
 
-        // Now wait for results
-        for (int i=0; i < nThreads; i++)
+        // The last range also takes the left over due to the division above
+        uint32_t count = (i == nRanges - 1) ? stats.samples_per_channel - i * stride : stride;
+        futures.append(QtConcurrent::run(this, &FITSData::getSampleStats<T>, cStart + i * stride, count, rangeHistogram));
+    }
+
+    SampleStats result;
+    for (auto &future : futures)
+        result.merge(future.result());
+
+    if (histogram)
+    {
+        *histogram = histograms[0];
+        for (uint32_t i = 1; i < nRanges; i++)
         {
-            QPair<T,T> result = futures[i].result();
-            if (result.first < min)
-                min = result.first;
-            if (result.second > max)
-                max = result.second;
+            const uint32_t *frequency = histograms[i].constData();
+            for (uint32_t bin = 0; bin < histogramSize; bin++)
+                (*histogram)[bin] += frequency[bin];
         }
-
-        stats.min[n] = min;
-        stats.max[n] = max;
     }
-#if 0
+
+    return result;
 }
-else
-{
-T *buffer = reinterpret_cast<T *>(imageBuffer);
-if (channels == 1)
+
+QFuture<FITSData::SampleStats> FITSData::runSampleStats(uint32_t start, uint32_t count, uint32_t *histogram) const
 {
-    for (unsigned int i = 0; i < stats.samples_per_channel; i++)
+    switch (data_type)
     {
-        if (buffer[i] < stats.min[0])
-            stats.min[0] = buffer[i];
-        else if (buffer[i] > stats.max[0])
-            stats.max[0] = buffer[i];
+    case TBYTE:
+        return QtConcurrent::run(this, &FITSData::getSampleStats<uint8_t>, start, count, histogram);
+    case TSHORT:
+        return QtConcurrent::run(this, &FITSData::getSampleStats<int16_t>, start, count, histogram);
+    case TUSHORT:
+        return QtConcurrent::run(this, &FITSData::getSampleStats<uint16_t>, start, count, histogram);
+    case TLONG:
+        return QtConcurrent::run(this, &FITSData::getSampleStats<int32_t>, start, count, histogram);
+    case TULONG:
+        return QtConcurrent::run(this, &FITSData::getSampleStats<uint32_t>, start, count, histogram);
+    case TFLOAT:
+        return QtConcurrent::run(this, &FITSData::getSampleStats<float>, start, count, histogram);
+    case TLONGLONG:
+        return QtConcurrent::run(this, &FITSData::getSampleStats<int64_t>, start, count, histogram);
+    case TDOUBLE:
+    default:
+        return QtConcurrent::run(this, &FITSData::getSampleStats<double>, start, count, histogram);
     }
 }
-else
-{
-int g_offset = stats.samples_per_channel;
-int b_offset = stats.samples_per_channel * 2;
 
-for (unsigned int i = 0; i < stats.samples_per_channel; i++)
+template <typename T>
+void FITSData::runningAverageStdDev()
 {
-    if (buffer[i] < stats.min[0])
-        stats.min[0] = buffer[i];
-    else if (buffer[i] > stats.max[0])
-        stats.max[0] = buffer[i];
-
-    if (buffer[i + g_offset] < stats.min[1])
-        stats.min[1] = buffer[i + g_offset];
-    else if (buffer[i + g_offset] > stats.max[1])
-        stats.max[1] = buffer[i + g_offset];
-
-    if (buffer[i + b_offset] < stats.min[2])
-        stats.min[2] = buffer[i + b_offset];
-    else if (buffer[i + b_offset] > stats.max[2])
-        stats.max[2] = buffer[i + b_offset];
-}
-}
+    const bool withHistogram = FITSFilters::UsesLUT<T>::value;
 
-}
+    invalidateCaches();
 
-qCInfo(KSTARS_FITS) << filename << "MinMax calculation took" << timer.elapsed() << "ms";
-#endif
+    for (int n = 0; n < channels; n++)
+    {
+        SampleStats result = getChannelStats<T>(n, withHistogram ? &histogramCache.frequency[n] : nullptr);
+        stats.mean[n]      = result.mean;
+        stats.stddev[n]    = sqrt(result.m2 / result.count);
+    }
+
+    histogramCache.valid = withHistogram;
 }
 
 template <typename T>
-QPair<double,double> FITSData::getSquaredSumAndMean(uint32_t start, uint32_t stride)
+void FITSData::calculateChannelStats()
 {
-    uint32_t m_n       = 2;
-    double m_oldM = 0, m_newM = 0, m_oldS = 0, m_newS = 0;
+    const bool withHistogram = FITSFilters::UsesLUT<T>::value;
 
-    T *buffer = reinterpret_cast<T *>(imageBuffer);
-    uint32_t end = start + stride;
+    invalidateCaches();
 
-    for (uint32_t i = start; i < end; i++)
+    for (int n = 0; n < channels; n++)
     {
-        m_newM = m_oldM + (buffer[i] - m_oldM) / m_n;
-        m_newS = m_oldS + (buffer[i] - m_oldM) * (buffer[i] - m_newM);
-
-        m_oldM = m_newM;
-        m_oldS = m_newS;
-        m_n++;
+        SampleStats result = getChannelStats<T>(n, withHistogram ? &histogramCache.frequency[n] : nullptr);
+        stats.min[n]       = result.min;
+        stats.max[n]       = result.max;
+        stats.mean[n]      = result.mean;
+        stats.stddev[n]    = sqrt(result.m2 / result.count);
     }
 
-    return qMakePair<double,double>(m_newM, m_newS);
+    histogramCache.valid = withHistogram;
 }
 
-template <typename T>
-void FITSData::runningAverageStdDev()
+void FITSData::invalidateCaches()
 {
-    //QTime timer;
-    //timer.start();
-    //if (filename.contains("thread"))
-    //{
-    // Create N threads
-    const uint8_t nThreads = 16;
+    // The stars are detected on the data and the float plane
+    starFuture.waitForFinished();
+
+    floatPlane.clear();
+    floatPlane.squeeze();
 
-    for (int n=0; n < channels; n++)
+    histogramCache.valid = false;
+    for (int n = 0; n < 3; n++)
     {
-        uint32_t cStart = n * stats.samples_per_channel;
+        histogramCache.frequency[n].clear();
+        histogramCache.medianValid[n] = false;
+        histogramCache.madValid[n]    = false;
+    }
+}
 
-        // Calculate how many elements we process per thread
-        uint32_t tStride = stats.samples_per_channel / nThreads;
+template <typename T>
+void FITSData::getHistogramRange(uint8_t channel, T *min, T *max) const
+{
+    if (FITSFilters::UsesLUT<T>::value)
+    {
+        *min = std::numeric_limits<T>::lowest();
+        *max = std::numeric_limits<T>::max();
+    }
+    else
+    {
+        *min = static_cast<T>(stats.min[channel]);
+        *max = static_cast<T>(stats.max[channel]);
+    }
+}
 
-        // Calculate the final stride since we can have some left over due to division above
-        uint32_t fStride = tStride + (stats.samples_per_channel - (tStride * nThreads));
+void FITSData::calculateHistogram(uint8_t channel, bool median, bool mad)
+{
+    switch (data_type)
+    {
+    case TBYTE:
+        calculateHistogram<uint8_t>(channel, median, mad);
+        break;
 
-        // Start location for inspecting elements
-        uint32_t tStart = cStart;
+    case TSHORT:
+        calculateHistogram<int16_t>(channel, median, mad);
+        break;
 
-        // List of futures
-        QList<QFuture<QPair<double,double>>> futures;
+    case TUSHORT:
+        calculateHistogram<uint16_t>(channel, median, mad);
+        break;
 
-        for (int i=0; i < nThreads; i++)
-        {
-            // Run threads
-            futures.append(QtConcurrent::run(this, &FITSData::getSquaredSumAndMean<T>, tStart, (i == (nThreads-1)) ? fStride : tStride));
-            tStart += tStride;
-        }
+    case TLONG:
+        calculateHistogram<int32_t>(channel, median, mad);
+        break;
 
-        double mean=0, squared_sum=0;
+    case TULONG:
+        calculateHistogram<uint32_t>(channel, median, mad);
+        break;
 
-        // Now wait for results
-        for (int i=0; i < nThreads; i++)
-        {
-            QPair<double,double> result = futures[i].result();
-            mean += result.first;
-            squared_sum += result.second;
-        }
+    case TFLOAT:
+        calculateHistogram<float>(channel, median, mad);
+        break;
 
-        double variance = squared_sum / stats.samples_per_channel;
+    case TLONGLONG:
+        calculateHistogram<int64_t>(channel, median, mad);
+        break;
+
+    case TDOUBLE:
+        calculateHistogram<double>(channel, median, mad);
+        break;
 
-        stats.mean[n]   = mean/nThreads;
-        stats.stddev[n] = sqrt(variance);
+    default:
+        break;
     }
-#if 0
 }
-else
-{
-T *buffer     = reinterpret_cast<T *>(imageBuffer);
 
-if (channels == 1)
+template <typename T>
+void FITSData::calculateHistogram(uint8_t channel, bool median, bool mad)
 {
-    int m_n       = 2;
-    double m_oldM = 0, m_newM = 0, m_oldS = 0, m_newS = 0;
+    if (imageBuffer == nullptr || stats.samples_per_channel == 0)
+        return;
+
+#ifdef PROFILE_HISTOGRAM
+    QElapsedTimer timer;
+    timer.start();
+#endif
+
+    T min, max;
 
-    for (unsigned int i = 1; i < stats.samples_per_channel; i++)
+    if (histogramCache.valid == false)
     {
-        m_newM = m_oldM + (buffer[i] - m_oldM) / m_n;
-        m_newS = m_oldS + (buffer[i] - m_oldM) * (buffer[i] - m_newM);
+        for (int n = 0; n < channels; n++)
+        {
+            getHistogramRange<T>(n, &min, &max);
+            histogramCache.frequency[n] = FITSFilters::histogramChannel(
+                reinterpret_cast<const T *>(imageBuffer) + n * stats.samples_per_channel, stats.width, stats.height, min, max);
+        }
+        histogramCache.valid = true;
+    }
+
+    const T *data = reinterpret_cast<const T *>(imageBuffer) + channel * stats.samples_per_channel;
+    getHistogramRange<T>(channel, &min, &max);
 
-        m_oldM = m_newM;
-        m_oldS = m_newS;
-        m_n++;
+    if ((median || mad) && histogramCache.medianValid[channel] == false)
+    {
+        stats.median[channel] = FITSFilters::medianOfChannel(data, stats.width, stats.height, min, max,
+                                                             histogramCache.frequency[channel]);
+        histogramCache.medianValid[channel] = true;
     }
 
-    double variance = (m_n == 2 ? 0 : m_newS / (m_n - 2));
+    if (mad && histogramCache.madValid[channel] == false)
+    {
+        histogramCache.mad[channel] = FITSFilters::madOfChannel(data, stats.width, stats.height, min, max,
+                                                                histogramCache.frequency[channel], stats.median[channel]);
+        histogramCache.madValid[channel] = true;
+    }
 
-    stats.mean[0]   = m_newM;
-    stats.stddev[0] = sqrt(variance);
+#ifdef PROFILE_HISTOGRAM
+    qCDebug(KSTARS_FITS) << filename << "Histogram" << (median ? "and median" : "") << (mad ? "and MAD" : "") << "took"
+                         << timer.elapsed() << "ms";
+#endif
 }
-else
-{
-int m_n[3]       = {2,2,2};
-double m_oldM[3] = {0}, m_newM[3] = {0}, m_oldS[3] = {0}, m_newS[3] = {0};
-
-T *rBuffer = buffer;
-T *gBuffer = buffer + stats.samples_per_channel;
-T *bBuffer = buffer + stats.samples_per_channel * 2;
 
-for (unsigned int i = 1; i < stats.samples_per_channel; i++)
+const QVector<uint32_t> &FITSData::getHistogram(uint8_t channel, double *min, double *binWidth)
 {
-    m_newM[0] = m_oldM[0] + (rBuffer[i] - m_oldM[0]) / m_n[0];
-    m_newS[0] = m_oldS[0] + (rBuffer[i] - m_oldM[0]) * (rBuffer[i] - m_newM[0]);
+    calculateHistogram(channel, false, false);
 
-    m_oldM[0] = m_newM[0];
-    m_oldS[0] = m_newS[0];
-    m_n[0]++;
+    const bool lut = (data_type == TBYTE || data_type == TSHORT || data_type == TUSHORT);
 
-    m_newM[1] = m_oldM[1] + (gBuffer[i] - m_oldM[1]) / m_n[1];
-    m_newS[1] = m_oldS[1] + (gBuffer[i] - m_oldM[1]) * (gBuffer[i] - m_newM[1]);
-
-    m_oldM[1] = m_newM[1];
-    m_oldS[1] = m_newS[1];
-    m_n[1]++;
-
-    m_newM[2] = m_oldM[2] + (bBuffer[i] - m_oldM[2]) / m_n[2];
-    m_newS[2] = m_oldS[2] + (bBuffer[i] - m_oldM[2]) * (bBuffer[i] - m_newM[2]);
-
-    m_oldM[2] = m_newM[2];
-    m_oldS[2] = m_newS[2];
-    m_n[2]++;
+    if (min)
+        *min = lut ? (data_type == TSHORT ? std::numeric_limits<int16_t>::lowest() : 0) : stats.min[channel];
+    if (binWidth)
+    {
+        const double scale = FITSFilters::histogramScale(stats.min[channel], stats.max[channel], FITSFilters::HISTOGRAM_BINS);
+        *binWidth = lut ? 1 : (scale > 0 ? 1 / scale : 0);
+    }
 
+    return histogramCache.frequency[channel];
 }
 
-double variance = (m_n[0] == 2 ? 0 : m_newS[0] / (m_n[0] - 2));
-stats.mean[0]   = m_newM[0];
-stats.stddev[0] = sqrt(variance);
-
-variance = (m_n[1] == 2 ? 0 : m_newS[1] / (m_n[1] - 2));
-stats.mean[1]   = m_newM[1];
-stats.stddev[1] = sqrt(variance);
+double FITSData::getMedian(uint8_t channel)
+{
+    calculateHistogram(channel, true, false);
+    return stats.median[channel];
+}
 
-variance = (m_n[2] == 2 ? 0 : m_newS[2] / (m_n[2] - 2));
-stats.mean[2]   = m_newM[2];
-stats.stddev[2] = sqrt(variance);
+void FITSData::setMedian(double val, uint8_t channel)
+{
+    stats.median[channel]               = val;
+    histogramCache.medianValid[channel] = true;
+    histogramCache.madValid[channel]    = false;
 }
+
+double FITSData::getMAD(uint8_t channel)
+{
+    calculateHistogram(channel, true, true);
+    return histogramCache.mad[channel];
 }
 
-qCInfo(KSTARS_FITS) << filename << "runningMeanStdDev calculation took" << timer.elapsed() << "ms";
-#endif
+void FITSData::getAutoStretchLimits(double *min, double *max)
+{
+    // The black point is the robust counterpart of mean - sigma: the median and MAD are not biased by stars and hot
+    // pixels, which otherwise push the black point well below the background. The white point is mean + 3 sigma.
+    *min = getMedian(0) - 1.4826 * getMAD(0);
+    *max = stats.mean[0] + stats.stddev[0] * 3;
+
+    if (*min >= *max)
+        *min = stats.mean[0] - stats.stddev[0];
 }
 
 void FITSData::setMinMax(double newMin, double newMax, uint8_t channel)
@@ -964,6 +1180,23 @@ int FITSData::findCannyStar(FITSData *data, const QRect &boundary)
 }
 
 int FITSData::findStars(StarAlgorithm algorithm, const QRect &trackingBox)
+{
+    starFuture.waitForFinished();
+
+    return detectStars(algorithm, trackingBox, algorithm == ALGORITHM_THRESHOLD ? getMedian(0) : 0);
+}
+
+QFuture<int> FITSData::findStarsAsync(StarAlgorithm algorithm, const QRect &trackingBox)
+{
+    starFuture.waitForFinished();
+
+    // The median fills the histogram cache, which the GUI thread reads too, so it is computed here
+    double background = (algorithm == ALGORITHM_THRESHOLD ? getMedian(0) : 0);
+    starFuture        = QtConcurrent::run(this, &FITSData::detectStars, algorithm, trackingBox, background);
+    return starFuture;
+}
+
+int FITSData::detectStars(StarAlgorithm algorithm, const QRect &trackingBox, double background)
 {
     int count = 0;
     starAlgorithm = algorithm;
@@ -986,7 +1219,7 @@ int FITSData::findStars(StarAlgorithm algorithm, const QRect &trackingBox)
         break;
 
     case ALGORITHM_THRESHOLD:
-        count = findOneStar(trackingBox);
+        count = findOneStar(trackingBox, background);
         break;
     }
 
@@ -1235,40 +1468,40 @@ int FITSData::findCannyStar(FITSData *data, const QRect &boundary)
     return 1;
 }
 
-int FITSData::findOneStar(const QRect &boundary)
+int FITSData::findOneStar(const QRect &boundary, double background)
 {
     switch (data_type)
     {
     case TBYTE:
-        return findOneStar<uint8_t>(boundary);
+        return findOneStar<uint8_t>(boundary, background);
         break;
 
     case TSHORT:
-        return findOneStar<int16_t>(boundary);
+        return findOneStar<int16_t>(boundary, background);
         break;
 
     case TUSHORT:
-        return findOneStar<uint16_t>(boundary);
+        return findOneStar<uint16_t>(boundary, background);
         break;
 
     case TLONG:
-        return findOneStar<int32_t>(boundary);
+        return findOneStar<int32_t>(boundary, background);
         break;
 
     case TULONG:
-        return findOneStar<uint32_t>(boundary);
+        return findOneStar<uint32_t>(boundary, background);
         break;
 
     case TFLOAT:
-        return findOneStar<float>(boundary);
+        return findOneStar<float>(boundary, background);
         break;
 
     case TLONGLONG:
-        return findOneStar<int64_t>(boundary);
+        return findOneStar<int64_t>(boundary, background);
         break;
 
     case TDOUBLE:
-        return findOneStar<double>(boundary);
+        return findOneStar<double>(boundary, background);
         break;
 
     default:
@@ -1279,7 +1512,7 @@ int FITSData::findOneStar(const QRect &boundary)
 }
 
 template <typename T>
-int FITSData::findOneStar(const QRect &boundary)
+int FITSData::findOneStar(const QRect &boundary, double background)
 {
     if (boundary.isEmpty())
         return -1;
@@ -1372,7 +1605,8 @@ int FITSData::findOneStar(const QRect &boundary)
 
     starCenters.append(center);
 
-    double FSum = 0, HF = 0, TF = 0, min = stats.min[0];
+    // The sky background is the median of the image, which unlike its minimum is not biased by dead pixels
+    double FSum = 0, HF = 0, TF = 0, min = background;
     const double resolution = 1.0 / 20.0;
 
     int cen_y = round(center->y);
@@ -1386,7 +1620,7 @@ int FITSData::findOneStar(const QRect &boundary)
     for (double x = leftEdge; x <= rightEdge; x += resolution)
     {
         //subPixels[x] = resolution * (image_buffer[static_cast<int>(floor(x)) + cen_y * stats.width] - min);
-        double slice = resolution * (buffer[static_cast<int>(floor(x)) + cen_y * stats.width] - min);
+        double slice = resolution * qMax(0.0, buffer[static_cast<int>(floor(x)) + cen_y * stats.width] - min);
         FSum += slice;
         subPixels.append(slice);
     }
@@ -1894,6 +2128,8 @@ void FITSData::applyFilter(FITSScale type, uint8_t *image, double *min, double *
     if (type == FITS_NONE)
         return;
 
+    starFuture.waitForFinished();
+
     double dataMin = stats.min[0], dataMax = stats.max[0];
 
     if (min && *min != -1)
@@ -1904,10 +2140,7 @@ void FITSData::applyFilter(FITSScale type, uint8_t *image, double *min, double *
     switch (type)
     {
     case FITS_AUTO_STRETCH:
-    {
-        dataMin = stats.mean[0] - stats.stddev[0];
-        dataMax = stats.mean[0] + stats.stddev[0] * 3;
-    }
+        getAutoStretchLimits(&dataMin, &dataMax);
         break;
 
     case FITS_HIGH_CONTRAST:
@@ -1942,7 +2175,7 @@ void FITSData::applyFilter(FITSScale type, uint8_t *image, double *min, double *
             {
                 dataMin = dataMin < INT16_MIN ? INT16_MIN : dataMin;
                 dataMax = dataMax > INT16_MAX ? INT16_MAX : dataMax;
-                applyFilter<uint16_t>(type, image, dataMin, dataMax);
+                applyFilter<int16_t>(type, image, dataMin, dataMax);
             }
 
             break;
@@ -1959,7 +2192,7 @@ void FITSData::applyFilter(FITSScale type, uint8_t *image, double *min, double *
             {
                 dataMin = dataMin < INT_MIN ? INT_MIN : dataMin;
                 dataMax = dataMax > INT_MAX ? INT_MAX : dataMax;
-                applyFilter<uint16_t>(type, image, dataMin, dataMax);
+                applyFilter<int32_t>(type, image, dataMin, dataMax);
             }
             break;
 
@@ -1967,13 +2200,13 @@ void FITSData::applyFilter(FITSScale type, uint8_t *image, double *min, double *
             {
                 dataMin = dataMin < 0 ? 0 : dataMin;
                 dataMax = dataMax > UINT_MAX ? UINT_MAX : dataMax;
-                applyFilter<uint16_t>(type, image, dataMin, dataMax);
+                applyFilter<uint32_t>(type, image, dataMin, dataMax);
             }
             break;
 
             case TFLOAT:
             {
-                dataMin = dataMin < FLT_MIN ? FLT_MIN : dataMin;
+                dataMin = dataMin < -FLT_MAX ? -FLT_MAX : dataMin;
                 dataMax = dataMax > FLT_MAX ? FLT_MAX : dataMax;
                 applyFilter<float>(type, image, dataMin, dataMax);
             }
@@ -1983,13 +2216,13 @@ void FITSData::applyFilter(FITSScale type, uint8_t *image, double *min, double *
             {
                 dataMin = dataMin < LLONG_MIN ? LLONG_MIN : dataMin;
                 dataMax = dataMax > LLONG_MAX ? LLONG_MAX : dataMax;
-                applyFilter<long>(type, image, dataMin, dataMax);
+                applyFilter<int64_t>(type, image, dataMin, dataMax);
             }
             break;
 
             case TDOUBLE:
             {
-                dataMin = dataMin < DBL_MIN ? DBL_MIN : dataMin;
+                dataMin = dataMin < -DBL_MAX ? -DBL_MAX : dataMin;
                 dataMax = dataMax > DBL_MAX ? DBL_MAX : dataMax;
                 applyFilter<double>(type, image, dataMin, dataMax);
             }
@@ -2020,17 +2253,17 @@ void FITSData::applyFilter(FITSScale type, uint8_t *targetImage, double image_mi
         calcStats = true;
     }
 
-    T min = image_min < std::numeric_limits<T>::min() ? std::numeric_limits<T>::min() : image_min;
+    T min = image_min < std::numeric_limits<T>::lowest() ? std::numeric_limits<T>::lowest() : image_min;
     T max = image_max > std::numeric_limits<T>::max() ? std::numeric_limits<T>::max() : image_max;
 
-    // Create N threads
-    const uint8_t nThreads = 16;
-
     uint32_t width  = stats.width;
     uint32_t height = stats.height;
 
-    //QTime timer;
-    //timer.start();
+#ifdef PROFILE_FILTERS
+    QElapsedTimer timer;
+    timer.start();
+#endif
+
     switch (type)
     {
     case FITS_AUTO:
@@ -2041,72 +2274,24 @@ void FITSData::applyFilter(FITSScale type, uint8_t *targetImage, double image_mi
     case FITS_SQRT:
     case FITS_HIGH_PASS:
     {
-        // List of futures
-        QList<QFuture<void>> futures;
-        double coeff = 0;
-
-        if (type == FITS_LOG)
-            coeff = max / log(1 + max);
-        else if (type == FITS_SQRT)
-            coeff = max / sqrt(max);
-
-        for (int n=0; n < channels; n++)
+        for (int n = 0; n < channels; n++)
         {
             if (type == FITS_HIGH_PASS)
                 min = stats.mean[n];
 
-            uint32_t cStart = n * stats.samples_per_channel;
-
-            // Calculate how many elements we process per thread
-            uint32_t tStride = stats.samples_per_channel / nThreads;
-
-            // Calculate the final stride since we can have some left over due to division above
-            uint32_t fStride = tStride + (stats.samples_per_channel - (tStride * nThreads));
-
-            T *runningBuffer = image + cStart;
+            T *channel = image + n * stats.samples_per_channel;
 
             if (type == FITS_LOG)
-            {
-                for (int i=0; i < nThreads; i++)
-                {
-                    // Run threads
-                    futures.append(QtConcurrent::map(runningBuffer, (runningBuffer+((i == (nThreads-1)) ? fStride : tStride)), [min,max,coeff](T & a)
-                    {
-                        a = qBound(min,static_cast<T>(round(coeff * log(1 + qBound(min, a, max)))),max);
-                    }));
-
-                    runningBuffer += tStride;
-                }
-            }
+                FITSFilters::logChannel(channel, width, height, min, max);
             else if (type == FITS_SQRT)
-            {
-                for (int i=0; i < nThreads; i++)
-                {
-                    // Run threads
-                    futures.append(QtConcurrent::map(runningBuffer, (runningBuffer+((i == (nThreads-1)) ? fStride : tStride)), [min,max,coeff](T & a)
-                    {
-                        a = qBound(min,static_cast<T>(round(coeff * a)),max);
-                    }));
-                }
-
-                runningBuffer += tStride;
-            }
+                FITSFilters::sqrtChannel(channel, width, height, min, max);
             else
-            {
-                for (int i=0; i < nThreads; i++)
-                {
-                    // Run threads
-                    futures.append(QtConcurrent::map(runningBuffer, (runningBuffer+((i == (nThreads-1)) ? fStride : tStride)), [min,max](T & a) {a = qBound(min, a,max);}));
-                    runningBuffer += tStride;
-                }
-            }
+                FITSFilters::clampChannel(channel, width, height, min, max);
         }
 
-        for (int i=0; i < nThreads*channels; i++)
-            futures[i].waitForFinished();
-
         if (calcStats)
         {
+            invalidateCaches();
             stats.min[0] = stats.min[1] = stats.min[2] = min;
             stats.max[0] = stats.max[1] = stats.max[2] = max;
             if (type != FITS_AUTO && type != FITS_LINEAR)
@@ -2117,363 +2302,29 @@ void FITSData::applyFilter(FITSScale type, uint8_t *targetImage, double image_mi
 
     case FITS_EQUALIZE:
     {
-#ifndef KSTARS_LITE
-        if (histogram == nullptr)
-            return;
-
-        T bufferVal                    = 0;
-        QVector<double> cumulativeFreq = histogram->getCumulativeFrequency();
-
-        double coeff = 255.0 / (height * width);
-        uint32_t row = 0;
-        uint32_t index=0;
-
-        for (int i = 0; i < channels; i++)
+        for (int n = 0; n < channels; n++)
         {
-            uint32_t offset = i * stats.samples_per_channel;
-            for (uint32_t j = 0; j < height; j++)
-            {
-                row = offset + j * width;
-                for (uint32_t k = 0; k < width; k++)
-                {
-                    index     = k + row;
-                    bufferVal = (image[index] - min) / histogram->getBinWidth();
+            T *channel = image + n * stats.samples_per_channel;
 
-                    if (bufferVal >= cumulativeFreq.size())
-                        bufferVal = cumulativeFreq.size() - 1;
+            // The cached histogram of the image serves if it covers the same range
+            T histogramMin, histogramMax;
+            getHistogramRange<T>(n, &histogramMin, &histogramMax);
 
-                    image[index] = qBound(min, static_cast<T>(round(coeff * cumulativeFreq[bufferVal])), max);
-                }
-            }
-        }
-#endif
-    }
-        if (calcStats)
-            calculateStats(true);
-        break;
-
-        // Based on http://www.librow.com/articles/article-1
-    case FITS_MEDIAN:
-    {
-        uint8_t BBP      = stats.bytesPerPixel;
-        T *extension = new T[(width + 2) * (height + 2)];
-        //   Check memory allocation
-        if (!extension)
-            return;
-        //   Create image extension
-        for (uint32_t ch = 0; ch < channels; ch++)
-        {
-            uint32_t offset = ch * stats.samples_per_channel;
-            uint32_t N = width, M = height;
-
-            for (uint32_t i = 0; i < M; ++i)
-            {
-                memcpy(extension + (N + 2) * (i + 1) + 1, image + (N * i) + offset, N * BBP);
-                extension[(N + 2) * (i + 1)]     = image[N * i + offset];
-                extension[(N + 2) * (i + 2) - 1] = image[N * (i + 1) - 1 + offset];
-            }
-            //   Fill first line of image extension
-            memcpy(extension, extension + N + 2, (N + 2) * BBP);
-            //   Fill last line of image extension
-            memcpy(extension + (N + 2) * (M + 1), extension + (N + 2) * M, (N + 2) * BBP);
-            //   Call median filter implementation
-
-            N = width + 2;
-            M = height + 2;
-
-            //   Move window through all elements of the image
-            for (uint32_t m = 1; m < M - 1; ++m)
-                for (uint32_t n = 1; n < N - 1; ++n)
-                {
-                    //   Pick up window elements
-                    int k = 0;
-                    float window[9];
-
-                    memset(&window[0], 0, 9*sizeof(float));
-                    for (uint32_t j = m - 1; j < m + 2; ++j)
-                        for (uint32_t i = n - 1; i < n + 2; ++i)
-                            window[k++] = extension[j * N + i];
-                    //   Order elements (only half of them)
-                    for (uint32_t j = 0; j < 5; ++j)
-                    {
-                        //   Find position of minimum element
-                        int mine = j;
-                        for (uint32_t l = j + 1; l < 9; ++l)
-                            if (window[l] < window[mine])
-                                mine = l;
-                        //   Put found minimum element in its place
-                        const float temp = window[j];
-                        window[j]        = window[mine];
-                        window[mine]     = temp;
-                    }
-                    //   Get result - the middle element
-                    image[(m - 1) * (N - 2) + n - 1 + offset] = window[4];
-                }
-        }
-
-        //   Free memory
-        delete[] extension;
-
-        if (calcStats)
-            runningAverageStdDev<T>();
-    }
-        break;
-
-    case FITS_ROTATE_CW:
-        rotFITS<T>(90, 0);
-        rotCounter++;
-        break;
-
-    case FITS_ROTATE_CCW:
-        rotFITS<T>(270, 0);
-        rotCounter--;
-        break;
-
-    case FITS_FLIP_H:
-        rotFITS<T>(0, 1);
-        flipHCounter++;
-        break;
-
-    case FITS_FLIP_V:
-        rotFITS<T>(0, 2);
-        flipVCounter++;
-        break;
-
-    default:
-        break;
-    }
-#if 0
-    }
-else
-{
-uint32_t index = 0, row=0, offset=0;
-
-switch (type)
-{
-    case FITS_AUTO:
-    case FITS_LINEAR:
-    {
-        for (uint8_t i = 0; i < channels; i++)
-        {
-            offset = i * stats.samples_per_channel;
-            for (uint32_t j = 0; j < height; j++)
-            {
-                row = offset + j * width;
-                for (uint32_t k = 0; k < width; k++)
-                {
-                    index        = k + row;
-                    image[index] = qBound(min, image[index], max);
-                }
-            }
-        }
-
-        if (calcStats)
-        {
-            stats.min[0] = min;
-            stats.max[0] = max;
-        }
-    }
-        break;
-
-    case FITS_LOG:
-    {
-        double coeff = max / log(1 + max);
-
-        for (int i = 0; i < channels; i++)
-        {
-            offset = i * stats.samples_per_channel;
-            for (uint32_t j = 0; j < height; j++)
-            {
-                row = offset + j * width;
-                for (uint32_t k = 0; k < width; k++)
-                {
-                    index        = k + row;
-                    image[index] = qBound(min, static_cast<T>(round(coeff * log(1 + qBound(min, image[index], max)))), max);
-                }
-            }
-        }
-
-        if (calcStats)
-        {
-            stats.min[0] = min;
-            stats.max[0] = max;
-            runningAverageStdDev<T>();
-        }
-    }
-        break;
-
-    case FITS_SQRT:
-    {
-        double coeff = max / sqrt(max);
-
-        for (int i = 0; i < channels; i++)
-        {
-            offset = i * stats.samples_per_channel;
-            for (uint32_t j = 0; j < height; j++)
-            {
-                row = offset + j * width;
-                for (uint32_t k = 0; k < width; k++)
-                {
-                    index        = k + row;
-                    image[index] = qBound(min, static_cast<T>(round(coeff * image[index])), max);
-                }
-            }
-        }
-
-        if (calcStats)
-        {
-            stats.min[0] = min;
-            stats.max[0] = max;
-            runningAverageStdDev<T>();
-        }
-    }
-        break;
-
-        // Only difference is how min and max are set
-    case FITS_AUTO_STRETCH:
-    case FITS_HIGH_CONTRAST:
-    {
-        for (uint32_t i = 0; i < channels; i++)
-        {
-            offset = i * stats.samples_per_channel;
-            for (uint32_t j = 0; j < height; j++)
-            {
-                row = offset + j * width;
-                for (uint32_t k = 0; k < width; k++)
-                    image[k + row] = qBound(min, image[k + row], max);
-            }
-        }
-        if (calcStats)
-        {
-            stats.min[0] = min;
-            stats.max[0] = max;
-            runningAverageStdDev<T>();
-        }
-    }
-        break;
-
-    case FITS_EQUALIZE:
-    {
-#ifndef KSTARS_LITE
-        if (histogram == nullptr)
-            return;
-
-        T bufferVal                    = 0;
-        QVector<double> cumulativeFreq = histogram->getCumulativeFrequency();
-
-        double coeff = 255.0 / (height * width);
-
-        for (uint32_t i = 0; i < channels; i++)
-        {
-            offset = i * stats.samples_per_channel;
-            for (uint32_t j = 0; j < height; j++)
-            {
-                row = offset + j * width;
-                for (uint32_t k = 0; k < width; k++)
-                {
-                    index     = k + row;
-                    bufferVal = (image[index] - min) / histogram->getBinWidth();
-
-                    if (bufferVal >= cumulativeFreq.size())
-                        bufferVal = cumulativeFreq.size() - 1;
-
-                    image[index] = qBound(min, static_cast<T>(round(coeff * cumulativeFreq[bufferVal])), max);
-                }
-            }
-        }
-#endif
-    }
-        if (calcStats)
-            calculateStats(true);
-        break;
-
-    case FITS_HIGH_PASS:
-    {
-        min = stats.mean[0];
-        for (uint32_t i = 0; i < channels; i++)
-        {
-            offset = i * stats.samples_per_channel;
-            for (uint32_t j = 0; j < height; j++)
-            {
-                row = offset + j * width;
-                for (uint32_t k = 0; k < width; k++)
-                {
-                    index        = k + row;
-                    image[index] = qBound(min, image[index], max);
-                }
-            }
-        }
-
-        if (calcStats)
-        {
-            stats.min[0] = min;
-            stats.max[0] = max;
-            runningAverageStdDev<T>();
-        }
-    }
-        break;
-
-        // Based on http://www.librow.com/articles/article-1
-    case FITS_MEDIAN:
-    {
-        int BBP      = stats.bytesPerPixel;
-        T *extension = new T[(width + 2) * (height + 2)];
-        //   Check memory allocation
-        if (!extension)
-            return;
-        //   Create image extension
-        for (uint32_t ch = 0; ch < channels; ch++)
-        {
-            offset = ch * stats.samples_per_channel;
-            uint32_t N = width, M = height;
-
-            for (uint32_t i = 0; i < M; ++i)
-            {
-                memcpy(extension + (N + 2) * (i + 1) + 1, image + (N * i) + offset, N * BBP);
-                extension[(N + 2) * (i + 1)]     = image[N * i + offset];
-                extension[(N + 2) * (i + 2) - 1] = image[N * (i + 1) - 1 + offset];
-            }
-            //   Fill first line of image extension
-            memcpy(extension, extension + N + 2, (N + 2) * BBP);
-            //   Fill last line of image extension
-            memcpy(extension + (N + 2) * (M + 1), extension + (N + 2) * M, (N + 2) * BBP);
-            //   Call median filter implementation
-
-            N = width + 2;
-            M = height + 2;
-
-            //   Move window through all elements of the image
-            for (uint32_t m = 1; m < M - 1; ++m)
-                for (uint32_t n = 1; n < N - 1; ++n)
-                {
-                    //   Pick up window elements
-                    int k = 0;
-                    float window[9];
-
-                    memset(&window[0], 0, 9*sizeof(float));
-                    for (uint32_t j = m - 1; j < m + 2; ++j)
-                        for (uint32_t i = n - 1; i < n + 2; ++i)
-                            window[k++] = extension[j * N + i];
-                    //   Order elements (only half of them)
-                    for (uint32_t j = 0; j < 5; ++j)
-                    {
-                        //   Find position of minimum element
-                        int mine = j;
-                        for (uint32_t l = j + 1; l < 9; ++l)
-                            if (window[l] < window[mine])
-                                mine = l;
-                        //   Put found minimum element in its place
-                        const float temp = window[j];
-                        window[j]        = window[mine];
-                        window[mine]     = temp;
-                    }
-                    //   Get result - the middle element
-                    image[(m - 1) * (N - 2) + n - 1 + offset] = window[4];
-                }
+            if (calcStats && (FITSFilters::UsesLUT<T>::value || (histogramMin == min && histogramMax == max)))
+                FITSFilters::equalizeChannel(channel, width, height, min, max, getHistogram(n));
+            else
+                FITSFilters::equalizeChannel(channel, width, height, min, max,
+                                             FITSFilters::histogramChannel(channel, width, height, min, max));
         }
+    }
+        if (calcStats)
+            calculateStats(true);
+        break;
 
-        //   Free memory
-        delete[] extension;
+    case FITS_MEDIAN:
+    {
+        for (int n = 0; n < channels; n++)
+            FITSFilters::medianChannel(image + n * stats.samples_per_channel, width, height);
 
         if (calcStats)
             runningAverageStdDev<T>();
@@ -2500,14 +2351,12 @@ switch (type)
         flipVCounter++;
         break;
 
-    case FITS_CUSTOM:
     default:
-        return;
         break;
-}
-}
+    }
 
-qCInfo(KSTARS_FITS) << filename << "Apply Filter calculation took" << timer.elapsed() << "ms";
+#ifdef PROFILE_FILTERS
+    qCDebug(KSTARS_FITS) << filename << "Apply Filter" << type << "took" << timer.elapsed() << "ms";
 #endif
 }
 
@@ -2554,7 +2403,10 @@ bool FITSData::checkForWCS()
 
     int status = 0;
     char *header;
-    int nkeyrec, nreject, nwcs;
+    int nkeyrec, nreject;
+
+    // The header may have changed since it was last parsed
+    clearWCS();
 
     if (fits_hdr2str(fptr, 1, nullptr, 0, &header, &nkeyrec, &status))
     {
@@ -2601,6 +2453,19 @@ bool FITSData::checkForWCS()
     return false;
 }
 
+void FITSData::clearWCS()
+{
+#if !defined(KSTARS_LITE) && defined(HAVE_WCSLIB)
+    if (wcs != nullptr)
+        wcsvfree(&nwcs, &wcs);
+#endif
+
+    wcs       = nullptr;
+    nwcs      = 0;
+    HasWCS    = false;
+    WCSLoaded = false;
+}
+
 bool FITSData::loadWCS()
 {
 #if !defined(KSTARS_LITE) && defined(HAVE_WCSLIB)
@@ -2613,84 +2478,91 @@ bool FITSData::loadWCS()
 
     qCDebug(KSTARS_FITS) << "Started WCS Data Processing...";
 
+    // The header is usually parsed already by checkForWCS() when the image is loaded
+    if (HasWCS == false && checkForWCS() == false)
+        return false;
+
     int status = 0;
-    char *header;
-    int nkeyrec, nreject, nwcs, stat[2];
-    double imgcrd[2], phi = 0, pixcrd[2], theta = 0, world[2];
     int width  = getWidth();
     int height = getHeight();
 
-    if (fits_hdr2str(fptr, 1, nullptr, 0, &header, &nkeyrec, &status))
-    {
-        char errmsg[512];
-        fits_get_errstatus(status, errmsg);
-        lastError = errmsg;
-        return false;
-    }
+    // Coordinates are evaluated on demand by pixelToWCS(). Only sample the image on a coarse
+    // grid, in one batch, to know which part of the sky it covers.
+    const int ncoord = (WCS_GRID_SIZE + 1) * (WCS_GRID_SIZE + 1);
+    QVector<double> pixcrd(2 * ncoord), imgcrd(2 * ncoord), world(2 * ncoord), phi(ncoord), theta(ncoord);
+    QVector<int> stat(ncoord);
 
-    if ((status = wcspih(header, nkeyrec, WCSHDR_all, -3, &nreject, &nwcs, &wcs)))
+    for (int i = 0, k = 0; i <= WCS_GRID_SIZE; i++)
     {
-        free(header);
-        lastError = QString("wcspih ERROR %1: %2.").arg(status).arg(wcshdr_errmsg[status]);
-        return false;
+        for (int j = 0; j <= WCS_GRID_SIZE; j++, k++)
+        {
+            pixcrd[2 * k]     = (width - 1) * j / double(WCS_GRID_SIZE);
+            pixcrd[2 * k + 1] = (height - 1) * i / double(WCS_GRID_SIZE);
+        }
     }
 
-    free(header);
-
-    if (wcs == 0)
+    // Status 8 means that some of the coordinates are invalid, they are flagged in stat
+    status = wcsp2s(wcs, ncoord, 2, pixcrd.data(), imgcrd.data(), phi.data(), theta.data(), world.data(), stat.data());
+    if (status != 0 && status != 8)
     {
-        //fprintf(stderr, "No world coordinate systems found.\n");
-        lastError = i18n("No world coordinate systems found.");
+        lastError = QString("wcsp2s error %1: %2.").arg(status).arg(wcs_errmsg[status]);
         return false;
     }
 
-    // FIXME: Call above goes through EVEN if no WCS is present, so we're adding this to return for now.
-    if (wcs->crpix[0] == 0)
+    wcsBounds = QRectF();
+    double minRA = 1000, maxRA = -1000, minDec = 1000, maxDec = -1000;
+    for (int k = 0; k < ncoord; k++)
     {
-        lastError = i18n("No world coordinate systems found.");
-        return false;
-    }
+        if (stat[k])
+            continue;
 
-    if ((status = wcsset(wcs)))
-    {
-        lastError = QString("wcsset error %1: %2.").arg(status).arg(wcs_errmsg[status]);
-        return false;
+        minRA  = qMin(minRA, world[2 * k]);
+        maxRA  = qMax(maxRA, world[2 * k]);
+        minDec = qMin(minDec, world[2 * k + 1]);
+        maxDec = qMax(maxDec, world[2 * k + 1]);
     }
+    if (minRA <= maxRA)
+        wcsBounds = QRectF(QPointF(minRA, minDec), QPointF(maxRA, maxDec));
 
     delete[] wcs_coord;
+    wcs_coord = nullptr;
 
-    wcs_coord = new wcs_point[width * height];
-
-    if (wcs_coord == nullptr)
+    // The table of the coordinates of every pixel is only built on request, one row at a time
+    if (Options::fullWCSTable())
     {
-        lastError = "Not enough memory for WCS data!";
-        return false;
-    }
+        wcs_coord = new wcs_point[width * height];
 
-    wcs_point *p = wcs_coord;
+        pixcrd.resize(2 * width);
+        imgcrd.resize(2 * width);
+        world.resize(2 * width);
+        phi.resize(width);
+        theta.resize(width);
+        stat.resize(width);
 
-    for (int i = 0; i < height; i++)
-    {
-        for (int j = 0; j < width; j++)
-        {
-            pixcrd[0] = j;
-            pixcrd[1] = i;
+        wcs_point *p = wcs_coord;
 
-            if ((status = wcsp2s(wcs, 1, 2, &pixcrd[0], &imgcrd[0], &phi, &theta, &world[0], &stat[0])))
+        for (int i = 0; i < height; i++)
+        {
+            for (int j = 0; j < width; j++)
             {
-                lastError = QString("wcsp2s error %1: %2.").arg(status).arg(wcs_errmsg[status]);
+                pixcrd[2 * j]     = j;
+                pixcrd[2 * j + 1] = i;
             }
-            else
-            {
-                p->ra  = world[0];
-                p->dec = world[1];
 
-                p++;
+            status = wcsp2s(wcs, width, 2, pixcrd.data(), imgcrd.data(), phi.data(), theta.data(), world.data(),
+                            stat.data());
+            if (status != 0 && status != 8)
+                lastError = QString("wcsp2s error %1: %2.").arg(status).arg(wcs_errmsg[status]);
+
+            for (int j = 0; j < width; j++, p++)
+            {
+                p->ra  = world[2 * j];
+                p->dec = world[2 * j + 1];
             }
         }
     }
 
-    findObjectsInImage(&world[0], phi, theta, &imgcrd[0], &pixcrd[0], &stat[0]);
+    findObjectsInImage();
 
     WCSLoaded = true;
     HasWCS = true;
@@ -2703,6 +2575,19 @@ bool FITSData::loadWCS()
 #endif
 }
 
+bool FITSData::getWCSBounds(double &minRA, double &maxRA, double &minDec, double &maxDec) const
+{
+    if (WCSLoaded == false || wcsBounds.isNull())
+        return false;
+
+    minRA  = wcsBounds.left();
+    maxRA  = wcsBounds.right();
+    minDec = wcsBounds.top();
+    maxDec = wcsBounds.bottom();
+
+    return true;
+}
+
 bool FITSData::wcsToPixel(SkyPoint &wcsCoord, QPointF &wcsPixelPoint, QPointF &wcsImagePoint)
 {
 #if !defined(KSTARS_LITE) && defined(HAVE_WCSLIB)
@@ -2776,12 +2661,13 @@ bool FITSData::pixelToWCS(const QPointF &wcsPixelPoint, SkyPoint &wcsCoord)
 }
 
 #if !defined(KSTARS_LITE) && defined(HAVE_WCSLIB)
-void FITSData::findObjectsInImage(double world[], double phi, double theta, double imgcrd[], double pixcrd[],
-                                  int stat[])
+void FITSData::findObjectsInImage()
 {
     int width  = getWidth();
     int height = getHeight();
     int status = 0;
+    int stat[2];
+    double imgcrd[2], phi = 0, pixcrd[2], theta = 0, world[2];
     char date[64];
     KSNumbers *num = nullptr;
 
@@ -2800,20 +2686,13 @@ void FITSData::findObjectsInImage(double world[], double phi, double theta, doub
 
     SkyMapComposite *map = KStarsData::Instance()->skyComposite();
 
-    wcs_point *wcs_coord = getWCSCoord();
-    if (wcs_coord)
+    // Opposite corners of the image
+    SkyPoint p1, p2;
+    if (pixelToWCS(QPointF(0, 0), p1) && pixelToWCS(QPointF(width - 1, height - 1), p2))
     {
-        int size = width * height;
-
         objList.clear();
 
-        SkyPoint p1;
-        p1.setRA0(dms(wcs_coord[0].ra));
-        p1.setDec0(dms(wcs_coord[0].dec));
         p1.updateCoordsNow(num);
-        SkyPoint p2;
-        p2.setRA0(dms(wcs_coord[size - 1].ra));
-        p2.setDec0(dms(wcs_coord[size - 1].dec));
         p2.updateCoordsNow(num);
         QList<SkyObject *> list = map->findObjectsInArea(p1, p2);
 
@@ -3173,6 +3052,10 @@ bool FITSData::rotFITS(int rotate, int mirror)
     delete[] imageBuffer;
     imageBuffer = rotimage;
 
+    // The histogram is the same, only the float plane has to be converted again
+    floatPlane.clear();
+    floatPlane.squeeze();
+
     return true;
 }
 
@@ -3467,6 +3350,8 @@ uint8_t *FITSData::getImageBuffer()
 
 void FITSData::setImageBuffer(uint8_t *buffer)
 {
+    invalidateCaches();
+
     delete[] imageBuffer;
     imageBuffer = buffer;
 }
@@ -3529,6 +3414,8 @@ void FITSData::setBayerParams(BayerParams *param)
 
 bool FITSData::debayer()
 {
+    invalidateCaches();
+
     if (bayerBuffer == nullptr)
     {
         int anynull = 0, status = 0;
@@ -3561,147 +3448,57 @@ bool FITSData::debayer()
 
 bool FITSData::debayer_8bit()
 {
-    dc1394error_t error_code;
-
-    int rgb_size               = stats.samples_per_channel * 3 * stats.bytesPerPixel;
-    uint8_t *destinationBuffer = new uint8_t[rgb_size];
-
-    if (destinationBuffer == nullptr)
-    {
-        KSNotification::error(i18n("Unable to allocate memory for temporary bayer buffer."), i18n("Debayer error"));
-        return false;
-    }
-
-    int ds1394_height      = stats.height;
-    uint8_t *dc1394_source = bayerBuffer;
-
-    if (debayerParams.offsetY == 1)
-    {
-        dc1394_source += stats.width;
-        ds1394_height--;
-    }
-
-    if (debayerParams.offsetX == 1)
-    {
-        dc1394_source++;
-    }
-
-    error_code = dc1394_bayer_decoding_8bit(dc1394_source, destinationBuffer, stats.width, ds1394_height,
-                                            debayerParams.filter, debayerParams.method);
-
-    if (error_code != DC1394_SUCCESS)
-    {
-        KSNotification::error(i18n("Debayer failed (%1)", error_code), i18n("Debayer error"));
-        channels = 1;
-        delete[] destinationBuffer;
-        return false;
-    }
-
-    if (channels == 1)
-    {
-        delete[] imageBuffer;
-        imageBuffer = new uint8_t[rgb_size];
-
-        if (imageBuffer == nullptr)
-        {
-            delete[] destinationBuffer;
-            KSNotification::error(i18n("Unable to allocate memory for temporary bayer buffer."), i18n("Debayer error"));
-            return false;
-        }
-    }
-
-    // Data in R1G1B1, we need to copy them into 3 layers for FITS
-
-    uint8_t *rBuff = imageBuffer;
-    uint8_t *gBuff = imageBuffer + (stats.width * stats.height);
-    uint8_t *bBuff = imageBuffer + (stats.width * stats.height * 2);
-
-    int imax = stats.samples_per_channel * 3 - 3;
-    for (int i = 0; i <= imax; i += 3)
-    {
-        *rBuff++ = destinationBuffer[i];
-        *gBuff++ = destinationBuffer[i + 1];
-        *bBuff++ = destinationBuffer[i + 2];
-    }
-
-    channels = 3;
-    delete[] destinationBuffer;
-    bayerBuffer = nullptr;
-    return true;
+    return debayer<uint8_t>();
 }
 
 bool FITSData::debayer_16bit()
 {
-    dc1394error_t error_code;
+    return debayer<uint16_t>();
+}
 
-    int rgb_size               = stats.samples_per_channel * 3 * stats.bytesPerPixel;
-    uint8_t *destinationBuffer = new uint8_t[rgb_size];
+template <typename T>
+bool FITSData::debayer()
+{
+    const uint32_t planeSize = stats.samples_per_channel;
 
-    uint16_t *buffer    = reinterpret_cast<uint16_t *>(bayerBuffer);
-    uint16_t *dstBuffer = reinterpret_cast<uint16_t *>(destinationBuffer);
+    // Decoded straight into the planes of the color image, which then replaces the bayered one
+    uint8_t *rgbBuffer = new (std::nothrow) uint8_t[planeSize * 3 * sizeof(T)];
 
-    if (destinationBuffer == nullptr)
+    if (rgbBuffer == nullptr)
     {
         KSNotification::error(i18n("Unable to allocate memory for temporary bayer buffer."), i18n("Debayer error"));
         return false;
     }
 
-    int ds1394_height       = stats.height;
-    uint16_t *dc1394_source = buffer;
+    // Superpixels are enough to focus and align, and much faster
+    dc1394bayer_method_t method = debayerParams.method;
+    if (Options::debayerSuperpixelPreview() && (mode == FITS_FOCUS || mode == FITS_ALIGN))
+        method = DC1394_BAYER_METHOD_DOWNSAMPLE;
 
-    if (debayerParams.offsetY == 1)
-    {
-        dc1394_source += stats.width;
-        ds1394_height--;
-    }
+    // Offsets shift the pattern rather than the image, which keeps its size
+    dc1394color_filter_t filter =
+        FITSBayer::shiftFilter(debayerParams.filter, debayerParams.offsetX, debayerParams.offsetY);
 
-    if (debayerParams.offsetX == 1)
-    {
-        dc1394_source++;
-    }
+    T *red   = reinterpret_cast<T *>(rgbBuffer);
+    T *green = red + planeSize;
+    T *blue  = green + planeSize;
 
-    error_code = dc1394_bayer_decoding_16bit(dc1394_source, dstBuffer, stats.width, ds1394_height, debayerParams.filter,
-                                             debayerParams.method, 16);
+    dc1394error_t error_code = FITSBayer::debayer(reinterpret_cast<const T *>(bayerBuffer), stats.width,
+                                                  stats.height, filter, method, red, green, blue);
 
     if (error_code != DC1394_SUCCESS)
     {
         KSNotification::error(i18n("Debayer failed (%1)", error_code), i18n("Debayer error"));
         channels = 1;
-        delete[] destinationBuffer;
+        delete[] rgbBuffer;
         return false;
     }
 
-    if (channels == 1)
-    {
-        delete[] imageBuffer;
-        imageBuffer = new uint8_t[rgb_size];
-
-        if (imageBuffer == nullptr)
-        {
-            delete[] destinationBuffer;
-            KSNotification::error(i18n("Unable to allocate memory for temporary bayer buffer."), i18n("Debayer error"));
-            return false;
-        }
-    }
-
-    buffer = reinterpret_cast<uint16_t *>(imageBuffer);
-
-    // Data in R1G1B1, we need to copy them into 3 layers for FITS
-
-    uint16_t *rBuff = buffer;
-    uint16_t *gBuff = buffer + (stats.width * stats.height);
-    uint16_t *bBuff = buffer + (stats.width * stats.height * 2);
-
-    int imax = stats.samples_per_channel * 3 - 3;
-    for (int i = 0; i <= imax; i += 3)
-    {
-        *rBuff++ = dstBuffer[i];
-        *gBuff++ = dstBuffer[i + 1];
-        *bBuff++ = dstBuffer[i + 2];
-    }
+    // The bayered samples were read into the image buffer
+    delete[] imageBuffer;
+    imageBuffer = rgbBuffer;
 
-    channels = 3;
-    delete[] destinationBuffer;
+    channels    = 3;
     bayerBuffer = nullptr;
     return true;
 }
@@ -3962,6 +3759,33 @@ QString FITSData::getLastError() const
     return lastError;
 }
 
+QString FITSData::getOrSaveFilename()
+{
+    if (filename.isEmpty() == false)
+        return filename;
+
+    QTemporaryFile tmpFile(QDir::tempPath() + "/fitsXXXXXX");
+    tmpFile.setAutoRemove(false);
+
+    // Only reserve a unique name, CFITSIO refuses to create a file that exists already
+    if (tmpFile.open() == false)
+        return QString();
+
+    QString tmpFilename = tmpFile.fileName();
+    tmpFile.close();
+    tmpFile.remove();
+
+    if (saveFITS(tmpFilename) != 0)
+    {
+        qCWarning(KSTARS_FITS) << "Failed to save memory image to" << tmpFilename;
+        return QString();
+    }
+
+    tempFile = true;
+
+    return filename;
+}
+
 bool FITSData::getAutoRemoveTemporaryFITS() const
 {
     return autoRemoveTemporaryFITS;
@@ -4165,8 +3989,8 @@ QImage FITSData::FITSToImage(const QString &filename)
         fitsImage = QImage(data.getWidth(), data.getHeight(), QImage::Format_RGB32);
     }
 
-    double dataMin = data.stats.mean[0] - data.stats.stddev[0];
-    double dataMax = data.stats.mean[0] + data.stats.stddev[0] * 3;
+    double dataMin = 0, dataMax = 0;
+    data.getAutoStretchLimits(&dataMin, &dataMax);
 
     double bscale = 255. / (dataMax - dataMin);
     double bzero  = (-dataMin) * (255. / (dataMax - dataMin));
@@ -4260,6 +4084,7 @@ bool FITSData::createWCSFile(const QString &newWCSFile, double orientation, doub
     }
 
     status = 0;
+    fitsMemory.clear();
 
     if (tempFile && autoRemoveTemporaryFITS)
     {
@@ -4394,7 +4219,8 @@ bool FITSData::createWCSFile(const QString &newWCSFile, double orientation, doub
 
     fits_flush_file(fptr, &status);
 
-    WCSLoaded = false;
+    // Replace any solution parsed from the keywords the image came with, loadWCS() then uses the new one
+    checkForWCS();
 
     qCDebug(KSTARS_FITS) << "Finished creating WCS file: " << newWCSFile;
 
@@ -4419,44 +4245,80 @@ int FITSData::findSEPStars(const QRect &boundary)
         maxRadius = w;
     }
 
-    float *data = new float[w*h];
+    const float *plane = getFloatPlane();
+    if (plane == nullptr)
+        return -1;
 
-    switch (stats.bitpix)
+    // Full frames are cut into strips of rows extracted in parallel. Tracking boxes are small enough for one job.
+    int nStrips = 1;
+    if (boundary.isNull())
+        nStrips = qMax(1, qMin(QThreadPool::globalInstance()->maxThreadCount(), h / (SEP_STRIP_OVERLAP * 4)));
+
+    QVector<SEPStrip> strips(nStrips);
+    for (int i = 0; i < nStrips; i++)
     {
-    case BYTE_IMG:
-        getFloatBuffer<uint8_t>(data, x, y, w, h);
-        break;
-    case SHORT_IMG:
-        getFloatBuffer<int16_t>(data, x, y, w, h);
-        break;
-    case USHORT_IMG:
-        getFloatBuffer<uint16_t>(data, x, y, w, h);
-        break;
-    case LONG_IMG:
-        getFloatBuffer<int32_t>(data, x, y, w, h);
-        break;
-    case ULONG_IMG:
-        getFloatBuffer<uint32_t>(data, x, y, w, h);
-        break;
-    case FLOAT_IMG:
-        delete [] data;
-        data = reinterpret_cast<float *>(imageBuffer);
-        break;
-    case LONGLONG_IMG:
-        getFloatBuffer<int64_t>(data, x, y, w, h);
-        break;
-    case DOUBLE_IMG:
-        getFloatBuffer<double>(data, x, y, w, h);
-        break;
-    default:
-        delete [] data;
+        SEPStrip &strip = strips[i];
+        strip.first     = y + h * i / nStrips;
+        strip.last      = y + h * (i + 1) / nStrips;
+        strip.top       = (i == 0) ? strip.first : strip.first - SEP_STRIP_OVERLAP;
+        strip.bottom    = (i == nStrips - 1) ? strip.last : strip.last + SEP_STRIP_OVERLAP;
+    }
+
+    const int stride = stats.width;
+    QtConcurrent::blockingMap(strips, [plane, stride, x, w, maxRadius](SEPStrip &strip) {
+        extractSEPStrip(plane, stride, x, w, maxRadius, strip);
+    });
+
+    QList<Edge*> edges;
+    int status = 0;
+    for (const SEPStrip &strip : strips)
+    {
+        edges += strip.stars;
+        if (strip.status)
+            status = strip.status;
+    }
+
+    if (status)
+    {
+        qDeleteAll(edges);
+
+        char errorMessage[512];
+        sep_get_errmsg(status, errorMessage);
+        qCritical(KSTARS_FITS) << errorMessage;
         return -1;
-        break;
     }
 
-    float *imback = nullptr;
-    double *flux= nullptr, *fluxerr= nullptr, *area= nullptr;
-    short *flag = nullptr;
+    // Let's sort edges, starting with widest
+    qSort(edges.begin(), edges.end(), [](const Edge *edge1, const Edge *edge2) -> bool { return edge1->width > edge2->width;});
+
+    // Take only the first 100 stars
+    {
+        int starCount = qMin(100, edges.count());
+        for (int i=0; i < starCount; i++)
+            starCenters.append(edges[i]);
+        for (int i=starCount; i < edges.count(); i++)
+            delete edges[i];
+    }
+
+    edges.clear();
+
+    qCDebug(KSTARS_FITS) << qSetFieldWidth(10) << "#" << "#X" << "#Y" << "#Flux" << "#Width" << "#HFR";;
+    for (int i=0; i < starCenters.count(); i++)
+        qCDebug(KSTARS_FITS) << qSetFieldWidth(10) << i << starCenters[i]->x << starCenters[i]->y
+                             << starCenters[i]->sum << starCenters[i]->width << starCenters[i]->HFR;
+
+    return starCenters.count();
+}
+
+void FITSData::extractSEPStrip(const float *plane, int stride, int x, int w, int maxRadius, SEPStrip &strip)
+{
+    const int h = strip.bottom - strip.top;
+
+    // SEP subtracts the background in place, so each strip works on its own copy of the plane
+    QVector<float> data(w * h);
+    for (int row = 0; row < h; row++)
+        memcpy(data.data() + row * w, plane + (strip.top + row) * stride + x, w * sizeof(float));
+
     short flux_flag=0;
     int status = 0;
     sep_bkg *bkg = nullptr;
@@ -4464,117 +4326,108 @@ int FITSData::findSEPStars(const QRect &boundary)
     float conv[] = {1,2,1, 2,4,2, 1,2,1};
     double flux_fractions[2] = {0};
     double requested_frac[2] = { 0.5, 0.99 };
-    QList<Edge*> edges;
 
     // #0 Create SEP Image structure
-    sep_image im = {data, nullptr, nullptr, SEP_TFLOAT, 0, 0, w, h, 0.0, SEP_NOISE_NONE, 1.0, 0.0};
+    sep_image im = {data.data(), nullptr, nullptr, SEP_TFLOAT, 0, 0, w, h, 0.0, SEP_NOISE_NONE, 1.0, 0.0};
 
     // #1 Background estimate
     status = sep_background(&im, 64, 64, 3, 3, 0.0, &bkg);
     if (status) goto exit;
 
-    // #2 Background evaluation
-    imback = (float *)malloc((w * h)*sizeof(float));
-    status = sep_bkg_array(bkg, imback, SEP_TFLOAT);
-    if (status) goto exit;
-
-    // #3 Background substraction
+    // #2 Background substraction
     status = sep_bkg_subarray(bkg, im.data, im.dtype);
     if (status) goto exit;
 
-    // #4 Source Extraction
+    // #3 Source Extraction
     // Note that we set deblend_cont = 1.0 to turn off deblending.
     status = sep_extract(&im, 2*bkg->globalrms, SEP_THRESH_ABS, 10, conv, 3, 3, SEP_FILTER_CONV, 32, 1.0, 1, 1.0, &catalog);
     if (status) goto exit;
 
-#if 0
-    // #4 Aperture photometry
-    im.noise = &(bkg->globalrms);  /* set image noise level */
-    im.ndtype = SEP_TFLOAT;
-    fluxt = flux = (double *)malloc(catalog->nobj * sizeof(double));
-    fluxerrt = fluxerr = (double *)malloc(catalog->nobj * sizeof(double));
-    areat = area = (double *)malloc(catalog->nobj * sizeof(double));
-    flagt = flag = (short *)malloc(catalog->nobj * sizeof(short));
-    for (int i=0; i<catalog->nobj; i++, fluxt++, fluxerrt++, flagt++, areat++)
-        sep_sum_circle(&im, catalog->x[i], catalog->y[i], 10.0, 5, 0, fluxt, fluxerrt, areat, flagt);
-#endif
-
     // TODO
     // Must detect edge detection
-    // Must limit to brightest 100 (by flux) centers
     // Should probably use ellipse to draw instead of simple circle?
     // Useful for galaxies and also elenogated stars.
     for (int i=0; i<catalog->nobj; i++)
     {
+        // Stars in the margins belong to the neighbouring strips
+        const double row = catalog->y[i] + strip.top;
+        if (row < strip.first || row >= strip.last)
+            continue;
+
         double flux = catalog->flux[i];
         // Get HFR
         sep_flux_radius(&im, catalog->x[i], catalog->y[i], maxRadius, 5, 0, &flux, requested_frac, 2, flux_fractions, &flux_flag);
 
         Edge *center = new Edge();
         center->x = catalog->x[i]+x+0.5;
-        center->y = catalog->y[i]+y+0.5;
+        center->y = row+0.5;
         center->val = catalog->peak[i];
         center->sum = flux;
         center->HFR = center->width = flux_fractions[0];
         if (flux_fractions[1] < maxRadius)
             center->width = flux_fractions[1]*2;
-        edges.append(center);
-    }
-
-    // Let's sort edges, starting with widest
-    qSort(edges.begin(), edges.end(), [](const Edge *edge1, const Edge *edge2) -> bool { return edge1->width > edge2->width;});
-
-    // Take only the first 100 stars
-    {
-        int starCount = qMin(100, edges.count());
-        for (int i=0; i < starCount; i++)
-            starCenters.append(edges[i]);
+        strip.stars.append(center);
     }
 
-    edges.clear();
-
-    qCDebug(KSTARS_FITS) << qSetFieldWidth(10) << "#" << "#X" << "#Y" << "#Flux" << "#Width" << "#HFR";;
-    for (int i=0; i < starCenters.count(); i++)
-        qCDebug(KSTARS_FITS) << qSetFieldWidth(10) << i << starCenters[i]->x << starCenters[i]->y
-                             << starCenters[i]->sum << starCenters[i]->width << starCenters[i]->HFR;
-
 exit:
-    if (stats.bitpix != FLOAT_IMG)
-        delete [] data;
     sep_bkg_free(bkg);
     sep_catalog_free(catalog);
-    free(flux);
-    free(fluxerr);
-    free(area);
-    free(flag);
-
-    if (status)
-    {
-        char errorMessage[512];
-        sep_get_errmsg(status, errorMessage);
-        qCritical(KSTARS_FITS) << errorMessage;
-        return -1;
-    }
 
-    return starCenters.count();
+    strip.status = status;
 }
 
-template <typename T>
-void FITSData::getFloatBuffer(float *buffer, int x, int y, int w, int h)
+const float *FITSData::getFloatPlane()
 {
-    T *rawBuffer = reinterpret_cast<T *>(imageBuffer);
-
-    float *floatPtr = buffer;
+    if (imageBuffer == nullptr)
+        return nullptr;
 
-    int x2 = x+w;
-    int y2 = y+h;
+    if (data_type == TFLOAT)
+        return reinterpret_cast<const float *>(imageBuffer);
 
-    for (int y1=y; y1 < y2; y1++)
+    if (floatPlane.isEmpty())
     {
-        int offset = y1*stats.width;
-        for (int x1=x; x1 < x2; x1++)
+        switch (data_type)
         {
-            *floatPtr++ = rawBuffer[offset+x1];
+        case TBYTE:
+            convertFloatPlane<uint8_t>();
+            break;
+        case TSHORT:
+            convertFloatPlane<int16_t>();
+            break;
+        case TUSHORT:
+            convertFloatPlane<uint16_t>();
+            break;
+        case TLONG:
+            convertFloatPlane<int32_t>();
+            break;
+        case TULONG:
+            convertFloatPlane<uint32_t>();
+            break;
+        case TLONGLONG:
+            convertFloatPlane<int64_t>();
+            break;
+        case TDOUBLE:
+            convertFloatPlane<double>();
+            break;
+        default:
+            return nullptr;
         }
     }
+
+    return floatPlane.constData();
+}
+
+template <typename T>
+void FITSData::convertFloatPlane()
+{
+    floatPlane.resize(stats.samples_per_channel);
+
+    const T *source = reinterpret_cast<const T *>(imageBuffer);
+    float *target   = floatPlane.data();
+    const uint32_t width = stats.width;
+
+    FITSFilters::forEachBand(stats.height, [source, target, width](uint32_t first, uint32_t last) {
+        for (uint32_t i = first * width, end = last * width; i < end; i++)
+            target[i] = source[i];
+    });
 }
@@ -31,6 +31,9 @@
 
 #include <fitsio.h>
 
+#include <QByteArray>
+#include <QElapsedTimer>
+#include <QFuture>
 #include <QObject>
 #include <QRect>
 
@@ -95,6 +98,8 @@ class FITSData
 
     /* Loads FITS image, scales it, and displays it in the GUI */
     bool loadFITS(const QString &filename, bool silent = true);
+    /* Loads FITS image from a complete FITS file held in memory, without a file on disk */
+    bool loadFITSFromMemory(const QByteArray &buffer, bool silent = true);
     /* Save FITS */
     int saveFITS(const QString &filename);
     /* Rescale image lineary from image_buffer, fit to window if desired */
@@ -146,8 +151,26 @@ class FITSData
     double getStdDev(uint8_t channel = 0) { return stats.stddev[channel]; }
     void setMean(double value, uint8_t channel = 0) { stats.mean[channel] = value; }
     double getMean(uint8_t channel = 0) { return stats.mean[channel]; }
-    void setMedian(double val, uint8_t channel = 0) { stats.median[channel] = val; }
-    double getMedian(uint8_t channel = 0) { return stats.median[channel]; }
+    void setMedian(double val, uint8_t channel = 0);
+    /* Exact median of a channel, computed from its histogram on first use */
+    double getMedian(uint8_t channel = 0);
+    /* Exact median absolute deviation of a channel from its median, computed on first use */
+    double getMAD(uint8_t channel = 0);
+    /**
+     * @brief getHistogram Histogram of a channel, computed once per image and shared by all its users.
+     * 8 and 16 bit data has one bin per value of the data type, starting at its lowest value. Other types have
+     * FITSFilters::HISTOGRAM_BINS bins between the minimum and maximum of the channel.
+     * @param channel Channel
+     * @param min If not null, set to the lowest value of the first bin
+     * @param binWidth If not null, set to the width of the bins
+     * @return Frequency of each bin
+     */
+    const QVector<uint32_t> &getHistogram(uint8_t channel = 0, double *min = nullptr, double *binWidth = nullptr);
+    /* Black and white points of the automatic stretch */
+    void getAutoStretchLimits(double *min, double *max);
+    /* Drop the histogram, median, MAD and float plane cached from the image data. Call it before changing the data in
+       place, it also waits for the star detection running in the background. */
+    void invalidateCaches();
 
     int getBytesPerPixel() { return stats.bytesPerPixel; }
     void setSNR(double val) { stats.SNR = val; }
@@ -165,6 +188,12 @@ class FITSData
     QList<Edge *> getStarCentersInSubFrame(QRect subFrame);    
 
     int findStars(StarAlgorithm algorithm = ALGORITHM_CENTROID, const QRect &trackingBox = QRect());
+    /**
+     * @brief findStarsAsync Runs findStars() in the global thread pool.
+     * Stars must not be read nor searched until the future is finished. Deleting or modifying the image waits for it.
+     * @return Future of the number of stars detected, -1 on error
+     */
+    QFuture<int> findStarsAsync(StarAlgorithm algorithm = ALGORITHM_CENTROID, const QRect &trackingBox = QRect());
 
     void getCenterSelection(int *x, int *y);
     int findOneStar(const QRect &boundary);
@@ -175,10 +204,11 @@ class FITSData
     static int findCannyStar(FITSData *data, const QRect &boundary);
 
     // Use SEP (Sextractor Library) to find stars
-    template <typename T>
-    void getFloatBuffer(float *buffer, int x, int y, int w, int h);
     int findSEPStars(const QRect &boundary = QRect());
 
+    // First channel of the image as floats, converted on first use and cached until the image changes
+    const float *getFloatPlane();
+
     // Half Flux Radius
     Edge *getMaxHFRStar() { return maxHFRStar; }
     double getHFR(HFRType type = HFR_AVERAGE);
@@ -197,8 +227,18 @@ class FITSData
     // Is WCS Image loaded?
     bool isWCSLoaded() { return WCSLoaded; }
 
+    /**
+         * @brief getWCSCoord Get the J2000 coordinates of every pixel of the image
+         * @return The coordinates, row by row, or nullptr unless the FullWCSTable option is set. Use pixelToWCS() otherwise.
+         */
     wcs_point *getWCSCoord() { return wcs_coord; }
 
+    /**
+         * @brief getWCSBounds Get the range of J2000 coordinates covered by the image, sampled on a coarse grid of pixels
+         * @return True if WCS data is loaded, false otherwise.
+         */
+    bool getWCSBounds(double &minRA, double &maxRA, double &minDec, double &maxDec) const;
+
     /**
          * @brief wcsToPixel Given J2000 (RA0,DE0) coordinates. Find in the image the corresponding pixel coordinates.
          * @param wcsCoord Coordinates of target
@@ -251,8 +291,10 @@ class FITSData
     int getRotCounter() const;
     void setRotCounter(int value);
 
-    // Filename
+    // Filename. Empty if the image was loaded from memory.
     const QString &getFilename() { return filename; }
+    // Filename, saving images loaded from memory to a temporary file first. Empty on error.
+    QString getOrSaveFilename();
 
     // Horizontal flip counter. We keep count to rotate WCS keywords on save
     int getFlipHCounter() const;
@@ -264,7 +306,7 @@ class FITSData
 
 #ifndef KSTARS_LITE
 #ifdef HAVE_WCSLIB
-    void findObjectsInImage(double world[], double phi, double theta, double imgcrd[], double pixcrd[], int stat[]);
+    void findObjectsInImage();
 #endif
 #endif
     QList<FITSSkyObject *> getSkyObjects();
@@ -279,11 +321,17 @@ class FITSData
     QString getLastError() const;
 
   private:
+    /* Close the current FITS file and release its memory buffer, if any */
+    void closeFITS();
+    /* Read header and data of the image opened in fptr */
+    bool readFITS(bool silent, QElapsedTimer &loadTimer);
     void rotWCSFITS(int angle, int mirror);
     bool checkCollision(Edge *s1, Edge *s2);
-    int calculateMinMax(bool refresh = false);
+    bool readDataMinMax();
     bool checkDebayer();
     void readWCSKeys();
+    /* Free the WCS structs parsed from the header, if any */
+    void clearWCS();
 
     // Templated functions
     template <typename T>
@@ -302,19 +350,68 @@ class FITSData
                       int minEdgeWidth = MINIMUM_PIXEL_RANGE);
     // Star Detect - Threshold
     template <typename T>
-    int findOneStar(const QRect &boundary);
+    int findOneStar(const QRect &boundary, double background);
 
-    template <typename T>
-    void calculateMinMax();
+    /// Statistics of a range of samples. Partial results of several ranges can be merged.
+    struct SampleStats
+    {
+        double min { 1.0E30 }, max { -1.0E30 };
+        double mean { 0 };
+        /// Sum of squared differences from the mean
+        double m2 { 0 };
+        uint32_t count { 0 };
+
+        void merge(const SampleStats &other);
+    };
 
+    /* Statistics of count samples starting at start. If histogram is not null, it is filled with
+       the frequency of each value, which is only valid for 8 and 16 bit data. */
+    template <typename T>
+    SampleStats getSampleStats(uint32_t start, uint32_t count, uint32_t *histogram = nullptr) const;
+    /* Statistics of a whole channel, computed in parallel in the global thread pool */
     template <typename T>
-    QPair<T,T> getParitionMinMax(uint32_t start, uint32_t stride);
+    SampleStats getChannelStats(uint8_t channel, QVector<uint32_t> *histogram = nullptr) const;
 
-    /* Calculate running average & standard deviation using Welford’s method for computing variance */
+    /* Calculate average & standard deviation of all channels, and their histogram for 8 and 16 bit data */
     template <typename T>
     void runningAverageStdDev();
+    /* Calculate min, max, average & standard deviation of all channels in one pass, with the histogram for 8 and 16 bit data */
     template <typename T>
-    QPair<double,double> getSquaredSumAndMean(uint32_t start, uint32_t stride);
+    void calculateChannelStats();
+
+    /* Star detection proper, see findStars(). The background is the image median, used by the threshold algorithm:
+     * it is read from the histogram cache on the calling thread, before detection may move to the thread pool. */
+    int detectStars(StarAlgorithm algorithm, const QRect &trackingBox, double background);
+
+    /* Rows of the image extracted by one SEP job. Stars are kept if their center is in [first, last), the rows
+       from top to bottom include a margin so that stars close to first and last are complete. */
+    struct SEPStrip
+    {
+        int top { 0 };
+        int bottom { 0 };
+        int first { 0 };
+        int last { 0 };
+        int status { 0 };
+        QList<Edge *> stars;
+    };
+    /* Extract the stars of a strip of columns x to x + w of the float plane */
+    static void extractSEPStrip(const float *plane, int stride, int x, int w, int maxRadius, SEPStrip &strip);
+
+    template <typename T>
+    void convertFloatPlane();
+
+    /* Compute the histogram of all channels unless cached, then the median and MAD of channel if requested */
+    void calculateHistogram(uint8_t channel, bool median, bool mad);
+    template <typename T>
+    void calculateHistogram(uint8_t channel, bool median, bool mad);
+    /* Range covered by the histogram of a channel */
+    template <typename T>
+    void getHistogramRange(uint8_t channel, T *min, T *max) const;
+
+    /* Read the image in bands of rows, computing the statistics of each band while the next one is read */
+    bool readImageTiles(bool computeStats, QString &errMessage);
+    /* Start getSampleStats() for the current data type in the global thread pool */
+    QFuture<SampleStats> runSampleStats(uint32_t start, uint32_t count, uint32_t *histogram) const;
 
     // Sobel detector by Gonzalo Exequiel Pedone
     template <typename T>
@@ -338,6 +435,10 @@ class FITSData
 #endif
     /// Pointer to CFITSIO FITS file struct
     fitsfile *fptr { nullptr };
+    /// FITS file of images loaded from memory. CFITSIO keeps the addresses of the pointer and size.
+    QByteArray fitsMemory;
+    void *fitsMemoryPtr { nullptr };
+    size_t fitsMemorySize { 0 };
 
     /// FITS image data type (TBYTE, TUSHORT, TINT, TFLOAT, TLONG, TDOUBLE)
     int data_type { 0 };
@@ -375,8 +476,12 @@ class FITSData
 
     /// Pointer to WCS coordinate data, if any.
     wcs_point *wcs_coord { nullptr };
+    /// Range of J2000 RA (x) and Dec (y) covered by the image, in degrees
+    QRectF wcsBounds;
     /// WCS Struct
     struct wcsprm *wcs { nullptr };
+    /// Number of WCS structs in wcs
+    int nwcs { 0 };
     /// All the stars we detected, if any.
     QList<Edge *> starCenters;
     QList<Edge *> localStarCenters;
@@ -403,6 +508,21 @@ class FITSData
         uint16_t height { 0 };
     } stats;
 
+    /// First channel as floats, see getFloatPlane(). Unused for float images.
+    QVector<float> floatPlane;
+    /// Star detection running in the global thread pool, see findStarsAsync()
+    QFuture<int> starFuture;
+
+    /// Histograms of the channels, see getHistogram(), and the statistics derived from them
+    struct
+    {
+        QVector<uint32_t> frequency[3];
+        bool valid { false };
+        bool medianValid[3] = { false, false, false };
+        double mad[3] = {0};
+        bool madValid[3] = { false, false, false };
+    } histogramCache;
+
     /// Remove temproray files after closing
     bool autoRemoveTemporaryFITS { true };
 
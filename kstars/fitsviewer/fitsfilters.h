@@ -0,0 +1,560 @@
+/***************************************************************************
+                          fitsfilters.h  -  FITS Image
+                             -------------------
+    begin                : Sun Oct 18 2026
+    copyright            : (C) 2026 by KStars Developers
+ ***************************************************************************/
+
+/***************************************************************************
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ ***************************************************************************/
+
+#pragma once
+
+#include <QPair>
+#include <QThreadPool>
+#include <QVector>
+#include <QtConcurrent>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <type_traits>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define FITS_FILTERS_SSE2
+#endif
+
+/**
+ * Kernels used by FITSData::applyFilter() on one channel of width x height samples of type T.
+ *
+ * The work is split in bands of rows that are processed in the global thread pool. Clamping uses
+ * SSE2 when available. Other point operations go through a lookup table for 8 and 16 bit data,
+ * which is much cheaper than evaluating log() or sqrt() for every sample.
+ */
+namespace FITSFilters
+{
+/** Runs function(firstRow, lastRow) on bands of rows in the global thread pool and waits for all of them */
+template <typename Function>
+void forEachBand(uint32_t rows, Function function)
+{
+    // A few bands per thread, so that threads finishing early can pick up more work
+    const uint32_t nBands =
+        std::max<uint32_t>(1, std::min<uint32_t>(rows, QThreadPool::globalInstance()->maxThreadCount() * 4));
+
+    QVector<QPair<uint32_t, uint32_t>> bands;
+    bands.reserve(nBands);
+    for (uint32_t i = 0; i < nBands; i++)
+        bands.append(qMakePair(uint32_t(uint64_t(rows) * i / nBands), uint32_t(uint64_t(rows) * (i + 1) / nBands)));
+
+    QtConcurrent::blockingMap(bands, [&function](QPair<uint32_t, uint32_t> &band) { function(band.first, band.second); });
+}
+
+/** 8 and 16 bit integer types are transformed through lookup tables */
+template <typename T>
+struct UsesLUT : std::integral_constant<bool, std::is_integral<T>::value && sizeof(T) <= 2>
+{
+};
+
+/** Index of a value in a lookup table covering all values of T */
+template <typename T>
+inline uint32_t lutIndex(T value)
+{
+    return static_cast<uint32_t>(static_cast<int32_t>(value) - static_cast<int32_t>(std::numeric_limits<T>::min()));
+}
+
+/** Converts a result to T, rounding it for integer types */
+template <typename T>
+inline T toSample(double value)
+{
+    return static_cast<T>(std::is_integral<T>::value ? std::round(value) : value);
+}
+
+template <typename T>
+inline void clampScalar(T *data, uint32_t count, T min, T max)
+{
+    for (uint32_t i = 0; i < count; i++)
+        data[i] = std::min(std::max(data[i], min), max);
+}
+
+/** Clamps count samples to [min, max] */
+template <typename T>
+inline void clamp(T *data, uint32_t count, T min, T max)
+{
+    clampScalar(data, count, min, max);
+}
+
+#ifdef FITS_FILTERS_SSE2
+template <>
+inline void clamp<uint8_t>(uint8_t *data, uint32_t count, uint8_t min, uint8_t max)
+{
+    const __m128i vMin = _mm_set1_epi8(static_cast<char>(min));
+    const __m128i vMax = _mm_set1_epi8(static_cast<char>(max));
+    uint32_t i         = 0;
+
+    for (; i + 16 <= count; i += 16)
+    {
+        __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i *>(data + i));
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(data + i), _mm_min_epu8(_mm_max_epu8(v, vMin), vMax));
+    }
+    clampScalar(data + i, count - i, min, max);
+}
+
+template <>
+inline void clamp<int16_t>(int16_t *data, uint32_t count, int16_t min, int16_t max)
+{
+    const __m128i vMin = _mm_set1_epi16(min);
+    const __m128i vMax = _mm_set1_epi16(max);
+    uint32_t i         = 0;
+
+    for (; i + 8 <= count; i += 8)
+    {
+        __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i *>(data + i));
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(data + i), _mm_min_epi16(_mm_max_epi16(v, vMin), vMax));
+    }
+    clampScalar(data + i, count - i, min, max);
+}
+
+template <>
+inline void clamp<uint16_t>(uint16_t *data, uint32_t count, uint16_t min, uint16_t max)
+{
+    // SSE2 has no unsigned 16 bit min/max, saturated arithmetic does the same
+    const __m128i vMin = _mm_set1_epi16(static_cast<short>(min));
+    const __m128i vMax = _mm_set1_epi16(static_cast<short>(max));
+    uint32_t i         = 0;
+
+    for (; i + 8 <= count; i += 8)
+    {
+        __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i *>(data + i));
+        v         = _mm_adds_epu16(_mm_subs_epu16(v, vMin), vMin);
+        v         = _mm_subs_epu16(v, _mm_subs_epu16(v, vMax));
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(data + i), v);
+    }
+    clampScalar(data + i, count - i, min, max);
+}
+
+template <>
+inline void clamp<float>(float *data, uint32_t count, float min, float max)
+{
+    const __m128 vMin = _mm_set1_ps(min);
+    const __m128 vMax = _mm_set1_ps(max);
+    uint32_t i        = 0;
+
+    for (; i + 4 <= count; i += 4)
+        _mm_storeu_ps(data + i, _mm_min_ps(_mm_max_ps(_mm_loadu_ps(data + i), vMin), vMax));
+    clampScalar(data + i, count - i, min, max);
+}
+
+template <>
+inline void clamp<double>(double *data, uint32_t count, double min, double max)
+{
+    const __m128d vMin = _mm_set1_pd(min);
+    const __m128d vMax = _mm_set1_pd(max);
+    uint32_t i         = 0;
+
+    for (; i + 2 <= count; i += 2)
+        _mm_storeu_pd(data + i, _mm_min_pd(_mm_max_pd(_mm_loadu_pd(data + i), vMin), vMax));
+    clampScalar(data + i, count - i, min, max);
+}
+#endif
+
+/** Clamps a channel to [min, max] */
+template <typename T>
+void clampChannel(T *data, uint32_t width, uint32_t height, T min, T max)
+{
+    forEachBand(height, [=](uint32_t first, uint32_t last) {
+        clamp(data + first * width, (last - first) * width, min, max);
+    });
+}
+
+template <typename T, typename Function>
+void transformChannel(T *data, uint32_t width, uint32_t height, Function function, std::true_type)
+{
+    QVector<T> lut(1 << (8 * sizeof(T)));
+    for (int i = 0; i < lut.size(); i++)
+        lut[i] = function(static_cast<T>(i + std::numeric_limits<T>::min()));
+
+    const T *table = lut.constData();
+    forEachBand(height, [=](uint32_t first, uint32_t last) {
+        T *samples = data + first * width;
+        for (uint32_t i = 0, count = (last - first) * width; i < count; i++)
+            samples[i] = table[lutIndex(samples[i])];
+    });
+}
+
+template <typename T, typename Function>
+void transformChannel(T *data, uint32_t width, uint32_t height, Function function, std::false_type)
+{
+    forEachBand(height, [=](uint32_t first, uint32_t last) {
+        T *samples = data + first * width;
+        for (uint32_t i = 0, count = (last - first) * width; i < count; i++)
+            samples[i] = function(samples[i]);
+    });
+}
+
+/** Replaces every sample a of a channel by function(a) */
+template <typename T, typename Function>
+void transformChannel(T *data, uint32_t width, uint32_t height, Function function)
+{
+    transformChannel(data, width, height, function, UsesLUT<T>());
+}
+
+/** Logarithmic stretch of a channel to [min, max] */
+template <typename T>
+void logChannel(T *data, uint32_t width, uint32_t height, T min, T max)
+{
+    const double coeff = max / std::log(1 + static_cast<double>(max));
+    transformChannel(data, width, height, [=](T a) {
+        return std::min(std::max(toSample<T>(coeff * std::log(1 + static_cast<double>(std::min(std::max(a, min), max)))),
+                                 min), max);
+    });
+}
+
+/** Square root stretch of a channel to [min, max] */
+template <typename T>
+void sqrtChannel(T *data, uint32_t width, uint32_t height, T min, T max)
+{
+    const double coeff = max / std::sqrt(static_cast<double>(max));
+    transformChannel(data, width, height, [=](T a) {
+        return std::min(std::max(toSample<T>(coeff * std::sqrt(static_cast<double>(std::min(std::max(a, min), max)))),
+                                 min), max);
+    });
+}
+
+#ifdef FITS_FILTERS_SSE2
+template <>
+inline void sqrtChannel<float>(float *data, uint32_t width, uint32_t height, float min, float max)
+{
+    const float coeff = max / std::sqrt(max);
+    forEachBand(height, [=](uint32_t first, uint32_t last) {
+        const __m128 vMin = _mm_set1_ps(min), vMax = _mm_set1_ps(max), vCoeff = _mm_set1_ps(coeff);
+        float *samples    = data + first * width;
+        uint32_t count    = (last - first) * width, i = 0;
+
+        for (; i + 4 <= count; i += 4)
+        {
+            __m128 v = _mm_min_ps(_mm_max_ps(_mm_loadu_ps(samples + i), vMin), vMax);
+            v        = _mm_mul_ps(vCoeff, _mm_sqrt_ps(v));
+            _mm_storeu_ps(samples + i, _mm_min_ps(_mm_max_ps(v, vMin), vMax));
+        }
+        for (; i < count; i++)
+            samples[i] = std::min(std::max(coeff * std::sqrt(std::min(std::max(samples[i], min), max)), min), max);
+    });
+}
+#endif
+
+/** Number of bins of the histograms of types that do not use lookup tables */
+const uint32_t HISTOGRAM_BINS = 0x10000;
+
+/** Number of bins of the histograms of samples of type T. 8 and 16 bit data uses one bin per value. */
+template <typename T>
+inline uint32_t histogramBins()
+{
+    return UsesLUT<T>::value ? (1u << (8 * sizeof(T))) : HISTOGRAM_BINS;
+}
+
+/** Bins per unit of the histograms between min and max, see histogramBin() */
+inline double histogramScale(double min, double max, uint32_t nBins)
+{
+    return (max > min) ? (nBins - 1) / (max - min) : 0;
+}
+
+/** Bin of a value in a histogram of nBins bins between min and max. Values out of range go to the first and last bins. */
+inline uint32_t valueBin(double value, double min, double scale, uint32_t nBins)
+{
+    double bin = (value - min) * scale;
+    return bin <= 0 ? 0 : std::min(static_cast<uint32_t>(bin), nBins - 1);
+}
+
+/** Bin of a sample in a histogram of histogramBins() bins between min and max */
+template <typename T>
+inline uint32_t histogramBin(T value, T min, double scale, uint32_t nBins, std::true_type)
+{
+    Q_UNUSED(min);
+    Q_UNUSED(scale);
+    Q_UNUSED(nBins);
+    return lutIndex(value);
+}
+
+template <typename T>
+inline uint32_t histogramBin(T value, T min, double scale, uint32_t nBins, std::false_type)
+{
+    return valueBin(static_cast<double>(value), min, scale, nBins);
+}
+
+/** Number of threads used by forEachThreadBand() */
+inline uint32_t threadBands(uint32_t rows)
+{
+    return std::max<uint32_t>(1, std::min<uint32_t>(rows, QThreadPool::globalInstance()->maxThreadCount()));
+}
+
+/** Runs function(index, firstRow, lastRow) on one band of rows per thread of the global thread pool */
+template <typename Function>
+void forEachThreadBand(uint32_t rows, Function function)
+{
+    const uint32_t nBands = threadBands(rows);
+
+    QVector<uint32_t> ids;
+    for (uint32_t i = 0; i < nBands; i++)
+        ids.append(i);
+
+    QtConcurrent::blockingMap(ids, [&](uint32_t &id) {
+        function(id, uint32_t(uint64_t(rows) * id / nBands), uint32_t(uint64_t(rows) * (id + 1) / nBands));
+    });
+}
+
+/** Histogram of nBins bins of a channel, bin(sample) giving the bin of each sample. Each thread fills its own bins. */
+template <typename T, typename Bin>
+QVector<uint32_t> binHistogram(const T *data, uint32_t width, uint32_t height, uint32_t nBins, Bin bin)
+{
+    QVector<QVector<uint32_t>> histograms(threadBands(height));
+
+    forEachThreadBand(height, [&](uint32_t id, uint32_t first, uint32_t last) {
+        QVector<uint32_t> &histogram = histograms[id];
+        histogram.fill(0, nBins);
+        uint32_t *bins   = histogram.data();
+        const T *samples = data + first * width;
+        for (uint32_t i = 0, count = (last - first) * width; i < count; i++)
+            bins[bin(samples[i])]++;
+    });
+
+    QVector<uint32_t> &result = histograms[0];
+    for (int n = 1; n < histograms.count(); n++)
+    {
+        const uint32_t *bins = histograms[n].constData();
+        for (uint32_t i = 0; i < nBins; i++)
+            result[i] += bins[i];
+    }
+
+    return result;
+}
+
+/** Histogram of a channel, in histogramBins() bins between min and max */
+template <typename T>
+QVector<uint32_t> histogramChannel(const T *data, uint32_t width, uint32_t height, T min, T max)
+{
+    const uint32_t nBins = histogramBins<T>();
+    const double scale   = histogramScale(min, max, nBins);
+
+    return binHistogram(data, width, height, nBins,
+                        [=](T value) { return histogramBin(value, min, scale, nBins, UsesLUT<T>()); });
+}
+
+/** Rank of the median of count samples. Medians of even counts are the lower of the two middle samples. */
+inline uint64_t medianRank(uint64_t count)
+{
+    return count > 0 ? (count - 1) / 2 : 0;
+}
+
+/** Bin holding the sample of rank k (from 0) of a histogram. before is set to the number of samples in the bins below. */
+inline uint32_t rankBin(const QVector<uint32_t> &histogram, uint64_t k, uint64_t *before)
+{
+    uint64_t cumulative = 0;
+    for (int bin = 0; bin < histogram.count() - 1; bin++)
+    {
+        if (cumulative + histogram[bin] > k)
+        {
+            *before = cumulative;
+            return bin;
+        }
+        cumulative += histogram[bin];
+    }
+
+    *before = cumulative;
+    return histogram.count() - 1;
+}
+
+/**
+ * Exact value of rank k among value(sample) for all samples of a channel. frequency is the histogram of these values,
+ * bin(sample) giving the bin of each sample. The values of the bin holding rank k are collected in parallel and
+ * partially sorted.
+ */
+template <typename T, typename Bin, typename Value>
+double selectRank(const T *data, uint32_t width, uint32_t height, const QVector<uint32_t> &frequency, uint64_t k,
+                  Bin bin, Value value)
+{
+    uint64_t before      = 0;
+    const uint32_t target = rankBin(frequency, k, &before);
+
+    QVector<QVector<double>> parts(threadBands(height));
+    forEachThreadBand(height, [&](uint32_t id, uint32_t first, uint32_t last) {
+        QVector<double> &part = parts[id];
+        const T *samples      = data + first * width;
+        for (uint32_t i = 0, count = (last - first) * width; i < count; i++)
+        {
+            if (bin(samples[i]) == target)
+                part.append(value(samples[i]));
+        }
+    });
+
+    QVector<double> values;
+    values.reserve(frequency[target]);
+    for (const QVector<double> &part : parts)
+        values += part;
+
+    if (values.isEmpty())
+        return 0;
+
+    auto nth = values.begin() + std::min<uint64_t>(k - before, values.size() - 1);
+    std::nth_element(values.begin(), nth, values.end());
+    return *nth;
+}
+
+/**
+ * Exact median of a channel, given its histogramChannel() between min and max. 8 and 16 bit data has one bin
+ * per value, so the median is read from the histogram. Other types collect the samples of the median bin.
+ */
+template <typename T>
+double medianOfChannel(const T *data, uint32_t width, uint32_t height, T min, T max, const QVector<uint32_t> &histogram)
+{
+    const uint64_t k     = medianRank(uint64_t(width) * height);
+    const uint32_t nBins = histogramBins<T>();
+
+    if (UsesLUT<T>::value)
+    {
+        uint64_t before = 0;
+        return rankBin(histogram, k, &before) + static_cast<double>(std::numeric_limits<T>::min());
+    }
+
+    const double scale = histogramScale(min, max, nBins);
+    return selectRank(data, width, height, histogram, k,
+                      [=](T value) { return histogramBin(value, min, scale, nBins, UsesLUT<T>()); },
+                      [](T value) { return static_cast<double>(value); });
+}
+
+/**
+ * Exact median absolute deviation of a channel from its median, given its histogramChannel() between min and max.
+ * For 8 and 16 bit data the histogram of the deviations is derived from the histogram of the values. Other types
+ * need one pass for the histogram of the deviations, and another one for the samples of the median bin.
+ */
+template <typename T>
+double madOfChannel(const T *data, uint32_t width, uint32_t height, T min, T max, const QVector<uint32_t> &histogram,
+                    double median)
+{
+    const uint64_t k     = medianRank(uint64_t(width) * height);
+    const uint32_t nBins = histogramBins<T>();
+
+    if (UsesLUT<T>::value)
+    {
+        // The median is one of the values, so deviations are integers below nBins
+        const double lowest = std::numeric_limits<T>::min();
+        QVector<uint32_t> deviations(nBins, 0);
+        for (uint32_t bin = 0; bin < nBins; bin++)
+        {
+            if (histogram[bin])
+                deviations[std::min(static_cast<uint32_t>(std::fabs(bin + lowest - median)), nBins - 1)] += histogram[bin];
+        }
+
+        uint64_t before = 0;
+        return rankBin(deviations, k, &before);
+    }
+
+    const double maxDeviation = std::max(static_cast<double>(max) - median, median - static_cast<double>(min));
+    const double scale        = histogramScale(0, maxDeviation, nBins);
+    auto deviation            = [=](T value) { return std::fabs(static_cast<double>(value) - median); };
+    auto bin                  = [=](T value) { return valueBin(deviation(value), 0, scale, nBins); };
+
+    return selectRank(data, width, height, binHistogram(data, width, height, nBins, bin), k, bin, deviation);
+}
+
+/**
+ * Histogram equalization of a channel. Its histogram, as returned by histogramChannel() for the same
+ * min and max, is turned into a lookup table from bins to output values in [0, 255], bounded to [min, max].
+ */
+template <typename T>
+void equalizeChannel(T *data, uint32_t width, uint32_t height, T min, T max, const QVector<uint32_t> &histogram)
+{
+    const uint32_t nBins = histogramBins<T>();
+    const double scale   = histogramScale(min, max, nBins);
+
+    QVector<T> output(nBins);
+    const double coeff = 255.0 / (static_cast<double>(width) * height);
+    uint64_t cumulative = 0;
+    for (uint32_t bin = 0; bin < nBins; bin++)
+    {
+        cumulative += histogram[bin];
+        output[bin] = std::min(std::max(toSample<T>(coeff * cumulative), min), max);
+    }
+
+    const T *table = output.constData();
+    forEachBand(height, [=](uint32_t first, uint32_t last) {
+        T *samples = data + first * width;
+        for (uint32_t i = 0, count = (last - first) * width; i < count; i++)
+            samples[i] = table[histogramBin(samples[i], min, scale, nBins, UsesLUT<T>())];
+    });
+}
+
+template <typename T>
+inline void sort2(T &a, T &b)
+{
+    const T lo = std::min(a, b);
+    b          = std::max(a, b);
+    a          = lo;
+}
+
+/** Median of nine values with a sorting network of 19 comparisons, p is modified */
+template <typename T>
+inline T median9(T *p)
+{
+    sort2(p[1], p[2]);
+    sort2(p[4], p[5]);
+    sort2(p[7], p[8]);
+    sort2(p[0], p[1]);
+    sort2(p[3], p[4]);
+    sort2(p[6], p[7]);
+    sort2(p[1], p[2]);
+    sort2(p[4], p[5]);
+    sort2(p[7], p[8]);
+    sort2(p[0], p[3]);
+    sort2(p[5], p[8]);
+    sort2(p[4], p[7]);
+    sort2(p[3], p[6]);
+    sort2(p[1], p[4]);
+    sort2(p[2], p[5]);
+    sort2(p[4], p[7]);
+    sort2(p[4], p[2]);
+    sort2(p[6], p[4]);
+    sort2(p[4], p[2]);
+    return p[4];
+}
+
+/** 3x3 median filter of a channel. Samples outside the image repeat the nearest edge. */
+template <typename T>
+void medianChannel(T *data, uint32_t width, uint32_t height)
+{
+    QVector<T> copy(static_cast<int>(width * height));
+    memcpy(copy.data(), data, width * height * sizeof(T));
+    const T *source = copy.constData();
+
+    forEachBand(height, [=](uint32_t first, uint32_t last) {
+        T window[9];
+
+        for (uint32_t y = first; y < last; y++)
+        {
+            const T *rows[3] = { source + (y > 0 ? y - 1 : 0) * width, source + y * width,
+                                 source + (y + 1 < height ? y + 1 : y) * width };
+            T *target = data + y * width;
+
+            for (uint32_t x = 0; x < width; x++)
+            {
+                const uint32_t left = x > 0 ? x - 1 : 0, right = x + 1 < width ? x + 1 : x;
+                for (int r = 0; r < 3; r++)
+                {
+                    window[3 * r]     = rows[r][left];
+                    window[3 * r + 1] = rows[r][x];
+                    window[3 * r + 2] = rows[r][right];
+                }
+                target[x] = median9(window);
+            }
+        }
+    });
+}
+}
@@ -20,7 +20,6 @@
 
 #include <KMessageBox>
 
-#include <zlib.h>
 
 histogramUI::histogramUI(QDialog *parent) : QDialog(parent)
 {
@@ -78,58 +77,12 @@ void FITSHistogram::showEvent(QShowEvent *)
    syncGUI();
 }
 
-void FITSHistogram::constructHistogram()
-{
-    FITSData *image_data = tab->getView()->getImageData();
-
-    isGUISynced = false;
-
-    switch (image_data->getDataType())
-    {
-        case TBYTE:
-            constructHistogram<uint8_t>();
-            break;
-
-        case TSHORT:
-            constructHistogram<int16_t>();
-            break;
-
-        case TUSHORT:
-            constructHistogram<uint16_t>();
-            break;
-
-        case TLONG:
-            constructHistogram<int32_t>();
-            break;
-
-        case TULONG:
-            constructHistogram<uint32_t>();
-            break;
-
-        case TFLOAT:
-            constructHistogram<float>();
-            break;
-
-        case TLONGLONG:
-            constructHistogram<int64_t>();
-            break;
-
-        case TDOUBLE:
-            constructHistogram<double>();
-            break;
-
-        default:
-            break;
-    }
-}
-
-template <typename T>
 void FITSHistogram::constructHistogram()
 {
     uint16_t fits_w = 0, fits_h = 0;
     FITSData *image_data = tab->getView()->getImageData();
 
-    T *buffer = reinterpret_cast<T *>(image_data->getImageBuffer());
+    isGUISynced = false;
 
     image_data->getDimensions(&fits_w, &fits_h);
     image_data->getMinMax(&fits_min, &fits_max);
@@ -150,42 +103,44 @@ void FITSHistogram::constructHistogram()
     for (int i = 0; i < binCount; i++)
         intensity[i] = fits_min + (binWidth * i);
 
-    uint16_t r_id = 0;
-
-    if (image_data->getNumOfChannels() == 1)
+    // The fine histogram of FITSData, computed over all pixels once per image, is regrouped into the bins displayed
+    auto regroup = [&](uint8_t channel, QVector<double> &frequency)
     {
-        for (uint32_t i = 0; i < samples; i += 4)
+        double engineMin = 0, engineBinWidth = 0;
+        const QVector<uint32_t> &engineFrequency = image_data->getHistogram(channel, &engineMin, &engineBinWidth);
+
+        for (int i = 0; i < engineFrequency.size(); i++)
         {
-            r_id = round((buffer[i] - fits_min) / binWidth);
-            r_frequency[r_id >= binCount ? binCount - 1 : r_id] += 4;
+            if (engineFrequency[i] == 0)
+                continue;
+
+            int id = 0;
+            if (binWidth > 0)
+                id = qBound(0, static_cast<int>(round((engineMin + i * engineBinWidth - fits_min) / binWidth)), binCount - 1);
+            frequency[id] += engineFrequency[i];
         }
-    }
-    else
+    };
+
+    regroup(0, r_frequency);
+
+    if (image_data->getNumOfChannels() > 1)
     {
         g_frequency.fill(0, binCount);
         b_frequency.fill(0, binCount);
 
-        int g_offset = samples;
-        int b_offset = samples * 2;
-        for (uint32_t i = 0; i < samples; i += 4)
-        {
-            uint16_t g_id = 0, b_id = 0;
-
-            r_id = round((buffer[i] - fits_min) / binWidth);
-            r_frequency[r_id >= binCount ? binCount - 1 : r_id] += 4;
-
-            g_id = round((buffer[i + g_offset] - fits_min) / binWidth);
-            g_frequency[g_id >= binCount ? binCount - 1 : g_id] += 4;
-
-            b_id = round((buffer[i + b_offset] - fits_min) / binWidth);
-            b_frequency[b_id >= binCount ? binCount - 1 : b_id] += 4;
-        }
+        regroup(1, g_frequency);
+        regroup(2, b_frequency);
     }
 
     // Cumulative Frequency
+    double cumulative = 0;
     for (int i = 0; i < binCount; i++)
-        for (int j = 0; j <= i; j++)
-            cumulativeFrequency[i] += r_frequency[j];
+    {
+        cumulative += r_frequency[i];
+        cumulativeFrequency[i] = cumulative;
+    }
+
+    maxFrequency = 0;
 
     if (image_data->getNumOfChannels() == 1)
     {
@@ -208,22 +163,9 @@ void FITSHistogram::constructHistogram()
         }
     }
 
-    double median      = 0;
-    int halfCumulative = cumulativeFrequency[binCount - 1] / 2;
-    for (int i = 0; i < binCount; i++)
-    {
-        if (cumulativeFrequency[i] >= halfCumulative)
-        {
-            median = i * binWidth + fits_min;
-            break;
-        }
-    }
-
     // Custom index to indicate the overall constrast of the image
     JMIndex = cumulativeFrequency[binCount / 8] / cumulativeFrequency[binCount / 4];
     qCDebug(KSTARS_FITS) << "FITHistogram: JMIndex " << JMIndex;
-
-    image_data->setMedian(median);    
 }
 
 void FITSHistogram::syncGUI()
@@ -528,121 +470,32 @@ FITSHistogramCommand::FITSHistogramCommand(QWidget *parent, FITSHistogram *inHis
     histogram = inHisto;
     min       = lmin;
     max       = lmax;
-}
 
-FITSHistogramCommand::~FITSHistogramCommand()
-{
-    delete[] delta;
+    // Tiles released to stay within the memory budget cannot be restored
+    undoStore.setReleaseHandler([this]() { markUnrecoverable(); });
 }
 
-bool FITSHistogramCommand::calculateDelta(uint8_t *buffer)
+FITSHistogramCommand::~FITSHistogramCommand()
 {
-    FITSData *image_data = tab->getView()->getImageData();
-
-    uint8_t *image_buffer    = image_data->getImageBuffer();
-    int totalPixels          = image_data->getSize() * image_data->getNumOfChannels();
-    unsigned long totalBytes = totalPixels * image_data->getBytesPerPixel();
-
-    uint8_t *raw_delta = new uint8_t[totalBytes];
-
-    if (raw_delta == nullptr)
-    {
-        qWarning() << "Error! not enough memory to create image delta" << endl;
-        return false;
-    }
-
-    for (unsigned int i = 0; i < totalBytes; i++)
-        raw_delta[i] = buffer[i] ^ image_buffer[i];
-
-    compressedBytes = sizeof(uint8_t) * totalBytes + totalBytes / 64 + 16 + 3;
-    delete[] delta;
-    delta = new uint8_t[compressedBytes];
-
-    if (delta == nullptr)
-    {
-        delete[] raw_delta;
-        qCCritical(KSTARS_FITS) << "FITSHistogram Error: Ran out of memory compressing delta";
-        return false;
-    }
-
-    int r = compress2(delta, &compressedBytes, raw_delta, totalBytes, 5);
-
-    if (r != Z_OK)
-    {
-        delete[] raw_delta;
-        /* this should NEVER happen */
-        qCCritical(KSTARS_FITS) << "FITSHistogram Error: Failed to compress raw_delta";
-        return false;
-    }
-
-    //qDebug() << "compressed bytes size " << compressedBytes << " bytes" << endl;
-
-    delete[] raw_delta;
-
-    return true;
 }
 
-bool FITSHistogramCommand::reverseDelta()
+void FITSHistogramCommand::redo()
 {
-    FITSView *image       = tab->getView();
-    FITSData *image_data  = image->getImageData();
-    uint8_t *image_buffer = (image_data->getImageBuffer());
-
-    unsigned int size = image_data->getSize();
-    int channels      = image_data->getNumOfChannels();
-
-    int totalPixels          = size * channels;
-    unsigned long totalBytes = totalPixels * image_data->getBytesPerPixel();
-
-    uint8_t *output_image = new uint8_t[totalBytes];
-
-    if (output_image == nullptr)
-    {
-        qWarning() << "Error! not enough memory to create output image" << endl;
-        return false;
-    }
-
-    uint8_t *raw_delta = new uint8_t[totalBytes];
-
-    if (raw_delta == nullptr)
-    {
-        delete[] output_image;
-        qWarning() << "Error! not enough memory to create image delta" << endl;
-        return false;
-    }
-
-    int r = uncompress(raw_delta, &totalBytes, delta, compressedBytes);
-    if (r != Z_OK)
+    // Applying the filter again would apply it twice
+    if (unrecoverable)
     {
-        qCCritical(KSTARS_FITS) << "FITSHistogram compression error in reverseDelta()";
-        delete[] output_image;
-        delete[] raw_delta;
-        return false;
+        qCWarning(KSTARS_FITS) << "FITS undo data for" << text() << "is no longer available";
+        return;
     }
 
-    for (unsigned int i = 0; i < totalBytes; i++)
-        output_image[i] = raw_delta[i] ^ image_buffer[i];
-
-    image_data->setImageBuffer(output_image);
-
-    delete[] raw_delta;
-
-    return true;
-}
-
-void FITSHistogramCommand::redo()
-{
     FITSView *image      = tab->getView();
     FITSData *image_data = image->getImageData();
 
     uint8_t *image_buffer = image_data->getImageBuffer();
-    unsigned int size     = image_data->getSize();
-    int channels          = image_data->getNumOfChannels();
-    int BBP               = image_data->getBytesPerPixel();
 
     QApplication::setOverrideCursor(Qt::WaitCursor);
 
-    if (delta != nullptr)
+    if (undoStore.isValid())
     {
         double min, max, stddev, average, median, snr;
         min     = image_data->getMin();
@@ -652,7 +505,11 @@ void FITSHistogramCommand::redo()
         median  = image_data->getMedian();
         snr     = image_data->getSNR();
 
-        reverseDelta();
+        if (swapTiles() == false)
+        {
+            QApplication::restoreOverrideCursor();
+            return;
+        }
 
         restoreStats();
 
@@ -670,16 +527,8 @@ void FITSHistogramCommand::redo()
         }
         else
         {
-            uint8_t *buffer = new uint8_t[size * channels * BBP];
-
-            if (buffer == nullptr)
-            {
-                qWarning() << "Error! not enough memory to create image buffer in redo()" << endl;
-                QApplication::restoreOverrideCursor();
-                return;
-            }
-
-            memcpy(buffer, image_buffer, size * channels * BBP);
+            // Only the tiles changed by the filter are kept, compressed in the background
+            undoStore.capture(image_buffer, bufferSize());
             double dataMin = min, dataMax = max;
 
             switch (type)
@@ -702,8 +551,7 @@ void FITSHistogramCommand::redo()
                     break;
             }
 
-            calculateDelta(buffer);
-            delete[] buffer;
+            undoStore.commit(image_data->getImageBuffer());
         }
     }
 
@@ -724,12 +572,19 @@ void FITSHistogramCommand::redo()
 
 void FITSHistogramCommand::undo()
 {
+    // The image keeps the filter
+    if (unrecoverable)
+    {
+        qCWarning(KSTARS_FITS) << "FITS undo data for" << text() << "is no longer available";
+        return;
+    }
+
     FITSView *image      = tab->getView();
     FITSData *image_data = image->getImageData();
 
     QApplication::setOverrideCursor(Qt::WaitCursor);
 
-    if (delta != nullptr)
+    if (undoStore.isValid())
     {
         double min, max, stddev, average, median, snr;
         min     = image_data->getMin();
@@ -739,7 +594,11 @@ void FITSHistogramCommand::undo()
         median  = image_data->getMedian();
         snr     = image_data->getSNR();
 
-        reverseDelta();
+        if (swapTiles() == false)
+        {
+            QApplication::restoreOverrideCursor();
+            return;
+        }
 
         restoreStats();
 
@@ -805,6 +664,38 @@ QString FITSHistogramCommand::text() const
     return i18n("Unknown");
 }
 
+uint64_t FITSHistogramCommand::bufferSize() const
+{
+    FITSData *image_data = tab->getView()->getImageData();
+
+    return static_cast<uint64_t>(image_data->getSize()) * image_data->getNumOfChannels() * image_data->getBytesPerPixel();
+}
+
+bool FITSHistogramCommand::swapTiles()
+{
+    FITSData *image_data = tab->getView()->getImageData();
+
+    image_data->invalidateCaches();
+
+    if (undoStore.swap(image_data->getImageBuffer(), bufferSize()) == false)
+    {
+        qCWarning(KSTARS_FITS) << "FITS undo data for" << text() << "is no longer available";
+        markUnrecoverable();
+        return false;
+    }
+
+    return true;
+}
+
+void FITSHistogramCommand::markUnrecoverable()
+{
+    unrecoverable = true;
+#if QT_VERSION >= QT_VERSION_CHECK(5, 9, 0)
+    // The undo stack drops obsolete commands instead of undoing or redoing them
+    setObsolete(true);
+#endif
+}
+
 void FITSHistogramCommand::saveStats(double min, double max, double stddev, double mean, double median, double SNR)
 {
     stats.min    = min;
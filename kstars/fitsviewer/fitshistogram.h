@@ -11,6 +11,7 @@
 #pragma once
 
 #include "fitscommon.h"
+#include "fitsundostore.h"
 #include "ui_fitshistogramui.h"
 
 #include <QDialog>
@@ -59,9 +60,6 @@ class FITSHistogram : public QDialog
     void checkRangeLimit(const QCPRange &range);
 
   private:
-    template <typename T>
-    void constructHistogram();
-
     histogramUI *ui { nullptr };
     FITSTab *tab { nullptr };
 
@@ -109,8 +107,12 @@ class FITSHistogramCommand : public QUndoCommand
         long dim[2];
     } stats;
 
-    bool calculateDelta(uint8_t *buffer);
-    bool reverseDelta();
+    /* Size of the image buffer, in bytes */
+    uint64_t bufferSize() const;
+    /* Exchange the tiles of the image with the ones saved, to undo or redo the filter */
+    bool swapTiles();
+    /* The saved tiles were lost: the filter can neither be undone nor redone, the command is made obsolete */
+    void markUnrecoverable();
     void saveStats(double min, double max, double stddev, double mean, double median, double SNR);
     void restoreStats();
 
@@ -119,7 +121,9 @@ class FITSHistogramCommand : public QUndoCommand
     double min { 0 };
     double max { 0 };
 
-    unsigned char *delta { nullptr };
-    unsigned long compressedBytes { 0 };
+    /// Tiles of the image changed by the filter, before it was applied or after it was undone
+    FITSUndoStore undoStore;
+    /// True once the tiles were released or found corrupted
+    bool unrecoverable { false };
     FITSTab *tab { nullptr };
 };
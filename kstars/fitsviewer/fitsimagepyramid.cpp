@@ -0,0 +1,497 @@
+/*  FITS Image Pyramid
+    Copyright (C) 2026 KStars Developers
+
+    This application is free software; you can redistribute it and/or
+    modify it under the terms of the GNU General Public
+    License as published by the Free Software Foundation; either
+    version 2 of the License, or (at your option) any later version.
+*/
+
+#include "fitsimagepyramid.h"
+
+#include "fitsdata.h"
+
+#include <QPainter>
+#include <QThread>
+#include <QTimer>
+#include <QtConcurrent>
+
+#include <algorithm>
+#include <cmath>
+#include <functional>
+
+// Memory used by the rendered tiles, in kilobytes
+#define TILE_CACHE_SIZE (128 * 1024)
+// Rows rendered by each task when a whole level is rendered
+#define BAND_HEIGHT     64
+// Levels below the top one used for the preview, which is then up to 4x TILE_SIZE wide
+#define PREVIEW_DEPTH   2
+
+FITSImagePyramid::FITSImagePyramid(QObject *parent) : QObject(parent)
+{
+    tiles.setMaxCost(TILE_CACHE_SIZE);
+}
+
+void FITSImagePyramid::setImage(FITSData *data, double min, double max)
+{
+    tiles.clear();
+    queue.clear();
+    preview = QImage();
+
+    imageData   = data;
+    imageWidth  = 0;
+    imageHeight = 0;
+    topLevel    = 0;
+
+    if (imageData == nullptr)
+        return;
+
+    imageWidth  = imageData->getWidth();
+    imageHeight = imageData->getHeight();
+    channels    = (imageData->getNumOfChannels() == 1) ? 1 : 3;
+
+    while (levelSize(topLevel).width() > TILE_SIZE || levelSize(topLevel).height() > TILE_SIZE)
+        topLevel++;
+    previewLevel = qMax(0, topLevel - PREVIEW_DEPTH);
+
+    if (min == max)
+    {
+        bscale = 0;
+        bzero  = 255;
+    }
+    else
+    {
+        bscale = 255. / (max - min);
+        bzero  = (-min) * bscale;
+    }
+}
+
+int FITSImagePyramid::levelForScale(double scale) const
+{
+    if (scale >= 1)
+        return 0;
+
+    int level = static_cast<int>(std::floor(std::log2(1. / scale)));
+    return qBound(0, level, topLevel);
+}
+
+QSize FITSImagePyramid::levelSize(int level) const
+{
+    const int block = 1 << level;
+    return QSize((imageWidth + block - 1) >> level, (imageHeight + block - 1) >> level);
+}
+
+QRect FITSImagePyramid::tileRect(int level, int x, int y) const
+{
+    return QRect(x * TILE_SIZE, y * TILE_SIZE, TILE_SIZE, TILE_SIZE) & QRect(QPoint(0, 0), levelSize(level));
+}
+
+QImage FITSImagePyramid::createImage(int width, int height) const
+{
+    if (channels == 3)
+        return QImage(width, height, QImage::Format_RGB32);
+
+    // Tiles are rendered in parallel, so the table is built by the thread-safe initialization of the static
+    static const QVector<QRgb> grayTable = []() {
+        QVector<QRgb> table(256);
+        for (int i = 0; i < 256; i++)
+            table[i] = qRgb(i, i, i);
+        return table;
+    }();
+
+    QImage image(width, height, QImage::Format_Indexed8);
+    image.setColorTable(grayTable);
+    return image;
+}
+
+void FITSImagePyramid::draw(QPainter *painter, const QRect &rect, double scale, bool wait)
+{
+    if (imageData == nullptr || scale <= 0)
+        return;
+
+    const int level          = levelForScale(scale);
+    const double levelScale  = scale * (1 << level);
+    const QSize size         = levelSize(level);
+    const int columns        = (size.width() + TILE_SIZE - 1) / TILE_SIZE;
+    const int rows           = (size.height() + TILE_SIZE - 1) / TILE_SIZE;
+    const double tileDisplay = TILE_SIZE * levelScale;
+
+    const int x0 = qBound(0, static_cast<int>(rect.left() / tileDisplay), columns - 1);
+    const int x1 = qBound(0, static_cast<int>((rect.right() + 1) / tileDisplay), columns - 1);
+    const int y0 = qBound(0, static_cast<int>(rect.top() / tileDisplay), rows - 1);
+    const int y1 = qBound(0, static_cast<int>((rect.bottom() + 1) / tileDisplay), rows - 1);
+
+    QList<TileID> missing;
+    for (int y = y0; y <= y1; y++)
+    {
+        for (int x = x0; x <= x1; x++)
+        {
+            if (tiles.contains(key(level, x, y)) == false)
+                missing.append({ level, x, y });
+        }
+    }
+
+    if (wait)
+        renderTiles(missing);
+    else
+    {
+        // Refine from the center of the area outwards
+        const QPointF center((x0 + x1) / 2., (y0 + y1) / 2.);
+        std::sort(missing.begin(), missing.end(), [center](const TileID &a, const TileID &b)
+        {
+            return std::hypot(a.x - center.x(), a.y - center.y()) < std::hypot(b.x - center.x(), b.y - center.y());
+        });
+        queue = missing;
+    }
+
+    painter->save();
+    painter->setRenderHint(QPainter::Antialiasing, false);
+    painter->setRenderHint(QPainter::SmoothPixmapTransform, true);
+
+    for (int y = y0; y <= y1; y++)
+    {
+        for (int x = x0; x <= x1; x++)
+        {
+            // Round both edges so that neighbouring tiles share them
+            const QRect source = tileRect(level, x, y);
+            const QRect target(QPoint(qRound(source.left() * levelScale), qRound(source.top() * levelScale)),
+                               QPoint(qRound((source.right() + 1) * levelScale) - 1,
+                                      qRound((source.bottom() + 1) * levelScale) - 1));
+
+            QImage *tile = tiles.object(key(level, x, y));
+            if (tile)
+                painter->drawImage(target, *tile);
+            else
+                drawFallback(painter, target, { level, x, y });
+        }
+    }
+
+    painter->restore();
+
+    if (queue.isEmpty() == false && queueScheduled == false)
+    {
+        queueScheduled = true;
+        QTimer::singleShot(0, this, SLOT(renderQueue()));
+    }
+}
+
+void FITSImagePyramid::drawFallback(QPainter *painter, const QRect &target, const TileID &id)
+{
+    const QRect source = tileRect(id.level, id.x, id.y);
+
+    for (int level = id.level + 1; level <= topLevel; level++)
+    {
+        const int shift = level - id.level;
+        QImage *tile    = tiles.object(key(level, id.x >> shift, id.y >> shift));
+
+        if (tile == nullptr)
+            continue;
+
+        const double factor = 1. / (1 << shift);
+        const QRectF area(source.x() * factor - (id.x >> shift) * TILE_SIZE,
+                          source.y() * factor - (id.y >> shift) * TILE_SIZE, source.width() * factor,
+                          source.height() * factor);
+        painter->drawImage(target, *tile, area);
+        return;
+    }
+
+    if (preview.isNull())
+        preview = renderLevel(previewLevel, true);
+
+    const double factor = static_cast<double>(1 << id.level) / (1 << previewLevel);
+    painter->drawImage(target, preview,
+                       QRectF(source.x() * factor, source.y() * factor, source.width() * factor,
+                              source.height() * factor));
+}
+
+void FITSImagePyramid::renderQueue()
+{
+    queueScheduled = false;
+
+    if (imageData == nullptr || queue.isEmpty())
+        return;
+
+    // Small batches, so that the view is repainted between them
+    const int batchSize = qMax(1, QThread::idealThreadCount()) * 2;
+    QList<TileID> batch = queue.mid(0, batchSize);
+    queue.erase(queue.begin(), queue.begin() + batch.size());
+
+    renderTiles(batch);
+
+    if (queue.isEmpty() == false)
+    {
+        queueScheduled = true;
+        QTimer::singleShot(0, this, SLOT(renderQueue()));
+    }
+
+    emit updated();
+}
+
+void FITSImagePyramid::renderTiles(const QList<TileID> &ids)
+{
+    struct Job
+    {
+        TileID id;
+        QList<QImage> children;
+        QImage image;
+    };
+
+    QVector<Job> jobs;
+
+    for (const TileID &id : ids)
+    {
+        if (tiles.contains(key(id.level, id.x, id.y)))
+            continue;
+
+        Job job;
+        job.id = id;
+
+        // Downsample the tiles of the level below if they are all available
+        if (id.level > 0)
+        {
+            for (int n = 0; n < 4; n++)
+            {
+                const int x = id.x * 2 + n % 2;
+                const int y = id.y * 2 + n / 2;
+
+                if (tileRect(id.level - 1, x, y).isEmpty())
+                {
+                    job.children.append(QImage());
+                    continue;
+                }
+
+                QImage *child = tiles.object(key(id.level - 1, x, y));
+                if (child == nullptr)
+                {
+                    job.children.clear();
+                    break;
+                }
+                job.children.append(*child);
+            }
+        }
+
+        jobs.append(job);
+    }
+
+    if (jobs.isEmpty())
+        return;
+
+    std::function<void(Job &)> render = [this](Job &job)
+    {
+        job.image = renderTile(job.id, job.children);
+    };
+
+    QtConcurrent::blockingMap(jobs, render);
+
+    for (const Job &job : jobs)
+        tiles.insert(key(job.id.level, job.id.x, job.id.y), new QImage(job.image),
+                     qMax(1, job.image.bytesPerLine() * job.image.height() / 1024));
+}
+
+QImage FITSImagePyramid::renderTile(const TileID &id, const QList<QImage> &children) const
+{
+    const QRect area = tileRect(id.level, id.x, id.y);
+    QImage tile      = createImage(area.width(), area.height());
+
+    if (children.isEmpty())
+    {
+        renderRegion(id.level, area, tile.bits(), tile.bytesPerLine(), QPoint(0, 0));
+        return tile;
+    }
+
+    const int half = TILE_SIZE / 2;
+
+    for (int n = 0; n < children.count(); n++)
+    {
+        const QImage &child = children.at(n);
+        if (child.isNull())
+            continue;
+
+        const int offsetX = (n % 2) * half;
+        const int offsetY = (n / 2) * half;
+        const int width   = (child.width() + 1) / 2;
+        const int height  = (child.height() + 1) / 2;
+
+        // Odd edges are averaged with themselves
+        for (int j = 0; j < height; j++)
+        {
+            const uchar *row0 = child.constScanLine(2 * j);
+            const uchar *row1 = child.constScanLine(qMin(2 * j + 1, child.height() - 1));
+            uchar *scanLine   = tile.scanLine(offsetY + j);
+
+            for (int i = 0; i < width; i++)
+            {
+                const int i0 = 2 * i;
+                const int i1 = qMin(2 * i + 1, child.width() - 1);
+
+                if (channels == 1)
+                {
+                    scanLine[offsetX + i] = (row0[i0] + row0[i1] + row1[i0] + row1[i1] + 2) / 4;
+                }
+                else
+                {
+                    const QRgb *rgb0 = reinterpret_cast<const QRgb *>(row0);
+                    const QRgb *rgb1 = reinterpret_cast<const QRgb *>(row1);
+                    const QRgb a = rgb0[i0], b = rgb0[i1], c = rgb1[i0], d = rgb1[i1];
+
+                    reinterpret_cast<QRgb *>(scanLine)[offsetX + i] =
+                        qRgb((qRed(a) + qRed(b) + qRed(c) + qRed(d) + 2) / 4,
+                             (qGreen(a) + qGreen(b) + qGreen(c) + qGreen(d) + 2) / 4,
+                             (qBlue(a) + qBlue(b) + qBlue(c) + qBlue(d) + 2) / 4);
+                }
+            }
+        }
+    }
+
+    return tile;
+}
+
+QImage FITSImagePyramid::fullImage()
+{
+    if (imageData == nullptr)
+        return QImage();
+
+    return renderLevel(0, false);
+}
+
+QImage FITSImagePyramid::renderLevel(int level, bool sample)
+{
+    const QSize size = levelSize(level);
+    QImage image     = createImage(size.width(), size.height());
+
+    // Detach once here, the tasks only write to their own rows
+    uchar *bits            = image.bits();
+    const int bytesPerLine = image.bytesPerLine();
+
+    QVector<QRect> bands;
+    for (int y = 0; y < size.height(); y += BAND_HEIGHT)
+        bands.append(QRect(0, y, size.width(), qMin(BAND_HEIGHT, size.height() - y)));
+
+    std::function<void(QRect &)> render = [&](QRect &band)
+    {
+        renderRegion(level, band, bits, bytesPerLine, band.topLeft(), sample);
+    };
+
+    QtConcurrent::blockingMap(bands, render);
+
+    return image;
+}
+
+void FITSImagePyramid::renderRegion(int level, const QRect &area, uchar *bits, int bytesPerLine, const QPoint &offset,
+                                    bool sample) const
+{
+    switch (imageData->getDataType())
+    {
+        case TBYTE:
+            renderRegion<uint8_t>(level, area, bits, bytesPerLine, offset, sample);
+            break;
+
+        case TSHORT:
+            renderRegion<int16_t>(level, area, bits, bytesPerLine, offset, sample);
+            break;
+
+        case TUSHORT:
+            renderRegion<uint16_t>(level, area, bits, bytesPerLine, offset, sample);
+            break;
+
+        case TLONG:
+            renderRegion<int32_t>(level, area, bits, bytesPerLine, offset, sample);
+            break;
+
+        case TULONG:
+            renderRegion<uint32_t>(level, area, bits, bytesPerLine, offset, sample);
+            break;
+
+        case TFLOAT:
+            renderRegion<float>(level, area, bits, bytesPerLine, offset, sample);
+            break;
+
+        case TLONGLONG:
+            renderRegion<int64_t>(level, area, bits, bytesPerLine, offset, sample);
+            break;
+
+        case TDOUBLE:
+            renderRegion<double>(level, area, bits, bytesPerLine, offset, sample);
+            break;
+
+        default:
+            break;
+    }
+}
+
+template <typename T>
+void FITSImagePyramid::renderRegion(int level, const QRect &area, uchar *bits, int bytesPerLine, const QPoint &offset,
+                                    bool sample) const
+{
+    const T *buffer      = reinterpret_cast<const T *>(imageData->getImageBuffer());
+    const uint32_t size  = imageWidth * imageHeight;
+    const int block      = 1 << level;
+    const int width      = area.width();
+    const bool average   = (sample == false && block > 1);
+    const double scale   = bscale;
+    const double zero    = bzero;
+
+    auto toByte = [scale, zero](double value) -> int
+    {
+        return static_cast<int>(qBound(0.0, value * scale + zero, 255.0));
+    };
+
+    // Per output pixel: first raw column and number of raw columns it covers
+    QVector<int> firstColumn(width), columnCount(width);
+    for (int i = 0; i < width; i++)
+    {
+        const int x0 = (area.x() + i) * block;
+        firstColumn[i] = average ? x0 : qMin(x0 + block / 2, imageWidth - 1);
+        columnCount[i] = average ? qMin(block, imageWidth - x0) : 1;
+    }
+
+    QVector<double> sums(average ? width * channels : 0);
+    double value[3] = { 0, 0, 0 };
+
+    for (int j = 0; j < area.height(); j++)
+    {
+        const int y0      = (area.y() + j) * block;
+        const int yFirst  = average ? y0 : qMin(y0 + block / 2, imageHeight - 1);
+        const int yCount  = average ? qMin(block, imageHeight - y0) : 1;
+        uchar *scanLine   = bits + (offset.y() + j) * bytesPerLine;
+
+        if (average)
+        {
+            sums.fill(0);
+            for (int y = yFirst; y < yFirst + yCount; y++)
+            {
+                for (int c = 0; c < channels; c++)
+                {
+                    const T *row = buffer + c * size + y * imageWidth;
+                    double *sum  = sums.data() + c * width;
+
+                    for (int i = 0; i < width; i++)
+                    {
+                        const T *pixel = row + firstColumn[i];
+                        double total   = 0;
+                        for (int k = 0; k < columnCount[i]; k++)
+                            total += pixel[k];
+                        sum[i] += total;
+                    }
+                }
+            }
+        }
+
+        for (int i = 0; i < width; i++)
+        {
+            for (int c = 0; c < channels; c++)
+            {
+                if (average)
+                    value[c] = sums[c * width + i] / (columnCount[i] * yCount);
+                else
+                    value[c] = buffer[c * size + yFirst * imageWidth + firstColumn[i]];
+            }
+
+            if (channels == 1)
+                scanLine[offset.x() + i] = toByte(value[0]);
+            else
+                reinterpret_cast<QRgb *>(scanLine)[offset.x() + i] =
+                    qRgb(toByte(value[0]), toByte(value[1]), toByte(value[2]));
+        }
+    }
+}
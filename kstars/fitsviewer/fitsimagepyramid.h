@@ -0,0 +1,136 @@
+/*  FITS Image Pyramid
+    Copyright (C) 2026 KStars Developers
+
+    This application is free software; you can redistribute it and/or
+    modify it under the terms of the GNU General Public
+    License as published by the Free Software Foundation; either
+    version 2 of the License, or (at your option) any later version.
+*/
+
+#pragma once
+
+#include <QCache>
+#include <QImage>
+#include <QList>
+#include <QObject>
+#include <QRect>
+
+class QPainter;
+
+class FITSData;
+
+/**
+ * @class FITSImagePyramid
+ *
+ * Stretched 8 bit display tiles of a FITS image, at several resolutions.
+ *
+ * Level 0 has the resolution of the image and every following level halves it. Each level is
+ * cut into tiles of TILE_SIZE x TILE_SIZE pixels, which are only rendered when they are drawn.
+ * Tiles are rendered from the image data, averaging the pixels they cover, or from the four tiles
+ * of the level below when these are cached already, and kept in a cache of limited size.
+ *
+ * draw() only uses tiles that are ready. Missing tiles are replaced by the closest coarser tile
+ * available, or by a quick preview of the whole image, and queued. The queue is rendered in
+ * parallel batches from the event loop, and updated() is emitted after each batch so the view
+ * can repaint with the finer tiles.
+ *
+ * Tiles are always rendered on the thread owning the pyramid, which waits for the batches it
+ * hands to the thread pool. The image data can hence be modified from that thread at any time,
+ * as long as setImage() is called afterwards.
+ *
+ * @short Multi-resolution tiles of a stretched FITS image
+ */
+class FITSImagePyramid : public QObject
+{
+    Q_OBJECT
+
+  public:
+    static const int TILE_SIZE = 256;
+
+    explicit FITSImagePyramid(QObject *parent = nullptr);
+
+    /**
+     * @brief setImage Drops all tiles and sets the image and its linear stretch
+     * @param data Image data, or nullptr to clear the pyramid
+     * @param min Value displayed as black
+     * @param max Value displayed as white. If equal to min, the image is displayed white.
+     */
+    void setImage(FITSData *data, double min, double max);
+
+    /**
+     * @brief draw Draws the part of the image displayed in rect
+     * @param painter Painter, in the coordinates of the image displayed at scale
+     * @param rect Area to draw, in the same coordinates
+     * @param scale Display scale, 1 being one display pixel per image pixel
+     * @param wait If true, missing tiles are rendered before drawing instead of being queued
+     */
+    void draw(QPainter *painter, const QRect &rect, double scale, bool wait = false);
+
+    /**
+     * @brief fullImage Renders the complete image at full resolution, in parallel.
+     * @return Indexed8 grayscale image for one channel, RGB32 otherwise
+     */
+    QImage fullImage();
+
+    /** @return Level whose resolution is the closest one not lower than scale */
+    int levelForScale(double scale) const;
+
+  signals:
+    /** Queued tiles are now available */
+    void updated();
+
+  private slots:
+    void renderQueue();
+
+  private:
+    struct TileID
+    {
+        int level;
+        int x;
+        int y;
+    };
+
+    static quint64 key(int level, int x, int y)
+    {
+        return (static_cast<quint64>(level) << 48) | (static_cast<quint64>(y) << 24) | static_cast<quint64>(x);
+    }
+
+    /* Area of a tile, in the pixels of its level */
+    QRect tileRect(int level, int x, int y) const;
+    /* Size of a level, in its pixels */
+    QSize levelSize(int level) const;
+    /* Allocate an empty display image of the right format */
+    QImage createImage(int width, int height) const;
+
+    /* Render tiles, in parallel, and add them to the cache */
+    void renderTiles(const QList<TileID> &ids);
+    /* Render one tile from the image data, or from the four tiles of the level below if given */
+    QImage renderTile(const TileID &id, const QList<QImage> &children) const;
+    /* Render a whole level, in parallel bands */
+    QImage renderLevel(int level, bool sample);
+    /* Render area of level into the image at bits, at offset. With sample set, only one pixel is read per output pixel. */
+    void renderRegion(int level, const QRect &area, uchar *bits, int bytesPerLine, const QPoint &offset,
+                      bool sample = false) const;
+    template <typename T>
+    void renderRegion(int level, const QRect &area, uchar *bits, int bytesPerLine, const QPoint &offset,
+                      bool sample) const;
+
+    /* Draw a tile that is not rendered yet from a coarser tile, or from the preview */
+    void drawFallback(QPainter *painter, const QRect &target, const TileID &id);
+
+    FITSData *imageData { nullptr };
+    int imageWidth { 0 };
+    int imageHeight { 0 };
+    int channels { 1 };
+    int topLevel { 0 };
+    int previewLevel { 0 };
+    double bscale { 1 };
+    double bzero { 0 };
+
+    /// Rendered tiles, with their size in kilobytes as cost
+    QCache<quint64, QImage> tiles;
+    /// Coarse image of the whole image, used until the tiles are rendered
+    QImage preview;
+    QList<TileID> queue;
+    bool queueScheduled { false };
+};
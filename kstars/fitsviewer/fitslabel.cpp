@@ -19,12 +19,15 @@
 #include "kstarsdata.h"
 #include "Options.h"
 #include "skymap.h"
+#include "skyobjects/skypoint.h"
 
 #ifdef HAVE_INDI
 #include "basedevice.h"
 #include "indi/indilistener.h"
 #endif
 
+#include <QPainter>
+#include <QPaintEvent>
 #include <QScrollBar>
 
 #define BASE_OFFSET    50
@@ -55,6 +58,17 @@ bool FITSLabel::getMouseButtonDown()
     return mouseButtonDown;
 }
 
+/**
+The image is not held in a pixmap, the view draws the tiles that intersect the exposed area.
+ */
+
+void FITSLabel::paintEvent(QPaintEvent *e)
+{
+    QPainter painter(this);
+
+    view->drawImage(&painter, e->rect());
+}
+
 /**
 This method was added to make the panning function work.
 If the mouse button is released, it resets mouseButtonDown variable and the mouse cursor.
@@ -156,17 +170,12 @@ void FITSLabel::mouseMoveEvent(QMouseEvent *e)
 
     if (view_data->hasWCS() && view->getCursorMode() != FITSView::selectCursor)
     {
-        int index = x + y * width;
-
-        wcs_point *wcs_coord = view_data->getWCSCoord();
+        SkyPoint wcsCoord;
 
-        if (wcs_coord)
+        if (view_data->isWCSLoaded() && view_data->pixelToWCS(QPointF(x, y), wcsCoord))
         {
-            if (index > size)
-                return;
-
-            ra.setD(wcs_coord[index].ra);
-            dec.setD(wcs_coord[index].dec);
+            ra  = wcsCoord.ra0();
+            dec = wcsCoord.dec0();
 
             emit newStatus(QString("%1 , %2").arg(ra.toHMSString(), dec.toDMSString()), FITS_WCS);
         }
@@ -220,24 +229,24 @@ void FITSLabel::mousePressEvent(QMouseEvent *e)
         FITSData *view_data = view->getImageData();
         if (view_data->hasWCS())
         {
-            wcs_point *wcs_coord = view_data->getWCSCoord();
-            if (wcs_coord)
-            {
-                double x, y;
-                x = round(e->x() / scale);
-                y = round(e->y() / scale);
+            double x, y;
+            x = round(e->x() / scale);
+            y = round(e->y() / scale);
+
+            x = KSUtils::clamp(x, 1.0, width);
+            y = KSUtils::clamp(y, 1.0, height);
 
-                x         = KSUtils::clamp(x, 1.0, width);
-                y         = KSUtils::clamp(y, 1.0, height);
-                int index = x + y * width;
+            SkyPoint wcsCoord;
+            if (view_data->isWCSLoaded() && view_data->pixelToWCS(QPointF(x, y), wcsCoord))
+            {
                 if (KMessageBox::Continue == KMessageBox::warningContinueCancel(
                                                  nullptr,
-                                                 "Slewing to Coordinates: \nRA: " + dms(wcs_coord[index].ra).toHMSString() +
-                                                     "\nDec: " + dms(wcs_coord[index].dec).toDMSString(),
+                                                 "Slewing to Coordinates: \nRA: " + wcsCoord.ra0().toHMSString() +
+                                                     "\nDec: " + wcsCoord.dec0().toDMSString(),
                                                  i18n("Continue Slew"), KStandardGuiItem::cont(),
                                                  KStandardGuiItem::cancel(), "continue_slew_warning"))
                 {
-                    centerTelescope(wcs_coord[index].ra / 15.0, wcs_coord[index].dec);
+                    centerTelescope(wcsCoord.ra0().Hours(), wcsCoord.dec0().Degrees());
                     view->setCursorMode(view->lastMouseMode);
                     view->updateScopeButton();
                 }
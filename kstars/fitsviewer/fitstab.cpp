@@ -25,7 +25,6 @@
 #include "ui_fitsheaderdialog.h"
 #include "ui_statform.h"
 
-#include <QtConcurrent>
 #include <KMessageBox>
 
 FITSTab::FITSTab(FITSViewer *parent) : QWidget()
@@ -39,8 +38,6 @@ FITSTab::FITSTab(FITSViewer *parent) : QWidget()
 
 FITSTab::~FITSTab()
 {
-    // Make sure it's done
-    histogramFuture.waitForFinished();
     //disconnect();
 }
 
@@ -102,9 +99,6 @@ bool FITSTab::loadFITS(const QUrl *imageURL, FITSMode mode, FITSScale filter, bo
 
     bool imageLoad = view->loadFITS(imageURL->toLocalFile(), silent);
 
-    // If it was already running make sure it's done
-    histogramFuture.waitForFinished();
-
     if (imageLoad)
     {
         if (histogram == nullptr)
@@ -113,10 +107,11 @@ bool FITSTab::loadFITS(const QUrl *imageURL, FITSMode mode, FITSScale filter, bo
         FITSData *image_data = view->getImageData();
         image_data->setHistogram(histogram);
 
-        histogramFuture = QtConcurrent::run([&]() {histogram->constructHistogram();});
-
         image_data->applyFilter(filter);
 
+        // Only regroups the histogram FITSData computed, in parallel, when loading the image
+        histogram->constructHistogram();
+
         if (filter != FITS_NONE)
             view->rescale(ZOOM_KEEP_LEVEL);
 
@@ -124,9 +119,6 @@ bool FITSTab::loadFITS(const QUrl *imageURL, FITSMode mode, FITSScale filter, bo
             view->toggleStars(true);
 
         view->updateFrame();
-
-        //histoFuture.waitForFinished();
-        //histogram->syncGUI();
     }
 
     return imageLoad;
@@ -21,7 +21,6 @@
 #include <QUndoStack>
 #include <QUrl>
 #include <QWidget>
-#include <QFuture>
 
 #include <memory>
 
@@ -95,9 +94,6 @@ class FITSTab : public QWidget
     QString previewText;
     int uid { 0 };
 
-    QFuture<void> histogramFuture;
-
-
   signals:
     void debayerToggled(bool);
     void newStatus(const QString &msg, FITSBar id);
@@ -0,0 +1,191 @@
+/*  FITS Undo Store
+    Copyright (C) 2026 KStars Developers
+
+    This application is free software; you can redistribute it and/or
+    modify it under the terms of the GNU General Public
+    License as published by the Free Software Foundation; either
+    version 2 of the License, or (at your option) any later version.
+*/
+
+#include "fitsundostore.h"
+
+#include "fits_debug.h"
+#include "Options.h"
+
+#include <QtConcurrent>
+
+#include <cstring>
+
+// zlib level used for the tiles, favoring speed over ratio
+#define TILE_COMPRESSION_LEVEL 1
+
+QList<FITSUndoStore *> FITSUndoStore::stores;
+
+FITSUndoStore::FITSUndoStore()
+{
+    stores.append(this);
+}
+
+FITSUndoStore::~FITSUndoStore()
+{
+    release();
+    stores.removeOne(this);
+}
+
+void FITSUndoStore::release()
+{
+    compression.waitForFinished();
+
+    tiles.clear();
+    tiles.squeeze();
+    usage = 0;
+    valid = false;
+}
+
+void FITSUndoStore::capture(const uint8_t *buffer, uint64_t size)
+{
+    release();
+
+    bufferSize = size;
+
+    const uint32_t count = (size + TILE_SIZE - 1) / TILE_SIZE;
+    tiles.resize(count);
+    for (uint32_t i = 0; i < count; i++)
+        tiles[i].index = i;
+
+    // Tiles are compressed as they are copied, the buffer is never held twice in memory
+    usage = size;
+    QtConcurrent::blockingMap(tiles, [this, buffer, size](Tile &tile) {
+        const uint64_t offset = static_cast<uint64_t>(tile.index) * TILE_SIZE;
+        tile.data = QByteArray(reinterpret_cast<const char *>(buffer + offset),
+                               static_cast<int>(qMin<uint64_t>(TILE_SIZE, size - offset)));
+        compressTile(tile, usage);
+    });
+}
+
+void FITSUndoStore::commit(const uint8_t *buffer)
+{
+    // Tiles the modification did not touch are not needed to revert it
+    QtConcurrent::blockingMap(tiles, [this, buffer](Tile &tile) {
+        const QByteArray original = tile.compressed ? qUncompress(tile.data) : tile.data;
+        const uint64_t offset     = static_cast<uint64_t>(tile.index) * TILE_SIZE;
+        if (static_cast<uint64_t>(original.size()) == qMin<uint64_t>(TILE_SIZE, bufferSize - offset) &&
+            memcmp(original.constData(), buffer + offset, original.size()) == 0)
+            tile.data.clear();
+    });
+
+    QVector<Tile> modified;
+    uint64_t size = 0;
+    for (const Tile &tile : tiles)
+    {
+        if (tile.data.isEmpty())
+            continue;
+        modified.append(tile);
+        size += tile.data.size();
+    }
+
+    tiles = modified;
+    usage = size;
+    valid = true;
+
+    // The budget releases the least recently committed stores first
+    stores.removeOne(this);
+    stores.append(this);
+
+    qCDebug(KSTARS_FITS) << "Undo store keeps" << tiles.count() << "modified tiles out of"
+                         << (bufferSize + TILE_SIZE - 1) / TILE_SIZE << "in" << size << "bytes";
+
+    // Tiles are already compressed, the budget is charged with their actual size
+    makeRoom();
+}
+
+bool FITSUndoStore::swap(uint8_t *buffer, uint64_t size)
+{
+    if (valid == false || size != bufferSize)
+        return false;
+
+    compression.waitForFinished();
+
+    // Unpack all tiles first, so the buffer is left untouched if any of them is corrupted
+    std::atomic<bool> unpacked { true };
+    QtConcurrent::blockingMap(tiles, [&unpacked, size](Tile &tile) {
+        if (tile.compressed)
+        {
+            tile.data       = qUncompress(tile.data);
+            tile.compressed = false;
+        }
+
+        const uint64_t offset = static_cast<uint64_t>(tile.index) * TILE_SIZE;
+        if (static_cast<uint64_t>(tile.data.size()) != qMin<uint64_t>(TILE_SIZE, size - offset))
+            unpacked = false;
+    });
+
+    if (unpacked == false)
+    {
+        qCCritical(KSTARS_FITS) << "FITS undo data is corrupted, it is discarded";
+        release();
+        return false;
+    }
+
+    QtConcurrent::blockingMap(tiles, [buffer](Tile &tile) {
+        uint8_t *target = buffer + static_cast<uint64_t>(tile.index) * TILE_SIZE;
+        QByteArray current(reinterpret_cast<const char *>(target), tile.data.size());
+        memcpy(target, tile.data.constData(), tile.data.size());
+        tile.data = current;
+    });
+
+    uint64_t total = 0;
+    for (const Tile &tile : tiles)
+        total += tile.data.size();
+    usage = total;
+
+    compress();
+
+    return true;
+}
+
+void FITSUndoStore::compress()
+{
+    compression = QtConcurrent::map(tiles, [this](Tile &tile) { compressTile(tile, usage); });
+}
+
+void FITSUndoStore::compressTile(Tile &tile, std::atomic<uint64_t> &usage)
+{
+    if (tile.compressed)
+        return;
+
+    QByteArray packed = qCompress(tile.data, TILE_COMPRESSION_LEVEL);
+
+    // Noisy data may not compress at all
+    if (packed.size() >= tile.data.size())
+        return;
+
+    usage -= tile.data.size() - packed.size();
+    tile.data       = packed;
+    tile.compressed = true;
+}
+
+void FITSUndoStore::makeRoom()
+{
+    const uint64_t budget = static_cast<uint64_t>(Options::fITSUndoMemory()) * 1024 * 1024;
+
+    uint64_t total = 0;
+    for (const FITSUndoStore *store : stores)
+        total += store->memoryUsage();
+
+    for (FITSUndoStore *store : stores)
+    {
+        if (total <= budget)
+            break;
+        if (store == this || store->isValid() == false)
+            continue;
+
+        total -= store->memoryUsage();
+        store->release();
+
+        qCInfo(KSTARS_FITS) << "Released FITS undo data to stay within" << Options::fITSUndoMemory() << "MB";
+
+        if (store->releaseHandler)
+            store->releaseHandler();
+    }
+}
@@ -0,0 +1,110 @@
+/*  FITS Undo Store
+    Copyright (C) 2026 KStars Developers
+
+    This application is free software; you can redistribute it and/or
+    modify it under the terms of the GNU General Public
+    License as published by the Free Software Foundation; either
+    version 2 of the License, or (at your option) any later version.
+*/
+
+#pragma once
+
+#include <QByteArray>
+#include <QFuture>
+#include <QList>
+#include <QVector>
+
+#include <atomic>
+#include <functional>
+
+/**
+ * @class FITSUndoStore
+ *
+ * Content of an image buffer before it was modified, kept to undo the modification.
+ *
+ * The buffer is cut into tiles of TILE_SIZE bytes. capture() compresses all of them with the fastest
+ * zlib level before the buffer is modified, so the buffer is not held twice in memory, and commit()
+ * drops those that the modification left unchanged. Filters write the whole buffer, so every tile is
+ * captured: which ones changed is only known once the filter is applied.
+ *
+ * swap() exchanges the stored tiles with the ones of the buffer, so the same store first undoes the
+ * modification, then redoes it. The tiles taken from the buffer are compressed in the background in
+ * the global thread pool.
+ *
+ * The memory used by all stores is limited to the FITSUndoMemory option. When a new modification
+ * exceeds it, the least recently committed stores are released and their modification can no
+ * longer be reverted; their release handler is then called. The last modification is always kept.
+ *
+ * Stores must be used from the GUI thread only.
+ *
+ * @short Compressed tiles of an image buffer, to undo its modification
+ */
+class FITSUndoStore
+{
+  public:
+    static const uint32_t TILE_SIZE = 64 * 1024;
+
+    FITSUndoStore();
+    ~FITSUndoStore();
+
+    /**
+     * @brief capture Copies and compresses the content of buffer, before it is modified
+     * @param buffer Image buffer
+     * @param size Size of the buffer, in bytes
+     */
+    void capture(const uint8_t *buffer, uint64_t size);
+
+    /**
+     * @brief commit Keeps the captured tiles that differ from buffer, then releases other stores over the budget
+     * @param buffer Same image buffer as given to capture(), modified
+     */
+    void commit(const uint8_t *buffer);
+
+    /**
+     * @brief swap Exchanges the stored tiles with the ones of buffer
+     * @param buffer Image buffer, with the same size as the captured one
+     * @param size Size of the buffer, in bytes
+     * @return False if the tiles were released or do not match the buffer, which is then left unchanged
+     */
+    bool swap(uint8_t *buffer, uint64_t size);
+
+    /** Drop all tiles */
+    void release();
+
+    /** @return True if the store holds the tiles of a modification */
+    bool isValid() const { return valid; }
+
+    /**
+     * @brief setReleaseHandler Sets the function called when the store is released to stay within the memory budget
+     * @param handler Function called on the GUI thread, from the commit() of another store
+     */
+    void setReleaseHandler(const std::function<void()> &handler) { releaseHandler = handler; }
+
+    /** @return Memory used by the stored tiles, in bytes */
+    uint64_t memoryUsage() const { return usage; }
+
+  private:
+    struct Tile
+    {
+        uint32_t index { 0 };
+        QByteArray data;
+        bool compressed { false };
+    };
+
+    /* Start compressing the tiles in the global thread pool */
+    void compress();
+    /* Release the least recently committed other stores while all stores use more memory than the budget */
+    void makeRoom();
+
+    static void compressTile(Tile &tile, std::atomic<uint64_t> &usage);
+
+    QVector<Tile> tiles;
+    QFuture<void> compression;
+    uint64_t bufferSize { 0 };
+    bool valid { false };
+    std::atomic<uint64_t> usage { 0 };
+    std::function<void()> releaseHandler;
+
+    /// All stores, least recently committed first
+    static QList<FITSUndoStore *> stores;
+};
@@ -13,6 +13,7 @@
 #include "config-kstars.h"
 
 #include "fitsdata.h"
+#include "fitsimagepyramid.h"
 #include "fitslabel.h"
 #include "kspopupmenu.h"
 #include "kstarsdata.h"
@@ -30,6 +31,8 @@
 
 #include <QtConcurrent>
 
+#include <limits>
+
 #define BASE_OFFSET    50
 #define ZOOM_DEFAULT   100.0
 #define ZOOM_MIN       10
@@ -42,6 +45,7 @@ FITSView::FITSView(QWidget *parent, FITSMode fitsMode, FITSScale filterType) : Q
     grabGesture(Qt::PinchGesture);
 
     image_frame.reset(new FITSLabel(this));
+    pyramid.reset(new FITSImagePyramid(this));
     filter             = filterType;
     mode               = fitsMode;
 
@@ -56,6 +60,8 @@ FITSView::FITSView(QWidget *parent, FITSMode fitsMode, FITSScale filterType) : Q
     connect(image_frame.get(), SIGNAL(pointSelected(int,int)), this, SLOT(processPointSelection(int,int)));
     connect(image_frame.get(), SIGNAL(markerSelected(int,int)), this, SLOT(processMarkerSelection(int,int)));
     connect(&wcsWatcher, SIGNAL(finished()), this, SLOT(syncWCSState()));
+    connect(&starsWatcher, SIGNAL(finished()), this, SLOT(syncStarsState()));
+    connect(pyramid.get(), SIGNAL(updated()), image_frame.get(), SLOT(update()));
 
     image_frame->setMouseTracking(true);
     setCursorMode(
@@ -80,7 +86,9 @@ FITSView::FITSView(QWidget *parent, FITSMode fitsMode, FITSScale filterType) : Q
 FITSView::~FITSView()
 {
     wcsWatcher.waitForFinished();
+    starsWatcher.waitForFinished();
 
+    pyramid->setImage(nullptr, 0, 0);
     delete (imageData);
     delete (display_image);
 }
@@ -158,6 +166,16 @@ void FITSView::resizeEvent(QResizeEvent *event)
 }*/
 
 bool FITSView::loadFITS(const QString &inFilename, bool silent)
+{
+    return loadImageData(inFilename, QByteArray(), silent);
+}
+
+bool FITSView::loadFITSFromMemory(const QByteArray &buffer, bool silent)
+{
+    return loadImageData(QString(), buffer, silent);
+}
+
+bool FITSView::loadImageData(const QString &inFilename, const QByteArray &buffer, bool silent)
 {
     if (floatingToolBar)
         floatingToolBar->setVisible(true);
@@ -173,9 +191,11 @@ bool FITSView::loadFITS(const QString &inFilename, bool silent)
         imageData->getBayerParams(&param);
     }
 
-    // In case loadWCS is still running for previous image data, let's wait until it's over
+    // In case loadWCS or star detection is still running for previous image data, let's wait until it's over
     wcsWatcher.waitForFinished();
+    starsWatcher.waitForFinished();
 
+    pyramid->setImage(nullptr, 0, 0);
     delete imageData;
     imageData = nullptr;
 
@@ -198,7 +218,8 @@ bool FITSView::loadFITS(const QString &inFilename, bool silent)
         qApp->processEvents();
     }
 
-    if (imageData->loadFITS(inFilename, silent) == false)
+    bool rc = buffer.isEmpty() ? imageData->loadFITS(inFilename, silent) : imageData->loadFITSFromMemory(buffer, silent);
+    if (rc == false)
         return false;
 
     if (mode == FITS_NORMAL)
@@ -358,34 +379,22 @@ void FITSView::leaveEvent(QEvent *)
 
 template <typename T>
 int FITSView::rescale(FITSZoom type)
-{    
+{
     double min, max;
-    bool displayBuffer = false;
 
-    if (display_image == nullptr)
+    if (imageData == nullptr)
         return -1;
 
-    uint8_t *image_buffer = imageData->getImageBuffer();
-
-    uint32_t size = imageData->getSize();
-    int BBP       = imageData->getBytesPerPixel();
-
     filter = filterStack.last();
 
     if (Options::autoStretch() && (filter == FITS_NONE || (filter >= FITS_ROTATE_CW && filter <= FITS_FLIP_V)))
     {
-        image_buffer = new uint8_t[imageData->getSize() * imageData->getNumOfChannels() * BBP];
-        memcpy(image_buffer, imageData->getImageBuffer(), imageData->getSize() * imageData->getNumOfChannels() * BBP);
-
-        displayBuffer = true;
+        // Same limits as FITS_AUTO_STRETCH. Values out of them are clamped when the tiles are rendered,
+        // so the image buffer does not need to be copied and filtered.
+        imageData->getAutoStretchLimits(&min, &max);
 
-        double data_min = -1;
-        double data_max = -1;
-
-        imageData->applyFilter(FITS_AUTO_STRETCH, image_buffer, &data_min, &data_max);
-
-        min = data_min;
-        max = data_max;
+        min = qMax(min, static_cast<double>(std::numeric_limits<T>::lowest()));
+        max = qMin(max, static_cast<double>(std::numeric_limits<T>::max()));
     }
     else
     {
@@ -393,127 +402,29 @@ int FITSView::rescale(FITSZoom type)
         imageData->getMinMax(&min, &max);
     }
 
-    T *buffer = reinterpret_cast<T *>(image_buffer);
-
     if (min == max)
-    {
-        display_image->fill(Qt::white);
         emit newStatus(i18n("Image is saturated!"), FITS_MESSAGE);
-    }
-    else
-    {
-        double bscale = 255. / (max - min);
-        double bzero  = (-min) * (255. / (max - min));
-
-        if (image_height != imageData->getHeight() || image_width != imageData->getWidth())
-        {
-            image_width  = imageData->getWidth();
-            image_height = imageData->getHeight();
-
-            initDisplayImage();
-
-            if (isVisible())
-                emit newStatus(QString("%1x%2").arg(image_width).arg(image_height), FITS_RESOLUTION);
-        }
-
-        image_frame->setScaledContents(true);
-        currentWidth  = display_image->width();
-        currentHeight = display_image->height();
-
-        if (imageData->getNumOfChannels() == 1)
-        {
-            QList<QFuture<void>> futures;
-
-            /* Fill in pixel values using indexed map, linear scale */
-            for (uint32_t j = 0; j < image_height; j++)
-            {                
-                futures.append(QtConcurrent::run([=]()
-                {
-                    T *runningBuffer = buffer +j*image_width;
-                    uint8_t *scanLine = display_image->scanLine(j);
-                    for (uint32_t i = 0; i < image_width; i++)
-                    {
-                        //scanLine[i] = qBound(0, static_cast<uint8_t>(runningBuffer[i] * bscale + bzero), 255);
-                        scanLine[i] = qBound(0.0, runningBuffer[i] * bscale + bzero, 255.0);
-                    }
-                }));
-            }
-
-            for(QFuture<void> future : futures)
-                future.waitForFinished();
-        }
-        else
-        {
-            QList<QFuture<void>> futures;
-            /* Fill in pixel values using indexed map, linear scale */
-            for (uint32_t j = 0; j < image_height; j++)
-            {                
-                futures.append(QtConcurrent::run([=]()
-                {
-                    QRgb *scanLine = reinterpret_cast<QRgb *>((display_image->scanLine(j)));
-                    T *runningBufferR = buffer + j*image_width;
-                    T *runningBufferG = buffer + j*image_width + size;
-                    T *runningBufferB = buffer + j*image_width + size*2;
 
-                    for (uint32_t i = 0; i < image_width; i++)
-                    {
-                        scanLine[i] = qRgb(runningBufferR[i] * bscale + bzero,
-                                           runningBufferG[i] * bscale + bzero,
-                                           runningBufferB[i] * bscale + bzero);;
-                    }
-                }));
-            }
-
-            for(QFuture<void> future : futures)
-                future.waitForFinished();
-        }
+    if (image_height != imageData->getHeight() || image_width != imageData->getWidth())
+    {
+        image_width  = imageData->getWidth();
+        image_height = imageData->getHeight();
 
-#if 0
-        if (imageData->getNumOfChannels() == 1)
-               {
-                   /* Fill in pixel values using indexed map, linear scale */
-                   for (int j = 0; j < image_height; j++)
-                   {
-                       unsigned char *scanLine = display_image->scanLine(j);
-
-                       for (int i = 0; i < image_width; i++)
-                       {
-                           val         = buffer[j * image_width + i] * bscale + bzero;
-                           scanLine[i] = qBound(0.0, val, 255.0);
-                       }
-                   }
-               }
-               else
-               {
-                   double rval = 0, gval = 0, bval = 0;
-                   QRgb value;
-                   /* Fill in pixel values using indexed map, linear scale */
-                   for (int j = 0; j < image_height; j++)
-                   {
-                       QRgb *scanLine = reinterpret_cast<QRgb *>((display_image->scanLine(j)));
-
-                       for (int i = 0; i < image_width; i++)
-                       {
-                           rval = buffer[j * image_width + i];
-                           gval = buffer[j * image_width + i + size];
-                           bval = buffer[j * image_width + i + size * 2];
-
-                           value = qRgb(rval * bscale + bzero, gval * bscale + bzero, bval * bscale + bzero);
-
-                           scanLine[i] = value;
-                       }
-                   }
-               }
-#endif
+        if (isVisible())
+            emit newStatus(QString("%1x%2").arg(image_width).arg(image_height), FITS_RESOLUTION);
     }
 
-    if (displayBuffer)
-        delete[] image_buffer;
+    // Only the tiles that are displayed get rendered, when they are painted
+    initDisplayImage();
+    pyramid->setImage(imageData, min, max);
+
+    currentWidth  = image_width;
+    currentHeight = image_height;
 
     switch (type)
     {
         case ZOOM_FIT_WINDOW:
-            if ((display_image->width() > width() || display_image->height() > height()))
+            if ((static_cast<int>(image_width) > width() || static_cast<int>(image_height) > height()))
             {
                 double w = baseSize().width() - BASE_OFFSET;
                 double h = baseSize().height() - BASE_OFFSET;
@@ -617,7 +528,7 @@ void FITSView::ZoomOut()
 
 void FITSView::ZoomToFit()
 {
-    if (display_image)
+    if (imageData)
     {
         rescale(ZOOM_FIT_WINDOW);
         updateFrame();
@@ -626,27 +537,12 @@ void FITSView::ZoomToFit()
 
 void FITSView::updateFrame()
 {
-    QPixmap displayPixmap;
-    bool ok = false;
-
-    if (display_image == nullptr)
+    if (imageData == nullptr)
         return;
 
-    if (currentZoom != ZOOM_DEFAULT)
-        ok = displayPixmap.convertFromImage(
-            display_image->scaled(currentWidth, currentHeight, Qt::KeepAspectRatio, Qt::SmoothTransformation));
-    else
-        ok = displayPixmap.convertFromImage(*display_image);
-
-    if (ok == false)
-        return;
-
-    QPainter painter(&displayPixmap);
-
-    drawOverlay(&painter);
-
-    image_frame->setPixmap(displayPixmap);
+    // The visible part of the image is drawn by image_frame when it is repainted
     image_frame->resize(currentWidth, currentHeight);
+    image_frame->update();
 }
 
 void FITSView::ZoomDefault()
@@ -672,7 +568,8 @@ void FITSView::drawOverlay(QPainter *painter)
 {
     painter->setRenderHint(QPainter::Antialiasing, Options::useAntialias());
 
-    if (markStars)
+    // Stars being detected in the background are drawn once syncStarsState() is called
+    if (markStars && starsWatcher.isRunning() == false)
         drawStarCentroid(painter);
 
     if (trackingBoxEnabled && getCursorMode() != FITSView::scopeCursor)
@@ -870,28 +767,13 @@ void FITSView::drawEQGrid(QPainter *painter)
 
     if (imageData->hasWCS())
     {
-        wcs_point *wcs_coord = imageData->getWCSCoord();
-        if (wcs_coord)
-        {
-            int size      = image_width * image_height;
-            double maxRA  = -1000;
-            double minRA  = 1000;
-            double maxDec = -1000;
-            double minDec = 1000;
+        double maxRA  = -1000;
+        double minRA  = 1000;
+        double maxDec = -1000;
+        double minDec = 1000;
 
-            for (int i = 0; i < (size); i++)
-            {
-                double ra  = wcs_coord[i].ra;
-                double dec = wcs_coord[i].dec;
-                if (ra > maxRA)
-                    maxRA = ra;
-                if (ra < minRA)
-                    minRA = ra;
-                if (dec > maxDec)
-                    maxDec = dec;
-                if (dec < minDec)
-                    minDec = dec;
-            }
+        if (imageData->getWCSBounds(minRA, maxRA, minDec, maxDec))
+        {
             int minDecMinutes = (int)(minDec * 12); //This will force the Dec Scale to 5 arc minutes in the loop
             int maxDecMinutes = (int)(maxDec * 12);
 
@@ -1141,7 +1023,13 @@ QPixmap &FITSView::getTrackingBoxPixmap()
     int w  = trackingBox.width() * (currentZoom / ZOOM_DEFAULT);
     int h  = trackingBox.height() * (currentZoom / ZOOM_DEFAULT);
 
-    trackingBoxPixmap = image_frame->grab(QRect(x1, y1, w, h));
+    // Render the box completely instead of grabbing tiles that may not be refined yet
+    trackingBoxPixmap = QPixmap(w, h);
+    trackingBoxPixmap.fill(Qt::black);
+
+    QPainter painter(&trackingBoxPixmap);
+    painter.translate(-x1, -y1);
+    drawImage(&painter, QRect(x1, y1, w, h), true);
 
     return trackingBoxPixmap;
 }
@@ -1340,20 +1228,38 @@ int FITSView::findStars(StarAlgorithm algorithm, const QRect &searchBox)
     return count;
 }
 
+QFuture<int> FITSView::findStarsAsync(StarAlgorithm algorithm, const QRect &searchBox)
+{
+    QFuture<int> future = imageData->findStarsAsync(algorithm, trackingBoxEnabled ? trackingBox : searchBox);
+
+    starsWatcher.setFuture(future);
+    return future;
+}
+
+void FITSView::syncStarsState()
+{
+    if (starsWatcher.isCanceled())
+        return;
+
+    int count = starsWatcher.result();
+
+    if (markStars)
+        updateFrame();
+
+    if (count >= 0 && isVisible())
+        emit newStatus(i18np("1 star detected.", "%1 stars detected.", count), FITS_MESSAGE);
+
+    emit starsFound(count);
+}
+
 void FITSView::toggleStars(bool enable)
 {
     markStars = enable;
 
-    if (markStars == true && imageData->areStarsSearched() == false)
+    if (markStars == true && imageData->areStarsSearched() == false && starsWatcher.isRunning() == false)
     {
-        QApplication::setOverrideCursor(Qt::WaitCursor);
         emit newStatus(i18n("Finding stars..."), FITS_MESSAGE);
-        qApp->processEvents();
-        int count = findStars();
-
-        if (count >= 0 && isVisible())
-            emit newStatus(i18np("1 star detected.", "%1 stars detected.", count), FITS_MESSAGE);
-        QApplication::restoreOverrideCursor();
+        findStarsAsync();
     }
 }
 
@@ -1455,21 +1361,27 @@ QPoint FITSView::getImagePoint(QPoint viewPortPoint)
 
 void FITSView::initDisplayImage()
 {
+    // Rendered again from the pyramid by getDisplayImage() when needed
     delete display_image;
     display_image = nullptr;
+}
 
-    if (imageData->getNumOfChannels() == 1)
-    {
-        display_image = new QImage(image_width, image_height, QImage::Format_Indexed8);
+QImage *FITSView::getDisplayImage()
+{
+    if (display_image == nullptr && imageData != nullptr)
+        display_image = new QImage(pyramid->fullImage());
 
-        display_image->setColorCount(256);
-        for (int i = 0; i < 256; i++)
-            display_image->setColor(i, qRgb(i, i, i));
-    }
-    else
-    {
-        display_image = new QImage(image_width, image_height, QImage::Format_RGB32);
-    }
+    return display_image;
+}
+
+void FITSView::drawImage(QPainter *painter, const QRect &rect, bool wait)
+{
+    if (imageData == nullptr)
+        return;
+
+    pyramid->draw(painter, rect, currentZoom / ZOOM_DEFAULT, wait);
+
+    drawOverlay(painter);
 }
 
 /**
@@ -46,6 +46,7 @@ class QToolBar;
 
 class FITSData;
 class FITSHistogram;
+class FITSImagePyramid;
 class FITSLabel;
 
 class FITSView : public QScrollArea
@@ -59,6 +60,8 @@ class FITSView : public QScrollArea
 
     // Loads FITS image, scales it, and displays it in the GUI
     bool loadFITS(const QString &filename, bool silent = true);
+    // Same as loadFITS, but from a complete FITS file held in memory
+    bool loadFITSFromMemory(const QByteArray &buffer, bool silent = true);
     // Save FITS
     int saveFITS(const QString &filename);
     // Rescale image lineary from image_buffer, fit to window if desired
@@ -67,7 +70,8 @@ class FITSView : public QScrollArea
     // Access functions
     FITSData *getImageData() { return imageData; }
     double getCurrentZoom() { return currentZoom; }
-    QImage *getDisplayImage() { return display_image; }
+    // Full resolution display image, rendered on first use after each rescale
+    QImage *getDisplayImage();
 
     // Tracking square
     void setTrackingBoxEnabled(bool enable);
@@ -113,6 +117,11 @@ class FITSView : public QScrollArea
 
     // Star Detection
     int findStars(StarAlgorithm algorithm = ALGORITHM_CENTROID, const QRect &searchBox = QRect());
+    /**
+     * @brief findStarsAsync Same as findStars(), in the background. starsFound() is emitted once done.
+     * @return Future of the number of stars detected, -1 on error
+     */
+    QFuture<int> findStarsAsync(StarAlgorithm algorithm = ALGORITHM_CENTROID, const QRect &searchBox = QRect());
     void toggleStars(bool enable);
     void setStarsEnabled(bool enable);
 
@@ -164,6 +173,10 @@ class FITSView : public QScrollArea
          */
     void syncWCSState();
     //void handleWCSCompletion();
+    /**
+         * @brief syncStarsState Redraw the stars detected in the background and report their count
+         */
+    void syncStarsState();
 
 private:
     bool event(QEvent *event);
@@ -177,6 +190,8 @@ private:
     double stddev();
     void calculateMaxPixel(double min, double max);
     void initDisplayImage();
+    // Draws the visible tiles of the image and the overlays, in the coordinates of image_frame
+    void drawImage(QPainter *painter, const QRect &rect, bool wait = false);
 
     QPointF getPointForGridLabel();
     bool pointIsInImage(QPointF pt, bool scaled);
@@ -188,6 +203,8 @@ public:
 protected:
     /// WCS Future Watcher
     QFutureWatcher<bool> wcsWatcher;
+    /// Star detection Future Watcher
+    QFutureWatcher<int> starsWatcher;
     /// Cross hair
     QPointF markerCrosshair;
     /// Pointer to FITSData object
@@ -196,6 +213,9 @@ protected:
     double currentZoom { 0 };
 
 private:
+    // Loads the image from buffer if it is not empty, otherwise from filename
+    bool loadImageData(const QString &filename, const QByteArray &buffer, bool silent);
+
     QLabel *noImageLabel { nullptr };
     QPixmap noImage;
 
@@ -213,7 +233,9 @@ private:
     /// Image zoom factor
     const double zoomFactor;
 
-    /// FITS image that is displayed in the GUI
+    /// Stretched tiles of the image that are displayed in the GUI
+    std::unique_ptr<FITSImagePyramid> pyramid;
+    /// Full resolution display image, only rendered when getDisplayImage() is called
     QImage *display_image { nullptr };
     FITSHistogram *histogram { nullptr };
 
@@ -265,6 +287,7 @@ private:
     void wcsToggled(bool);
     void actionUpdated(const QString &name, bool enable);
     void trackingStarSelected(int x, int y);
+    void starsFound(int count);
 
     friend class FITSLabel;
 };
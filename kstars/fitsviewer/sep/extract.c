@@ -35,9 +35,9 @@
 			             /* thresholding filtered weight-maps */
 
 /* globals */
-int plistexist_cdvalue, plistexist_thresh, plistexist_var;
-int plistoff_value, plistoff_cdvalue, plistoff_thresh, plistoff_var;
-int plistsize;
+SEP_TLS int plistexist_cdvalue, plistexist_thresh, plistexist_var;
+SEP_TLS int plistoff_value, plistoff_cdvalue, plistoff_thresh, plistoff_var;
+SEP_TLS int plistsize;
 size_t extract_pixstack = 300000;
 
 /* get and set pixstack */
@@ -753,7 +753,7 @@ int sortit(infostruct *info, objliststruct *objlist, int minarea,
 	   int deblend_nthresh, double deblend_mincont, double gain)
 {
   objliststruct	        objlistout, *objlist2;
-  static objstruct	obj;
+  static SEP_TLS objstruct	obj;
   int 			i, status;
 
   status=RETURN_OK;  
@@ -36,11 +36,11 @@ void lutzsort(infostruct *, objliststruct *);
 
 /*------------------------- Static buffers for lutz() -----------------------*/
 
-static infostruct  *info=NULL, *store=NULL;
-static char	   *marker=NULL;
-static pixstatus   *psstack=NULL;
-static int         *start=NULL, *end=NULL, *discan=NULL;
-static int         xmin, ymin, xmax, ymax;
+static SEP_TLS infostruct  *info=NULL, *store=NULL;
+static SEP_TLS char	   *marker=NULL;
+static SEP_TLS pixstatus   *psstack=NULL;
+static SEP_TLS int         *start=NULL, *end=NULL, *discan=NULL;
+static SEP_TLS int         xmin, ymin, xmax, ymax;
 
 
 /******************************* lutzalloc ***********************************/
@@ -108,7 +108,7 @@ int lutz(pliststruct *plistin,
 	 int *objrootsubmap, int subx, int suby, int subw,
 	 objstruct *objparent, objliststruct *objlist, int minarea)
 {
-  static infostruct	curpixinfo,initinfo;
+  static SEP_TLS infostruct	curpixinfo,initinfo;
   objstruct		*obj;
   pliststruct		*plist,*pixel, *plistint;
   
@@ -32,6 +32,14 @@
 #define RELTHRESH_NO_NOISE  9
 #define UNKNOWN_NOISE_TYPE  10
 
+/* Storage of the globals used while extracting sources, one copy per thread so that
+   sep_extract() can run on several images at once */
+#if defined(_MSC_VER)
+#define SEP_TLS __declspec(thread)
+#else
+#define SEP_TLS __thread
+#endif
+
 #define	BIG 1e+30  /* a huge number (< biggest value a float can store) */
 #define	PI  3.1415926535898
 #define	DEG (PI/180.0)	    /* 1 deg in radians */
@@ -1212,6 +1212,15 @@ void CCD::processBLOB(IBLOB *bp)
     else
         targetChip = primaryChip.get();
 
+    // Focus and guide frames are only used by their views, so they are loaded straight from the BLOB
+    // instead of going through a temporary file. Align still needs a file for the solvers.
+    bool inMemory = false;
+#ifdef HAVE_CFITSIO
+    inMemory = BType == BLOB_FITS &&
+               (targetChip->getCaptureMode() == FITS_FOCUS || targetChip->getCaptureMode() == FITS_GUIDE);
+#endif
+    QByteArray fitsBuffer;
+
     QString currentDir;
 
     if (targetChip->isBatchMode() == false)
@@ -1232,10 +1241,16 @@ void CCD::processBLOB(IBLOB *bp)
     if (filename.endsWith('/') == false)
         filename.append('/');
 
+    // The BLOB buffer is reused for the next image, so keep our own copy
+    if (inMemory)
+    {
+        fitsBuffer = QByteArray(static_cast<char *>(bp->blob), bp->size);
+        filename.clear();
+    }
     // Create temporary name if ANY of the following conditions are met:
     // 1. file is preview or batch mode is not enabled
-    // 2. file type is not FITS_NORMAL (focus, guide..etc)
-    if (targetChip->isBatchMode() == false || targetChip->getCaptureMode() != FITS_NORMAL)
+    // 2. file type is not FITS_NORMAL (align, calibrate..etc)
+    else if (targetChip->isBatchMode() == false || targetChip->getCaptureMode() != FITS_NORMAL)
     {
         //tmpFile.setPrefix("fits");
         tmpFile.setAutoRemove(false);
@@ -1290,13 +1305,21 @@ void CCD::processBLOB(IBLOB *bp)
         fits_temp_file.close();
     }
 
-    if (BType == BLOB_FITS)
+    // Images kept in memory are opened read-only, so they go without the FILTER keyword
+    if (inMemory)
+        filter.clear();
+    else if (BType == BLOB_FITS)
         addFITSKeywords(filename);
 
-    // store file name
-    strncpy(BLOBFilename, filename.toLatin1(), MAXINDIFILENAME);
+    // store file name, frames kept in memory have none until getBLOBFilename() saves them
     bp->aux1 = &BType;
-    bp->aux2 = BLOBFilename;
+    if (inMemory)
+        bp->aux2 = nullptr;
+    else
+    {
+        strncpy(BLOBFilename, filename.toLatin1(), MAXINDIFILENAME);
+        bp->aux2 = BLOBFilename;
+    }
 
     if (targetChip->getCaptureMode() == FITS_NORMAL && targetChip->isBatchMode() == true)
     {
@@ -1505,9 +1528,13 @@ void CCD::processBLOB(IBLOB *bp)
                     if (focusView)
                     {
                         focusView->setFilter(captureFilter);
-                        bool imageLoad = focusView->loadFITS(filename, true);
+                        bool imageLoad = focusView->loadFITSFromMemory(fitsBuffer, true);
                         if (imageLoad)
                         {
+                            if (targetChip == primaryChip.get())
+                                primaryMemoryView = focusView;
+                            else
+                                guideMemoryView = focusView;
                             focusView->updateFrame();
                             emit newImage(focusView->getDisplayImage(), targetChip);
                         }
@@ -1526,9 +1553,13 @@ void CCD::processBLOB(IBLOB *bp)
                     if (guideView)
                     {
                         guideView->setFilter(captureFilter);
-                        bool imageLoad = guideView->loadFITS(filename, true);
+                        bool imageLoad = guideView->loadFITSFromMemory(fitsBuffer, true);
                         if (imageLoad)
                         {
+                            if (targetChip == primaryChip.get())
+                                primaryMemoryView = guideView;
+                            else
+                                guideMemoryView = guideView;
                             guideView->updateFrame();
                             emit newImage(guideView->getDisplayImage(), targetChip);
                         }
@@ -1627,7 +1658,7 @@ void CCD::addFITSKeywords(const QString& filename)
 
         // Use open diskfile as it does not use extended file names which has problems opening
         // files with [ ] or ( ) in their names.
-        if (fits_open_diskfile(&fptr, filename.toLatin1(), READONLY, &status))
+        if (fits_open_diskfile(&fptr, filename.toLatin1(), READWRITE, &status))
         {
             fits_report_error(stderr, status);
             return;
@@ -1762,6 +1793,20 @@ CCDChip *CCD::getChip(CCDChip::ChipType cType)
     return nullptr;
 }
 
+QString CCD::getBLOBFilename(IBLOB *bp)
+{
+    if (bp->aux2 != nullptr)
+        return QString(static_cast<char *>(bp->aux2));
+
+#ifdef HAVE_CFITSIO
+    FITSView *memoryView = (!strcmp(bp->name, "CCD2")) ? guideMemoryView : primaryMemoryView;
+    if (memoryView && memoryView->getImageData())
+        return memoryView->getImageData()->getOrSaveFilename();
+#endif
+
+    return QString();
+}
+
 bool CCD::setRapidGuide(CCDChip *targetChip, bool enable)
 {
     ISwitchVectorProperty *rapidSP = nullptr;
@@ -211,6 +211,14 @@ class CCD : public DeviceDecorator
     // Update FITS Header
     bool setFITSHeader(const QMap<QString, QString> &values);
 
+    /**
+     * @brief getBLOBFilename Returns the file holding the last image received in a BLOB. Focus and guide frames are
+     * only kept in memory, they are saved to a temporary file on the first request.
+     * @param bp BLOB of the image
+     * @return Full file name, or an empty string if the image is no longer available
+     */
+    QString getBLOBFilename(IBLOB *bp);
+
     FITSViewer *getViewer() { return fv; }
     CCDChip *getChip(CCDChip::ChipType cType);
     void setFITSDir(const QString &dir) { fitsDir = dir; }
@@ -270,5 +278,7 @@ class CCD : public DeviceDecorator
 
     QPointer<FITSViewer> fv;
     QPointer<ImageViewer> imageViewer;
+    // Views holding the last frame of each chip kept in memory
+    QPointer<FITSView> primaryMemoryView, guideMemoryView;
 };
 }
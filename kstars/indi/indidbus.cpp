@@ -17,6 +17,7 @@
 #include "indi/servermanager.h"
 #include "indi/driverinfo.h"
 #include "indi/clientmanager.h"
+#include "indi/indiccd.h"
 #include "indi/indilistener.h"
 #include "indi/deviceinfo.h"
 
@@ -602,7 +603,16 @@ QString INDIDBus::getBLOBFile(const QString &device, const QString &property, co
                 IBLOB *b = IUFindBLOB(bp, blobName.toLatin1());
                 if (b)
                 {
-                    filename   = QString(((char *)b->aux2));
+                    // CCDs keep focus and guide frames in memory until their file is requested
+                    ISD::CCD *ccd = dynamic_cast<ISD::CCD *>(gd);
+                    filename      = ccd ? ccd->getBLOBFilename(b) : QString(((char *)b->aux2));
+
+                    if (filename.isEmpty())
+                    {
+                        qCWarning(KSTARS) << "No file holds BLOB: " << device << '.' << property << '.' << blobName;
+                        return filename;
+                    }
+
                     size       = b->bloblen;
                     blobFormat = QString(b->format).trimmed();
 
@@ -18,6 +18,7 @@
 
 #include "ksalmanac.h"
 
+#include "altitudesolver.h"
 #include "geolocation.h"
 #include "ksnumbers.h"
 #include "kstarsdata.h"
@@ -84,10 +85,6 @@ void KSAlmanac::RiseSetTime(SkyObject *o, double *riseTime, double *setTime, QTi
     }
 }
 
-// FIXME: This is utter code duplication. All this should be handled
-// in the KStars engine. Forgive me for adding to the nonsense, but I
-// want to get the Observation Planner functional first. -- asimha
-// seems to be copied from AltVsTime::setDawnDusk
 void KSAlmanac::findDawnDusk()
 {
     KStarsDateTime today = dt;
@@ -95,29 +92,18 @@ void KSAlmanac::findDawnDusk()
     CachingDms LST = geo->GSTtoLST(today.gst());
 
     m_Sun.updateCoords(&num, true, geo->lat(), &LST, true); // We can abuse our own copy of the sun
-    double dawn, da, dusk, du, max_alt, min_alt;
-    double last_h   = -12.0;
-    double last_alt = findAltitude(&m_Sun, last_h);
-    dawn = dusk = -13.0;
-    max_alt     = -100.0;
-    min_alt     = 100.0;
-    for (double h = -11.95; h <= 12.0; h += 0.05)
+
+    // Astronomical twilight within 12 hours of midnight, keeping the sun coordinates of midnight
+    const KStarsDateTime start(today.djd() - 0.5L), end(today.djd() + 0.5L);
+    double dawn = -13.0, dusk = -13.0;
+    double da, du;
+
+    for (const AltitudeSolver::TimeRange &range : AltitudeSolver::aboveAltitude(m_Sun, geo, -18.0, start, end))
     {
-        double alt = findAltitude(&m_Sun, h);
-        bool asc   = alt - last_alt > 0;
-        if (alt > max_alt)
-            max_alt = alt;
-        if (alt < min_alt)
-            min_alt = alt;
-
-        if (asc && last_alt <= -18.0 && alt >= -18.0)
-            dawn = h;
-        if (!asc && last_alt >= -18.0 && alt <= -18.0)
-            dusk = h;
-
-        // Never used
-//        last_h   = h;
-        last_alt = alt;
+        if (range.start > start)
+            dawn = (range.start.djd() - today.djd()) * 24.0;
+        if (range.end < end)
+            dusk = (range.end.djd() - today.djd()) * 24.0;
     }
 
     if (dawn < -12.0 || dusk < -12.0)
@@ -134,8 +120,8 @@ void KSAlmanac::findDawnDusk()
     DawnAstronomicalTwilight = da;
     DuskAstronomicalTwilight = du;
 
-    SunMaxAlt = max_alt;
-    SunMinAlt = min_alt;
+    SunMaxAlt = m_Sun.maxAlt(*geo->lat());
+    SunMinAlt = m_Sun.minAlt(*geo->lat());
 }
 
 void KSAlmanac::findMoonPhase()
@@ -170,8 +156,3 @@ double KSAlmanac::sunZenithAngleToTime(double z)
     double HASunset = acos((-m_Sun.dec().sin() * geo->lat()->sin()) / (m_Sun.dec().cos() * geo->lat()->cos()));
     return SunSet + (HA - HASunset) / 24.0;
 }
-
-double KSAlmanac::findAltitude(const SkyPoint *p, double hour)
-{
-    return SkyPoint::findAltitude(p, dt, geo, hour).Degrees();
-}
@@ -109,8 +109,7 @@ class KSAlmanac
     void RiseSetTime(SkyObject *o, double *riseTime, double *setTime, QTime *RiseTime, QTime *SetTime);
 
     /**
-         * Computes astronomical twilight for dawn and dusk
-         * @note Code duplication -- copied from Alt vs Time
+         * Computes astronomical twilight for dawn and dusk, solving the altitude of the sun at midnight
          */
     void findDawnDusk();
 
@@ -119,13 +118,6 @@ class KSAlmanac
          */
     void findMoonPhase();
 
-    /**
-         * FIXME: More code duplication!
-         * findAltitude should really be part of KSEngine. Copying from ObservingList.
-         * returns in degrees
-         */
-    double findAltitude(const SkyPoint *p, double hour);
-
     KSSun m_Sun;
     KSMoon m_Moon;
     KStarsDateTime dt;
@@ -28,6 +28,7 @@
 #include "skyobjects/deepskyobject.h"
 #include "skyobjects/ksmoon.h"
 #include "skyobjects/satellite.h"
+#include "skyobjects/satellitepropagator.h"
 #include "skyobjects/supernova.h"
 #include "skycomponents/constellationboundarylines.h"
 #include "skycomponents/flagcomponent.h"
@@ -115,6 +116,25 @@ QString transitTimeLabel(SkyObject *o)
     else
         return "--:--";
 }
+
+// String representation for the next pass of a satellite, within a day
+QString satellitePassLabel(Satellite *sat)
+{
+    KStarsData *data = KStarsData::Instance();
+    double now       = data->clock()->utc().djd();
+
+    QVector<SatellitePropagator::Pass> passes = SatellitePropagator::predictPasses(sat, data->geo(), now, now + 1);
+    if (passes.isEmpty())
+        return i18n("No pass within a day");
+
+    const SatellitePropagator::Pass &pass = passes.first();
+
+    //We can round to the nearest minute by simply adding 30 seconds to the time.
+    QTime aos = data->geo()->UTtoLT(KStarsDateTime(pass.aos)).time().addSecs(30);
+    QTime los = data->geo()->UTtoLT(KStarsDateTime(pass.los)).time().addSecs(30);
+    return i18n("Next pass: %1 to %2, up to %3°", QLocale().toString(aos, QLocale::ShortFormat),
+                QLocale().toString(los, QLocale::ShortFormat), QString::number(pass.maxElevation, 'f', 0));
+}
 }
 
 KSPopupMenu::KSPopupMenu()
@@ -272,6 +292,7 @@ void KSPopupMenu::createSatelliteMenu(Satellite *satellite)
     addFancyLabel(i18n("Velocity: %1 km/s", velocity), -2);
     addFancyLabel(i18n("Altitude: %1 km", altitude), -2);
     addFancyLabel(i18n("Range: %1 km", range), -2);
+    addFancyLabel(satellitePassLabel(satellite), -2);
 
     addSeparator();
 
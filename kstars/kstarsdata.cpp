@@ -36,10 +36,16 @@
 #include <KMessageBox>
 #endif
 
+#include <QElapsedTimer>
+#include <QMutex>
 #include <QSqlQuery>
 #include <QSqlRecord>
+#include <QWaitCondition>
 #include <QtConcurrent>
 
+#include <functional>
+#include <vector>
+
 #include "kstars_debug.h"
 
 namespace
@@ -87,6 +93,204 @@ bool nonFatalErrorMessage(QString fname)
     return true;
 }
 #endif
+
+/**
+ * Runs the loaders of KStarsData::initialize() as a graph of tasks.
+ *
+ * Tasks that must run on the main thread, because they create QObjects or database connections
+ * used later by the GUI, run in the order they were added. The others run in the global thread
+ * pool as soon as the tasks they depend on are finished. Once a task fails, no further tasks are
+ * started.
+ */
+class StartupTaskGraph
+{
+  public:
+    typedef std::function<bool()> Function;
+
+    /** Add a task and return its id. Dependencies must have been added before. */
+    int add(const QString &name, bool mainThread, const Function &function,
+            const QVector<int> &dependencies = QVector<int>())
+    {
+        Task task;
+
+        task.name         = name;
+        task.mainThread   = mainThread;
+        task.function     = function;
+        task.dependencies = dependencies;
+        task.pending      = dependencies.size();
+
+        int id = static_cast<int>(tasks.size());
+
+        for (int dependency : dependencies)
+            tasks[dependency].dependents.append(id);
+
+        tasks.push_back(task);
+        return id;
+    }
+
+    /** Run all tasks and wait for them. Returns false if any task failed. */
+    bool run()
+    {
+        timer.start();
+
+        {
+            QMutexLocker locker(&mutex);
+
+            remaining = static_cast<int>(tasks.size());
+            for (int id = 0; id < static_cast<int>(tasks.size()); id++)
+            {
+                if (tasks[id].mainThread == false && tasks[id].pending == 0)
+                    launch(id);
+            }
+        }
+
+        for (int id = 0; id < static_cast<int>(tasks.size()); id++)
+        {
+            if (tasks[id].mainThread == false)
+                continue;
+
+            {
+                QMutexLocker locker(&mutex);
+                while (tasks[id].pending > 0)
+                    finished.wait(&mutex);
+            }
+
+            execute(id);
+        }
+
+        QMutexLocker locker(&mutex);
+        while (remaining > 0)
+            finished.wait(&mutex);
+
+        return firstFailure < 0;
+    }
+
+    /** Id of the first task that returned false, or -1 */
+    int failedTask() const { return firstFailure; }
+
+    /** Log when each task ran, the total wall time and the critical path */
+    void report() const
+    {
+        qint64 wallTime = 0;
+        int last        = -1;
+
+        for (int id = 0; id < static_cast<int>(tasks.size()); id++)
+        {
+            const Task &task = tasks[id];
+
+            if (task.started && task.end >= wallTime)
+            {
+                wallTime = task.end;
+                last     = id;
+            }
+
+            if (task.started)
+                qCInfo(KSTARS) << "Startup task" << task.name << (task.mainThread ? "(main thread)" : "(thread pool)")
+                               << "started at" << task.start << "ms, took" << task.end - task.start << "ms";
+            else
+                qCInfo(KSTARS) << "Startup task" << task.name << "skipped";
+        }
+
+        // Walk back from the last task to finish, through whatever it had to wait for last:
+        // one of its dependencies or, for main thread tasks, the previous main thread task.
+        QStringList path;
+        qint64 pathTime = 0;
+
+        while (last >= 0 && tasks[last].started)
+        {
+            const Task &task = tasks[last];
+            int previous     = -1;
+
+            path.prepend(task.name);
+            pathTime += task.end - task.start;
+
+            for (int dependency : task.dependencies)
+            {
+                if (previous < 0 || tasks[dependency].end > tasks[previous].end)
+                    previous = dependency;
+            }
+
+            if (task.mainThread)
+            {
+                for (int id = last - 1; id >= 0; id--)
+                {
+                    if (tasks[id].mainThread)
+                    {
+                        if (previous < 0 || tasks[id].end > tasks[previous].end)
+                            previous = id;
+                        break;
+                    }
+                }
+            }
+
+            last = previous;
+        }
+
+        qCInfo(KSTARS) << "Startup took" << wallTime << "ms, critical path" << pathTime << "ms:"
+                       << path.join(" -> ");
+    }
+
+  private:
+    struct Task
+    {
+        QString name;
+        bool mainThread { true };
+        Function function;
+        QVector<int> dependencies;
+        QVector<int> dependents;
+        int pending { 0 };
+        bool started { false };
+        qint64 start { 0 };
+        qint64 end { 0 };
+    };
+
+    // Called with the mutex locked
+    void launch(int id)
+    {
+        QtConcurrent::run([this, id]() { execute(id); });
+    }
+
+    void execute(int id)
+    {
+        bool canRun = false;
+
+        {
+            QMutexLocker locker(&mutex);
+
+            canRun = firstFailure < 0;
+            if (canRun)
+            {
+                tasks[id].started = true;
+                tasks[id].start   = timer.elapsed();
+            }
+        }
+
+        bool ok = canRun ? tasks[id].function() : false;
+
+        QMutexLocker locker(&mutex);
+        Task &task = tasks[id];
+
+        task.end = timer.elapsed();
+        if (canRun && ok == false && firstFailure < 0)
+            firstFailure = id;
+
+        for (int dependent : task.dependents)
+        {
+            if (--tasks[dependent].pending == 0 && tasks[dependent].mainThread == false)
+                launch(dependent);
+        }
+
+        remaining--;
+        finished.wakeAll();
+    }
+
+    std::vector<Task> tasks;
+    QElapsedTimer timer;
+    QMutex mutex;
+    QWaitCondition finished;
+    int remaining { 0 };
+    int firstFailure { -1 };
+};
 }
 
 KStarsData *KStarsData::pinstance = nullptr;
@@ -137,101 +341,87 @@ KStarsData::~KStarsData()
 
 bool KStarsData::initialize()
 {
-    //Initialize CatalogDB//
-    catalogdb()->Initialize();
-
-    //Load Time Zone Rules//
-    emit progressText(i18n("Reading time zone rules"));
-    if (!readTimeZoneRulebook())
-    {
-        fatalErrorMessage("TZrules.dat");
-        return false;
-    }
-
-
-    emit progressText(i18n("Upgrade existing user city db to support geographic elevation."));
-
-
-    QString dbfile = KSPaths::writableLocation(QStandardPaths::GenericDataLocation) + QDir::separator() + "mycitydb.sqlite";
+    StartupTaskGraph tasks;
 
-    /// This code to add Height column to table city in mycitydb.sqlite is a transitional measure to support a meaningful
-    /// geographic elevation.
-    if (QFile::exists(dbfile))
-    {
-            QSqlDatabase fixcitydb = QSqlDatabase::addDatabase("QSQLITE", "fixcitydb");
-
-        fixcitydb.setDatabaseName(dbfile);
-        fixcitydb.open();
-
-        if (fixcitydb.tables().contains("city",Qt::CaseInsensitive))
-        {
-            QSqlRecord r = fixcitydb.record("city");
-            if (!r.contains("Elevation"))
-            {
-                emit progressText(i18n("Adding \"Elevation\" column to city table."));
-
-                QSqlQuery query(fixcitydb);
-                if (query.exec("alter table city add column Elevation real default -10;") == false)
-                {
-                    emit progressText(QString("failed to add Elevation column to city table in mycitydb.sqlite: &1").arg(query.lastError().text()));
-                }
-            }
-            else
-            {
-                emit progressText(i18n("City table already contains \"Elevation\"."));
-            }
-        }
-        else
-        {
-            emit progressText(i18n("City table missing from database."));
-        }
-        fixcitydb.close();
-    }
+    //Load Time Zone Rules and Cities in the background, cities are only needed at the end//
+    int tzRules = tasks.add("Time zone rules", false, [this]() { return readTimeZoneRulebook(); });
+    int cities  = tasks.add("City data", false, [this]() { return readCityData(); }, { tzRules });
 
+#ifndef KSTARS_LITE
+    tasks.add("Online lookup tree", false, [this]() {
+        readADVTreeData();
+        return true;
+    });
+#endif
 
-    //Load Cities//
-    emit progressText(i18n("Loading city data"));
-    if (!readCityData())
-    {
-        fatalErrorMessage("citydb.sqlite");
-        return false;
-    }
+    //Initialize CatalogDB//
+    int catalogDB = tasks.add("Catalog database", true, [this]() {
+        catalogdb()->Initialize();
+        return true;
+    });
 
     //Initialize User Database//
-    emit progressText(i18n("Loading User Information"));
-    m_ksuserdb.Initialize();
+    int userDB = tasks.add("User database", true, [this]() {
+        emit progressText(i18n("Loading User Information"));
+        m_ksuserdb.Initialize();
+        return true;
+    });
 
     //Initialize SkyMapComposite//
-    emit progressText(i18n("Loading sky objects"));
-    m_SkyComposite.reset(new SkyMapComposite());
-    //Load Image URLs//
+    int skyObjects = tasks.add("Sky objects", true, [this]() {
+        emit progressText(i18n("Loading sky objects"));
+        m_SkyComposite.reset(new SkyMapComposite());
+        return true;
+    }, { catalogDB, userDB });
+
+    //Load Image and Information URLs//
     //#ifndef Q_OS_ANDROID
     //On Android these 2 calls produce segfault. WARNING
-    emit progressText(i18n("Loading Image URLs"));
-
-    if( !readURLData( "image_url.dat", 0 ) && !nonFatalErrorMessage( "image_url.dat" ) )
-        return false;
-    //QtConcurrent::run(this, &KStarsData::readURLData, QString("image_url.dat"), 0, false);
-
-    //Load Information URLs//
-    //emit progressText(i18n("Loading Information URLs"));
-    if( !readURLData( "info_url.dat", 1 ) && !nonFatalErrorMessage( "info_url.dat" ) )
-        return false;
-    QtConcurrent::run(this, &KStarsData::readURLData, QString("info_url.dat"), 1, false);
-
+    // They stay on the main thread: the auxiliary info of sky objects is created on first use
+    int imageURLs = tasks.add("Image URLs", true, [this]() {
+        emit progressText(i18n("Loading Image URLs"));
+        return readURLData("image_url.dat", 0) || nonFatalErrorMessage("image_url.dat");
+    }, { skyObjects });
+
+    int infoURLs = tasks.add("Information URLs", true, [this]() {
+        return readURLData("info_url.dat", 1) || nonFatalErrorMessage("info_url.dat");
+    }, { imageURLs });
 //#endif
 //emit progressText( i18n("Loading Variable Stars" ) );
 
 #ifndef KSTARS_LITE
     //Initialize Observing List
-    m_ObservingList = new ObservingList();
+    tasks.add("Observing list", true, [this]() {
+        m_ObservingList = new ObservingList();
+        return true;
+    }, { skyObjects });
 #endif
 
-    readUserLog();
+    tasks.add("User log", true, [this]() {
+        readUserLog();
+        return true;
+    }, { infoURLs });
+
+    //Load User Cities after the others, so their order in the list is kept//
+    tasks.add("User city data", true, [this]() {
+        emit progressText(i18n("Loading city data"));
+        return readUserCityData();
+    }, { cities });
+
+    bool success = tasks.run();
+
+    tasks.report();
+
+    if (success == false)
+    {
+        if (tasks.failedTask() == tzRules)
+            fatalErrorMessage("TZrules.dat");
+        else if (tasks.failedTask() == cities)
+            fatalErrorMessage("citydb.sqlite");
+
+        return false;
+    }
 
-#ifndef KSTARS_LITE
-    readADVTreeData();
-#endif
     return true;
 }
 
@@ -457,9 +647,49 @@ bool KStarsData::readCityData()
     }
     citydb.close();
 
+    return citiesFound;
+}
+
+bool KStarsData::readUserCityData()
+{
+    QString dbfile = KSPaths::writableLocation(QStandardPaths::GenericDataLocation) + QDir::separator() + "mycitydb.sqlite";
+
+    /// This code to add Height column to table city in mycitydb.sqlite is a transitional measure to support a meaningful
+    /// geographic elevation.
+    if (QFile::exists(dbfile))
+    {
+        QSqlDatabase fixcitydb = QSqlDatabase::addDatabase("QSQLITE", "fixcitydb");
+
+        fixcitydb.setDatabaseName(dbfile);
+        fixcitydb.open();
+
+        if (fixcitydb.tables().contains("city",Qt::CaseInsensitive))
+        {
+            QSqlRecord r = fixcitydb.record("city");
+            if (!r.contains("Elevation"))
+            {
+                emit progressText(i18n("Adding \"Elevation\" column to city table."));
+
+                QSqlQuery query(fixcitydb);
+                if (query.exec("alter table city add column Elevation real default -10;") == false)
+                {
+                    emit progressText(QString("failed to add Elevation column to city table in mycitydb.sqlite: &1").arg(query.lastError().text()));
+                }
+            }
+            else
+            {
+                emit progressText(i18n("City table already contains \"Elevation\"."));
+            }
+        }
+        else
+        {
+            emit progressText(i18n("City table missing from database."));
+        }
+        fixcitydb.close();
+    }
+
     // Reading local database
     QSqlDatabase mycitydb = QSqlDatabase::addDatabase("QSQLITE", "mycitydb");
-    dbfile = KSPaths::writableLocation(QStandardPaths::GenericDataLocation) + QDir::separator() + "mycitydb.sqlite";
 
     if (QFile::exists(dbfile))
     {
@@ -491,7 +721,7 @@ bool KStarsData::readCityData()
         }
     }
 
-    return citiesFound;
+    return true;
 }
 
 bool KStarsData::readTimeZoneRulebook()
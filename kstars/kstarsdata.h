@@ -291,15 +291,24 @@ class KStarsData : public QObject
 
   private:
     /**
-     * Populate list of geographic locations from "citydb.sqlite" database. Also check for custom
-     * locations file "mycitydb.sqlite" database, but don't require it.  Each line in the file
-     * provides the information required to create one GeoLocation object.
-     * @short Fill list of geographic locations from file(s)
+     * Populate list of geographic locations from "citydb.sqlite" database. Each line in the file
+     * provides the information required to create one GeoLocation object. This does not touch
+     * any GUI or shared database connection, so it may run outside of the main thread.
+     * @short Fill list of geographic locations from file
      * @return true if at least one city read successfully.
-     * @see KStarsData::processCity()
+     * @see KStarsData::readUserCityData()
      */
     bool readCityData();
 
+    /**
+     * Append the custom locations of the "mycitydb.sqlite" database to the list of geographic
+     * locations, if the database exists, after adding the elevation column to older databases.
+     * Must run on the main thread, which later uses the same connection to edit locations.
+     * @short Fill list of geographic locations from the user database
+     * @return false if the user database exists but cannot be read.
+     */
+    bool readUserCityData();
+
     /** Read the data file that contains daylight savings time rules. */
     bool readTimeZoneRulebook();
 
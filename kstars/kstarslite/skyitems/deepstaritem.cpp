@@ -28,6 +28,7 @@
 #include "htmesh/MeshIterator.h"
 #include "projections/projector.h"
 #include "skynodes/pointsourcenode.h"
+#include "skynodes/starbatchnode.h"
 #include "skynodes/trixelnode.h"
 
 DeepStarItem::DeepStarItem(DeepStarComponent *deepStarComp, RootNode *rootNode)
@@ -174,25 +175,22 @@ void DeepStarItem::update()
                 const Projector *projector = SkyMapLite::Instance()->projector();
                 double delLim              = SkyMapLite::deleteLimit();
 
+                StarBatchNode *stars = static_cast<StarBatchNode *>(trixel->firstChild());
+
                 if (trixelID != regionID)
                 {
                     trixel->hide();
 
-                    if (trixel->hideCount() > delLim)
+                    if (stars)
                     {
-                        QLinkedList<QPair<SkyObject *, SkyNode *>>::iterator i = trixel->m_nodes.begin();
-
-                        while (i != trixel->m_nodes.end())
+                        if (trixel->hideCount() > delLim)
                         {
-                            SkyNode *node = (*i).second;
-                            if (node)
-                            {
-                                trixel->removeChildNode(node);
-                                delete node;
-
-                                *i = QPair<SkyObject *, SkyNode *>((*i).first, 0);
-                            }
-                            i++;
+                            trixel->removeChildNode(stars);
+                            delete stars;
+                        }
+                        else
+                        {
+                            stars->updateTexture();
                         }
                     }
 
@@ -209,70 +207,41 @@ void DeepStarItem::update()
                         regionID = region.next();
                     }
 
-                    QLinkedList<QPair<SkyObject *, SkyNode *>>::iterator i = (&trixel->m_nodes)->begin();
-
-                    while (i != (&trixel->m_nodes)->end())
+                    //All stars of the trixel are drawn by one node, filled again on each update
+                    if (!stars)
                     {
-                        bool hide     = false;
-                        bool hideSlew = false;
+                        stars = new StarBatchNode(rootNode(), LabelsItem::label_t::NO_LABEL, trixelID);
+                        trixel->appendChildNode(stars);
+                    }
+                    stars->clear();
 
-                        bool drawLabel = false;
+                    QLinkedList<QPair<SkyObject *, SkyNode *>>::const_iterator i = trixel->m_nodes.constBegin();
 
+                    // Stars are hidden while slewing
+                    bool hideSlew = hideFaintStars && hideStarsMag;
+
+                    while (!hideSlew && i != trixel->m_nodes.constEnd())
+                    {
                         StarObject *starObj = static_cast<StarObject *>((*i).first);
-                        SkyNode *node       = (*i).second;
+                        i++;
 
                         int mag = starObj->mag();
 
                         // break loop if maglim is reached
                         if (mag > maglim)
-                            hide = true;
-                        if (hideFaintStars && hideStarsMag)
-                            hideSlew = true;
+                            break;
                         if (starObj->updateID != KStarsData::Instance()->updateID())
                             starObj->JITupdate();
 
-                        if (node)
-                        {
-                            if (node->hideCount() > delLim || hide)
-                            {
-                                trixel->removeChildNode(node);
-                                delete node;
-                                *i = QPair<SkyObject *, SkyNode *>((*i).first, 0);
-                            }
-                            else
-                            {
-                                if (!hideSlew)
-                                {
-                                    node->update(drawLabel);
-                                }
-                                else
-                                {
-                                    node->hide();
-                                }
-                            }
-                        }
-                        else
-                        {
-                            if (!hide && !hideSlew && projector->checkVisibility(starObj))
-                            {
-                                QPointF pos;
-
-                                bool visible = false;
-                                pos          = projector->toScreen(starObj, true, &visible);
-                                if (visible && projector->onScreen(pos))
-                                {
-                                    PointSourceNode *point =
-                                        new PointSourceNode(starObj, rootNode(), LabelsItem::label_t::STAR_LABEL,
-                                                            starObj->spchar(), starObj->mag(), trixelID);
-                                    trixel->appendChildNode(point);
-
-                                    *i = QPair<SkyObject *, SkyNode *>((*i).first, static_cast<SkyNode *>(point));
-                                    point->updatePos(pos, drawLabel);
-                                }
-                            }
-                        }
-                        i++;
+                        if (!projector->checkVisibility(starObj))
+                            continue;
+
+                        bool visible = false;
+                        QPointF pos  = projector->toScreen(starObj, true, &visible);
+                        if (visible && projector->onScreen(pos))
+                            stars->addStar(starObj, pos, false);
                     }
+                    stars->update();
                 }
             }
             else if (false)
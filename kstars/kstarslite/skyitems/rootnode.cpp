@@ -1,3 +1,4 @@
+#include <QPainter>
 #include <QSGTexture>
 #include <QQuickWindow>
 
@@ -164,6 +165,7 @@ RootNode::~RootNode()
             delete m_textureCache[i][c];
         }
     }
+    delete m_starAtlas;
 }
 
 void RootNode::genCachedTextures()
@@ -184,6 +186,59 @@ void RootNode::genCachedTextures()
                 win->createTextureFromImage(images[i][c]->toImage(), QQuickWindow::TextureCanUseAtlas);
         }
     }
+
+    // StarBatchNode draws all the stars of a trixel with one texture: the images are copied in a grid, one row for
+    // each spectral class and one column for each size, with a transparent border against filtering artifacts
+    int cell    = 0;
+    int columns = 0;
+    for (const QVector<QPixmap *> &sizes : images)
+    {
+        columns = qMax(columns, sizes.length());
+        for (int c = 1; c < sizes.length(); ++c)
+            cell = qMax(cell, qMax(sizes[c]->width(), sizes[c]->height()) + 2);
+    }
+
+    QImage atlas(qMax(1, cell * columns), qMax(1, cell * images.length()), QImage::Format_ARGB32_Premultiplied);
+    atlas.fill(Qt::transparent);
+
+    qreal ratio = win->effectiveDevicePixelRatio();
+    QPainter p(&atlas);
+
+    m_spriteTextures = QVector<QVector<QRectF>>(images.length());
+    m_spriteRects    = QVector<QVector<QSizeF>>(images.length());
+
+    for (int i = 0; i < images.length(); ++i)
+    {
+        int length          = images[i].length();
+        m_spriteTextures[i] = QVector<QRectF>(length);
+        m_spriteRects[i]    = QVector<QSizeF>(length);
+        for (int c = 1; c < length; ++c)
+        {
+            const QPixmap *image = images[i][c];
+            const int x          = c * cell + 1;
+            const int y          = i * cell + 1;
+
+            p.drawPixmap(x, y, *image);
+            m_spriteTextures[i][c] = QRectF(double(x) / atlas.width(), double(y) / atlas.height(),
+                                            double(image->width()) / atlas.width(),
+                                            double(image->height()) / atlas.height());
+            //Like PointNode, we divide the size of the image by ratio
+            m_spriteRects[i][c] = QSizeF(image->width() / ratio, image->height() / ratio);
+        }
+    }
+    p.end();
+
+    //The old atlas is deleted once all StarBatchNodes use the new one
+    m_oldStarAtlas = m_starAtlas;
+    m_starAtlas    = win->createTextureFromImage(atlas);
+}
+
+void RootNode::getCachedSprite(int size, char spType, QRectF &texture, QSizeF &rect) const
+{
+    int index = m_skyMapLite->harvardToIndex(spType);
+
+    texture = m_spriteTextures[index][size];
+    rect    = m_spriteRects[index][size];
 }
 
 QSGTexture *RootNode::getCachedTexture(int size, char spType)
@@ -298,6 +353,9 @@ void RootNode::update(bool clearTextures)
 
     if (clearTextures)
     {
+        delete m_oldStarAtlas;
+        m_oldStarAtlas = nullptr;
+
         //Delete old textures
         if (m_oldTextureCache.length())
         {
@@ -83,6 +83,18 @@ class RootNode : public QSGClipNode
      */
     QSGTexture *getCachedTexture(int size, char spType);
 
+    /** @return texture holding the images of stars of all sizes and spectral classes, see getCachedSprite() */
+    inline QSGTexture *starAtlas() const { return m_starAtlas; }
+
+    /**
+     * @short returns the place of a star image in starAtlas()
+     * @param size size of the star
+     * @param spType spectral class
+     * @param texture normalized texture coordinates of the image
+     * @param rect size of the image on SkyMapLite
+     */
+    void getCachedSprite(int size, char spType, QRectF &texture, QSizeF &rect) const;
+
     /** @short triangulates and sets new clipping polygon provided by Projection system */
     void updateClipPoly();
 
@@ -110,6 +122,12 @@ class RootNode : public QSGClipNode
   private:
     QVector<QVector<QSGTexture *>> m_textureCache;
     QVector<QVector<QSGTexture *>> m_oldTextureCache;
+    /// All images of textureCache in one texture, for StarBatchNode
+    QSGTexture *m_starAtlas { nullptr };
+    QSGTexture *m_oldStarAtlas { nullptr };
+    /// Normalized texture coordinates and sizes of the images in m_starAtlas
+    QVector<QVector<QRectF>> m_spriteTextures;
+    QVector<QVector<QSizeF>> m_spriteRects;
     SkyMapLite *m_skyMapLite { nullptr };
 
     QPolygonF m_clipPoly;
@@ -0,0 +1,146 @@
+/** *************************************************************************
+                          starbatchnode.cpp  -  K Desktop Planetarium
+                             -------------------
+    begin                : 18/10/2026
+    copyright            : (C) 2026 by KStars Developers
+ ***************************************************************************/
+/** *************************************************************************
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ ***************************************************************************/
+
+#include "starbatchnode.h"
+
+#include "labelnode.h"
+#include "Options.h"
+#include "skymaplite.h"
+#include "starobject.h"
+#include "../rootnode.h"
+
+#include <QSGGeometryNode>
+#include <QSGTextureMaterial>
+
+#include <algorithm>
+#include <cmath>
+
+StarBatchNode::StarBatchNode(RootNode *rootNode, LabelsItem::label_t labelType, Trixel trixel)
+    : m_rootNode(rootNode), m_geometryNode(new QSGGeometryNode), m_material(new QSGTextureMaterial),
+      m_labelType(labelType), m_trixel(trixel)
+{
+    m_geometry = new QSGGeometry(QSGGeometry::defaultAttributes_TexturedPoint2D(), 0);
+    m_geometry->setDrawingMode(GL_TRIANGLES);
+    // The vertices change on every update
+    m_geometry->setVertexDataPattern(QSGGeometry::StreamPattern);
+    m_geometryNode->setGeometry(m_geometry);
+    m_geometryNode->setFlag(QSGNode::OwnsGeometry);
+
+    // Star images are transparent around the star
+    m_material->setTexture(m_rootNode->starAtlas());
+    m_material->setFlag(QSGMaterial::Blending);
+    m_geometryNode->setMaterial(m_material);
+    m_geometryNode->setFlag(QSGNode::OwnsMaterial);
+
+    appendChildNode(m_geometryNode);
+}
+
+StarBatchNode::~StarBatchNode()
+{
+    if (m_labelType == LabelsItem::label_t::STAR_LABEL || m_labelType == LabelsItem::label_t::CATALOG_STAR_LABEL)
+    {
+        for (LabelNode *label : m_labels)
+            m_rootNode->labelsItem()->deleteLabel(label);
+    }
+}
+
+float StarBatchNode::starWidth(float mag) const
+{
+    const double maxSize = 10.0;
+
+    float size = (m_sizeFactor * (m_sizeMagLim - mag) / m_sizeMagLim) + 1.;
+    if (size <= 1.0)
+        size = 1.0;
+    if (size > maxSize)
+        size = maxSize;
+
+    return size;
+}
+
+void StarBatchNode::clear()
+{
+    // Keeps the capacity, the vertices of the next update are written in the same memory
+    m_vertices.clear();
+
+    for (LabelNode *label : m_shownLabels)
+        label->hide();
+    m_shownLabels.clear();
+
+    //adjust maglimit for ZoomLevel, once for all stars
+    const double maxSize = 10.0;
+    double lgmin         = log10(MINZOOM);
+    double lgz           = log10(Options::zoomFactor());
+
+    m_sizeFactor = maxSize + (lgz - lgmin);
+    m_sizeMagLim = SkyMapLite::Instance()->sizeMagLim();
+}
+
+void StarBatchNode::addStar(StarObject *star, const QPointF &pos, bool drawLabel)
+{
+    QRectF texture;
+    QSizeF size;
+    m_rootNode->getCachedSprite(qMin(static_cast<int>(starWidth(star->mag())), 14), star->spchar(), texture, size);
+
+    // Two triangles centered on the star, like PointSourceNode::changePos() centers the texture
+    const float left   = pos.x() - 0.5 * size.width();
+    const float top    = pos.y() - 0.5 * size.height();
+    const float right  = left + size.width();
+    const float bottom = top + size.height();
+
+    QSGGeometry::TexturedPoint2D corners[4];
+    corners[0].set(left, top, texture.left(), texture.top());
+    corners[1].set(right, top, texture.right(), texture.top());
+    corners[2].set(left, bottom, texture.left(), texture.bottom());
+    corners[3].set(right, bottom, texture.right(), texture.bottom());
+
+    m_vertices << corners[0] << corners[1] << corners[2] << corners[2] << corners[1] << corners[3];
+
+    if (drawLabel && m_labelType != LabelsItem::label_t::NO_LABEL)
+    {
+        LabelNode *&label = m_labels[star];
+        if (!label) //This way labels will be created only when they are needed
+            label = m_rootNode->labelsItem()->addLabel(star, m_labelType, m_trixel);
+        label->setLabelPos(pos);
+        m_shownLabels.append(label);
+    }
+}
+
+void StarBatchNode::update()
+{
+    // The buffer is reallocated only when the number of stars changes
+    if (m_geometry->vertexCount() != m_vertices.size())
+        m_geometry->allocate(m_vertices.size());
+
+    std::copy(m_vertices.constBegin(), m_vertices.constEnd(), m_geometry->vertexDataAsTexturedPoint2D());
+    m_geometry->markVertexDataDirty();
+    m_geometryNode->markDirty(QSGNode::DirtyGeometry);
+
+    updateTexture();
+}
+
+void StarBatchNode::updateTexture()
+{
+    if (m_material->texture() != m_rootNode->starAtlas())
+    {
+        m_material->setTexture(m_rootNode->starAtlas());
+        m_geometryNode->markDirty(QSGNode::DirtyMaterial);
+    }
+}
+
+void StarBatchNode::forgetLabels()
+{
+    m_labels.clear();
+    m_shownLabels.clear();
+}
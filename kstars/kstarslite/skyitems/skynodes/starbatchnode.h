@@ -0,0 +1,98 @@
+/** *************************************************************************
+                          starbatchnode.h  -  K Desktop Planetarium
+                             -------------------
+    begin                : 18/10/2026
+    copyright            : (C) 2026 by KStars Developers
+ ***************************************************************************/
+/** *************************************************************************
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ ***************************************************************************/
+
+#pragma once
+
+#include "typedef.h"
+#include "../labelsitem.h"
+#include "../skyopacitynode.h"
+
+#include <QHash>
+#include <QSGGeometry>
+#include <QVector>
+
+class LabelNode;
+class QSGGeometryNode;
+class QSGTextureMaterial;
+class RootNode;
+class StarObject;
+
+/**
+ * @class StarBatchNode
+ *
+ * PointSourceNode draws each star with its own transform, opacity and texture nodes, so that a trixel full of stars
+ * costs thousands of nodes to synchronize and as many draw calls. StarBatchNode draws all the stars of a trixel
+ * with one geometry node: each star is a quad in a single vertex buffer, textured with the image of its size and
+ * spectral class in the star atlas of RootNode. The vertex buffer is rewritten in place on every update.
+ *
+ * @short SkyOpacityNode derived class that draws the stars of a trixel in one batch
+ */
+class StarBatchNode : public SkyOpacityNode
+{
+  public:
+    /**
+     * @short Constructor
+     * @param rootNode pointer to the top parent node, which holds the star atlas
+     * @param labelType type of the labels of the stars, NO_LABEL if they are never labeled
+     * @param trixel trixel of the stars
+     */
+    StarBatchNode(RootNode *rootNode, LabelsItem::label_t labelType, Trixel trixel);
+    virtual ~StarBatchNode();
+
+    /** @short Remove all stars and hide their labels, before the stars in view are added again */
+    void clear();
+
+    /**
+     * @short Add a star to the batch
+     * @param star star to draw
+     * @param pos position of the star on SkyMapLite
+     * @param drawLabel true if the label of the star has to be drawn
+     */
+    void addStar(StarObject *star, const QPointF &pos, bool drawLabel);
+
+    /** @short Copy the stars added since clear() to the vertex buffer */
+    void update();
+
+    /** @short Use the current star atlas of RootNode, which is recreated when the color scheme changes */
+    void updateTexture();
+
+    /**
+     * @short Forget the labels of the stars without deleting them
+     * @note Call it after LabelsItem::deleteLabels() deleted all star labels
+     */
+    void forgetLabels();
+
+  private:
+    /** @short Get the width of a star of magnitude mag, see PointSourceNode::starWidth() */
+    float starWidth(float mag) const;
+
+    RootNode *m_rootNode { nullptr };
+    QSGGeometryNode *m_geometryNode { nullptr };
+    QSGGeometry *m_geometry { nullptr };
+    QSGTextureMaterial *m_material { nullptr };
+    /// Two triangles for each star added since clear()
+    QVector<QSGGeometry::TexturedPoint2D> m_vertices;
+
+    LabelsItem::label_t m_labelType { LabelsItem::NO_LABEL };
+    Trixel m_trixel { 0 };
+    /// Labels are created once for each star and hidden while it is not labeled
+    QHash<StarObject *, LabelNode *> m_labels;
+    /// Labels shown since clear()
+    QVector<LabelNode *> m_shownLabels;
+
+    /// Parameters of starWidth() for the current update
+    float m_sizeFactor { 0 };
+    float m_sizeMagLim { 0 };
+};
@@ -26,7 +26,7 @@
 #include "starcomponent.h"
 #include "htmesh/MeshIterator.h"
 #include "projections/projector.h"
-#include "skynodes/pointsourcenode.h"
+#include "skynodes/starbatchnode.h"
 #include "skynodes/trixelnode.h"
 
 #include <QLinkedList>
@@ -172,21 +172,15 @@ void StarItem::update()
 
     while (trixel != 0)
     {
+        StarBatchNode *stars = static_cast<StarBatchNode *>(trixel->firstChild());
+
         if (reIndex)
         {
             StarList *skyList = index->at(trixelID);
 
-            QSGNode *n = trixel->firstChild();
-
-            //Delete nodes
-            while (n != 0)
-            {
-                QSGNode *c = n;
-                n          = n->nextSibling();
-
-                trixel->removeChildNode(c);
-                delete c;
-            }
+            //Labels were deleted above
+            if (stars)
+                stars->forgetLabels();
 
             //Delete all pairs that represent stars
             trixel->m_nodes.clear();
@@ -202,16 +196,22 @@ void StarItem::update()
             }
         }
 
-        bool hide = false;
-
         if (trixelID != regionID)
         {
             trixel->hide();
             label->hide();
 
-            if (trixel->hideCount() > delLim)
+            if (stars)
             {
-                trixel->deleteAllChildNodes();
+                if (trixel->hideCount() > delLim)
+                {
+                    trixel->removeChildNode(stars);
+                    delete stars;
+                }
+                else
+                {
+                    stars->updateTexture();
+                }
             }
         }
         else
@@ -224,69 +224,40 @@ void StarItem::update()
                 regionID = region.next();
             }
 
-            QLinkedList<QPair<SkyObject *, SkyNode *>> *nodes = &trixel->m_nodes;
+            //All stars of the trixel are drawn by one node, filled again on each update
+            if (!stars)
+            {
+                stars = new StarBatchNode(rootNode(), labelType(), trixelID);
+                trixel->appendChildNode(stars);
+            }
+            stars->clear();
 
-            QLinkedList<QPair<SkyObject *, SkyNode *>>::iterator i = nodes->begin();
+            QLinkedList<QPair<SkyObject *, SkyNode *>>::const_iterator i = trixel->m_nodes.constBegin();
 
-            while (i != nodes->end())
+            while (i != trixel->m_nodes.constEnd())
             {
-                bool drawLabel = false;
-
                 StarObject *starObj = static_cast<StarObject *>((*i).first);
-                SkyNode *node       = (*i).second;
+                i++;
 
                 int mag = starObj->mag();
 
                 // break loop if maglim is reached
                 if (mag > maglim)
-                    hide = true;
-                if (!(hideLabel || mag > labelMagLim))
-                    drawLabel = true;
+                    break;
+
+                bool drawLabel = !(hideLabel || mag > labelMagLim);
                 if (starObj->updateID != KStarsData::Instance()->updateID())
                     starObj->JITupdate();
 
-                if (node)
-                {
-                    if (node->hideCount() > delLim || hide)
-                    {
-                        trixel->removeChildNode(node);
-                        delete node;
-                        *i = QPair<SkyObject *, SkyNode *>((*i).first, 0);
-                    }
-                    else
-                    {
-                        if (!hide)
-                        {
-                            node->update(drawLabel);
-                        }
-                        else
-                        {
-                            node->hide();
-                        }
-                    }
-                }
-                else
-                {
-                    if (!hide && projector->checkVisibility(starObj))
-                    {
-                        QPointF pos;
-
-                        bool visible = false;
-                        pos          = projector->toScreen(starObj, true, &visible);
-                        if (visible && projector->onScreen(pos))
-                        {
-                            PointSourceNode *point =
-                                new PointSourceNode(starObj, rootNode(), LabelsItem::label_t::STAR_LABEL,
-                                                    starObj->spchar(), starObj->mag(), trixelID);
-                            trixel->appendChildNode(point);
-
-                            *i = QPair<SkyObject *, SkyNode *>((*i).first, static_cast<SkyNode *>(point));
-                            point->updatePos(pos, drawLabel);
-                        }
-                    }
-                }
-                i++;
+                if (!projector->checkVisibility(starObj))
+                    continue;
+
+                bool visible = false;
+                QPointF pos  = projector->toScreen(starObj, true, &visible);
+                if (visible && projector->onScreen(pos))
+                    stars->addStar(starObj, pos, drawLabel);
             }
+            stars->update();
         }
         trixel = static_cast<TrixelNode *>(trixel->nextSibling());
         label  = static_cast<TrixelNode *>(label->nextSibling());
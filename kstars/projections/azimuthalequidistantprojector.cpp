@@ -23,6 +23,22 @@
 
 #include "azimuthalequidistantprojector.h"
 
+#include "projectorbatch.h"
+
+namespace
+{
+/** k(c) of the projection, shared by projectionK() and the batch projection */
+struct AzimuthalEquidistantKernel
+{
+    inline double operator()(double c) const
+    {
+        double crad = acos(c);
+        // This handles the 0/0 case. The limit of x / sin(x) is 1 as x -> 0.
+        return ((crad != 0) ? crad / sin(crad) : 1);
+    }
+};
+}
+
 AzimuthalEquidistantProjector::AzimuthalEquidistantProjector(const ViewParams &p) : Projector(p)
 {
     updateClipPoly();
@@ -40,11 +56,16 @@ double AzimuthalEquidistantProjector::radius() const
 
 double AzimuthalEquidistantProjector::projectionK(double x) const
 {
-    double crad = acos(x);
-    return ((crad != 0) ? crad / sin(crad) : 1); // This handles the 0/0 case. The limit of x / sin(x) is 1 as x -> 0.
+    return AzimuthalEquidistantKernel()(x);
 }
 
 double AzimuthalEquidistantProjector::projectionL(double x) const
 {
     return x;
 }
+
+void AzimuthalEquidistantProjector::projectBatch(const double *lon, const double *lat, int count, Vector2f *screen,
+                                                 bool *onVisibleHemisphere, bool oRefract) const
+{
+    projectAzimuthal(AzimuthalEquidistantKernel(), lon, lat, count, screen, onVisibleHemisphere, oRefract);
+}
@@ -36,6 +36,10 @@ class AzimuthalEquidistantProjector : public Projector
     double radius() const override;
     double projectionK(double x) const override;
     double projectionL(double x) const override;
+
+  protected:
+    void projectBatch(const double *lon, const double *lat, int count, Vector2f *screen, bool *onVisibleHemisphere,
+                      bool oRefract) const override;
 };
 
 #endif // AZIMUTHALEQUIDISTANTPROJECTOR_H
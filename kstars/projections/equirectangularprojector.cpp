@@ -71,6 +71,48 @@ Vector2f EquirectangularProjector::toScreenVec(const SkyPoint *o, bool oRefract,
     return p;
 }
 
+void EquirectangularProjector::projectBatch(const double *lon, const double *lat, int count, Vector2f *screen,
+                                            bool *onVisibleHemisphere, bool oRefract) const
+{
+    double focusX, focusY;
+    if (m_vp.useAltAz)
+    {
+        focusX = m_vp.focus->az().radians();
+        focusY = m_vp.focus->alt().radians();
+    }
+    else
+    {
+        focusX = m_vp.focus->ra().radians();
+        focusY = m_vp.focus->dec().radians();
+    }
+
+    // No trigonometry here, the loop only inlines toScreenVec()
+    for (int i = 0; i < count; ++i)
+    {
+        double Y, dX;
+        if (m_vp.useAltAz)
+        {
+            //account for atmospheric refraction
+            Y  = (oRefract ? SkyPoint::refract(lat[i] / dms::DegToRad) * dms::DegToRad : lat[i]);
+            dX = focusX - lon[i];
+        }
+        else
+        {
+            Y  = lat[i];
+            dX = lon[i] - focusX;
+        }
+
+        dX = KSUtils::reduceAngle(dX, -dms::PI, dms::PI);
+
+        Vector2f &p = screen[i];
+        p[0]        = 0.5 * m_vp.width - m_vp.zoomFactor * dX;
+        p[1]        = 0.5 * m_vp.height - m_vp.zoomFactor * (Y - focusY);
+
+        if (onVisibleHemisphere)
+            onVisibleHemisphere[i] = (p[0] > 0 && p[0] < m_vp.width);
+    }
+}
+
 SkyPoint EquirectangularProjector::fromScreen(const QPointF &p, dms *LST, const dms *lat) const
 {
     SkyPoint result;
@@ -39,6 +39,10 @@ class EquirectangularProjector : public Projector
     SkyPoint fromScreen(const QPointF &p, dms *LST, const dms *lat) const override;
     QVector<Vector2f> groundPoly(SkyPoint *labelpoint = nullptr, bool *drawLabel = nullptr) const override;
     void updateClipPoly() override;
+
+  protected:
+    void projectBatch(const double *lon, const double *lat, int count, Vector2f *screen, bool *onVisibleHemisphere,
+                      bool oRefract) const override;
 };
 
 #endif // EQUIRECTANGULARPROJECTOR_H
@@ -19,6 +19,20 @@
 
 #include "gnomonicprojector.h"
 
+#include "projectorbatch.h"
+
+namespace
+{
+/** k(c) of the projection, shared by projectionK() and the batch projection */
+struct GnomonicKernel
+{
+    inline double operator()(double c) const
+    {
+        return 1.0 / c;
+    }
+};
+}
+
 GnomonicProjector::GnomonicProjector(const ViewParams &p) : Projector(p)
 {
     updateClipPoly();
@@ -36,7 +50,7 @@ double GnomonicProjector::radius() const
 
 double GnomonicProjector::projectionK(double x) const
 {
-    return 1.0 / x;
+    return GnomonicKernel()(x);
 }
 
 double GnomonicProjector::projectionL(double x) const
@@ -49,3 +63,9 @@ double GnomonicProjector::cosMaxFieldAngle() const
     //Don't let things approach infty.
     return 0.02;
 }
+
+void GnomonicProjector::projectBatch(const double *lon, const double *lat, int count, Vector2f *screen,
+                                     bool *onVisibleHemisphere, bool oRefract) const
+{
+    projectAzimuthal(GnomonicKernel(), lon, lat, count, screen, onVisibleHemisphere, oRefract);
+}
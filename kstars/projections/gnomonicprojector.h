@@ -37,6 +37,10 @@ class GnomonicProjector : public Projector
     double projectionK(double x) const override;
     double projectionL(double x) const override;
     double cosMaxFieldAngle() const override;
+
+  protected:
+    void projectBatch(const double *lon, const double *lat, int count, Vector2f *screen, bool *onVisibleHemisphere,
+                      bool oRefract) const override;
 };
 
 #endif // GNOMONICPROJECTOR_H
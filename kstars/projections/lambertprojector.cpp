@@ -19,6 +19,20 @@
 
 #include "lambertprojector.h"
 
+#include "projectorbatch.h"
+
+namespace
+{
+/** k(c) of the projection, shared by projectionK() and the batch projection */
+struct LambertKernel
+{
+    inline double operator()(double c) const
+    {
+        return sqrt(2.0 / (1.0 + c));
+    }
+};
+}
+
 LambertProjector::LambertProjector(const ViewParams &p) : Projector(p)
 {
     updateClipPoly();
@@ -36,10 +50,16 @@ double LambertProjector::radius() const
 
 double LambertProjector::projectionK(double x) const
 {
-    return sqrt(2.0 / (1.0 + x));
+    return LambertKernel()(x);
 }
 
 double LambertProjector::projectionL(double x) const
 {
     return 2.0 * asin(0.5 * x);
 }
+
+void LambertProjector::projectBatch(const double *lon, const double *lat, int count, Vector2f *screen,
+                                    bool *onVisibleHemisphere, bool oRefract) const
+{
+    projectAzimuthal(LambertKernel(), lon, lat, count, screen, onVisibleHemisphere, oRefract);
+}
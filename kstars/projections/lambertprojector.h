@@ -37,6 +37,10 @@ class LambertProjector : public Projector
     double radius() const override;
     double projectionK(double x) const override;
     double projectionL(double x) const override;
+
+  protected:
+    void projectBatch(const double *lon, const double *lat, int count, Vector2f *screen, bool *onVisibleHemisphere,
+                      bool oRefract) const override;
 };
 
 #endif // LAMBERTPROJECTOR_H
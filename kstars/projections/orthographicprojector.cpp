@@ -19,6 +19,21 @@
 
 #include "orthographicprojector.h"
 
+#include "projectorbatch.h"
+
+namespace
+{
+/** k(c) of the projection, shared by projectionK() and the batch projection */
+struct OrthographicKernel
+{
+    inline double operator()(double c) const
+    {
+        Q_UNUSED(c);
+        return 1.0;
+    }
+};
+}
+
 OrthographicProjector::OrthographicProjector(const ViewParams &p) : Projector(p)
 {
     updateClipPoly();
@@ -36,11 +51,16 @@ double OrthographicProjector::radius() const
 
 double OrthographicProjector::projectionK(double x) const
 {
-    Q_UNUSED(x);
-    return 1.0;
+    return OrthographicKernel()(x);
 }
 
 double OrthographicProjector::projectionL(double x) const
 {
     return asin(x);
 }
+
+void OrthographicProjector::projectBatch(const double *lon, const double *lat, int count, Vector2f *screen,
+                                         bool *onVisibleHemisphere, bool oRefract) const
+{
+    projectAzimuthal(OrthographicKernel(), lon, lat, count, screen, onVisibleHemisphere, oRefract);
+}
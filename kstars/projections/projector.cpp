@@ -20,6 +20,7 @@
 #include "projector.h"
 
 #include "ksutils.h"
+#include "projectorbatch.h"
 #ifdef KSTARS_LITE
 #include "skymaplite.h"
 #endif
@@ -109,6 +110,20 @@ QPointF Projector::toScreen(const SkyPoint *o, bool oRefract, bool *onVisibleHem
     return KSUtils::vecToPoint(toScreenVec(o, oRefract, onVisibleHemisphere));
 }
 
+void Projector::toScreenBatch(const double *lon, const double *lat, int count, Vector2f *screen,
+                              bool *onVisibleHemisphere, bool oRefract) const
+{
+    if (count > 0)
+        projectBatch(lon, lat, count, screen, onVisibleHemisphere, oRefract && m_vp.useRefraction);
+}
+
+void Projector::projectBatch(const double *lon, const double *lat, int count, Vector2f *screen,
+                             bool *onVisibleHemisphere, bool oRefract) const
+{
+    projectAzimuthal([this](double c) { return projectionK(c); }, lon, lat, count, screen, onVisibleHemisphere,
+                     oRefract);
+}
+
 bool Projector::onScreen(const QPointF &p) const
 {
     return (0 <= p.x() && p.x() <= m_vp.width && 0 <= p.y() && p.y() <= m_vp.height);
@@ -40,6 +40,7 @@
 
 #include <QPointF>
 
+#include <algorithm>
 #include <cstddef>
 #include <cmath>
 
@@ -138,6 +139,34 @@ class Projector
      */
     QPointF toScreen(const SkyPoint *o, bool oRefract = true, bool *onVisibleHemisphere = nullptr) const;
 
+    /**
+     * @short Project many points at once.
+     *
+     * The result is the same as toScreenVec() for each point, but the projection of the whole batch is done by
+     * one virtual call: the sines and cosines are computed on SIMD registers and the projection-specific code is
+     * inlined in the loop. Points whose coordinates are not finite are at (0, 0) and not visible.
+     *
+     * @param lon azimuths when using horizontal coordinates, right ascensions otherwise, in radians
+     * @param lat unrefracted altitudes when using horizontal coordinates, declinations otherwise, in radians
+     * @param count number of points
+     * @param screen array of @p count screen pixel coordinates to fill
+     * @param onVisibleHemisphere if not nullptr, array of @p count bools set to whether each point is on the
+     *   visible part of the Celestial Sphere.
+     * @param oRefract same as for toScreenVec()
+     */
+    void toScreenBatch(const double *lon, const double *lat, int count, Vector2f *screen,
+                       bool *onVisibleHemisphere = nullptr, bool oRefract = true) const;
+
+    /**
+     * @short Project many SkyPoints at once.
+     * The coordinates of the points are gathered in chunks and projected with
+     * toScreenBatch(const double *, const double *, int, Vector2f *, bool *, bool).
+     * @param points iterator or pointer to the first of @p count pointers (or shared pointers) to SkyPoints
+     */
+    template <class Iterator>
+    void toScreenBatch(Iterator points, int count, Vector2f *screen, bool *onVisibleHemisphere = nullptr,
+                       bool oRefract = true) const;
+
     /**
      * @short Determine RA, Dec coordinates of the pixel at (dx, dy), which are the
      * screen pixel coordinate offsets from the center of the Sky pixmap.
@@ -276,6 +305,28 @@ class Projector
      */
     virtual double cosMaxFieldAngle() const { return 0; }
 
+    /**
+     * Project a batch of points, see toScreenBatch(). The default implementation calls projectionK() for each
+     * point, projections reimplement it with projectAzimuthal() and their own kernel.
+     * @param oRefract true if refraction must be applied, already combined with m_vp.useRefraction
+     */
+    virtual void projectBatch(const double *lon, const double *lat, int count, Vector2f *screen,
+                              bool *onVisibleHemisphere, bool oRefract) const;
+
+    /**
+     * Batch version of the azimuthal projection of toScreenVec(), for any @p Kernel callable as
+     * double projectionK(double c). It is defined in projectorbatch.h.
+     */
+    template <class Kernel>
+    void projectAzimuthal(const Kernel &projectionK, const double *lon, const double *lat, int count,
+                          Vector2f *screen, bool *onVisibleHemisphere, bool oRefract) const;
+
+    /// Number of points projected together, so that their intermediate values stay in the L1 cache
+    enum
+    {
+        BatchChunk = 256
+    };
+
     /**
      * Helper function for drawing ground.
      * @return the point with Alt = 0, az = @p az
@@ -294,3 +345,31 @@ class Projector
     double m_xrange { 0 };
     bool m_isPoleVisible { false };
 };
+
+template <class Iterator>
+void Projector::toScreenBatch(Iterator points, int count, Vector2f *screen, bool *onVisibleHemisphere,
+                              bool oRefract) const
+{
+    double lon[BatchChunk], lat[BatchChunk];
+
+    for (int begin = 0; begin < count; begin += BatchChunk)
+    {
+        const int n = std::min(count - begin, int(BatchChunk));
+        for (int i = 0; i < n; ++i)
+        {
+            const auto &p = *(points + (begin + i));
+            if (m_vp.useAltAz)
+            {
+                lon[i] = p->az().radians();
+                lat[i] = p->alt().radians();
+            }
+            else
+            {
+                lon[i] = p->ra().radians();
+                lat[i] = p->dec().radians();
+            }
+        }
+        toScreenBatch(lon, lat, n, screen + begin, onVisibleHemisphere ? onVisibleHemisphere + begin : nullptr,
+                      oRefract);
+    }
+}
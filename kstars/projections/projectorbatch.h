@@ -0,0 +1,122 @@
+/***************************************************************************
+                    projectorbatch.h  -  K Desktop Planetarium
+                             -------------------
+    begin                : Sun 18 Oct 2026
+    copyright            : (C) 2026 by KStars Developers
+ ***************************************************************************/
+
+/***************************************************************************
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ ***************************************************************************/
+
+#pragma once
+
+#include "projector.h"
+
+#include "ksutils.h"
+#include "skyobjects/vectorpack.h"
+
+/*
+ * Only the projections include this file: the kernel of each projection is a template argument, so the loop below
+ * is compiled once per projection with the kernel inlined.
+ */
+template <class Kernel>
+void Projector::projectAzimuthal(const Kernel &projectionK, const double *lon, const double *lat, int count,
+                                 Vector2f *screen, bool *onVisibleHemisphere, bool oRefract) const
+{
+    typedef VectorPack P;
+
+    alignas(32) double dX[BatchChunk];
+    alignas(32) double Y[BatchChunk];
+    alignas(32) double sindX[BatchChunk];
+    alignas(32) double cosdX[BatchChunk];
+    alignas(32) double sinY[BatchChunk];
+    alignas(32) double cosY[BatchChunk];
+
+    const double focusX = (m_vp.useAltAz ? m_vp.focus->az().radians() : m_vp.focus->ra().radians());
+    const double cosMax = cosMaxFieldAngle();
+    const double origX  = m_vp.width / 2;
+    const double origY  = m_vp.height / 2;
+    const double zoom   = m_vp.zoomFactor;
+#ifdef KSTARS_LITE
+    const double skyRotation = SkyMapLite::Instance()->getSkyRotation();
+    double sinT = 0, cosT = 1;
+    if (skyRotation != 0)
+        dms(skyRotation).SinCos(sinT, cosT);
+#endif
+
+    for (int begin = 0; begin < count; begin += BatchChunk)
+    {
+        const int n = std::min(count - begin, int(BatchChunk));
+
+        for (int i = 0; i < n; ++i)
+        {
+            if (m_vp.useAltAz)
+            {
+                //account for atmospheric refraction
+                Y[i]  = (oRefract ? SkyPoint::refract(lat[begin + i] / dms::DegToRad) * dms::DegToRad : lat[begin + i]);
+                dX[i] = focusX - lon[begin + i];
+            }
+            else
+            {
+                Y[i]  = lat[begin + i];
+                dX[i] = lon[begin + i] - focusX;
+            }
+            dX[i] = KSUtils::reduceAngle(dX[i], -dms::PI, dms::PI);
+        }
+
+        // Sines and cosines, NaN for the points that are not finite
+        int i = 0;
+        for (; i + P::width <= n; i += P::width)
+        {
+            P::type s, c;
+            vectorSinCos<P>(P::load(dX + i), s, c);
+            P::store(sindX + i, s);
+            P::store(cosdX + i, c);
+            vectorSinCos<P>(P::load(Y + i), s, c);
+            P::store(sinY + i, s);
+            P::store(cosY + i, c);
+        }
+        for (; i < n; ++i)
+        {
+            vectorSinCos<ScalarPack>(dX[i], sindX[i], cosdX[i]);
+            vectorSinCos<ScalarPack>(Y[i], sinY[i], cosY[i]);
+        }
+
+        for (i = 0; i < n; ++i)
+        {
+            if (!(std::isfinite(Y[i]) && std::isfinite(dX[i])))
+            {
+                screen[begin + i] = Vector2f(0, 0);
+                if (onVisibleHemisphere)
+                    onVisibleHemisphere[begin + i] = false;
+                continue;
+            }
+
+            //c is the cosine of the angular distance from the center
+            double c = m_sinY0 * sinY[i] + m_cosY0 * cosY[i] * cosdX[i];
+            if (onVisibleHemisphere)
+                onVisibleHemisphere[begin + i] = (c > cosMax);
+
+            double k = projectionK(c);
+            double x = origX - zoom * k * cosY[i] * sindX[i];
+            double y = origY - zoom * k * (m_cosY0 * sinY[i] - m_sinY0 * cosY[i] * cosdX[i]);
+#ifdef KSTARS_LITE
+            if (skyRotation != 0)
+            {
+                double newX = origX + (x - origX) * cosT - (y - origY) * sinT;
+                double newY = origY + (x - origX) * sinT + (y - origY) * cosT;
+
+                x = newX;
+                y = newY;
+            }
+#endif
+            screen[begin + i] = Vector2f(x, y);
+        }
+    }
+}
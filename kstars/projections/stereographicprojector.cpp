@@ -19,6 +19,20 @@
 
 #include "stereographicprojector.h"
 
+#include "projectorbatch.h"
+
+namespace
+{
+/** k(c) of the projection, shared by projectionK() and the batch projection */
+struct StereographicKernel
+{
+    inline double operator()(double c) const
+    {
+        return 2.0 / (1.0 + c);
+    }
+};
+}
+
 StereographicProjector::StereographicProjector(const ViewParams &p) : Projector(p)
 {
     updateClipPoly();
@@ -36,10 +50,16 @@ double StereographicProjector::radius() const
 
 double StereographicProjector::projectionK(double x) const
 {
-    return 2.0 / (1.0 + x);
+    return StereographicKernel()(x);
 }
 
 double StereographicProjector::projectionL(double x) const
 {
     return 2.0 * atan2(x, 2.0);
 }
+
+void StereographicProjector::projectBatch(const double *lon, const double *lat, int count, Vector2f *screen,
+                                          bool *onVisibleHemisphere, bool oRefract) const
+{
+    projectAzimuthal(StereographicKernel(), lon, lat, count, screen, onVisibleHemisphere, oRefract);
+}
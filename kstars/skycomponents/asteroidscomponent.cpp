@@ -49,6 +49,7 @@ AsteroidsComponent::AsteroidsComponent(SolarSystemComposite *parent) : BinaryLis
     SolarSystemListComponent(parent)
 {
     loadData();
+    loadOrbits();
 }
 
 AsteroidsComponent::~AsteroidsComponent()
@@ -214,13 +215,12 @@ void AsteroidsComponent::draw(SkyPainter *skyp)
 
     skyp->setBrush(QBrush(QColor("gray")));
 
-    foreach (SkyObject *so, m_ObjectList)
-    {
+    visitBodies(DRAW_BUF, [&](KSPlanetBase *body) {
         // FIXME: God help us!
-        KSAsteroid *ast = (KSAsteroid *)so;
+        KSAsteroid *ast = (KSAsteroid *)body;
 
         if (!ast->toDraw())
-            continue;
+            return;
 
         bool drawn = false;
 
@@ -231,7 +231,7 @@ void AsteroidsComponent::draw(SkyPainter *skyp)
 
         if (drawn && !(hideLabels || ast->mag() >= labelMagLimit))
             SkyLabeler::AddLabel(ast, SkyLabeler::ASTEROID_LABEL);
-    }
+    });
 #endif
 }
 
@@ -242,18 +242,17 @@ SkyObject *AsteroidsComponent::objectNearest(SkyPoint *p, double &maxrad)
     if (!selected())
         return nullptr;
 
-    foreach (SkyObject *o, m_ObjectList)
-    {
-        if (!(((KSAsteroid*)o)->toDraw()))
-            continue;
+    visitBodies(OBJ_NEAREST_BUF, [&](KSPlanetBase *body) {
+        if (!(((KSAsteroid *)body)->toDraw()))
+            return;
 
-        double r = o->angularDistanceTo(p).Degrees();
+        double r = body->angularDistanceTo(p).Degrees();
         if (r < maxrad)
         {
-            oBest  = o;
+            oBest  = body;
             maxrad = r;
         }
-    }
+    });
 
     return oBest;
 }
@@ -291,6 +290,7 @@ void AsteroidsComponent::downloadReady()
 
     // Reload asteroids
     loadData(true);
+    loadOrbits();
 #ifdef KSTARS_LITE
     KStarsLite::Instance()->data()->setFullTimeUpdate();
 #else
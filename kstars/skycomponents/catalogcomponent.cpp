@@ -19,10 +19,54 @@
 
 #include "catalogdata.h"
 #include "kstarsdata.h"
+#include "skymesh.h"
 #include "skypainter.h"
+#include "htmesh/MeshIterator.h"
 #include "skyobjects/starobject.h"
 #include "skyobjects/deepskyobject.h"
 
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace
+{
+/** Magnitude used to sort objects, objects of unknown magnitude come last */
+float sortMagnitude(const SkyObject *obj)
+{
+    const float mag = obj->mag();
+    return (std::isnan(mag) || mag > 36.0) ? std::numeric_limits<float>::infinity() : mag;
+}
+
+bool brighterThan(const SkyObject *obj1, const SkyObject *obj2)
+{
+    return sortMagnitude(obj1) < sortMagnitude(obj2);
+}
+
+template <class T>
+void updateObject(T *obj, KStarsData *data)
+{
+    if (obj->updateID != data->updateID())
+    {
+        obj->updateID = data->updateID();
+        if (obj->updateNumID != data->updateNumID())
+        {
+            obj->updateCoords(data->updateNum());
+        }
+        obj->EquatorialToHorizontal(data->lst(), data->geo()->lat());
+    }
+}
+
+/** Update the coordinates of a catalog object, either a star or a deep sky object */
+void updateObject(SkyObject *obj, KStarsData *data)
+{
+    if (obj->type() == 0)
+        updateObject(static_cast<StarObject *>(obj), data);
+    else
+        updateObject(static_cast<DeepSkyObject *>(obj), data);
+}
+}
+
 CatalogComponent::CatalogComponent(SkyComposite *parent, const QString &catname, bool showerrs, int index,
                                    bool callLoadData)
     : ListComponent(parent), m_catName(catname), m_Showerrs(showerrs), m_ccIndex(index)
@@ -63,8 +107,10 @@ void CatalogComponent::_loadData(bool includeCatalogDesignation)
         emitProgressText(i18n("Loading internal catalog: %1", m_catName));
 
     QList<QPair<int, QString>> names;
+    QVector<Trixel> trixels;
 
-    KStarsData::Instance()->catalogdb()->GetAllObjects(m_catName, m_ObjectList, names, this, includeCatalogDesignation);
+    KStarsData::Instance()->catalogdb()->GetAllObjects(m_catName, m_ObjectList, names, this, includeCatalogDesignation,
+                                                       &trixels);
     for (int iter = 0; iter < names.size(); ++iter)
     {
         if (names.at(iter).first <= SkyObject::TYPE_UNKNOWN)
@@ -140,6 +186,13 @@ void CatalogComponent::_loadData(bool includeCatalogDesignation)
     for (auto &list : objectNames())
         list.removeDuplicates();
 
+    // Trixels come with the objects, from the catalog snapshot
+    m_Index.clear();
+    for (int i = 0; i < m_ObjectList.size(); ++i)
+        m_Index[trixels[i]].append(m_ObjectList[i]);
+    for (CatalogList &list : m_Index)
+        std::stable_sort(list.begin(), list.end(), brighterThan);
+
     CatalogData loaded_catalog_data;
     KStarsData::Instance()->catalogdb()->GetCatalogData(m_catName, loaded_catalog_data);
     m_catColor    = loaded_catalog_data.color;
@@ -147,45 +200,23 @@ void CatalogComponent::_loadData(bool includeCatalogDesignation)
     m_catFluxUnit = loaded_catalog_data.fluxunit;
 }
 
+void CatalogComponent::appendIndex(SkyObject *obj)
+{
+    CatalogList &list = m_Index[SkyMesh::Instance()->index(obj)];
+    list.insert(std::upper_bound(list.begin(), list.end(), obj, brighterThan), obj);
+}
+
 void CatalogComponent::update(KSNumbers *)
 {
+#ifdef KSTARS_LITE
     if (selected())
     {
         KStarsData *data = KStarsData::Instance();
-        foreach (SkyObject *obj, m_ObjectList)
-        {
-            DeepSkyObject *dso = dynamic_cast<DeepSkyObject *>(obj);
-            StarObject *so     = dynamic_cast<StarObject *>(obj);
-            Q_ASSERT(dso || so); // We either have stars, or deep sky objects
-            if (dso)
-            {
-                // Update the deep sky object if need be
-                if (dso->updateID != data->updateID())
-                {
-                    dso->updateID = data->updateID();
-                    if (dso->updateNumID != data->updateNumID())
-                    {
-                        dso->updateCoords(data->updateNum());
-                    }
-                    dso->EquatorialToHorizontal(data->lst(), data->geo()->lat());
-                }
-            }
-            else
-            {
-                // Do exactly the same thing for stars
-                if (so->updateID != data->updateID())
-                {
-                    so->updateID = data->updateID();
-                    if (so->updateNumID != data->updateNumID())
-                    {
-                        so->updateCoords(data->updateNum());
-                    }
-                    so->EquatorialToHorizontal(data->lst(), data->geo()->lat());
-                }
-            }
-        }
+        for (SkyObject *obj : m_ObjectList)
+            updateObject(obj, data);
         this->updateID = data->updateID();
     }
+#endif
 }
 
 void CatalogComponent::draw(SkyPainter *skyp)
@@ -196,14 +227,44 @@ void CatalogComponent::draw(SkyPainter *skyp)
     skyp->setBrush(Qt::NoBrush);
     skyp->setPen(QColor(m_catColor));
 
-    // Check if the coordinates have been updated
-    if (updateID != KStarsData::Instance()->updateID())
-        update(nullptr);
+    // Same faint limit as the deep sky objects, objects of unknown magnitude are always drawn
+    double maglim = Options::magLimitDrawDeepSky();
+    double lgmin  = log10(MINZOOM);
+    double lgmax  = log10(MAXZOOM);
+    double lgz    = log10(Options::zoomFactor());
+    if (lgz <= 0.75 * lgmax)
+        maglim -= (Options::magLimitDrawDeepSky() - Options::magLimitDrawDeepSkyZoomOut()) * (0.75 * lgmax - lgz) /
+                  (0.75 * lgmax - lgmin);
+
+    MeshIterator region(SkyMesh::Instance(), DRAW_BUF);
+    while (region.hasNext())
+    {
+        QHash<Trixel, CatalogList>::const_iterator trixel = m_Index.constFind(region.next());
+        if (trixel == m_Index.constEnd())
+            continue;
+
+        // Skip the objects fainter than the limit, up to those of unknown magnitude
+        const CatalogList &list                = trixel.value();
+        CatalogList::const_iterator unknownMag = std::partition_point(
+            list.constBegin(), list.constEnd(), [](const SkyObject *obj) { return !std::isinf(sortMagnitude(obj)); });
+        CatalogList::const_iterator faint = std::upper_bound(
+            list.constBegin(), unknownMag, maglim, [](double mag, const SkyObject *obj) { return mag < obj->mag(); });
+
+        drawObjects(skyp, list.constBegin(), faint);
+        drawObjects(skyp, unknownMag, list.constEnd());
+    }
+}
+
+void CatalogComponent::drawObjects(SkyPainter *skyp, CatalogList::const_iterator first,
+                                   CatalogList::const_iterator last)
+{
+    KStarsData *data = KStarsData::Instance();
 
-    //Draw Custom Catalog objects
-    // FIXME: Improve using HTM!
-    foreach (SkyObject *obj, m_ObjectList)
+    for (; first != last; ++first)
     {
+        SkyObject *obj = *first;
+        updateObject(obj, data);
+
         if (obj->type() == 0)
         {
             StarObject *starobj = static_cast<StarObject *>(obj);
@@ -226,6 +287,51 @@ void CatalogComponent::draw(SkyPainter *skyp)
     }
 }
 
+SkyObject *CatalogComponent::objectNearest(SkyPoint *p, double &maxrad)
+{
+    if (!selected())
+        return nullptr;
+
+    KStarsData *data = KStarsData::Instance();
+    SkyObject *oBest = nullptr;
+
+    MeshIterator region(SkyMesh::Instance(), OBJ_NEAREST_BUF);
+    while (region.hasNext())
+    {
+        QHash<Trixel, CatalogList>::const_iterator trixel = m_Index.constFind(region.next());
+        if (trixel == m_Index.constEnd())
+            continue;
+
+        for (SkyObject *obj : trixel.value())
+        {
+            updateObject(obj, data);
+            double r = obj->angularDistanceTo(p).Degrees();
+            if (r < maxrad)
+            {
+                oBest  = obj;
+                maxrad = r;
+            }
+        }
+    }
+    return oBest;
+}
+
+void CatalogComponent::objectsInArea(QList<SkyObject *> &list, const SkyRegion &region)
+{
+    if (!selected())
+        return;
+
+    for (SkyRegion::const_iterator it = region.constBegin(); it != region.constEnd(); ++it)
+    {
+        QHash<Trixel, CatalogList>::const_iterator trixel = m_Index.constFind(it.key());
+        if (trixel != m_Index.constEnd())
+        {
+            for (SkyObject *obj : trixel.value())
+                list.append(obj);
+        }
+    }
+}
+
 bool CatalogComponent::getVisibility()
 {
     return (Options::showCatalog().at(m_ccIndex) > 0) ? true : false;
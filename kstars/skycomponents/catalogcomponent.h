@@ -19,6 +19,7 @@
 
 #include "listcomponent.h"
 #include "Options.h"
+#include "typedef.h"
 
 struct stat;
 
@@ -27,6 +28,9 @@ struct stat;
  * Represents a custom user-defined catalog.
  * Code adapted from CustomCatalogComponent.cpp originally authored by Thomas Kabelmann --spacetime
  *
+ * Objects are indexed by the trixel of the sky mesh containing their J2000 position, brightest first within each
+ * trixel, so that drawing and searching only visit the objects of the trixels in view.
+ *
  * @author Thomas Kabelmann
  *         Rishab Arora (spacetime)
  * @version 0.2
@@ -51,8 +55,16 @@ class CatalogComponent : public ListComponent
      */
     void draw(SkyPainter *skyp) override;
 
+    /**
+     * @short Update the coordinates of all objects in KStars Lite, which draws them all.
+     * Otherwise objects are updated when they are drawn or searched, like deep-sky objects.
+     */
     void update(KSNumbers *num) override;
 
+    SkyObject *objectNearest(SkyPoint *p, double &maxrad) override;
+
+    void objectsInArea(QList<SkyObject *> &list, const SkyRegion &region) override;
+
     /** @return the name of the catalog */
     inline QString name() const { return m_catName; }
 
@@ -91,10 +103,22 @@ class CatalogComponent : public ListComponent
     /** @short Load data into custom catalog */
     virtual void _loadData(bool includeCatalogDesignation);
 
+    /** @short Add an object of m_ObjectList to the trixel index, keeping its trixel sorted by magnitude */
+    void appendIndex(SkyObject *obj);
+
     // FIXME: There seems to be no way to remove catalogs from the program. -- asimha
 
     QString m_catName, m_catColor, m_catFluxFreq, m_catFluxUnit;
     bool m_Showerrs { false };
     int m_ccIndex { 0 };
     quint32 updateID { 0 };
+
+  private:
+    typedef QVector<SkyObject *> CatalogList;
+
+    /** @short Update and draw a range of objects of a trixel */
+    void drawObjects(SkyPainter *skyp, CatalogList::const_iterator first, CatalogList::const_iterator last);
+
+    /** @short Objects by trixel, by increasing magnitude then objects of unknown magnitude */
+    QHash<Trixel, CatalogList> m_Index;
 };
@@ -188,6 +188,8 @@ void CometsComponent::loadData()
         objectNames(SkyObject::COMET).append(com->name());
         objectLists(SkyObject::COMET).append(QPair<QString, const SkyObject *>(com->name(), com));
     }
+
+    loadOrbits();
 }
 
 void CometsComponent::draw(SkyPainter *skyp)
@@ -204,9 +206,8 @@ void CometsComponent::draw(SkyPainter *skyp)
     skyp->setPen(QPen(QColor("transparent")));
     skyp->setBrush(QBrush(QColor("white")));
 
-    foreach (SkyObject *so, m_ObjectList)
-    {
-        KSComet *com = (KSComet *)so;
+    visitBodies(DRAW_BUF, [&](KSPlanetBase *body) {
+        KSComet *com = (KSComet *)body;
         double mag   = com->mag();
         if (std::isnan(mag) == 0)
         {
@@ -214,7 +215,7 @@ void CometsComponent::draw(SkyPainter *skyp)
             if (drawn && !(hideLabels || com->rsun() >= rsunLabelLimit))
                 SkyLabeler::AddLabel(com, SkyLabeler::COMET_LABEL);
         }
-    }
+    });
 #endif
 }
 
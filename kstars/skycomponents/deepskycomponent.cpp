@@ -501,6 +501,9 @@ void DeepSkyComponent::drawDeepSkyCatalog(SkyPainter *skyp, bool drawObject, Dee
     //DrawID drawID = m_skyMesh->drawID();
     MeshIterator region(m_skyMesh, DRAW_BUF);
 
+    // The objects of all trixels are projected and drawn at once
+    QVector<DeepSkyObject *> objs;
+
     while (region.hasNext())
     {
         Trixel trixel       = region.next();
@@ -533,12 +536,19 @@ void DeepSkyComponent::drawDeepSkyCatalog(SkyPainter *skyp, bool drawObject, Dee
             bool sizeCriterion = (size > 1.0 || Options::zoomFactor() > 2000.);
             bool magCriterion  = (mag < (float)maglim) || (showUnknownMagObjects && (std::isnan(mag) || mag > 36.0));
             if (sizeCriterion && magCriterion)
-            {
-                bool drawn = skyp->drawDeepSkyObject(obj, drawImage);
-                if (drawn && !(m_hideLabels || mag > labelMagLim))
-                    addLabel(proj->toScreen(obj), obj);
-                //FIXME: find a better way to do above
-            }
+                objs.append(obj);
+        }
+    }
+
+    QVector<bool> drawn(objs.size());
+    skyp->drawDeepSkyObjects(objs.constData(), objs.size(), drawImage, drawn.data());
+    if (!m_hideLabels)
+    {
+        for (int i = 0; i < objs.size(); ++i)
+        {
+            //FIXME: find a better way to do this
+            if (drawn[i] && !(objs[i]->mag() > labelMagLim))
+                addLabel(proj->toScreen(objs[i]), objs[i]);
         }
     }
 #else
@@ -35,10 +35,15 @@
 
 #include <kstars_debug.h>
 
+#include <deque>
+
 #ifdef _WIN32
 #include <windows.h>
 #endif
 
+// How far ahead (in seconds) the motion of the focus is extrapolated to predict the next aperture
+#define PREFETCH_LOOKAHEAD 0.5
+
 DeepStarComponent::DeepStarComponent(SkyComposite *parent, QString fileName, float trigMag, bool staticstars)
     : ListComponent(parent), m_reindexNum(J2000), triggerMag(trigMag), m_FaintMagnitude(-5.0), staticStars(staticstars),
       dataFileName(fileName)
@@ -52,6 +57,7 @@ DeepStarComponent::DeepStarComponent(SkyComposite *parent, QString fileName, flo
 
 DeepStarComponent::~DeepStarComponent()
 {
+    m_prefetchFuture.waitForFinished();
     if (fileOpened)
         starReader.closeFile();
     fileOpened = false;
@@ -309,9 +315,21 @@ void DeepStarComponent::draw(SkyPainter *skyp)
     t_drawUnnamed = 0;
 
     visibleStarCount = 0;
+    // Stars of a trixel are projected and drawn at once. The deque keeps the scratch points of compact stars at
+    // the same address while it grows.
+    PointSourceBatch batch;
+    std::deque<SkyPoint> compactStars;
 
     t.start();
 
+    // The background loader may be recycling blocks of any trixel, so keep it out while drawing
+    QMutexLocker cacheLocker(m_StarBlockFactory->cacheMutex());
+
+    // While slewing, trixels that are not resident are handed to the background loader
+    // instead of stalling the frame. Whatever is already loaded in them is still drawn.
+    bool deferLoading = !staticStars && map->isSlewing();
+    QVector<Trixel> deferredTrixels;
+
     // Mark used blocks in the LRU Cache. Not required for static stars
     if (!staticStars)
     {
@@ -350,7 +368,9 @@ void DeepStarComponent::draw(SkyPainter *skyp)
         if ((int)currentRegion >= m_starBlockList.size())
             continue;
 
-        if (!staticStars && !m_starBlockList.at(currentRegion)->fillToMag(maglim) &&
+        if (deferLoading && !m_starBlockList.at(currentRegion)->isFilledToMag(maglim))
+            deferredTrixels.append(currentRegion);
+        else if (!staticStars && !m_starBlockList.at(currentRegion)->fillToMag(maglim) &&
             maglim <= m_FaintMagnitude * (1 - 1.5 / 16))
         {
             qCWarning(KSTARS) << "SBL::fillToMag( " << maglim << " ) failed for trixel " << currentRegion;
@@ -363,6 +383,11 @@ void DeepStarComponent::draw(SkyPainter *skyp)
 
         // REMARK: The following should never carry state, except for const parameters like updateID and maglim
         std::function<void(std::shared_ptr<StarBlock>)> mapFunction = [&updateID, &maglim](std::shared_ptr<StarBlock> myBlock) {
+            if (myBlock->isCompact())
+            {
+                myBlock->JITupdate(maglim);
+                return;
+            }
             for (StarObject &star : myBlock->contents())
             {
                 if (star.updateID != updateID)
@@ -374,6 +399,8 @@ void DeepStarComponent::draw(SkyPainter *skyp)
 
         QtConcurrent::blockingMap(m_starBlockList.at(currentRegion)->contents(), mapFunction);
 
+        batch.clear();
+        size_t nCompact = 0;
         for (int i = 0; i < m_starBlockList.at(currentRegion)->getBlockCount(); ++i)
         {
             std::shared_ptr<StarBlock> block = m_starBlockList.at(currentRegion)->block(i);
@@ -381,26 +408,43 @@ void DeepStarComponent::draw(SkyPainter *skyp)
             //                currentRegion << ". SB has " << block->getStarCount() << " stars" << endl;
             for (int j = 0; j < block->getStarCount(); j++)
             {
+                float mag = block->mag(j);
+
+                if (mag > maglim)
+                    break;
+
+                // Compact stars are drawn through scratch points, so that no StarObject is materialized
+                if (block->isCompact())
+                {
+                    if (nCompact == compactStars.size())
+                        compactStars.emplace_back();
+                    SkyPoint &compactStar = compactStars[nCompact++];
+                    block->apparentPosition(j, compactStar);
+                    batch.append(&compactStar, mag, block->spchar(j));
+                    continue;
+                }
+
                 StarObject *curStar = block->star(j);
 
                 //                qDebug() << "We claim that he's from trixel " << currentRegion
                 //<< ", and indexStar says he's from " << m_skyMesh->indexStar( curStar );
 
-                float mag = curStar->mag();
-
-                if (mag > maglim)
-                    break;
-
-                if (skyp->drawPointSource(curStar, mag, curStar->spchar()))
-                    visibleStarCount++;
+                batch.append(curStar, mag, curStar->spchar());
             }
         }
 
+        skyp->drawPointSources(batch);
+        visibleStarCount += batch.drawn.count(true);
+
         // DEBUG: Uncomment to identify problems with Star Block Factory / preservation of Magnitude Order in the LRU Cache
         //        verifySBLIntegrity();
         t_drawUnnamed += t.restart();
     }
     m_skyMesh->inDraw(false);
+    cacheLocker.unlock();
+
+    if (!staticStars)
+        schedulePrefetch(focus, radius, maglim, deferredTrixels);
 #ifdef PROFILE_SINCOS
     trig_calls_here += dms::trig_function_calls;
     trig_redundancy_here += dms::redundant_trig_function_calls;
@@ -419,12 +463,98 @@ void DeepStarComponent::draw(SkyPainter *skyp)
              << " stars' coordinates (StarObject::updateCoords) for an average of "
              << double(StarObject::updateCoordsCpuTime) / double(StarObject::starsUpdated) * 1.e6 << " us per star.";
 #endif
+#ifdef PROFILE_DYNAMICLOAD
+    qDebug() << dataFileName << (starReader.isMapped() ? "(mmap)" : "(stdio)") << "maglim" << maglim << ":"
+             << nTrixels << "trixels," << visibleStarCount << "stars drawn. Cache update" << t_updateCache
+             << "ms, dynamic load" << t_dynamicLoad << "ms, drawing" << t_drawUnnamed << "ms";
+#endif
 
 #else
     Q_UNUSED(skyp)
 #endif
 }
 
+void DeepStarComponent::schedulePrefetch(const SkyPoint *focus, float radius, float maglim,
+                                         const QVector<Trixel> &deferred)
+{
+#ifndef KSTARS_LITE
+    // Estimate how far the focus moved since the previous frame
+    double dt = (m_focusTimer.isValid() ? m_focusTimer.restart() / 1000.0 : 0.0);
+    if (!m_focusTimer.isValid())
+        m_focusTimer.start();
+
+    double dRA  = focus->ra().Degrees() - m_lastFocus.ra().Degrees();
+    double dDec = focus->dec().Degrees() - m_lastFocus.dec().Degrees();
+    if (dRA > 180.0)
+        dRA -= 360.0;
+    else if (dRA < -180.0)
+        dRA += 360.0;
+    m_lastFocus = *focus;
+
+    // Only one loader at a time; trixels still missing will be reported again by the next frame
+    if (m_prefetchFuture.isRunning())
+        return;
+
+    QVector<Trixel> trixels = deferred;
+
+    // Ignore the first frame after a pause, the motion since then tells us nothing
+    if (dt > 0.0 && dt < 1.0 && (dRA != 0.0 || dDec != 0.0))
+    {
+        // Do not look further ahead than one field of view
+        double k     = PREFETCH_LOOKAHEAD / dt;
+        double shift = sqrt(dRA * dRA + dDec * dDec) * k;
+        if (shift > radius)
+            k *= radius / shift;
+
+        SkyPoint predicted(dms(focus->ra().Degrees() + dRA * k).reduce(),
+                           dms(qBound(-90.0, focus->dec().Degrees() + dDec * k, 90.0)));
+
+        m_skyMesh->aperture(&predicted, radius + 1.0, PREFETCH_BUF);
+        MeshIterator region(m_skyMesh, PREFETCH_BUF);
+
+        QMutexLocker cacheLocker(StarBlockFactory::Instance()->cacheMutex());
+        while (region.hasNext())
+        {
+            Trixel trixel = region.next();
+            if ((int)trixel < m_starBlockList.size() && !trixels.contains(trixel) &&
+                !m_starBlockList.at(trixel)->isFilledToMag(maglim))
+                trixels.append(trixel);
+        }
+    }
+
+    if (trixels.isEmpty())
+        return;
+
+    m_prefetchFuture = QtConcurrent::run(this, &DeepStarComponent::prefetch, trixels, maglim, !deferred.isEmpty());
+#else
+    Q_UNUSED(focus)
+    Q_UNUSED(radius)
+    Q_UNUSED(maglim)
+    Q_UNUSED(deferred)
+#endif
+}
+
+void DeepStarComponent::prefetch(QVector<Trixel> trixels, float maglim, bool redraw)
+{
+    StarBlockFactory *factory = StarBlockFactory::Instance();
+
+    for (Trixel trixel : trixels)
+    {
+        QMutexLocker cacheLocker(factory->cacheMutex());
+
+        if (!m_starBlockList.at(trixel)->fillToMag(maglim, true) && maglim <= m_FaintMagnitude * (1 - 1.5 / 16))
+            qCWarning(KSTARS) << "SBL::fillToMag( " << maglim << " ) failed for trixel " << trixel << "in prefetch";
+    }
+
+#ifndef KSTARS_LITE
+    // Stars in view were skipped by the last frame, so draw them now that they are resident
+    if (redraw)
+        QMetaObject::invokeMethod(SkyMap::Instance(), "forceUpdate", Qt::QueuedConnection);
+#else
+    Q_UNUSED(redraw)
+#endif
+}
+
 bool DeepStarComponent::openDataFile()
 {
     if (starReader.getFileHandle())
@@ -464,6 +594,15 @@ bool DeepStarComponent::openDataFile()
         ret = fread(&MSpT, 2, 1, starReader.getFileHandle());
         if (starReader.getByteSwap())
             MSpT = bswap_16(MSpT);
+        // Dynamically loaded catalogs are paged in by StarBlockList::fillToMag(), which
+        // can then read the records straight out of the mapping instead of using stdio
+        if (!staticStars && Options::memoryMapStarCatalogs())
+        {
+            if (starReader.mapFile())
+                qCInfo(KSTARS) << "  Memory-mapped" << starReader.getMappedSize() << "bytes";
+            else
+                qCWarning(KSTARS) << "Could not memory-map deep star catalog" << dataFileName << ". Using stdio.";
+        }
         fileOpened = true;
         qCInfo(KSTARS) << "  Sky Mesh Size: " << m_skyMesh->size();
         for (long int i = 0; i < m_skyMesh->size(); i++)
@@ -508,6 +647,9 @@ SkyObject *DeepStarComponent::objectNearest(SkyPoint *p, double &maxrad)
 
     MeshIterator region(m_skyMesh, OBJ_NEAREST_BUF);
 
+    StarBlockFactory *factory = StarBlockFactory::Instance();
+    QMutexLocker cacheLocker(factory->cacheMutex());
+
     while (region.hasNext())
     {
         Trixel currentRegion = region.next();
@@ -519,6 +661,34 @@ SkyObject *DeepStarComponent::objectNearest(SkyPoint *p, double &maxrad)
         for (int i = 0; i < m_starBlockList.at(currentRegion)->getBlockCount(); ++i)
         {
             std::shared_ptr<StarBlock> block = m_starBlockList.at(currentRegion)->block(i);
+            // The star returned may be used after the mutex is released, keep the prefetch from recycling it
+            block->drawID = factory->drawID;
+#ifndef KSTARS_LITE
+            // Only materialize the best match of compact blocks
+            if (block->isCompact())
+            {
+                SkyPoint compactStar;
+                int jBest = -1;
+
+                block->JITupdate(m_zoomMagLimit);
+                for (int j = 0; j < block->getStarCount(); ++j)
+                {
+                    if (block->mag(j) > m_zoomMagLimit)
+                        break;
+
+                    block->apparentPosition(j, compactStar);
+                    double r = compactStar.angularDistanceTo(p).Degrees();
+                    if (r < maxrad)
+                    {
+                        jBest  = j;
+                        maxrad = r;
+                    }
+                }
+                if (jBest >= 0)
+                    oBest = block->star(jBest);
+                continue;
+            }
+#endif
             for (int j = 0; j < block->getStarCount(); ++j)
             {
 #ifdef KSTARS_LITE
@@ -573,6 +743,9 @@ bool DeepStarComponent::starsInAperture(QList<StarObject *> &list, const SkyPoin
     if (maglim < -28)
         maglim = m_FaintMagnitude;
 
+    StarBlockFactory *factory = StarBlockFactory::Instance();
+    QMutexLocker cacheLocker(factory->cacheMutex());
+
     while (region.hasNext())
     {
         Trixel currentRegion = region.next();
@@ -583,6 +756,27 @@ bool DeepStarComponent::starsInAperture(QList<StarObject *> &list, const SkyPoin
         for (int i = 0; i < sbl->getBlockCount(); ++i)
         {
             std::shared_ptr<StarBlock> block = sbl->block(i);
+            // The stars listed are used after the mutex is released, keep the prefetch from recycling them
+            block->drawID = factory->drawID;
+#ifndef KSTARS_LITE
+            // Only materialize the stars of compact blocks that lie in the aperture
+            if (block->isCompact())
+            {
+                SkyPoint compactStar;
+
+                block->JITupdate(maglim);
+                for (int j = 0; j < block->getStarCount(); ++j)
+                {
+                    if (block->mag(j) > maglim)
+                        break;
+
+                    block->apparentPosition(j, compactStar);
+                    if (compactStar.angularDistanceTo(&center).Degrees() <= radius)
+                        list.append(block->star(j));
+                }
+                continue;
+            }
+#endif
             for (int j = 0; j < block->getStarCount(); ++j)
             {
 #ifdef KSTARS_LITE
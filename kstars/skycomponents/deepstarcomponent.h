@@ -17,6 +17,8 @@
 
 #pragma once
 
+//#define PROFILE_DYNAMICLOAD
+
 /**
  * @class DeepStarComponent
  * Stores and manages unnamed stars, most of which are dynamically loaded into memory.
@@ -31,8 +33,12 @@
 #include "listcomponent.h"
 #include "starblockfactory.h"
 #include "skyobjects/deepstardata.h"
+#include "skyobjects/skypoint.h"
 #include "skyobjects/stardata.h"
 
+#include <QElapsedTimer>
+#include <QFuture>
+
 class SkyLabeler;
 class SkyMesh;
 class StarBlockFactory;
@@ -89,6 +95,20 @@ class DeepStarComponent : public ListComponent
 
     bool verifySBLIntegrity();
 
+    /**
+     * @short Fill the StarBlockLists of the given trixels up to a magnitude limit
+     *
+     * This is the body of the background loader started from draw(). It takes the
+     * StarBlockFactory cache mutex for one trixel at a time, so that the draw thread never
+     * waits for more than a single trixel to be read. It only recycles blocks unused since the
+     * previous draw cycle, the GUI thread may still hold stars of the others.
+     *
+     * @param trixels Trixels to load
+     * @param maglim Magnitude limit to load them to
+     * @param redraw If true, ask the sky map to redraw once something has been loaded
+     */
+    void prefetch(QVector<Trixel> trixels, float maglim, bool redraw);
+
     /**
      * @short Add to the given list, the stars from this component,
      * that lie within the specified circular aperture, and that are
@@ -113,6 +133,20 @@ class DeepStarComponent : public ListComponent
     static StarBlockFactory m_StarBlockFactory;
 
   private:
+    /**
+     * @short Start loading the trixels the view is about to need in the background
+     *
+     * The next aperture is predicted by extrapolating the motion of the focus since the
+     * previous frame. Trixels of the current aperture whose loading was deferred by draw()
+     * are queued first.
+     *
+     * @param focus Current focus of the sky map
+     * @param radius Radius of the current aperture in degrees
+     * @param maglim Magnitude limit to load stars to
+     * @param deferred Trixels in view that draw() did not load
+     */
+    void schedulePrefetch(const SkyPoint *focus, float radius, float maglim, const QVector<Trixel> &deferred);
+
     SkyMesh *m_skyMesh { nullptr };
     KSNumbers m_reindexNum;
 
@@ -132,6 +166,11 @@ class DeepStarComponent : public ListComponent
     long unsigned t_drawUnnamed { 0 };
     long unsigned t_updateCache { 0 };
 
+    // Background loading of star blocks
+    QFuture<void> m_prefetchFuture;
+    SkyPoint m_lastFocus;
+    QElapsedTimer m_focusTimer;
+
     QVector<std::shared_ptr<StarBlockList>> m_starBlockList;
     QHash<int, StarObject *> m_CatalogNumber;
 
@@ -92,9 +92,26 @@ void SatellitesComponent::update(KSNumbers *)
     if (!selected())
         return;
 
+    QVector<Satellite *> satellites;
     foreach (SatelliteGroup *group, m_groups)
     {
-        group->updateSatellitesPos();
+        for (int i = 0; i < group->size(); i++)
+        {
+            if (group->at(i)->selected())
+                satellites.append(group->at(i));
+        }
+    }
+    m_propagator.setSatellites(satellites);
+
+    // Satellites below the horizon are hidden by the ground, or not visible
+    KStarsData *data      = KStarsData::Instance();
+    bool skipBelowHorizon = Options::showGround() || Options::showVisibleSatellites();
+
+    // If position cannot be calculated, remove it from list
+    foreach (Satellite *sat, m_propagator.update(data->geo(), data->clock()->utc().djd(), skipBelowHorizon))
+    {
+        foreach (SatelliteGroup *group, m_groups)
+            group->removeOne(sat);
     }
 }
 
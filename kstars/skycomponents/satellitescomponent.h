@@ -18,6 +18,7 @@
 #pragma once
 
 #include "satellitegroup.h"
+#include "satellitepropagator.h"
 #include "skycomponent.h"
 
 #include <QList>
@@ -58,7 +59,8 @@ class SatellitesComponent : public SkyComponent
     void draw(SkyPainter *skyp) override;
 
     /**
-     * Update satellites position.
+     * Update position of the selected satellites, in parallel.
+     * Satellites below the horizon are skipped when they would not be drawn.
      * @param num
      */
     void update(KSNumbers *num) override;
@@ -109,4 +111,5 @@ class SatellitesComponent : public SkyComponent
   private:
     QList<SatelliteGroup *> m_groups; // List of all groups
     QHash<QString, Satellite *> nameHash;
+    SatellitePropagator m_propagator;
 };
@@ -591,6 +591,11 @@ QList<SkyObject *> SkyMapComposite::findObjectsInArea(const SkyPoint &p1, const
         m_Stars->objectsInArea(list, region);
     if (m_DeepSky->selected())
         m_DeepSky->objectsInArea(list, region);
+    // Custom catalogs check whether they are shown themselves
+    foreach (SkyComponent *sc, m_CustomCatalogs->components())
+        sc->objectsInArea(list, region);
+    m_internetResolvedComponent->objectsInArea(list, region);
+    m_manualAdditionsComponent->objectsInArea(list, region);
     return list;
 }
 
@@ -154,6 +154,12 @@ void SolarSystemComposite::drawTrails(SkyPainter *skyp)
             comp->drawTrails(skyp);
 }
 
+void SolarSystemComposite::updateObject(const SkyObject *obj)
+{
+    if (obj && !m_AsteroidsComponent->updateObject(obj))
+        m_CometsComponent->updateObject(obj);
+}
+
 const QList<SkyObject *> &SolarSystemComposite::asteroids() const
 {
     return m_AsteroidsComponent->objectList();
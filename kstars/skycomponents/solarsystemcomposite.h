@@ -63,6 +63,13 @@ class SolarSystemComposite : public SkyComposite
 
     void drawTrails(SkyPainter *skyp) override;
 
+    /**
+     * @short Compute the position of an asteroid or a comet for the last update, if it was not yet
+     * Bodies out of view are only computed on request, call this before using the coordinates of one.
+     * @param obj Object to update, other objects are ignored
+     */
+    void updateObject(const SkyObject *obj);
+
     CometsComponent *cometsComponent();
 
     AsteroidsComponent *asteroidsComponent();
@@ -19,16 +19,47 @@
 #include "solarsystemcomposite.h"
 
 #include <QPen>
+#include <QtConcurrent>
 #include <KLocalizedString>
 
 #include "Options.h"
 #include "skyobjects/ksplanet.h"
 #include "skyobjects/ksplanetbase.h"
 #include "kstarsdata.h"
+#include "htmesh/MeshIterator.h"
 #ifndef KSTARS_LITE
 #include "skymap.h"
+#else
+#include "skymaplite.h"
 #endif
 
+#include <cmath>
+
+namespace
+{
+/** @return the object the sky map is centered on, if any */
+const SkyObject *focusObject()
+{
+#ifdef KSTARS_LITE
+    SkyMapLite *map = SkyMapLite::Instance();
+#else
+    SkyMap *map = SkyMap::Instance();
+#endif
+    return map ? map->focusObject() : nullptr;
+}
+
+/** @return the object last clicked on the sky map, if any */
+const SkyObject *clickedObject()
+{
+#ifdef KSTARS_LITE
+    SkyMapLite *map = SkyMapLite::Instance();
+#else
+    SkyMap *map = SkyMap::Instance();
+#endif
+    return map ? map->clickedObject() : nullptr;
+}
+}
+
 SolarSystemListComponent::SolarSystemListComponent(SolarSystemComposite *p) : ListComponent(p), m_Earth(p->earth())
 {
 }
@@ -38,37 +69,211 @@ SolarSystemListComponent::~SolarSystemListComponent()
     //Object deletes handled by parent class (ListComponent)
 }
 
+void SolarSystemListComponent::loadOrbits()
+{
+    m_Bodies.clear();
+    m_BodyIndex.clear();
+    m_Batch.clear();
+    m_Index.clear();
+
+    for (SkyObject *o : m_ObjectList)
+    {
+        // FIXME: get rid of cast.
+        KSPlanetBase *p = (KSPlanetBase *)o;
+        m_BodyIndex.insert(p, m_Bodies.count());
+        m_Bodies.append(p);
+        m_Batch.append(p);
+    }
+
+    m_BodyUpdateNum.fill(0, m_Bodies.count());
+    m_BodyUpdateID.fill(0, m_Bodies.count());
+}
+
 void SolarSystemListComponent::update(KSNumbers *)
 {
+#ifdef KSTARS_LITE
     if (selected())
     {
-        KStarsData *data = KStarsData::Instance();
-        foreach (SkyObject *o, m_ObjectList)
+        for (const QVector<int> &trixel : m_Index)
         {
-            // FIXME: get rid of cast.
-            KSPlanetBase *p = (KSPlanetBase *)o;
-            p->EquatorialToHorizontal(data->lst(), data->geo()->lat());
+            for (int index : trixel)
+                updateBody(index);
         }
     }
+#endif
 }
 
 void SolarSystemListComponent::updateSolarSystemBodies(KSNumbers *num)
 {
-    if (selected())
+    if (!selected())
+        return;
+
+    KStarsData *data = KStarsData::Instance();
+    SkyMesh *mesh    = SkyMesh::Instance();
+
+    m_Num.reset(new KSNumbers(*num));
+    m_UpdateNum++;
+    m_Batch.update(num->julianDay(), m_Earth);
+
+    // Asteroids are drawn down to the magnitude limit, except the one being focused
+    const double magLimit  = Options::magLimitAsteroid();
+    const SkyObject *focus = focusObject();
+
+    // Bodies whose position is computed now: those the batch does not handle, those with a trail, then those in view
+    QVector<int> bodies;
+
+    m_Index.clear();
+    for (int i = 0; i < m_Bodies.count(); ++i)
+    {
+        KSPlanetBase *p = m_Bodies.at(i);
+
+        if (!m_Batch.isHandled(i))
+        {
+            bodies.append(i);
+            continue;
+        }
+        if (p->hasTrail())
+            bodies.append(i);
+
+        // The lower bound stands for the magnitude until the position is computed, see KSAsteroid::toCalculate()
+        const double mag = m_Batch.magnitude(i);
+        if (!std::isnan(mag))
+            p->setMag(mag);
+        if (mag >= magLimit && p != focus)
+            continue;
+
+        double ra, dec;
+        m_Batch.position(i, ra, dec);
+        m_Index[mesh->HTMesh::index(ra, dec)].append(i);
+    }
+
+#ifdef KSTARS_LITE
+    // KStars Lite draws all the bodies
+    for (const QVector<int> &trixel : m_Index)
+    {
+        for (int index : trixel)
+        {
+            if (!m_Bodies.at(index)->hasTrail())
+                bodies.append(index);
+        }
+    }
+#else
+    MeshIterator region(mesh, DRAW_BUF);
+    while (region.hasNext())
+    {
+        QHash<Trixel, QVector<int>>::const_iterator trixel = m_Index.constFind(region.next());
+        if (trixel == m_Index.constEnd())
+            continue;
+
+        for (int index : trixel.value())
+        {
+            if (!m_Bodies.at(index)->hasTrail())
+                bodies.append(index);
+        }
+    }
+#endif
+
+    // Trails are not extended concurrently
+    QtConcurrent::blockingMap(bodies, [&](int &index) {
+        if (!m_Bodies.at(index)->hasTrail())
+            updateBody(index);
+    });
+
+    for (int index : bodies)
     {
-        KStarsData *data = KStarsData::Instance();
-        foreach (SkyObject *o, m_ObjectList)
+        KSPlanetBase *p = m_Bodies.at(index);
+
+        if (p->hasTrail())
         {
-            KSPlanetBase *p = (KSPlanetBase *)o;
-            p->findPosition(num, data->geo()->lat(), data->lst(), m_Earth);
-            p->EquatorialToHorizontal(data->lst(), data->geo()->lat());
+            updateBody(index);
+            p->updateTrail(data->lst(), data->geo()->lat());
+        }
+
+        // Bodies the batch does not handle are indexed by their computed position
+        if (!m_Batch.isHandled(index))
+            m_Index[mesh->index(p)].append(index);
+    }
 
-            if (p->hasTrail())
-                p->updateTrail(data->lst(), data->geo()->lat());
+    // Tracking and centering need the position of these bodies even out of view
+    updateObject(focus);
+    updateObject(clickedObject());
+}
+
+bool SolarSystemListComponent::updateObject(const SkyObject *obj)
+{
+    QHash<const SkyObject *, int>::const_iterator body = m_BodyIndex.constFind(obj);
+    if (body == m_BodyIndex.constEnd())
+        return false;
+
+    // Nothing to compute before the first update
+    if (m_Num)
+        updateBody(body.value());
+    return true;
+}
+
+SkyObject *SolarSystemListComponent::findByName(const QString &name)
+{
+    SkyObject *o = ListComponent::findByName(name);
+    if (o)
+        updateObject(o);
+    return o;
+}
+
+void SolarSystemListComponent::updateBody(int index)
+{
+    KStarsData *data = KStarsData::Instance();
+    KSPlanetBase *p  = m_Bodies.at(index);
+
+    bool moved = false;
+
+    if (m_BodyUpdateNum.at(index) != m_UpdateNum)
+    {
+        m_BodyUpdateNum[index] = m_UpdateNum;
+        p->findPosition(m_Num.get(), data->geo()->lat(), data->lst(), m_Earth);
+        moved = true;
+    }
+
+    if (moved || m_BodyUpdateID.at(index) != data->updateID())
+    {
+        m_BodyUpdateID[index] = data->updateID();
+        p->EquatorialToHorizontal(data->lst(), data->geo()->lat());
+    }
+}
+
+void SolarSystemListComponent::visitBodies(MeshBufNum_t bufNum, const std::function<void(KSPlanetBase *)> &visit)
+{
+    MeshIterator region(SkyMesh::Instance(), bufNum);
+    while (region.hasNext())
+    {
+        QHash<Trixel, QVector<int>>::const_iterator trixel = m_Index.constFind(region.next());
+        if (trixel == m_Index.constEnd())
+            continue;
+
+        for (int index : trixel.value())
+        {
+            updateBody(index);
+            visit(m_Bodies.at(index));
         }
     }
 }
 
+SkyObject *SolarSystemListComponent::objectNearest(SkyPoint *p, double &maxrad)
+{
+    if (!selected())
+        return nullptr;
+
+    SkyObject *oBest = nullptr;
+    visitBodies(OBJ_NEAREST_BUF, [&](KSPlanetBase *body) {
+        double r = body->angularDistanceTo(p).Degrees();
+        if (r < maxrad)
+        {
+            oBest  = body;
+            maxrad = r;
+        }
+    });
+    return oBest;
+}
+
 void SolarSystemListComponent::drawTrails(SkyPainter *skyp)
 {
     //FIXME: here for all objects trails are drawn this could be source of inefficiency
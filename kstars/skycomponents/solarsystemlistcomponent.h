@@ -19,13 +19,30 @@
 #define SOLARSYSTEMLISTCOMPONENT_H
 
 #include "listcomponent.h"
+#include "skymesh.h"
+#include "typedef.h"
+#include "skyobjects/minorbodybatch.h"
+
+#include <QHash>
+#include <QVector>
+
+#include <functional>
+#include <memory>
 
 class KSPlanet;
+class KSPlanetBase;
 class SolarSystemComposite;
 
 /**
  *@class SolarSystemListComponent
  *
+ * Asteroids and comets are too many to compute all their positions on every update. The orbits are first solved
+ * for all bodies at once by a MinorBodyBatch, which gives an approximate position and, for asteroids, a lower bound
+ * of the magnitude. Asteroids fainter than the limit are skipped, the other bodies are indexed by the trixel of
+ * their approximate J2000 position. The bodies in view, and the focused or clicked one, get their full position
+ * computed in parallel, the others when they are visited by draw() or objectNearest() through visitBodies(), found
+ * by findByName(), or passed to updateObject().
+ *
  *@author Jason Harris
  *@version 1.0
  */
@@ -36,6 +53,10 @@ class SolarSystemListComponent : public ListComponent
 
     ~SolarSystemListComponent() override;
 
+    /**
+     * @short Update the horizontal coordinates of all indexed bodies in KStars Lite, which draws them all.
+     * Otherwise the bodies are updated when they are visited.
+     */
     void update(KSNumbers *num) override;
 
     /** @short Update the coordinates of the solar system bodies in this component.
@@ -46,11 +67,51 @@ class SolarSystemListComponent : public ListComponent
          */
     void updateSolarSystemBodies(KSNumbers *num) override;
 
+    SkyObject *objectNearest(SkyPoint *p, double &maxrad) override;
+
+    /** @short Find a body by name, its position is computed for the last update */
+    SkyObject *findByName(const QString &name) override;
+
+    /**
+     * @short Compute the position of a body for the last update, if it was not yet
+     * @param obj Object to update, which may belong to another component
+     * @return true if obj is a body of this component
+     */
+    bool updateObject(const SkyObject *obj);
+
   protected:
+    /** @short Read the orbits of the bodies of m_ObjectList, to be called whenever the list was loaded */
+    void loadOrbits();
+
+    /**
+     * @short Call visit for the bodies that may be drawn in the trixels of a mesh buffer
+     * The position of a body is computed before it is visited, if it was not yet for the last update.
+     */
+    void visitBodies(MeshBufNum_t bufNum, const std::function<void(KSPlanetBase *)> &visit);
+
     void drawTrails(SkyPainter *skyp) override;
 
   private:
+    /** @short Compute the position of the body at index for the last update, then its horizontal coordinates */
+    void updateBody(int index);
+
     KSPlanet *m_Earth;
+
+    /// Bodies of m_ObjectList, in the order of the batch
+    QVector<KSPlanetBase *> m_Bodies;
+    /// Index of each body in m_Bodies
+    QHash<const SkyObject *, int> m_BodyIndex;
+    MinorBodyBatch m_Batch;
+    /// Bodies that may be drawn, by trixel of their approximate J2000 position
+    QHash<Trixel, QVector<int>> m_Index;
+
+    /// Time of the last update, and its count
+    std::unique_ptr<KSNumbers> m_Num;
+    quint32 m_UpdateNum { 0 };
+    /// For each body, count of the update its position was computed for
+    QVector<quint32> m_BodyUpdateNum;
+    /// For each body, KStarsData::updateID() of its horizontal coordinates
+    QVector<quint32> m_BodyUpdateID;
 };
 
 #endif
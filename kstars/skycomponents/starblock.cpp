@@ -19,10 +19,19 @@
 
 #include "starblock.h"
 #include "skyobjects/starobject.h"
+#include "skyobjects/apparentplacebatch.h"
 #include "starcomponent.h"
 #include "skyobjects/stardata.h"
 #include "skyobjects/deepstardata.h"
 
+#ifndef KSTARS_LITE
+#include "kstarsdata.h"
+#include "Options.h"
+#endif
+
+#include <cmath>
+#include <ctime>
+
 #ifdef KSTARS_LITE
 #include "skymaplite.h"
 #include "kstarslite/skyitems/skynodes/pointsourcenode.h"
@@ -41,14 +50,36 @@ StarNode::~StarNode()
 }
 #endif
 
-StarBlock::StarBlock(int nstars)
+StarBlock::StarBlock(int nstars, bool compact)
     : faintMag(-5), brightMag(35), parent(nullptr), prev(nullptr), next(nullptr), drawID(0), nStars(0),
+      capacity(nstars)
+{
 #ifdef KSTARS_LITE
-      stars(nstars, StarNode())
+    Q_UNUSED(compact)
+    stars = QVector<StarNode>(nstars, StarNode());
 #else
-      stars(nstars, StarObject())
+    this->compact = compact;
+    if (!compact)
+    {
+        stars = QVector<StarObject>(nstars, StarObject());
+        return;
+    }
+
+    cStars.ra0.resize(nstars);
+    cStars.dec0.resize(nstars);
+    cStars.pmRA.resize(nstars);
+    cStars.pmDec.resize(nstars);
+    cStars.mag.resize(nstars);
+    cStars.B.resize(nstars);
+    cStars.V.resize(nstars);
+    cStars.spType.resize(2 * nstars);
+    cStars.ra.resize(nstars);
+    cStars.dec.resize(nstars);
+    cStars.alt.resize(nstars);
+    cStars.az.resize(nstars);
+    materialized.fill(nullptr, nstars);
+    materializedValid.fill(false, nstars);
 #endif
-{
 }
 
 void StarBlock::reset()
@@ -60,10 +91,16 @@ void StarBlock::reset()
     faintMag  = -5.0;
     brightMag = 35.0;
     nStars    = 0;
+#ifndef KSTARS_LITE
+    nPrecessed = nUpdated = 0;
+#endif
 }
 
 StarBlock::~StarBlock()
 {
+#ifndef KSTARS_LITE
+    qDeleteAll(materialized);
+#endif
 }
 
 #ifdef KSTARS_LITE
@@ -101,6 +138,30 @@ StarObject *StarBlock::addStar(const StarData &data)
 {
     if (isFull())
         return nullptr;
+
+    if (compact)
+    {
+        // NOTE: Parallax, HD number and flags are not kept by compact blocks
+        int i             = nStars++;
+        cStars.ra0[i]     = data.RA / 1000000.0 * 15.0;
+        cStars.dec0[i]    = data.Dec / 100000.0;
+        cStars.pmRA[i]    = data.dRA / 10.0;
+        cStars.pmDec[i]   = data.dDec / 10.0;
+        cStars.mag[i]     = data.mag / 100.0;
+        cStars.B[i]       = 99.9;
+        cStars.V[i]       = 99.9;
+        cStars.spType[2 * i]     = data.spec_type[0];
+        cStars.spType[2 * i + 1] = data.spec_type[1];
+        materializedValid[i]     = false;
+
+        if (cStars.mag[i] > faintMag)
+            faintMag = cStars.mag[i];
+        if (cStars.mag[i] < brightMag)
+            brightMag = cStars.mag[i];
+        // Do not materialize the star just because it was added
+        return nullptr;
+    }
+
     StarObject &star = stars[nStars++];
 
     star.init(&data);
@@ -115,6 +176,46 @@ StarObject *StarBlock::addStar(const DeepStarData &data)
 {
     if (isFull())
         return nullptr;
+
+    if (compact)
+    {
+        // Same conventions as StarObject::init( const DeepStarData * )
+        int i          = nStars++;
+        cStars.ra0[i]  = data.RA / 1000000.0 * 15.0;
+        cStars.dec0[i] = data.Dec / 100000.0;
+        cStars.pmRA[i] = data.dRA / 100.0;
+        cStars.pmDec[i] = data.dDec / 100.0;
+        if (data.V == 30000 && data.B != 30000)
+            cStars.mag[i] = (data.B - 1600) / 1000.0;
+        else
+            cStars.mag[i] = data.V / 1000.0;
+        cStars.B[i] = data.B / 1000.0;
+        cStars.V[i] = data.V / 1000.0;
+
+        char sp = 'B';
+        if (data.B == 30000 || data.V == 30000)
+            sp = '?';
+        else
+        {
+            double BV_Index = (data.B - data.V) / 1000.0;
+            (BV_Index > 0.0) && (sp = 'A');
+            (BV_Index > 0.325) && (sp = 'F');
+            (BV_Index > 0.575) && (sp = 'G');
+            (BV_Index > 0.975) && (sp = 'K');
+            (BV_Index > 1.6) && (sp = 'M');
+        }
+        cStars.spType[2 * i]     = sp;
+        cStars.spType[2 * i + 1] = '?';
+        materializedValid[i]     = false;
+
+        if (cStars.mag[i] > faintMag)
+            faintMag = cStars.mag[i];
+        if (cStars.mag[i] < brightMag)
+            brightMag = cStars.mag[i];
+        // Do not materialize the star just because it was added
+        return nullptr;
+    }
+
     StarObject &star = stars[nStars++];
 
     star.init(&data);
@@ -124,4 +225,124 @@ StarObject *StarBlock::addStar(const DeepStarData &data)
         brightMag = star.mag();
     return &star;
 }
+
+StarObject *StarBlock::star(int i)
+{
+    if (!compact)
+        return &stars[i];
+
+    if (!materializedValid[i])
+    {
+        if (!materialized[i])
+            materialized[i] = new StarObject();
+        initCompactStar(i, *materialized[i]);
+        materializedValid[i] = true;
+    }
+    // Callers expect the same apparent position as the star had when it was drawn
+    materialized[i]->JITupdate();
+    return materialized[i];
+}
+
+void StarBlock::initCompactStar(int i, StarObject &star) const
+{
+    star.init(cStars.ra0[i], cStars.dec0[i], cStars.mag[i], cStars.spType.constData() + 2 * i, cStars.pmRA[i],
+              cStars.pmDec[i], cStars.B[i], cStars.V[i]);
+}
+
+void StarBlock::JITupdate(float maglim)
+{
+    static KStarsData *data = KStarsData::Instance();
+
+    if (!compact)
+        return;
+
+    // Same criteria as StarObject::JITupdate(), but tracked for the whole block
+    if (updateNumID != data->updateNumID())
+    {
+        if (Options::alwaysRecomputeCoordinates() || std::abs(precessJD - data->updateNum()->getJD()) >= 0.00069444)
+        {
+            nPrecessed = 0;
+            precessJD  = data->updateNum()->getJD();
+        }
+        updateNumID = data->updateNumID();
+    }
+    if (updateID != data->updateID())
+    {
+        nUpdated = 0;
+        updateID = data->updateID();
+    }
+    nUpdated = qMin(nUpdated, nPrecessed);
+
+    if (nUpdated >= nStars)
+        return;
+
+    // Like the per-star loop used to, stop after the first star that is too faint
+    int end = nUpdated;
+    while (end < nStars && cStars.mag[end] <= maglim)
+        ++end;
+    end = qMin(end + 1, nStars);
+
+#ifdef PROFILE_UPDATECOORDS
+    std::clock_t start = std::clock();
+#endif
+
+    if (Options::useRelativistic())
+    {
+        // Light bending depends on the position of each star with respect to the Sun, which the
+        // batch kernel does not handle. Go through a scratch StarObject instead.
+        StarObject scratch;
+        SkyPoint apparent;
+
+        for (int i = nUpdated; i < end; ++i)
+        {
+            if (i >= nPrecessed)
+            {
+                initCompactStar(i, scratch);
+                scratch.updateCoords(data->updateNum());
+                cStars.ra[i]  = scratch.ra().Degrees();
+                cStars.dec[i] = scratch.dec().Degrees();
+            }
+
+            apparent.setRA(cStars.ra[i] / 15.0);
+            apparent.setDec(cStars.dec[i]);
+            apparent.EquatorialToHorizontal(data->lst(), data->geo()->lat());
+            cStars.alt[i] = apparent.alt().Degrees();
+            cStars.az[i]  = apparent.az().Degrees();
+        }
+    }
+    else
+    {
+        ApparentPlaceBatch batch(data->updateNum());
+        batch.setLocation(data->lst(), data->geo()->lat());
+
+        // Stars that are already precessed only need new horizontal coordinates
+        int precessed = qMin(nPrecessed, end);
+        if (nUpdated < precessed)
+            batch.toHorizontal(precessed - nUpdated, cStars.ra.constData() + nUpdated,
+                               cStars.dec.constData() + nUpdated, cStars.alt.data() + nUpdated,
+                               cStars.az.data() + nUpdated);
+
+        int first = qMax(nUpdated, nPrecessed);
+        if (first < end)
+            batch.apply(end - first, cStars.ra0.constData() + first, cStars.dec0.constData() + first,
+                        cStars.pmRA.constData() + first, cStars.pmDec.constData() + first, cStars.ra.data() + first,
+                        cStars.dec.data() + first, cStars.alt.data() + first, cStars.az.data() + first);
+    }
+
+#ifdef PROFILE_UPDATECOORDS
+    StarObject::updateCoordsCpuTime += double(std::clock() - start) / double(CLOCKS_PER_SEC);
+    StarObject::starsUpdated += end - qMax(nUpdated, nPrecessed);
+#endif
+
+    nPrecessed = qMax(nPrecessed, end);
+    nUpdated   = end;
+}
+
+void StarBlock::apparentPosition(int i, SkyPoint &p) const
+{
+    p.setRA(cStars.ra[i] / 15.0);
+    p.setDec(cStars.dec[i]);
+    p.setAlt(cStars.alt[i]);
+    p.setAz(cStars.az[i]);
+}
 #endif
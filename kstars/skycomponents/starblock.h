@@ -23,6 +23,7 @@
 
 #include <QVector>
 
+class SkyPoint;
 class StarObject;
 class StarBlockList;
 class PointSourceNode;
@@ -46,6 +47,12 @@ struct StarNode
  *@class StarBlock
  *Holds a block of stars and various peripheral variables to mark its place in data structures
  *
+ *A StarBlock can be created compact. A compact StarBlock does not hold StarObjects, but only
+ *the few quantities needed to draw unnamed stars (J2000.0 position, proper motion, magnitudes,
+ *spectral type and the cached apparent and horizontal positions), stored as one array per
+ *quantity. StarObjects are materialized on demand when star() is called, e.g. for
+ *objectNearest() and popup menus. Compact blocks are not available in KStars Lite.
+ *
  *@author  Akarsh Simha
  *@version 1.0
  */
@@ -63,8 +70,9 @@ class StarBlock
     /** Constructor
          *  Initializes values of various parameters and creates nstars number of stars
          *  @param nstars   Number of stars to hold in this StarBlock
+         *  @param compact  Hold the stars in compact arrays instead of StarObjects
          */
-    explicit StarBlock(int nstars = 100);
+    explicit StarBlock(int nstars = 100, bool compact = false);
 
     /**
          * Destructor
@@ -79,7 +87,8 @@ class StarBlock
          *  have names.
          *
          *@param  data    data to initialize star with.
-         *@return pointer to star initialized with data. nullptr if block is full.
+         *@return pointer to star initialized with data. nullptr if block is full, and always
+         *        nullptr for compact blocks, which do not materialize the star (see star()).
          */
     StarBlockEntry *addStar(const StarData &data);
     StarBlockEntry *addStar(const DeepStarData &data);
@@ -100,8 +109,9 @@ class StarBlock
          *
          *@return The number of stars that this StarBlock can hold
          */
-    inline int size() const { return stars.size(); }
+    inline int size() const { return capacity; }
 
+#ifdef KSTARS_LITE
     /**
          *@short  Return the i-th star in this StarBlock
          *
@@ -109,6 +119,54 @@ class StarBlock
          *@return A pointer to the i-th StarObject
          */
     inline StarBlockEntry *star(int i) { return &stars[i]; }
+#else
+    /**
+         *@short  Return the i-th star in this StarBlock
+         *
+         *For compact blocks, the StarObject is materialized from the compact arrays the first
+         *time it is requested after the star was added. The returned pointer stays valid as
+         *long as the StarBlock exists, but it may be re-initialized with another star once
+         *the block is recycled.
+         *
+         *@param  Index of StarBlock to return
+         *@return A pointer to the i-th StarObject
+         */
+    StarBlockEntry *star(int i);
+
+    /**
+         *@return true if the stars of this block are held in compact arrays
+         */
+    inline bool isCompact() const { return compact; }
+
+    /**
+         *@short  Return the magnitude of the i-th star without materializing it
+         */
+    inline float mag(int i) const { return (compact ? cStars.mag[i] : stars[i].mag()); }
+
+    /**
+         *@short  Return the spectral class of the i-th star without materializing it
+         */
+    inline char spchar(int i) const { return (compact ? cStars.spType[2 * i] : stars[i].spchar()); }
+
+    /**
+         *@short  Bring the apparent and horizontal positions of the compact stars up to date
+         *
+         *This is the compact counterpart of StarObject::JITupdate(). Stars are updated in
+         *order of increasing magnitude until the first star fainter than maglim.
+         *
+         *@param  maglim  Magnitude limit down to which stars are needed
+         */
+    void JITupdate(float maglim);
+
+    /**
+         *@short  Set the apparent and horizontal position of the i-th compact star on a SkyPoint
+         *
+         *@param  i  Index of the star
+         *@param  p  SkyPoint to write the position to
+         *@note   JITupdate() must have been called for the star
+         */
+    void apparentPosition(int i, SkyPoint &p) const;
+#endif
 
     /**
          *@return a reference to the internal container of this
@@ -116,6 +174,7 @@ class StarBlock
          */
 
     inline QVector<StarBlockEntry> &contents() { return stars; }
+    // NOTE: contents() is empty for compact StarBlocks
 
     // These methods are there because we might want to make faintMag and brightMag private at some point
     /**
@@ -157,8 +216,38 @@ class StarBlock
 
     /** Number of initialized stars in StarBlock. */
     int nStars;
+    /** Number of stars this StarBlock can hold. */
+    int capacity;
     /** Array of stars. */
     QVector<StarBlockEntry> stars;
+
+#ifndef KSTARS_LITE
+    /** Compact, structure-of-arrays storage of unnamed stars. */
+    struct CompactStars
+    {
+        QVector<float> ra0, dec0;   // J2000.0 position in degrees
+        QVector<float> pmRA, pmDec; // Proper motion in milliarcseconds per year
+        QVector<float> mag, B, V;
+        QVector<char> spType;       // Two characters per star
+        QVector<float> ra, dec;     // Apparent position in degrees
+        QVector<float> alt, az;     // Horizontal position in degrees
+    };
+
+    void initCompactStar(int i, StarObject &star) const;
+
+    bool compact { false };
+    CompactStars cStars;
+    /** StarObjects materialized from the compact arrays, allocated on demand */
+    QVector<StarObject *> materialized;
+    /** Whether materialized[i] holds the star currently at index i */
+    QVector<bool> materializedValid;
+    /** Number of leading stars whose apparent position is valid for updateNumID / horizontal for updateID */
+    int nPrecessed { 0 };
+    int nUpdated { 0 };
+    quint64 updateID { 0 };
+    quint64 updateNumID { 0 };
+    long double precessJD { 0 };
+#endif
 };
 
 #endif
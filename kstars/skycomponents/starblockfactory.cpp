@@ -24,6 +24,8 @@
 
 // TODO: Implement a better way of deciding this
 #define DEFAULT_NCACHE 12
+// Blocks handed out by the factory hold dynamically loaded unnamed stars, so they are compact
+#define DEFAULT_BLOCKSIZE 100
 
 StarBlockFactory *StarBlockFactory::pInstance = nullptr;
 
@@ -50,20 +52,24 @@ StarBlockFactory::~StarBlockFactory()
         pInstance = nullptr;
 }
 
-std::shared_ptr<StarBlock> StarBlockFactory::getBlock()
+std::shared_ptr<StarBlock> StarBlockFactory::getBlock(bool prefetch)
 {
     std::shared_ptr<StarBlock> freeBlock;
 
     if (nBlocks < nCache)
     {
-        freeBlock.reset(new StarBlock);
+        freeBlock.reset(new StarBlock(DEFAULT_BLOCKSIZE, true));
         if (freeBlock.get())
         {
             ++nBlocks;
             return freeBlock;
         }
     }
-    if (last && (last->drawID != drawID || last->drawID == 0))
+    // Blocks are pinned for one more draw cycle when loading in the background
+    bool recyclable = false;
+    if (last)
+        recyclable = prefetch ? (last->drawID + 1 < drawID) : (last->drawID != drawID || last->drawID == 0);
+    if (recyclable)
     {
         //        qCDebug(KSTARS) << "Recycling block with drawID =" << last->drawID << "and current drawID =" << drawID;
         if (last->parent->block(last->parent->getBlockCount() - 1) != last)
@@ -83,7 +89,7 @@ std::shared_ptr<StarBlock> StarBlockFactory::getBlock()
         freeBlock->next = nullptr;
         return freeBlock;
     }
-    freeBlock.reset(new StarBlock);
+    freeBlock.reset(new StarBlock(DEFAULT_BLOCKSIZE, true));
     if (freeBlock.get())
         ++nBlocks;
 
@@ -19,6 +19,8 @@
 
 #include "typedef.h"
 
+#include <QMutex>
+
 class StarBlock;
 
 /**
@@ -49,9 +51,12 @@ class StarBlockFactory
      * as the most recently used. If the StarBlock had a parent StarBlockList, this method
      * detaches the StarBlock from the StarBlockList
      *
+     * @param  prefetch  If true, only recycle StarBlocks unused in the current and previous draw cycles.
+     * The GUI thread may still point to the stars of blocks it used since the last draw cycle, so threads
+     * other than the GUI thread must set this.
      * @return A StarBlock that is available for use
      */
-    std::shared_ptr<StarBlock> getBlock();
+    std::shared_ptr<StarBlock> getBlock(bool prefetch = false);
 
     /**
      * @short  Mark a StarBlock as most recently used and sync its drawID with the current drawID
@@ -94,6 +99,15 @@ class StarBlockFactory
      */
     void printStructure() const;
 
+    /**
+     * @short  Returns the mutex guarding the cache
+     *
+     * Blocks handed out by getBlock() may be recycled from any StarBlockList, so every
+     * thread that fills, reads or releases StarBlocks of dynamically loaded catalogs must
+     * hold this mutex while doing so. The factory methods do not lock it themselves.
+     */
+    inline QMutex *cacheMutex() { return &m_cacheMutex; }
+
     quint32 drawID; // A number identifying the current draw cycle
 
   private:
@@ -114,6 +128,7 @@ class StarBlockFactory
     std::shared_ptr<StarBlock> first, last; // Pointers to the beginning and end of the linked list
     int nBlocks;             // Number of blocks we currently have in the cache
     int nCache;              // Number of blocks to start recycling cached blocks at
+    QMutex m_cacheMutex;     // Serializes access to the cache between draw and prefetch threads
 
     static StarBlockFactory *pInstance;
 };
@@ -29,6 +29,8 @@
 
 #include <QDebug>
 
+#include <cstring>
+
 StarBlockList::StarBlockList(const Trixel &tr, DeepStarComponent *parent)
 {
     trixel       = tr;
@@ -70,7 +72,28 @@ int StarBlockList::releaseBlock(StarBlock *block)
     return 0;
 }
 
-bool StarBlockList::fillToMag(float maglim)
+namespace
+{
+/**
+ * @short Returns a reference to a star record lying in a memory-mapped catalog
+ *
+ * Records that need no byte swapping and are suitably aligned are consumed in
+ * place. Otherwise they are copied into @p scratch and fixed up there.
+ */
+template <typename T>
+inline const T &mappedRecord(const uchar *record, bool byteSwap, T &scratch)
+{
+    if (!byteSwap && (reinterpret_cast<quintptr>(record) % alignof(T)) == 0)
+        return *reinterpret_cast<const T *>(record);
+
+    memcpy(&scratch, record, sizeof(T));
+    if (byteSwap)
+        DeepStarComponent::byteSwap(&scratch);
+    return scratch;
+}
+}
+
+bool StarBlockList::fillToMag(float maglim, bool prefetch)
 {
     // TODO: Remove staticity of BinFileHelper
     BinFileHelper *dSReader;
@@ -89,7 +112,11 @@ bool StarBlockList::fillToMag(float maglim)
     if (faintMag >= maglim)
         return true;
 
-    if (!dataFile)
+    // If the catalog is memory-mapped, records are read straight from the mapping and
+    // the shared stdio handle is never touched.
+    const bool mapped = dSReader->isMapped();
+
+    if (!mapped && !dataFile)
     {
         qDebug() << "dataFile not opened!";
         return false;
@@ -103,7 +130,21 @@ bool StarBlockList::fillToMag(float maglim)
 
     Q_ASSERT(nBlocks == (unsigned int)blocks.size());
 
-    BinFileHelper::unsigned_KDE_fseek(dataFile, readOffset, SEEK_SET);
+    const int recordSize = dSReader->guessRecordSize();
+    const bool byteSwap  = dSReader->getByteSwap();
+
+    if (mapped)
+    {
+        // All the records of a trixel are contiguous, so checking the end of the trixel is enough
+        quint64 trixelEnd = quint64(readOffset) + quint64(dSReader->getRecordCount(trixelId) - nStars) * recordSize;
+        if (trixelEnd > dSReader->getMappedSize())
+        {
+            qWarning() << "ERROR: Records of trixel" << trixel << "extend beyond the end of the mapped catalog";
+            return false;
+        }
+    }
+    else
+        BinFileHelper::unsigned_KDE_fseek(dataFile, readOffset, SEEK_SET);
 
     /*
     qDebug() << "Reading trixel" << trixel << ", id on disk =" << trixelId << ", currently nStars =" << nStars
@@ -117,7 +158,7 @@ bool StarBlockList::fillToMag(float maglim)
 
         if (nBlocks == 0 || blocks[nBlocks - 1]->isFull())
         {
-            std::shared_ptr<StarBlock> newBlock = SBFactory->getBlock();
+            std::shared_ptr<StarBlock> newBlock = SBFactory->getBlock(prefetch);
 
             if (!newBlock.get())
             {
@@ -135,10 +176,20 @@ bool StarBlockList::fillToMag(float maglim)
             ++nBlocks;
         }
         // TODO: Make this more general
-        if (dSReader->guessRecordSize() == 32)
+        if (mapped)
+        {
+            const uchar *record = dSReader->getMappedData(readOffset);
+
+            if (recordSize == 32)
+                blocks[nBlocks - 1]->addStar(mappedRecord(record, byteSwap, stardata));
+            else
+                blocks[nBlocks - 1]->addStar(mappedRecord(record, byteSwap, deepstardata));
+            readOffset += recordSize;
+        }
+        else if (recordSize == 32)
         {
             ret = fread(&stardata, sizeof(StarData), 1, dataFile);
-            if (dSReader->getByteSwap())
+            if (byteSwap)
                 DeepStarComponent::byteSwap(&stardata);
             readOffset += sizeof(StarData);
             blocks[nBlocks - 1]->addStar(stardata);
@@ -146,7 +197,7 @@ bool StarBlockList::fillToMag(float maglim)
         else
         {
             ret = fread(&deepstardata, sizeof(DeepStarData), 1, dataFile);
-            if (dSReader->getByteSwap())
+            if (byteSwap)
                 DeepStarComponent::byteSwap(&deepstardata);
             readOffset += sizeof(DeepStarData);
             blocks[nBlocks - 1]->addStar(deepstardata);
@@ -165,6 +216,14 @@ bool StarBlockList::fillToMag(float maglim)
     return ((maglim < faintMag) ? true : false);
 }
 
+bool StarBlockList::isFilledToMag(float maglim) const
+{
+    if (staticStars || faintMag >= maglim)
+        return true;
+
+    return (nStars >= parent->getStarReader()->getRecordCount(trixel));
+}
+
 void StarBlockList::setStaticBlock(std::shared_ptr<StarBlock> &block)
 {
     if (!block)
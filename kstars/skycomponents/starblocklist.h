@@ -44,9 +44,18 @@ class StarBlockList
      * @short Ensures that the list is loaded with stars to given magnitude limit
      *
      * @param Magnitude limit to load stars upto
+     * @param prefetch True when loading outside the GUI thread, see StarBlockFactory::getBlock()
      * @return true on success, false on failure (data file not found, bad seek etc)
      */
-    bool fillToMag(float maglim);
+    bool fillToMag(float maglim, bool prefetch = false);
+
+    /**
+     * @short Checks whether the stars down to the given magnitude are already resident
+     *
+     * @param maglim Magnitude limit to check for
+     * @return true if fillToMag( maglim ) would not need to read anything from the catalog
+     */
+    bool isFilledToMag(float maglim) const;
 
     /**
      * @short Sets the first StarBlock in the list to point to the given StarBlock
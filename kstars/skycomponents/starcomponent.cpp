@@ -307,10 +307,17 @@ void StarComponent::draw(SkyPainter *skyp)
     if (hideFaintStars && maglim > hideStarsMag)
         maglim = hideStarsMag;
 
-    m_StarBlockFactory->drawID = m_skyMesh->drawID();
+    {
+        // The background loader of the deep star catalogs compares block drawIDs with it
+        QMutexLocker cacheLocker(m_StarBlockFactory->cacheMutex());
+        m_StarBlockFactory->drawID = m_skyMesh->drawID();
+    }
 
     int nTrixels = 0;
 
+    // The stars of all trixels are projected and drawn at once
+    PointSourceBatch batch;
+
     while (region.hasNext())
     {
         ++nTrixels;
@@ -332,11 +339,22 @@ void StarComponent::draw(SkyPainter *skyp)
             if (curStar->updateID != updateID)
                 curStar->JITupdate();
 
-            bool drawn = skyp->drawPointSource(curStar, mag, curStar->spchar());
+            batch.append(curStar, mag, curStar->spchar());
+        }
+    }
+
+    skyp->drawPointSources(batch);
 
-            //FIXME_SKYPAINTER: find a better way to do this.
-            if (drawn && !(m_hideLabels || mag > labelMagLim))
+    //FIXME_SKYPAINTER: find a better way to do this.
+    if (!m_hideLabels)
+    {
+        for (int i = 0; i < batch.count(); ++i)
+        {
+            if (batch.drawn[i] && batch.mags[i] <= labelMagLim)
+            {
+                StarObject *curStar = static_cast<StarObject *>(batch.locs[i]);
                 addLabel(proj->toScreen(curStar), curStar);
+            }
         }
     }
 
@@ -31,6 +31,7 @@
 #include "ksutils.h"
 #include "Options.h"
 #include "skymapcomposite.h"
+#include "solarsystemcomposite.h"
 #ifdef HAVE_OPENGL
 #include "skymapgldraw.h"
 #endif
@@ -299,11 +300,16 @@ void SkyMap::slotTransientLabel()
 void SkyMap::setClickedObject(SkyObject *o)
 {
     ClickedObject = o;
+    // Asteroids and comets out of view have no current position until requested
+    if (o && data->skyComposite())
+        data->skyComposite()->solarSystemComposite()->updateObject(o);
 }
 
 void SkyMap::setFocusObject(SkyObject *o)
 {
     FocusObject = o;
+    if (o && data->skyComposite())
+        data->skyComposite()->solarSystemComposite()->updateObject(o);
     if (FocusObject)
         Options::setFocusObject(FocusObject->name());
     else
@@ -36,6 +36,8 @@
 #include "skylabeler.h"
 #include "Options.h"
 #include "skymesh.h"
+#include "skymapcomposite.h"
+#include "solarsystemcomposite.h"
 
 #include "kstarslite/skyitems/rootnode.h"
 #include "kstarslite/skyitems/skynodes/skynode.h"
@@ -309,12 +311,17 @@ void SkyMapLite::setClickedPoint(SkyPoint *f)
 void SkyMapLite::setClickedObject(SkyObject *o)
 {
     ClickedObject = o;
+    // Asteroids and comets out of view have no current position until requested
+    if (o && data->skyComposite())
+        data->skyComposite()->solarSystemComposite()->updateObject(o);
     m_ClickedObjectLite->setObject(o);
 }
 
 void SkyMapLite::setFocusObject(SkyObject *o)
 {
     FocusObject = o;
+    if (o && data->skyComposite())
+        data->skyComposite()->solarSystemComposite()->updateObject(o);
     if (FocusObject)
         Options::setFocusObject(FocusObject->name());
     else
@@ -0,0 +1,328 @@
+/***************************************************************************
+                  apparentplacebatch.cpp  -  K Desktop Planetarium
+                             -------------------
+    begin                : Sun 18 Oct 2026
+    copyright            : (C) 2026 by KStars Developers
+ ***************************************************************************/
+
+/***************************************************************************
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ ***************************************************************************/
+
+#include "apparentplacebatch.h"
+
+#include "dms.h"
+#include "ksnumbers.h"
+#include "vectorpack.h"
+
+#include <algorithm>
+#include <cmath>
+
+// Stars are processed in chunks, so that the intermediate values stay in the L1 cache
+#define BATCH_CHUNK 64
+
+namespace
+{
+const double DEG2RAD = M_PI / 180.0;
+const double RAD2DEG = 180.0 / M_PI;
+// Guards divisions at the poles, where the per-star code divides by zero as well
+const double TINY = 1e-300;
+
+/** Intermediate values of one chunk of stars */
+struct Chunk
+{
+    alignas(32) double sinRA[BATCH_CHUNK];
+    alignas(32) double cosRA[BATCH_CHUNK];
+    alignas(32) double sinDec[BATCH_CHUNK];
+    alignas(32) double cosDec[BATCH_CHUNK];
+    alignas(32) double pmRA[BATCH_CHUNK];
+    alignas(32) double pmDec[BATCH_CHUNK];
+    // Results of the vector pass
+    alignas(32) double vx[BATCH_CHUNK];
+    alignas(32) double vy[BATCH_CHUNK];
+    alignas(32) double vz[BATCH_CHUNK];
+    alignas(32) double dRA[BATCH_CHUNK];
+    alignas(32) double dDec[BATCH_CHUNK];
+    alignas(32) double sinAlt[BATCH_CHUNK];
+    alignas(32) double azArg[BATCH_CHUNK];
+    alignas(32) double sinHA[BATCH_CHUNK];
+};
+
+/**
+ * Horizontal coordinates from the sine and cosine of the apparent position, following
+ * SkyPoint::EquatorialToHorizontal(). Stores sin(Alt), the argument of acos() for the
+ * azimuth and sin(HA), which resolves the acos() ambiguity.
+ */
+template <class P>
+inline void horizontal(const ApparentPlaceBatch::Parameters &k, typename P::type sRA, typename P::type cRA,
+                       typename P::type sDec, typename P::type cDec, Chunk &c, int i)
+{
+    typedef typename P::type V;
+
+    const V sinLST = P::set1(k.sinLST), cosLST = P::set1(k.cosLST);
+    const V sinLat = P::set1(k.sinLat), cosLat = P::set1(k.cosLat);
+
+    V sinHA  = P::sub(P::mul(sinLST, cRA), P::mul(cosLST, sRA));
+    V cosHA  = P::add(P::mul(cosLST, cRA), P::mul(sinLST, sRA));
+    V sinAlt = P::add(P::mul(sDec, sinLat), P::mul(P::mul(cDec, cosLat), cosHA));
+    V cosAlt = P::sqrt(P::maxOf(P::sub(P::set1(1.0), P::mul(sinAlt, sinAlt)), P::set1(0.0)));
+    V arg    = P::div(P::sub(sDec, P::mul(sinLat, sinAlt)), P::maxOf(P::mul(cosLat, cosAlt), P::set1(TINY)));
+
+    P::store(c.sinAlt + i, sinAlt);
+    P::store(c.azArg + i, arg);
+    P::store(c.sinHA + i, sinHA);
+}
+
+/**
+ * Proper motion, precession, nutation and aberration of stars [begin, end) of a chunk.
+ * begin must be a multiple of P::width.
+ */
+template <class P>
+void apparentKernel(const ApparentPlaceBatch::Parameters &k, Chunk &c, int begin, int end, bool withHorizontal)
+{
+    typedef typename P::type V;
+
+    const V one = P::set1(1.0), zero = P::set1(0.0), tiny = P::set1(TINY);
+    const V m0 = P::set1(k.m[0]), m1 = P::set1(k.m[1]), m2 = P::set1(k.m[2]);
+    const V m3 = P::set1(k.m[3]), m4 = P::set1(k.m[4]), m5 = P::set1(k.m[5]);
+    const V m6 = P::set1(k.m[6]), m7 = P::set1(k.m[7]), m8 = P::set1(k.m[8]);
+    const V pmScale = P::set1(k.pmScale), pmLimit2 = P::set1(k.pmLimit2);
+    const V aberrA = P::set1(k.aberrA), aberrB = P::set1(k.aberrB);
+    const V sinOb = P::set1(k.sinOb), cosOb = P::set1(k.cosOb);
+    const V deg2rad = P::set1(DEG2RAD);
+
+    for (int i = begin; i + P::width <= end; i += P::width)
+    {
+        V sa = P::load(c.sinRA + i), ca = P::load(c.cosRA + i);
+        V sd = P::load(c.sinDec + i), cd = P::load(c.cosDec + i);
+        V pmra = P::load(c.pmRA + i), pmdec = P::load(c.pmDec + i);
+
+        // Unit vector of the J2000.0 position
+        V x = P::mul(cd, ca), y = P::mul(cd, sa), z = sd;
+
+        // Proper motion along a great circle, see StarObject::getIndexCoords()
+        V wRA  = P::mul(cd, pmra);
+        V pm2  = P::add(P::mul(wRA, wRA), P::mul(pmdec, pmdec));
+        V dst  = P::select(P::ge(pm2, pmLimit2), P::mul(P::sqrt(pm2), pmScale), zero);
+        V dst2 = P::mul(dst, dst);
+        // The displacement is at most a few milliradians, so short series are exact to double precision
+        V sinDst = P::mul(dst, P::sub(one, P::mul(dst2, P::set1(1.0 / 6.0))));
+        V cosDst = P::sub(one, P::mul(dst2, P::sub(P::set1(0.5), P::mul(dst2, P::set1(1.0 / 24.0)))));
+        V invPM  = P::div(one, P::maxOf(P::sqrt(P::add(P::mul(pmra, pmra), P::mul(pmdec, pmdec))), tiny));
+        V cosDir = P::mul(pmdec, invPM), sinDir = P::mul(pmra, invPM);
+        // Direction of motion: cos(dir) * north + sin(dir) * east
+        V tx = P::sub(zero, P::add(P::mul(P::mul(cosDir, sd), ca), P::mul(sinDir, sa)));
+        V ty = P::sub(P::mul(sinDir, ca), P::mul(P::mul(cosDir, sd), sa));
+        V tz = P::mul(cosDir, cd);
+        x    = P::add(P::mul(cosDst, x), P::mul(sinDst, tx));
+        y    = P::add(P::mul(cosDst, y), P::mul(sinDst, ty));
+        z    = P::add(P::mul(cosDst, z), P::mul(sinDst, tz));
+
+        // Precession and nutation
+        V vx = P::add(P::add(P::mul(m0, x), P::mul(m1, y)), P::mul(m2, z));
+        V vy = P::add(P::add(P::mul(m3, x), P::mul(m4, y)), P::mul(m5, z));
+        V vz = P::add(P::add(P::mul(m6, x), P::mul(m7, y)), P::mul(m8, z));
+
+        // Aberration, same formula as SkyPoint::aberrate()
+        V cosDec = P::sqrt(P::add(P::mul(vx, vx), P::mul(vy, vy)));
+        V invCD  = P::div(one, P::maxOf(cosDec, tiny));
+        V cosRA = P::mul(vx, invCD), sinRA = P::mul(vy, invCD), sinDec = vz;
+        V dRA  = P::mul(P::mul(P::mul(aberrA, cosOb), cosRA), invCD);
+        V dDec = P::add(P::mul(P::mul(aberrA, sinRA), P::sub(P::mul(sinOb, cosDec), P::mul(cosOb, sinDec))),
+                        P::mul(P::mul(aberrB, cosRA), sinDec));
+
+        P::store(c.vx + i, vx);
+        P::store(c.vy + i, vy);
+        P::store(c.vz + i, vz);
+        P::store(c.dRA + i, dRA);
+        P::store(c.dDec + i, dDec);
+
+        if (withHorizontal)
+        {
+            // Apply the aberration offsets through the angle addition formulas. The offsets
+            // are below a few milliradians, so short series replace sin() and cos() here too.
+            V dr = P::mul(dRA, deg2rad), dd = P::mul(dDec, deg2rad);
+            V dr2 = P::mul(dr, dr), dd2 = P::mul(dd, dd);
+            V sinDr = P::mul(dr, P::sub(one, P::mul(dr2, P::set1(1.0 / 6.0))));
+            V cosDr = P::sub(one, P::mul(dr2, P::sub(P::set1(0.5), P::mul(dr2, P::set1(1.0 / 24.0)))));
+            V sinDd = P::mul(dd, P::sub(one, P::mul(dd2, P::set1(1.0 / 6.0))));
+            V cosDd = P::sub(one, P::mul(dd2, P::sub(P::set1(0.5), P::mul(dd2, P::set1(1.0 / 24.0)))));
+            V cRA  = P::sub(P::mul(cosRA, cosDr), P::mul(sinRA, sinDr));
+            V sRA  = P::add(P::mul(sinRA, cosDr), P::mul(cosRA, sinDr));
+            V sDec = P::add(P::mul(sinDec, cosDd), P::mul(cosDec, sinDd));
+            V cDec = P::sub(P::mul(cosDec, cosDd), P::mul(sinDec, sinDd));
+            horizontal<P>(k, sRA, cRA, sDec, cDec, c, i);
+        }
+    }
+}
+
+template <class P>
+void horizontalKernel(const ApparentPlaceBatch::Parameters &k, Chunk &c, int begin, int end)
+{
+    for (int i = begin; i + P::width <= end; i += P::width)
+        horizontal<P>(k, P::load(c.sinRA + i), P::load(c.cosRA + i), P::load(c.sinDec + i), P::load(c.cosDec + i), c,
+                      i);
+}
+
+inline float azimuth(double arg, double sinHA)
+{
+    double az;
+    if (arg <= -1.0)
+        az = 180.0;
+    else if (arg >= 1.0)
+        az = 0.0;
+    else
+        az = acos(arg) * RAD2DEG;
+
+    // Resolve acos() ambiguity
+    if (sinHA > 0.0)
+        az = 360.0 - az;
+    return az;
+}
+
+inline void loadSinCos(const float *angle, int n, double *sinA, double *cosA)
+{
+    for (int i = 0; i < n; ++i)
+    {
+        double a = angle[i] * DEG2RAD;
+        sinA[i]  = sin(a);
+        cosA[i]  = cos(a);
+    }
+}
+
+/** Largest multiple of the vector width not exceeding n */
+inline int vectorEnd(int n)
+{
+    return n - n % VectorPack::width;
+}
+}
+
+ApparentPlaceBatch::ApparentPlaceBatch(const KSNumbers *num)
+{
+    // Nutation matrix R1( -eps - dEps ) R3( -dPsi ) R1( eps ), applied after precession
+    double eps  = num->obliquity()->radians();
+    double dEps = num->dObliq() * DEG2RAD;
+    double dPsi = num->dEcLong() * DEG2RAD;
+
+    auto R1 = [](double a) {
+        Eigen::Matrix3d r;
+        r << 1, 0, 0, 0, cos(a), sin(a), 0, -sin(a), cos(a);
+        return r;
+    };
+    auto R3 = [](double a) {
+        Eigen::Matrix3d r;
+        r << cos(a), sin(a), 0, -sin(a), cos(a), 0, 0, 0, 1;
+        return r;
+    };
+
+    // SkyPoint::precess() uses p2(), which holds the J2000.0 -> epoch matrix
+    Eigen::Matrix3d m = R1(-eps - dEps) * R3(-dPsi) * R1(eps) * num->p2();
+    for (int i = 0; i < 3; ++i)
+        for (int j = 0; j < 3; ++j)
+            k.m[3 * i + j] = m(i, j);
+
+    // Proper motion in mas/yr times Julian millenia is the displacement in arcseconds.
+    // Like StarObject::getIndexCoords(), ignore displacements below one arcsecond.
+    double jm  = num->julianMillenia();
+    k.pmScale  = jm * DEG2RAD / 3600.0;
+    k.pmLimit2 = (jm != 0.0) ? 1.0 / (jm * jm) : HUGE_VAL;
+
+    double K = num->constAberr().Degrees();
+    double e = num->earthEccentricity();
+    double sinL, cosL, sinP, cosP;
+    num->sunTrueLongitude().SinCos(sinL, cosL);
+    num->earthPerihelionLongitude().SinCos(sinP, cosP);
+    num->obliquity()->SinCos(k.sinOb, k.cosOb);
+    k.aberrA = K * (e * cosP - cosL);
+    k.aberrB = K * (e * sinP - sinL);
+
+    k.sinLST = k.sinLat = 0.0;
+    k.cosLST = k.cosLat = 1.0;
+}
+
+void ApparentPlaceBatch::setLocation(const dms *LST, const dms *lat)
+{
+    LST->SinCos(k.sinLST, k.cosLST);
+    lat->SinCos(k.sinLat, k.cosLat);
+    locationSet = true;
+}
+
+void ApparentPlaceBatch::apply(int n, const float *ra0, const float *dec0, const float *pmRA, const float *pmDec,
+                               float *ra, float *dec, float *alt, float *az) const
+{
+    Chunk c;
+    const bool withHorizontal = (alt && az && locationSet);
+
+    for (int start = 0; start < n; start += BATCH_CHUNK)
+    {
+        const int count = std::min(BATCH_CHUNK, n - start);
+
+        loadSinCos(ra0 + start, count, c.sinRA, c.cosRA);
+        loadSinCos(dec0 + start, count, c.sinDec, c.cosDec);
+        for (int i = 0; i < count; ++i)
+        {
+            c.pmRA[i]  = (pmRA ? pmRA[start + i] : 0.0);
+            c.pmDec[i] = (pmDec ? pmDec[start + i] : 0.0);
+        }
+
+        const int vend = vectorEnd(count);
+        apparentKernel<VectorPack>(k, c, 0, vend, withHorizontal);
+        apparentKernel<ScalarPack>(k, c, vend, count, withHorizontal);
+
+        for (int i = 0; i < count; ++i)
+        {
+            double r = atan2(c.vy[i], c.vx[i]) * RAD2DEG + c.dRA[i];
+            if (r < 0.0)
+                r += 360.0;
+            else if (r >= 360.0)
+                r -= 360.0;
+            ra[start + i]  = r;
+            dec[start + i] = asin(std::max(-1.0, std::min(1.0, c.vz[i]))) * RAD2DEG + c.dDec[i];
+
+            if (withHorizontal)
+            {
+                alt[start + i] = asin(std::max(-1.0, std::min(1.0, c.sinAlt[i]))) * RAD2DEG;
+                az[start + i]  = azimuth(c.azArg[i], c.sinHA[i]);
+            }
+        }
+    }
+}
+
+void ApparentPlaceBatch::toHorizontal(int n, const float *ra, const float *dec, float *alt, float *az) const
+{
+    Chunk c;
+
+    for (int start = 0; start < n; start += BATCH_CHUNK)
+    {
+        const int count = std::min(BATCH_CHUNK, n - start);
+
+        loadSinCos(ra + start, count, c.sinRA, c.cosRA);
+        loadSinCos(dec + start, count, c.sinDec, c.cosDec);
+
+        const int vend = vectorEnd(count);
+        horizontalKernel<VectorPack>(k, c, 0, vend);
+        horizontalKernel<ScalarPack>(k, c, vend, count);
+
+        for (int i = 0; i < count; ++i)
+        {
+            alt[start + i] = asin(std::max(-1.0, std::min(1.0, c.sinAlt[i]))) * RAD2DEG;
+            az[start + i]  = azimuth(c.azArg[i], c.sinHA[i]);
+        }
+    }
+}
+
+const char *ApparentPlaceBatch::instructionSet()
+{
+#if defined(BATCH_USE_AVX)
+    return "AVX";
+#elif defined(BATCH_USE_SSE2)
+    return "SSE2";
+#else
+    return "scalar";
+#endif
+}
@@ -0,0 +1,111 @@
+/***************************************************************************
+                   apparentplacebatch.h  -  K Desktop Planetarium
+                             -------------------
+    begin                : Sun 18 Oct 2026
+    copyright            : (C) 2026 by KStars Developers
+ ***************************************************************************/
+
+/***************************************************************************
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ ***************************************************************************/
+
+#pragma once
+
+class dms;
+class KSNumbers;
+
+/**
+ * @class ApparentPlaceBatch
+ *
+ * Computes apparent and horizontal coordinates for many stars at once.
+ *
+ * SkyPoint::updateCoords() applies precession, nutation and aberration to one point at a
+ * time, with its own trigonometry for every step. For a batch, precession and nutation are
+ * combined into a single rotation matrix that is set up once per KSNumbers, and every star
+ * is handled as a unit vector. Proper motion is applied along a great circle, like in
+ * StarObject::getIndexCoords(), and aberration uses the same formula as
+ * SkyPoint::aberrate(). The only trigonometric calls left per star are the ones converting
+ * to and from angles; everything in between runs on SIMD registers (AVX or SSE2, depending
+ * on the target the file is compiled for) with a scalar fallback.
+ *
+ * Nutation is applied rigorously, while SkyPoint::nutate() uses a first order
+ * approximation away from the poles. The results agree to the milliarcsecond level there.
+ * Gravitational light bending is not handled; callers that need it must use
+ * SkyPoint::updateCoords().
+ *
+ * @short Batch apparent place computation for star catalogs
+ */
+class ApparentPlaceBatch
+{
+  public:
+    /**
+     * @short Sets up the transformation from J2000.0 to the epoch of num
+     * @param num KSNumbers for the target epoch
+     */
+    explicit ApparentPlaceBatch(const KSNumbers *num);
+
+    /**
+     * @short Sets the sidereal time and latitude used for horizontal coordinates
+     * @param LST Local sidereal time
+     * @param lat Geographic latitude
+     */
+    void setLocation(const dms *LST, const dms *lat);
+
+    /**
+     * @short Computes the apparent coordinates of n stars
+     *
+     * @param n Number of stars
+     * @param ra0 J2000.0 right ascensions in degrees
+     * @param dec0 J2000.0 declinations in degrees
+     * @param pmRA Proper motions in RA in milliarcseconds per year, or nullptr
+     * @param pmDec Proper motions in Dec in milliarcseconds per year, or nullptr
+     * @param ra Apparent right ascensions in degrees, in [0, 360)
+     * @param dec Apparent declinations in degrees
+     * @param alt Altitudes in degrees, or nullptr. Requires setLocation().
+     * @param az Azimuths in degrees, or nullptr. Requires setLocation().
+     */
+    void apply(int n, const float *ra0, const float *dec0, const float *pmRA, const float *pmDec, float *ra,
+               float *dec, float *alt = nullptr, float *az = nullptr) const;
+
+    /**
+     * @short Computes horizontal coordinates from apparent coordinates
+     *
+     * Use this when only the sidereal time changed since apply() was called.
+     *
+     * @param n Number of stars
+     * @param ra Apparent right ascensions in degrees
+     * @param dec Apparent declinations in degrees
+     * @param alt Altitudes in degrees
+     * @param az Azimuths in degrees
+     */
+    void toHorizontal(int n, const float *ra, const float *dec, float *alt, float *az) const;
+
+    /**
+     * @return The instruction set the kernel was compiled for ("AVX", "SSE2" or "scalar")
+     */
+    static const char *instructionSet();
+
+    /** Constants of the transformation, shared with the kernels */
+    struct Parameters
+    {
+        /// Combined precession and nutation matrix, row-major
+        double m[9];
+        /// Proper motion [mas/yr] to displacement [rad] factor
+        double pmScale;
+        /// Proper motions with a squared magnitude below this are ignored
+        double pmLimit2;
+        /// Aberration terms, K ( e cos P - cos L ) and K ( e sin P - sin L ), in degrees
+        double aberrA, aberrB;
+        double sinOb, cosOb;
+        double sinLST, cosLST, sinLat, cosLat;
+    };
+
+  private:
+    Parameters k;
+    bool locationSet { false };
+};
@@ -229,6 +229,7 @@ class KSAsteroid : public KSPlanetBase
      */
     friend QDataStream &operator<<(QDataStream &out, const KSAsteroid &asteroid);
     friend QDataStream &operator>>(QDataStream &in, KSAsteroid *&asteroid);
+    friend class MinorBodyBatch;
 
     void findMagnitude(const KSNumbers *) override;
 
@@ -194,6 +194,8 @@ class KSComet : public KSPlanetBase
     void findPhysicalParameters();
 
   private:
+    friend class MinorBodyBatch;
+
     void findMagnitude(const KSNumbers *) override;
 
     long double JD { 0 };
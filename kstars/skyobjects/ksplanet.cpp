@@ -18,10 +18,18 @@
 #include "ksplanet.h"
 
 #include "ksnumbers.h"
+#include "kspaths.h"
 #include "ksutils.h"
 #include "ksfilereader.h"
+#include "kstars_debug.h"
+
+#include <QCryptographicHash>
+#include <QDateTime>
+#include <QFileInfo>
+#include <QSaveFile>
 
 #include <cmath>
+#include <cstring>
 #include <typeinfo>
 
 KSPlanet::OrbitDataManager KSPlanet::odm;
@@ -35,6 +43,42 @@ KSPlanet::OrbitDataManager::OrbitDataManager()
     //EMPTY
 }
 
+namespace
+{
+// Planets stored in the binary cache, and the sums of each of them
+const char *const cachedPlanets[] = { "mercury", "venus", "earth", "mars", "jupiter", "saturn", "uranus", "neptune" };
+const int nCachedPlanets          = sizeof(cachedPlanets) / sizeof(cachedPlanets[0]);
+const char sumNames[]             = { 'L', 'B', 'R' };
+const int nSeries                 = 3 * 6;
+
+const char cacheMagic[8]       = { 'K', 'S', 'V', 'S', 'O', 'P', '8', '7' };
+const quint32 cacheVersion     = 2;
+const quint32 cacheByteOrder   = 0x01020304;
+const char cacheFileName[]     = "vsop87.cache";
+
+/** Header of the binary cache, followed by the terms of all the series */
+struct VSOPCacheHeader
+{
+    char magic[8];
+    quint32 version;
+    quint32 byteOrder;
+    char checksum[16];
+    /// Offset of the first term and number of terms of each series
+    quint32 series[nCachedPlanets * nSeries][2];
+};
+
+QString seriesFileName(const QString &planet, int series)
+{
+    return QString("%1.%2%3.vsop").arg(planet).arg(sumNames[series / 6]).arg(series % 6);
+}
+
+KSPlanet::OrbitDataSeries &seriesOf(KSPlanet::OrbitDataColl &odc, int series)
+{
+    KSPlanet::OBArray &sum = (series < 6) ? odc.Lon : (series < 12) ? odc.Lat : odc.Dst;
+    return sum[series % 6];
+}
+}
+
 bool KSPlanet::OrbitDataManager::readOrbitData(const QString &fname, QVector<OrbitData> *vector)
 {
     QFile f;
@@ -63,56 +107,182 @@ bool KSPlanet::OrbitDataManager::readOrbitData(const QString &fname, QVector<Orb
     return true;
 }
 
-bool KSPlanet::OrbitDataManager::loadData(KSPlanet::OrbitDataColl &odc, const QString &n)
+bool KSPlanet::OrbitDataManager::readPlanet(const QString &n, OrbitDataColl &odc)
 {
-    QString fname, snum;
-    QFile f;
     int nCount = 0;
-    QString nl = n.toLower();
 
-    if (hash.contains(nl))
+    for (int i = 0; i < nSeries; ++i)
     {
-        odc = hash[nl];
-        return true; //orbit data already loaded
+        QVector<OrbitData> terms;
+        if (readOrbitData(seriesFileName(n, i), &terms))
+            nCount++;
+
+        storage.append(terms);
+        seriesOf(odc, i) = OrbitDataSeries(storage.last().constData(), storage.last().size());
     }
 
-    //Create a new OrbitDataColl
-    OrbitDataColl ret;
+    return nCount > 0;
+}
 
-    //Ecliptic Longitude
-    for (int i = 0; i < 6; ++i)
+QByteArray KSPlanet::OrbitDataManager::sourceChecksum() const
+{
+    QCryptographicHash hash(QCryptographicHash::Md5);
+    int nFiles = 0;
+
+    for (int p = 0; p < nCachedPlanets; ++p)
     {
-        snum.setNum(i);
-        fname = nl + ".L" + snum + ".vsop";
-        if (readOrbitData(fname, &ret.Lon[i]))
-            nCount++;
+        for (int i = 0; i < nSeries; ++i)
+        {
+            QString fname = seriesFileName(cachedPlanets[p], i);
+            QFile f;
+
+            hash.addData(fname.toLatin1());
+            if (KSUtils::openDataFile(f, fname))
+            {
+                // Reading all the files at each startup would cost more than the cache saves
+                QFileInfo info(f);
+                hash.addData(info.absoluteFilePath().toUtf8());
+                hash.addData(QByteArray::number(info.size()));
+                hash.addData(QByteArray::number(info.lastModified().toMSecsSinceEpoch()));
+                nFiles++;
+            }
+        }
     }
 
-    if (nCount == 0)
-        return false;
+    return nFiles > 0 ? hash.result() : QByteArray();
+}
 
-    //Ecliptic Latitude
-    for (int i = 0; i < 6; ++i)
+void KSPlanet::OrbitDataManager::loadCache()
+{
+    cacheLoaded = true;
+
+    QByteArray checksum = sourceChecksum();
+    if (checksum.isEmpty())
+        return;
+
+    QString path = KSPaths::writableLocation(QStandardPaths::GenericDataLocation) + cacheFileName;
+
+    cacheFile.reset(new QFile(path));
+    if (cacheFile->open(QIODevice::ReadOnly) && cacheFile->size() >= qint64(sizeof(VSOPCacheHeader)))
     {
-        snum.setNum(i);
-        fname = nl + ".B" + snum + ".vsop";
-        if (readOrbitData(fname, &ret.Lat[i]))
-            nCount++;
+        const uchar *data = cacheFile->map(0, cacheFile->size());
+        const VSOPCacheHeader *header = reinterpret_cast<const VSOPCacheHeader *>(data);
+        const quint64 nTerms = (cacheFile->size() - sizeof(VSOPCacheHeader)) / sizeof(OrbitData);
+
+        bool valid = data != nullptr && memcmp(header->magic, cacheMagic, sizeof(cacheMagic)) == 0 &&
+                     header->version == cacheVersion && header->byteOrder == cacheByteOrder &&
+                     memcmp(header->checksum, checksum.constData(), sizeof(header->checksum)) == 0;
+
+        for (int i = 0; valid && i < nCachedPlanets * nSeries; ++i)
+            valid = quint64(header->series[i][0]) + header->series[i][1] <= nTerms;
+
+        if (valid)
+        {
+            const OrbitData *terms = reinterpret_cast<const OrbitData *>(data + sizeof(VSOPCacheHeader));
+
+            for (int p = 0; p < nCachedPlanets; ++p)
+            {
+                OrbitDataColl odc;
+                int nCount = 0;
+
+                for (int i = 0; i < nSeries; ++i)
+                {
+                    const quint32 *series = header->series[p * nSeries + i];
+                    seriesOf(odc, i)      = OrbitDataSeries(terms + series[0], series[1]);
+                    nCount += (series[1] > 0);
+                }
+
+                if (nCount > 0)
+                    hash[cachedPlanets[p]] = odc;
+            }
+
+            return;
+        }
+    }
+
+    // The cache is missing or outdated. Read the text files of all planets now and save them for the next time.
+    cacheFile.reset();
+    qCInfo(KSTARS) << "Rebuilding the VSOP87 cache" << path;
+
+    for (int p = 0; p < nCachedPlanets; ++p)
+    {
+        OrbitDataColl odc;
+        if (readPlanet(cachedPlanets[p], odc))
+            hash[cachedPlanets[p]] = odc;
+    }
+
+    if (writeCache(path, checksum) == false)
+        qCWarning(KSTARS) << "Could not write the VSOP87 cache" << path;
+}
+
+bool KSPlanet::OrbitDataManager::writeCache(const QString &path, const QByteArray &checksum)
+{
+    static_assert(sizeof(OrbitData) == 3 * sizeof(double), "OrbitData must be stored without padding");
+
+    VSOPCacheHeader header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, cacheMagic, sizeof(cacheMagic));
+    header.version   = cacheVersion;
+    header.byteOrder = cacheByteOrder;
+    memcpy(header.checksum, checksum.constData(), qMin<int>(checksum.size(), sizeof(header.checksum)));
+
+    quint32 offset = 0;
+    for (int p = 0; p < nCachedPlanets; ++p)
+    {
+        OrbitDataColl odc = hash.value(cachedPlanets[p]);
+        for (int i = 0; i < nSeries; ++i)
+        {
+            header.series[p * nSeries + i][0] = offset;
+            header.series[p * nSeries + i][1] = seriesOf(odc, i).size();
+            offset += seriesOf(odc, i).size();
+        }
     }
 
-    if (nCount == 0)
+    QSaveFile f(path);
+    if (f.open(QIODevice::WriteOnly) == false)
         return false;
 
-    //Heliocentric Distance
-    for (int i = 0; i < 6; ++i)
+    f.write(reinterpret_cast<const char *>(&header), sizeof(header));
+
+    for (int p = 0; p < nCachedPlanets; ++p)
     {
-        snum.setNum(i);
-        fname = nl + ".R" + snum + ".vsop";
-        if (readOrbitData(fname, &ret.Dst[i]))
-            nCount++;
+        OrbitDataColl odc = hash.value(cachedPlanets[p]);
+        for (int i = 0; i < nSeries; ++i)
+        {
+            const OrbitDataSeries &series = seriesOf(odc, i);
+            if (series.size() > 0)
+                f.write(reinterpret_cast<const char *>(&series[0]), series.size() * sizeof(OrbitData));
+        }
     }
 
-    if (nCount == 0)
+    return f.commit();
+}
+
+bool KSPlanet::OrbitDataManager::loadData(KSPlanet::OrbitDataColl &odc, const QString &n)
+{
+    QString nl = n.toLower();
+
+    if (hash.contains(nl))
+    {
+        odc = hash[nl];
+        return true; //orbit data already loaded
+    }
+
+    if (cacheLoaded == false)
+    {
+        loadCache();
+
+        if (hash.contains(nl))
+        {
+            odc = hash[nl];
+            return true;
+        }
+    }
+
+    // Not one of the cached planets, read its text files
+    OrbitDataColl ret;
+
+    if (readPlanet(nl, ret) == false)
         return false;
 
     hash[nl] = ret;
@@ -19,10 +19,14 @@
 
 #include "ksplanetbase.h"
 
+#include <QFile>
 #include <QHash>
+#include <QList>
 #include <QString>
 #include <QVector>
 
+#include <memory>
+
 class KSNumbers;
 
 /**
@@ -118,7 +122,27 @@ class KSPlanet : public KSPlanetBase
         double A, B, C;
     };
 
-    typedef QVector<OrbitData> OBArray[6];
+    /**
+     * @class OrbitDataSeries
+     * A read-only view of the terms of a single sum. The terms are stored either in the
+     * memory-mapped binary cache of the VSOP87 tables, or by the OrbitDataManager when
+     * they were read from the text files.
+     */
+    class OrbitDataSeries
+    {
+      public:
+        OrbitDataSeries() = default;
+        OrbitDataSeries(const OrbitData *data, int count) : terms(data), nTerms(count) {}
+
+        int size() const { return nTerms; }
+        const OrbitData &operator[](int i) const { return terms[i]; }
+
+      private:
+        const OrbitData *terms { nullptr };
+        int nTerms { 0 };
+    };
+
+    typedef OrbitDataSeries OBArray[6];
 
     /**
      * OrbitDataColl contains three groups of six QVectors.  Each QVector is a
@@ -144,6 +168,10 @@ class KSPlanet : public KSPlanetBase
      * OrbitDataManager places the OrbitDataColl objects for all planets in a QDict
      * indexed by the planets' names. It also loads the positional data of each planet from disk.
      *
+     * Parsing the text files is slow, so the tables of all planets are also written to a binary
+     * cache in the user's data directory. On the next start, the cache is memory-mapped and used
+     * directly, as long as its checksum matches the one of the text files.
+     *
      * @author Mark Hollomon
      * @version 1.0
      */
@@ -174,7 +202,31 @@ class KSPlanet : public KSPlanetBase
          */
         bool readOrbitData(const QString &fname, QVector<KSPlanet::OrbitData> *vector);
 
+        /**
+         * Read all the text files of a planet.
+         * @param n the lowercase name of the planet.
+         * @param odc the OrbitDataColl to fill. Its terms are kept in storage.
+         * @return true if at least one file was read.
+         */
+        bool readPlanet(const QString &n, OrbitDataColl &odc);
+
+        /**
+         * Load the tables of all planets from the binary cache, rebuilding the cache
+         * first if it is missing or does not match the text files.
+         */
+        void loadCache();
+
+        /** @return the MD5 checksum of the names, paths, sizes and modification times of all the text files */
+        QByteArray sourceChecksum() const;
+
+        bool writeCache(const QString &path, const QByteArray &checksum);
+
         QHash<QString, OrbitDataColl> hash;
+        /// Terms read from the text files
+        QList<QVector<OrbitData>> storage;
+        /// The memory-mapped binary cache
+        std::unique_ptr<QFile> cacheFile;
+        bool cacheLoaded { false };
     };
 
   private:
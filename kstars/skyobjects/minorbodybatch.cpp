@@ -0,0 +1,333 @@
+/***************************************************************************
+                   minorbodybatch.cpp  -  K Desktop Planetarium
+                             -------------------
+    begin                : Sun 18 Oct 2026
+    copyright            : (C) 2026 by KStars Developers
+ ***************************************************************************/
+
+/***************************************************************************
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ ***************************************************************************/
+
+#include "minorbodybatch.h"
+
+#include "ksasteroid.h"
+#include "kscomet.h"
+#include "vectorpack.h"
+
+#include <QtConcurrent>
+
+#include <algorithm>
+#include <limits>
+
+// Bodies are processed in chunks, so that the intermediate values stay in the L1 cache
+#define BATCH_CHUNK 64
+// Number of bodies of a band mapped in parallel, a multiple of BATCH_CHUNK
+#define BATCH_BAND 4096
+
+namespace
+{
+const double DEG2RAD = M_PI / 180.0;
+const double RAD2DEG = 180.0 / M_PI;
+const double NaN     = std::numeric_limits<double>::quiet_NaN();
+
+// Obliquity of the ecliptic at J2000.0, the frame of the orbital elements
+const double OBLIQUITY = 23.4392911 * DEG2RAD;
+// Same factor as KSAsteroid and KSComet, period in days = PERIOD_FACTOR * a^1.5
+const double PERIOD_FACTOR = 365.2568984;
+// KSComet uses the near-parabolic approximation above this eccentricity
+const double MAX_ECCENTRICITY = 0.98;
+
+// Newton iterations done on all bodies. Starting from the guess of Danby, they solve all orbits below e = 0.7 to the
+// tolerance, the others are finished by the scalar refinement.
+const int KEPLER_ITERATIONS     = 4;
+const double KEPLER_TOLERANCE   = 1e-12;
+const int KEPLER_MAX_ITERATIONS = 50;
+
+/** Elements and results of the bodies of a chunk, pointers start at the first body of the chunk */
+struct Chunk
+{
+    const double *epoch, *meanAnomaly, *meanMotion, *e, *a, *px, *py, *pz, *qx, *qy, *qz;
+    double *rsun, *rearth, *x, *y, *z;
+    // Results of the Kepler pass
+    alignas(32) double M[BATCH_CHUNK];
+    alignas(32) double E[BATCH_CHUNK];
+    alignas(32) double sinE[BATCH_CHUNK];
+    alignas(32) double cosE[BATCH_CHUNK];
+    alignas(32) double residual[BATCH_CHUNK];
+};
+
+/**
+ * Mean anomaly at jd and Newton iterations on Kepler's equation E - e sin E = M, for bodies [begin, end) of a chunk.
+ * begin must be a multiple of P::width.
+ */
+template <class P>
+void keplerKernel(Chunk &c, double jd, int begin, int end)
+{
+    typedef typename P::type V;
+
+    const V one = P::set1(1.0), zero = P::set1(0.0), t = P::set1(jd);
+    const V twoPi = P::set1(2.0 * M_PI), invTwoPi = P::set1(0.5 / M_PI), danby = P::set1(0.85);
+
+    for (int i = begin; i + P::width <= end; i += P::width)
+    {
+        V e = P::loadu(c.e + i);
+        V dt = P::sub(t, P::loadu(c.epoch + i));
+        V M  = P::add(P::loadu(c.meanAnomaly + i), P::mul(P::loadu(c.meanMotion + i), dt));
+        M    = P::sub(M, P::mul(twoPi, P::round(P::mul(M, invTwoPi))));
+
+        // Starting guess of Danby, M + 0.85 e sign(sin M), with M in [-pi, pi]
+        V step = P::mul(danby, e);
+        V E    = P::add(M, P::select(P::ge(M, zero), step, P::sub(zero, step)));
+        V sinE, cosE;
+        for (int k = 0; k < KEPLER_ITERATIONS; ++k)
+        {
+            vectorSinCos<P>(E, sinE, cosE);
+            E = P::sub(E, P::div(P::sub(P::sub(E, P::mul(e, sinE)), M), P::sub(one, P::mul(e, cosE))));
+        }
+        vectorSinCos<P>(E, sinE, cosE);
+
+        P::store(c.M + i, M);
+        P::store(c.E + i, E);
+        P::store(c.sinE + i, sinE);
+        P::store(c.cosE + i, cosE);
+        P::store(c.residual + i, P::sub(P::sub(E, P::mul(e, sinE)), M));
+    }
+}
+
+/**
+ * Heliocentric and geocentric positions from the eccentric anomaly, for bodies [begin, end) of a chunk.
+ * begin must be a multiple of P::width.
+ */
+template <class P>
+void positionKernel(Chunk &c, const double earth[3], int begin, int end)
+{
+    typedef typename P::type V;
+
+    const V one = P::set1(1.0);
+    const V ex = P::set1(earth[0]), ey = P::set1(earth[1]), ez = P::set1(earth[2]);
+
+    for (int i = begin; i + P::width <= end; i += P::width)
+    {
+        V e    = P::loadu(c.e + i);
+        V sinE = P::load(c.sinE + i), cosE = P::load(c.cosE + i);
+        V xv   = P::sub(cosE, e);
+
+        V x = P::sub(P::add(P::mul(P::loadu(c.px + i), xv), P::mul(P::loadu(c.qx + i), sinE)), ex);
+        V y = P::sub(P::add(P::mul(P::loadu(c.py + i), xv), P::mul(P::loadu(c.qy + i), sinE)), ey);
+        V z = P::sub(P::add(P::mul(P::loadu(c.pz + i), xv), P::mul(P::loadu(c.qz + i), sinE)), ez);
+
+        P::storeu(c.rsun + i, P::mul(P::loadu(c.a + i), P::sub(one, P::mul(e, cosE))));
+        P::storeu(c.rearth + i, P::sqrt(P::add(P::add(P::mul(x, x), P::mul(y, y)), P::mul(z, z))));
+        P::storeu(c.x + i, x);
+        P::storeu(c.y + i, y);
+        P::storeu(c.z + i, z);
+    }
+}
+
+/** Largest multiple of the vector width not exceeding n */
+inline int vectorEnd(int n)
+{
+    return n - n % VectorPack::width;
+}
+}
+
+void MinorBodyBatch::clear()
+{
+    for (QVector<double> *values : { &m_epoch, &m_meanAnomaly, &m_meanMotion, &m_e, &m_a, &m_px, &m_py, &m_pz, &m_qx,
+                                     &m_qy, &m_qz, &m_H, &m_rsun, &m_rearth, &m_x, &m_y, &m_z, &m_magnitude })
+        values->clear();
+    m_bands.clear();
+}
+
+bool MinorBodyBatch::append(const KSPlanetBase *body)
+{
+    long double epoch = 0;
+    double meanAnomaly = 0, a = 0, e = NaN, H = NaN;
+    const dms *i = nullptr, *w = nullptr, *N = nullptr;
+
+    if (body->type() == SkyObject::ASTEROID)
+    {
+        const KSAsteroid *asteroid = static_cast<const KSAsteroid *>(body);
+
+        epoch       = asteroid->JD;
+        meanAnomaly = asteroid->M.radians();
+        a           = asteroid->a;
+        i           = &asteroid->i;
+        w           = &asteroid->w;
+        N           = &asteroid->N;
+        if (asteroid->a > 0 && asteroid->e >= 0 && asteroid->e < 1)
+            e = asteroid->e;
+        // With a slope parameter in [0, 1], the phase function cannot make the asteroid brighter
+        if (asteroid->G >= 0 && asteroid->G <= 1)
+            H = asteroid->H;
+    }
+    else if (body->type() == SkyObject::COMET)
+    {
+        const KSComet *comet = static_cast<const KSComet *>(body);
+
+        // The mean anomaly of comets is counted from the perihelion passage
+        epoch = comet->JDp;
+        a     = comet->a;
+        i     = &comet->i;
+        w     = &comet->w;
+        N     = &comet->N;
+        if (comet->a > 0 && comet->e >= 0 && comet->e <= MAX_ECCENTRICITY)
+            e = comet->e;
+    }
+
+    // Orbits that are not handled get zero vectors and a NaN eccentricity, which propagates to their results
+    double p[3] = { 0, 0, 0 }, q[3] = { 0, 0, 0 };
+    if (!std::isnan(e))
+    {
+        double sini, cosi, sinw, cosw, sinN, cosN;
+        i->SinCos(sini, cosi);
+        w->SinCos(sinw, cosw);
+        N->SinCos(sinN, cosN);
+
+        // Perihelion and semi-minor axis directions in the J2000 ecliptic frame, like KSAsteroid computes them
+        const double b     = a * sqrt(1.0 - e * e);
+        const double pe[3] = { cosN * cosw - sinN * sinw * cosi, sinN * cosw + cosN * sinw * cosi, sinw * sini };
+        const double qe[3] = { -cosN * sinw - sinN * cosw * cosi, -sinN * sinw + cosN * cosw * cosi, cosw * sini };
+
+        // Rotated to the J2000 equatorial frame
+        const double sinOb = sin(OBLIQUITY), cosOb = cos(OBLIQUITY);
+        p[0] = a * pe[0];
+        p[1] = a * (pe[1] * cosOb - pe[2] * sinOb);
+        p[2] = a * (pe[1] * sinOb + pe[2] * cosOb);
+        q[0] = b * qe[0];
+        q[1] = b * (qe[1] * cosOb - qe[2] * sinOb);
+        q[2] = b * (qe[1] * sinOb + qe[2] * cosOb);
+    }
+
+    m_epoch.append(static_cast<double>(epoch));
+    m_meanAnomaly.append(meanAnomaly);
+    m_meanMotion.append(std::isnan(e) ? 0.0 : 2.0 * M_PI / (PERIOD_FACTOR * pow(a, 1.5)));
+    m_e.append(e);
+    m_a.append(a);
+    m_px.append(p[0]);
+    m_py.append(p[1]);
+    m_pz.append(p[2]);
+    m_qx.append(q[0]);
+    m_qy.append(q[1]);
+    m_qz.append(q[2]);
+    m_H.append(H);
+
+    return !std::isnan(e);
+}
+
+void MinorBodyBatch::update(long double jd, const KSPlanetBase *earth)
+{
+    const int n = count();
+
+    for (QVector<double> *values : { &m_rsun, &m_rearth, &m_x, &m_y, &m_z, &m_magnitude })
+        values->resize(n);
+
+    if (m_bands.count() != (n + BATCH_BAND - 1) / BATCH_BAND)
+    {
+        m_bands.clear();
+        for (int start = 0; start < n; start += BATCH_BAND)
+            m_bands.append(start);
+    }
+
+    // Heliocentric position of the Earth, in the J2000 equatorial frame
+    double earthPosition[3] = { 0, 0, 0 };
+    if (earth)
+    {
+        double sinL, cosL, sinB, cosB;
+        earth->ecLong().SinCos(sinL, cosL);
+        earth->ecLat().SinCos(sinB, cosB);
+
+        const double xe = earth->rsun() * cosB * cosL;
+        const double ye = earth->rsun() * cosB * sinL;
+        const double ze = earth->rsun() * sinB;
+
+        earthPosition[0] = xe;
+        earthPosition[1] = ye * cos(OBLIQUITY) - ze * sin(OBLIQUITY);
+        earthPosition[2] = ye * sin(OBLIQUITY) + ze * cos(OBLIQUITY);
+    }
+
+    QtConcurrent::blockingMap(m_bands, [&](int &start) {
+        updateBand(start, std::min(start + BATCH_BAND, n), static_cast<double>(jd), earthPosition);
+    });
+}
+
+void MinorBodyBatch::updateBand(int begin, int end, double jd, const double earth[3])
+{
+    Chunk c;
+
+    for (int start = begin; start < end; start += BATCH_CHUNK)
+    {
+        const int count = std::min(BATCH_CHUNK, end - start);
+
+        c.epoch       = m_epoch.constData() + start;
+        c.meanAnomaly = m_meanAnomaly.constData() + start;
+        c.meanMotion  = m_meanMotion.constData() + start;
+        c.e           = m_e.constData() + start;
+        c.a           = m_a.constData() + start;
+        c.px          = m_px.constData() + start;
+        c.py          = m_py.constData() + start;
+        c.pz          = m_pz.constData() + start;
+        c.qx          = m_qx.constData() + start;
+        c.qy          = m_qy.constData() + start;
+        c.qz          = m_qz.constData() + start;
+        c.rsun        = m_rsun.data() + start;
+        c.rearth      = m_rearth.data() + start;
+        c.x           = m_x.data() + start;
+        c.y           = m_y.data() + start;
+        c.z           = m_z.data() + start;
+
+        const int vend = vectorEnd(count);
+        keplerKernel<VectorPack>(c, jd, 0, vend);
+        keplerKernel<ScalarPack>(c, jd, vend, count);
+
+        // Finish the eccentric orbits, NaN residuals of orbits that are not handled fail the test
+        for (int i = 0; i < count; ++i)
+        {
+            if (fabs(c.residual[i]) <= KEPLER_TOLERANCE || std::isnan(c.residual[i]))
+                continue;
+
+            const double e = c.e[i], M = c.M[i];
+            double E = c.E[i];
+            for (int k = 0; k < KEPLER_MAX_ITERATIONS; ++k)
+            {
+                const double f = E - e * sin(E) - M;
+                if (fabs(f) <= KEPLER_TOLERANCE)
+                    break;
+                E -= f / (1.0 - e * cos(E));
+            }
+            c.sinE[i] = sin(E);
+            c.cosE[i] = cos(E);
+        }
+
+        positionKernel<VectorPack>(c, earth, 0, vend);
+        positionKernel<ScalarPack>(c, earth, vend, count);
+
+        for (int i = start; i < start + count; ++i)
+            m_magnitude[i] = m_H.at(i) + 5.0 * log10(m_rsun.at(i) * m_rearth.at(i));
+    }
+}
+
+void MinorBodyBatch::position(int index, double &ra, double &dec) const
+{
+    ra  = atan2(m_y[index], m_x[index]) * RAD2DEG;
+    dec = atan2(m_z[index], sqrt(m_x[index] * m_x[index] + m_y[index] * m_y[index])) * RAD2DEG;
+    if (ra < 0.0)
+        ra += 360.0;
+}
+
+const char *MinorBodyBatch::instructionSet()
+{
+#if defined(BATCH_USE_AVX)
+    return "AVX";
+#elif defined(BATCH_USE_SSE2)
+    return "SSE2";
+#else
+    return "scalar";
+#endif
+}
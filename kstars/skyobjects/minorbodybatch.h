@@ -0,0 +1,117 @@
+/***************************************************************************
+                    minorbodybatch.h  -  K Desktop Planetarium
+                             -------------------
+    begin                : Sun 18 Oct 2026
+    copyright            : (C) 2026 by KStars Developers
+ ***************************************************************************/
+
+/***************************************************************************
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ ***************************************************************************/
+
+#pragma once
+
+#include <QVector>
+
+#include <cmath>
+
+class KSPlanetBase;
+
+/**
+ * @class MinorBodyBatch
+ *
+ * Computes approximate positions and magnitudes of many asteroids and comets at once.
+ *
+ * KSAsteroid and KSComet solve Kepler's equation and reduce the position to apparent coordinates one body at a
+ * time. The batch keeps the elements of elliptic orbits in one array per element, with the orientation of each
+ * orbit folded into the J2000 equatorial vectors of the perihelion and of the semi-minor axis. The bodies are split
+ * in bands mapped in parallel, and each band solves Kepler's equation with Newton iterations on SIMD registers (AVX
+ * or SSE2, like ApparentPlaceBatch) using a polynomial sine and cosine; the few solutions that did not converge are
+ * refined with scalar iterations.
+ *
+ * The results are the distances to the Sun and to the Earth, the geocentric J2000 direction without light time and
+ * topocentric corrections, and a lower bound of the magnitude of asteroids: KSAsteroid::findMagnitude() adds a
+ * phase term to H + 5 log10(r Delta), which only makes the asteroid fainter. This is enough to tell which bodies
+ * need the full reduction of KSPlanetBase::findPosition().
+ *
+ * Near-parabolic and hyperbolic orbits are not handled, see isHandled().
+ *
+ * @short Batch Kepler solution for asteroids and comets
+ */
+class MinorBodyBatch
+{
+  public:
+    /** @short Remove all bodies */
+    void clear();
+
+    /**
+     * @short Add a body at the end of the batch
+     * @param body Asteroid or comet
+     * @return False if the orbit of the body is not handled, its results are then NaN
+     */
+    bool append(const KSPlanetBase *body);
+
+    /** @return Number of bodies */
+    int count() const { return m_e.count(); }
+
+    /** @return True if the orbit of the body at index is handled by the batch */
+    bool isHandled(int index) const { return !std::isnan(m_e[index]); }
+
+    /**
+     * @short Compute the positions of all bodies
+     * @param jd Julian day
+     * @param earth Earth, at its position for jd. If nullptr, the directions are heliocentric.
+     */
+    void update(long double jd, const KSPlanetBase *earth);
+
+    /** @return Distance of the body at index to the Sun, in AU */
+    double rsun(int index) const { return m_rsun[index]; }
+
+    /** @return Distance of the body at index to the Earth, in AU */
+    double rearth(int index) const { return m_rearth[index]; }
+
+    /**
+     * @return Lower bound of the magnitude of the asteroid at index, NaN for comets and for asteroids whose slope
+     * parameter may make them brighter
+     */
+    double magnitude(int index) const { return m_magnitude[index]; }
+
+    /**
+     * @short Approximate geocentric J2000 coordinates of the body at index
+     * @param index Index of the body
+     * @param ra Right ascension in degrees, in [0, 360)
+     * @param dec Declination in degrees
+     */
+    void position(int index, double &ra, double &dec) const;
+
+    /**
+     * @return The instruction set the kernel was compiled for ("AVX", "SSE2" or "scalar")
+     */
+    static const char *instructionSet();
+
+  private:
+    /// Update the bodies [begin, end)
+    void updateBand(int begin, int end, double jd, const double earth[3]);
+
+    /// Julian day of the mean anomaly, mean anomaly then in radians, and mean motion in radians per day
+    QVector<double> m_epoch, m_meanAnomaly, m_meanMotion;
+    /// Eccentricity, NaN for orbits that are not handled
+    QVector<double> m_e;
+    /// Semi-major axis in AU
+    QVector<double> m_a;
+    /// Perihelion direction times the semi-major axis, and semi-minor axis direction times its length
+    QVector<double> m_px, m_py, m_pz, m_qx, m_qy, m_qz;
+    /// Absolute magnitude of asteroids, NaN for comets
+    QVector<double> m_H;
+
+    /// Results of the last update, geocentric position in AU
+    QVector<double> m_rsun, m_rearth, m_x, m_y, m_z, m_magnitude;
+
+    /// First bodies of the bands mapped in parallel
+    QVector<int> m_bands;
+};
@@ -17,14 +17,13 @@
 
 #include "satellite.h"
 
+#include "geolocation.h"
 #include "ksplanetbase.h"
 #ifndef KSTARS_LITE
 #include "kspopupmenu.h"
 #endif
 #include "kstarsdata.h"
-#include "kssun.h"
 #include "Options.h"
-#include "skymapcomposite.h"
 
 #include <QDebug>
 
@@ -205,9 +204,6 @@ void Satellite::init()
     xlamo = 0.;
     zmol  = 0.;
     zmos  = 0.;
-    atime = 0.;
-    xli   = 0.;
-    xni   = 0.;
 
     method = 'n';
 
@@ -694,9 +690,6 @@ void Satellite::init()
                     xfact = mdot + xpidot - rptim + dmdt + domdt + dnodt - m_mean_motion;
                 }
 
-                xli   = xlamo;
-                xni   = m_mean_motion;
-                atime = 0.0;
                 // Value never used
 //                nm    = m_mean_motion + dndt;
             }
@@ -720,26 +713,35 @@ void Satellite::init()
 int Satellite::updatePos()
 {
     KStarsData *data = KStarsData::Instance();
-    return sgp4((data->clock()->utc().djd() - m_tle_jd) * MINPD);
+    Observer observer(data->geo(), data->clock()->utc().djd());
+    double position[3], velocity[3];
+
+    int rc = propagate(observer.jd, position, velocity);
+    if (rc == 0)
+        setPosition(position, velocity, observer);
+
+    return rc;
 }
 
-int Satellite::sgp4(double tsince)
+int Satellite::propagate(double jd, double position[3], double velocity[3]) const
 {
-    KStarsData *data = KStarsData::Instance();
+    return sgp4((jd - m_tle_jd) * MINPD, position, velocity);
+}
 
+int Satellite::sgp4(double tsince, double position[3], double velocity[3]) const
+{
     int ktr;
     double am, axnl, aynl, betal, cosim, cnod, cos2u, coseo1 = 0, cosi, cosip, cosisq, cossu, cosu, delm, delomg, em,
-        ecose, el2, eo1, ep, esine, argpm, argpp, argpdf, pl,
-        mrt = 0.0, mvt, rdotl, rl, rvdot, rvdotl, sinim, dndt, sin2u, sineo1 = 0, sini, sinip, sinsu, sinu, snod, su, t2,
-        t3, t4, tem5, temp, temp1, temp2, tempa, tempe, templ, u, ux, uy, uz, vx, vy, vz, inclm, mm, nm, nodem, xinc,
-        xincp, xl, xlm, mp, xmdf, xmx, xmy, nodedf, xnode, nodep, tc, sat_posx, sat_posy, sat_posz, sat_posw, sat_velx,
-        sat_vely, sat_velz, sinlat, obs_posx, obs_posy, obs_posz, obs_posw, /*obs_velx, obs_vely, obs_velz,*/
-        coslat, thetageo, sintheta, costheta, c, sq, achcp, vkmpersec;
+        ecose, el2, eo1, ep, esine, argpm, argpp, argpdf, pl, mrt = 0.0, mvt, rdotl, rl, rvdot, rvdotl, sinim, dndt,
+        sin2u, sineo1 = 0, sini, sinip, sinsu, sinu, snod, su, t2, t3, t4, tem5, temp, temp1, temp2, tempa, tempe,
+        templ, u, ux, uy, uz, vx, vy, vz, inclm, mm, nm, nodem, xinc, xincp, xl, xlm, mp, xmdf, xmx, xmy, nodedf,
+        xnode, nodep, tc, vkmpersec;
 //    double emsq;
 
     const double temp4 = 1.5e-12;
 
-    double jul_utc = data->clock()->utc().djd();
+    // Long and short period coefficients, recomputed from the perturbed inclination in deep space
+    double ycof = aycof, lcof = xlcof, c41 = con41, x1m = x1mth2, x7m = x7thm1;
 
     vkmpersec = RADIUSEARTHKM * XKE / 60.0;
 
@@ -778,7 +780,7 @@ int Satellite::sgp4(double tsince)
         tc = tsince;
         // Deep space contributions to mean elements for perturbing third body
         int iretn;
-        double delt, ft, theta, x2li, x2omi, xl, xldot, xnddt, xndt, xomi;
+        double atime, delt, ft, theta, x2li, x2omi, xl, xldot, xli, xni, xnddt, xndt, xomi;
 
         // Define some constants
         const double fasx2 = 0.13130908;
@@ -808,12 +810,10 @@ int Satellite::sgp4(double tsince)
         ft = 0.0;
         if (irez != 0)
         {
-            if ((atime == 0.0) || (tsince * atime <= 0.0) || (fabs(tsince) < fabs(atime)))
-            {
-                atime = 0.0;
-                xni   = m_mean_motion;
-                xli   = xlamo;
-            }
+            // Integrate from the epoch, the satellite is not changed between calls
+            atime = 0.0;
+            xni   = m_mean_motion;
+            xli   = xlamo;
 
             if (tsince > 0.0)
                 delt = step;
@@ -1040,16 +1040,16 @@ int Satellite::sgp4(double tsince)
     {
         sinip = sin(xincp);
         cosip = cos(xincp);
-        aycof = -0.5 * J3OJ2 * sinip;
+        ycof  = -0.5 * J3OJ2 * sinip;
         if (fabs(cosip + 1.0) > 1.5e-12)
-            xlcof = -0.25 * J3OJ2 * sinip * (3.0 + 5.0 * cosip) / (1.0 + cosip);
+            lcof = -0.25 * J3OJ2 * sinip * (3.0 + 5.0 * cosip) / (1.0 + cosip);
         else
-            xlcof = -0.25 * J3OJ2 * sinip * (3.0 + 5.0 * cosip) / temp4;
+            lcof = -0.25 * J3OJ2 * sinip * (3.0 + 5.0 * cosip) / temp4;
     }
     axnl = ep * cos(argpp);
     temp = 1.0 / (am * (1.0 - ep * ep));
-    aynl = ep * sin(argpp) + temp * aycof;
-    xl   = mp + argpp + nodep + temp * xlcof * axnl;
+    aynl = ep * sin(argpp) + temp * ycof;
+    xl   = mp + argpp + nodep + temp * lcof * axnl;
 
     // Solve kepler's equation
     u    = fmod(xl - nodep, TWOPI);
@@ -1098,16 +1098,16 @@ int Satellite::sgp4(double tsince)
     if (method == 'd')
     {
         cosisq = cosip * cosip;
-        con41  = 3.0 * cosisq - 1.0;
-        x1mth2 = 1.0 - cosisq;
-        x7thm1 = 7.0 * cosisq - 1.0;
+        c41    = 3.0 * cosisq - 1.0;
+        x1m    = 1.0 - cosisq;
+        x7m    = 7.0 * cosisq - 1.0;
     }
-    mrt   = rl * (1.0 - 1.5 * temp2 * betal * con41) + 0.5 * temp1 * x1mth2 * cos2u;
-    su    = su - 0.25 * temp2 * x7thm1 * sin2u;
+    mrt   = rl * (1.0 - 1.5 * temp2 * betal * c41) + 0.5 * temp1 * x1m * cos2u;
+    su    = su - 0.25 * temp2 * x7m * sin2u;
     xnode = nodep + 1.5 * temp2 * cosip * sin2u;
     xinc  = xincp + 1.5 * temp2 * cosip * sinip * cos2u;
-    mvt   = rdotl - nm * temp1 * x1mth2 * sin2u / XKE;
-    rvdot = rvdotl + nm * temp1 * (x1mth2 * cos2u + 1.5 * con41) / XKE;
+    mvt   = rdotl - nm * temp1 * x1m * sin2u / XKE;
+    rvdot = rvdotl + nm * temp1 * (x1m * cos2u + 1.5 * c41) / XKE;
 
     // Orientation vectors
     sinsu = sin(su);
@@ -1126,22 +1126,20 @@ int Satellite::sgp4(double tsince)
     vz    = sini * cossu;
 
     // Position and velocity (in km and km/sec)
-    sat_posx   = (mrt * ux) * RADIUSEARTHKM;
-    sat_posy   = (mrt * uy) * RADIUSEARTHKM;
-    sat_posz   = (mrt * uz) * RADIUSEARTHKM;
-    sat_posw   = sqrt(sat_posx * sat_posx + sat_posy * sat_posy + sat_posz * sat_posz);
-    sat_velx   = (mvt * ux + rvdot * vx) * vkmpersec;
-    sat_vely   = (mvt * uy + rvdot * vy) * vkmpersec;
-    sat_velz   = (mvt * uz + rvdot * vz) * vkmpersec;
-    m_velocity = sqrt(sat_velx * sat_velx + sat_vely * sat_vely + sat_velz * sat_velz);
+    position[0] = (mrt * ux) * RADIUSEARTHKM;
+    position[1] = (mrt * uy) * RADIUSEARTHKM;
+    position[2] = (mrt * uz) * RADIUSEARTHKM;
+    velocity[0] = (mvt * ux + rvdot * vx) * vkmpersec;
+    velocity[1] = (mvt * uy + rvdot * vy) * vkmpersec;
+    velocity[2] = (mvt * uz + rvdot * vz) * vkmpersec;
 
     //     printf("tsince=%.15f\n", tsince);
-    //     printf("sat_posx=%.15f\n", sat_posx);
-    //     printf("sat_posy=%.15f\n", sat_posy);
-    //     printf("sat_posz=%.15f\n", sat_posz);
-    //     printf("sat_velx=%.15f\n", sat_velx);
-    //     printf("sat_vely=%.15f\n", sat_vely);
-    //     printf("sat_velz=%.15f\n", sat_velz);
+    //     printf("sat_posx=%.15f\n", position[0]);
+    //     printf("sat_posy=%.15f\n", position[1]);
+    //     printf("sat_posz=%.15f\n", position[2]);
+    //     printf("sat_velx=%.15f\n", velocity[0]);
+    //     printf("sat_vely=%.15f\n", velocity[1]);
+    //     printf("sat_velz=%.15f\n", velocity[2]);
 
     if (mrt < 1.0)
     {
@@ -1149,57 +1147,31 @@ int Satellite::sgp4(double tsince)
         return (6);
     }
 
-    // Observer ECI position and velocity
-    sinlat   = sin(data->geo()->lat()->radians());
-    coslat   = cos(data->geo()->lat()->radians());
-    thetageo = data->geo()->LMST(jul_utc);
-    sintheta = sin(thetageo);
-    costheta = cos(thetageo);
-    c        = 1.0 / sqrt(1.0 + F * (F - 2.0) * sinlat * sinlat);
-    sq       = (1.0 - F) * (1.0 - F) * c;
-    achcp    = (RADIUSEARTHKM * c + MEANALT) * coslat;
-    obs_posx = achcp * costheta;
-    obs_posy = achcp * sintheta;
-    obs_posz = (RADIUSEARTHKM * sq + MEANALT) * sinlat;
-    obs_posw = sqrt(obs_posx * obs_posx + obs_posy * sat_posy + obs_posz * obs_posz);
-    /*obs_velx = -MFACTOR * obs_posy;
-    obs_vely = MFACTOR * obs_posx;
-    obs_velz = 0.;*/
-
-    m_altitude = sat_posw - obs_posw + MEANALT;
-
-    // Az and Dec
-    double range_posx = sat_posx - obs_posx;
-    double range_posy = sat_posy - obs_posy;
-    double range_posz = sat_posz - obs_posz;
-    m_range           = sqrt(range_posx * range_posx + range_posy * range_posy + range_posz * range_posz);
-    //     double range_velx = sat_velx - obs_velx;
-    //     double range_vely = sat_velx - obs_vely;
-    //     double range_velz = sat_velx - obs_velz;
-
-    double top_s = sinlat * costheta * range_posx + sinlat * sintheta * range_posy - coslat * range_posz;
-    double top_e = -sintheta * range_posx + costheta * range_posy;
-    double top_z = coslat * costheta * range_posx + coslat * sintheta * range_posy + sinlat * range_posz;
-
-    double azimut = atan(-top_e / top_s);
-    if (top_s > 0.)
-        azimut += M_PI;
-    if (azimut < 0.)
-        azimut += TWOPI;
-    double elevation = arcSin(top_z / m_range);
-
-    //     printf("azimut=%.15f\n\r", azimut / DEG2RAD);
-    //     printf("elevation=%.15f\n\r", elevation / DEG2RAD);
+    return (0);
+}
 
-    setAz(azimut / DEG2RAD);
-    setAlt(elevation / DEG2RAD);
-    HorizontalToEquatorial(data->lst(), data->geo()->lat());
+Satellite::Observer::Observer(GeoLocation *geo, double jd) : jd(jd), latitude(geo->lat())
+{
+    double thetageo, c, sq, achcp;
+
+    // Observer ECI position
+    sinlat      = sin(latitude->radians());
+    coslat      = cos(latitude->radians());
+    thetageo    = geo->LMST(jd);
+    sintheta    = sin(thetageo);
+    costheta    = cos(thetageo);
+    c           = 1.0 / sqrt(1.0 + F * (F - 2.0) * sinlat * sinlat);
+    sq          = (1.0 - F) * (1.0 - F) * c;
+    achcp       = (RADIUSEARTHKM * c + MEANALT) * coslat;
+    position[0] = achcp * costheta;
+    position[1] = achcp * sintheta;
+    position[2] = (RADIUSEARTHKM * sq + MEANALT) * sinlat;
+    position[3] = sqrt(position[0] * position[0] + position[1] * position[1] + position[2] * position[2]);
 
-    // is the satellite visible ?
     // Find ECI coordinates of the sun
     double mjd, year, T, M, L, e, C, O, Lsa, nu, R, eps;
 
-    mjd  = jul_utc - 2415020.0;
+    mjd  = jd - 2415020.0;
     year = 1900.0 + mjd / 365.25;
     T    = (mjd + deltaET(year) / (MINPD * 60.0)) / 36525.0;
     M    = DEG2RAD * (Modulus(358.47583 + Modulus(35999.04975 * T, 360.0) - (0.000150 + 0.0000033 * T) * T * T, 360.0));
@@ -1214,33 +1186,74 @@ int Satellite::sgp4(double tsince)
     eps  = DEG2RAD * (23.452294 - (0.0130125 + (0.00000164 - 0.000000503 * T) * T) * T + 0.00256 * cos(O));
     R    = AU * R;
 
-    double sun_posx = R * cos(Lsa);
-    double sun_posy = R * sin(Lsa) * cos(eps);
-    double sun_posz = R * sin(Lsa) * sin(eps);
-    double sun_posw = R;
+    sun[0] = R * cos(Lsa);
+    sun[1] = R * sin(Lsa) * cos(eps);
+    sun[2] = R * sin(Lsa) * sin(eps);
+    sun[3] = R;
 
+    double azimut, elevation, range;
+    toHorizontal(sun, azimut, elevation, range);
+    night = elevation <= -12.0 * DEG2RAD;
+}
+
+void Satellite::Observer::toHorizontal(const double pos[3], double &azimuth, double &elevation, double &range) const
+{
+    double range_posx = pos[0] - position[0];
+    double range_posy = pos[1] - position[1];
+    double range_posz = pos[2] - position[2];
+    range             = sqrt(range_posx * range_posx + range_posy * range_posy + range_posz * range_posz);
+
+    double top_s = sinlat * costheta * range_posx + sinlat * sintheta * range_posy - coslat * range_posz;
+    double top_e = -sintheta * range_posx + costheta * range_posy;
+    double top_z = coslat * costheta * range_posx + coslat * sintheta * range_posy + sinlat * range_posz;
+
+    azimuth = atan(-top_e / top_s);
+    if (top_s > 0.)
+        azimuth += M_PI;
+    if (azimuth < 0.)
+        azimuth += TWOPI;
+    elevation = arcSin(top_z / range);
+}
+
+void Satellite::setPosition(const double position[3], const double velocity[3], const Observer &observer)
+{
+    double sat_posw = sqrt(position[0] * position[0] + position[1] * position[1] + position[2] * position[2]);
+
+    m_velocity = sqrt(velocity[0] * velocity[0] + velocity[1] * velocity[1] + velocity[2] * velocity[2]);
+    m_altitude = sat_posw - observer.position[3] + MEANALT;
+
+    // Az and Dec
+    double azimut, elevation;
+    observer.toHorizontal(position, azimut, elevation, m_range);
+
+    //     printf("azimut=%.15f\n\r", azimut / DEG2RAD);
+    //     printf("elevation=%.15f\n\r", elevation / DEG2RAD);
+
+    setAz(azimut / DEG2RAD);
+    setAlt(elevation / DEG2RAD);
+    HorizontalToEquatorial(KStarsData::Instance()->lst(), observer.latitude);
+
+    // is the satellite visible ?
     // Calculates satellite's eclipse status and depth
+    const double *sun = observer.sun;
     double sd_sun, sd_earth, delta, depth;
 
     // Determine partial eclipse
     sd_earth       = arcSin(RADIUSEARTHKM / sat_posw);
-    double rho_x   = sun_posx - sat_posx;
-    double rho_y   = sun_posy - sat_posy;
-    double rho_z   = sun_posz - sat_posz;
+    double rho_x   = sun[0] - position[0];
+    double rho_y   = sun[1] - position[1];
+    double rho_z   = sun[2] - position[2];
     double rho_w   = sqrt(rho_x * rho_x + rho_y * rho_y + rho_z * rho_z);
     sd_sun         = arcSin(SR / rho_w);
-    double earth_x = -1.0 * sat_posx;
-    double earth_y = -1.0 * sat_posy;
-    double earth_z = -1.0 * sat_posz;
+    double earth_x = -1.0 * position[0];
+    double earth_y = -1.0 * position[1];
+    double earth_z = -1.0 * position[2];
     double earth_w = sat_posw;
-    delta      = PIO2 - arcSin((sun_posx * earth_x + sun_posy * earth_y + sun_posz * earth_z) / (sun_posw * earth_w));
-    depth      = sd_earth - sd_sun - delta;
-    KSSun *sun = (KSSun *)data->skyComposite()->findByName("Sun");
+    delta          = PIO2 - arcSin((sun[0] * earth_x + sun[1] * earth_y + sun[2] * earth_z) / (sun[3] * earth_w));
+    depth          = sd_earth - sd_sun - delta;
 
     m_is_eclipsed = sd_earth >= sd_sun && depth >= 0;
-    m_is_visible  = !m_is_eclipsed && sun->alt().Degrees() <= -12.0 && elevation >= 0.0;
-
-    return (0);
+    m_is_visible  = !m_is_eclipsed && observer.night && elevation >= 0.0;
 }
 
 QString Satellite::sgp4ErrorString(int code)
@@ -21,6 +21,7 @@
 
 #include <QString>
 
+class GeoLocation;
 class KSPopupMenu;
 
 /**
@@ -33,6 +34,40 @@ class KSPopupMenu;
 class Satellite : public SkyObject
 {
   public:
+    /**
+     * @struct Satellite::Observer
+     * Observer and sun positions in the ECI frame at a given time, shared by all satellites.
+     */
+    struct Observer
+    {
+        /**
+         * @param geo Location of the observer
+         * @param jd Julian date (UTC)
+         */
+        Observer(GeoLocation *geo, double jd);
+
+        /**
+         * @short Compute horizontal coordinates of an ECI position
+         * @param position ECI position in km
+         * @param azimuth Azimuth in radians
+         * @param elevation Elevation in radians, without refraction
+         * @param range Distance from the observer in km
+         */
+        void toHorizontal(const double position[3], double &azimuth, double &elevation, double &range) const;
+
+        /// Julian date (UTC)
+        double jd;
+        /// Latitude of the observer
+        const dms *latitude;
+        double sinlat, coslat, sintheta, costheta;
+        /// ECI position of the observer in km, and its norm
+        double position[4];
+        /// ECI position of the sun in km, and its norm
+        double sun[4];
+        /// True if the sun is at least 12° under horizon
+        bool night;
+    };
+
     /** @short Constructor */
     Satellite(const QString &name, const QString &line1, const QString &line2);
 
@@ -48,6 +83,23 @@ class Satellite : public SkyObject
     /** @short Update satellite position */
     int updatePos();
 
+    /**
+     * @short Compute the position of the satellite, without changing it
+     * @param jd Julian date (UTC)
+     * @param position ECI position in km
+     * @param velocity ECI velocity in km/s
+     * @return 0 on success, an error code for sgp4ErrorString() otherwise
+     */
+    int propagate(double jd, double position[3], double velocity[3]) const;
+
+    /**
+     * @short Set the position of the satellite as seen by an observer
+     * @param position ECI position in km at the time of the observer
+     * @param velocity ECI velocity in km/s at the time of the observer
+     * @param observer Observer at the current time of the sky map
+     */
+    void setPosition(const double position[3], const double velocity[3], const Observer &observer);
+
     /**
      * @return True if the satellite is visible (above horizon, in the sunlight and sun at least 12° under horizon)
      */
@@ -81,14 +133,21 @@ class Satellite : public SkyObject
     void initPopupMenu(KSPopupMenu *pmenu) override;
 
   private:
+    friend class SatellitePropagator;
+
     /** @short Compute non time dependant parameters */
     void init();
 
-    /** @short Compute satellite position */
-    int sgp4(double tsince);
+    /**
+     * @short Compute satellite position and velocity
+     * @param tsince Time since the TLE epoch in minutes
+     * @param position ECI position in km
+     * @param velocity ECI velocity in km/s
+     */
+    int sgp4(double tsince, double position[3], double velocity[3]) const;
 
     /** @return Arcsine of the argument */
-    double arcSin(double arg);
+    static double arcSin(double arg);
 
     /**
      * Provides the difference between UT (approximately the same as UTC)
@@ -96,10 +155,10 @@ class Satellite : public SkyObject
      * This function is based on a least squares fit of data from 1950
      * to 1991 and will need to be updated periodically.
      */
-    double deltaET(double year);
+    static double deltaET(double year);
 
     /** @return arg1 mod arg2 */
-    double Modulus(double arg1, double arg2);
+    static double Modulus(double arg1, double arg2);
 
     // TLE
     /// Satellite Number
@@ -169,7 +228,7 @@ class Satellite : public SkyObject
     double sgh3 { 0 }, sgh4 { 0 }, sh2 { 0 }, sh3 { 0 }, si2 { 0 }, si3 { 0 }, sl2 { 0 }, sl3 { 0 };
     double sl4 { 0 }, gsto { 0 }, xfact { 0 }, xgh2 { 0 }, xgh3 { 0 }, xgh4 { 0 }, xh2 { 0 };
     double xh3 { 0 }, xi2 { 0 }, xi3 { 0 }, xl2 { 0 }, xl3 { 0 }, xl4 { 0 }, xlamo { 0 }, zmol { 0 };
-    double zmos { 0 }, atime { 0 }, xli { 0 }, xni { 0 };
+    double zmos { 0 };
 
     char method;
 };
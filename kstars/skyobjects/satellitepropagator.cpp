@@ -0,0 +1,379 @@
+/***************************************************************************
+                 satellitepropagator.cpp  -  K Desktop Planetarium
+                             -------------------
+    begin                : Sun 18 Oct 2026
+    copyright            : (C) 2026 by KStars Developers
+ ***************************************************************************/
+
+/***************************************************************************
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ ***************************************************************************/
+
+#include "satellitepropagator.h"
+
+#include "geolocation.h"
+
+#include <QtConcurrent>
+
+#include <cmath>
+#include <numeric>
+
+namespace
+{
+// WGS-72 constants, as used by Satellite::sgp4()
+const double XKE        = 0.07436691613317; // 60.0 / sqrt(RADIUSEARTHKM^3/MU)
+const double FLATTENING = 3.35281066474748e-3;
+// Rotation of the Earth in radians per day
+const double EARTH_ROTATION = 7.292115e-5 * 86400.0;
+
+const double DEG2RAD = M_PI / 180.0;
+
+// Nodes are one minute apart
+const double NODES_PER_DAY = 1440.0;
+// Satellites are skipped when the horizon is that much closer to the observer, so that they are under -1°
+const double HORIZON_MARGIN = 2.0 * DEG2RAD;
+// Pass prediction samples the elevation every minute, AOS, LOS and culmination are found to a second
+const double PASS_STEP      = 1.0 / 1440.0;
+const double PASS_PRECISION = 1.0 / 86400.0;
+
+/** @return Angle between two ECI positions seen from the center of the Earth, in radians */
+double geocentricAngle(const double a[3], const double b[3])
+{
+    const double x = a[1] * b[2] - a[2] * b[1];
+    const double y = a[2] * b[0] - a[0] * b[2];
+    const double z = a[0] * b[1] - a[1] * b[0];
+
+    return atan2(sqrt(x * x + y * y + z * z), a[0] * b[0] + a[1] * b[1] + a[2] * b[2]);
+}
+}
+
+void SatellitePropagator::bounds(const Satellite *satellite, double &horizon, double &rate)
+{
+    const double n = satellite->m_mean_motion;
+    const double e = satellite->m_eccentricity;
+
+    // Semi-major axis in Earth radii, from the mean motion in radians per minute. The lowest observer, at a pole,
+    // sees the satellite at apogee rise when the geocentric angle between them is below the horizon angle.
+    const double ratio = (1.0 - FLATTENING) / (pow(XKE / n, 2.0 / 3.0) * (1.0 + e));
+    horizon            = ratio < 1.0 ? acos(ratio) : 0.0;
+
+    // Angular velocity at perigee plus the velocity of the observer, with a margin for drag and perturbations
+    rate = 1.1 * (n * 1440.0 * (1.0 + e) * (1.0 + e) / pow(1.0 - e * e, 1.5) + EARTH_ROTATION);
+}
+
+void SatellitePropagator::setSatellites(const QVector<Satellite *> &satellites)
+{
+    if (satellites == m_satellites)
+        return;
+
+    const int count = satellites.count();
+
+    m_satellites = satellites;
+    m_indexes.resize(count);
+    std::iota(m_indexes.begin(), m_indexes.end(), 0);
+
+    for (int k = 0; k < 2; k++)
+    {
+        m_nodeJD[k].fill(NAN, count);
+        m_x[k].resize(count);
+        m_y[k].resize(count);
+        m_z[k].resize(count);
+        m_vx[k].resize(count);
+        m_vy[k].resize(count);
+        m_vz[k].resize(count);
+    }
+    m_status.fill(0, count);
+
+    m_horizon.resize(count);
+    m_rate.resize(count);
+    for (int i = 0; i < count; i++)
+        bounds(satellites[i], m_horizon[i], m_rate[i]);
+
+    m_belowFrom.fill(0, count);
+    m_belowUntil.fill(0, count);
+}
+
+QVector<Satellite *> SatellitePropagator::update(GeoLocation *geo, double jd, bool skipBelowHorizon)
+{
+    // Satellites were skipped for the horizon of another location
+    if (geo->lat()->Degrees() != m_latitude || geo->lng()->Degrees() != m_longitude)
+    {
+        m_latitude  = geo->lat()->Degrees();
+        m_longitude = geo->lng()->Degrees();
+        m_belowFrom.fill(0);
+        m_belowUntil.fill(0);
+    }
+
+    const qint64 node = static_cast<qint64>(floor(jd * NODES_PER_DAY));
+    bool direct       = false;
+
+    if (node != m_node)
+    {
+        // When the clock moves to the next or the previous interval, the node they share is kept
+        if (node == m_node + 1 || node == m_node - 1)
+        {
+            std::swap(m_nodeJD[0], m_nodeJD[1]);
+            std::swap(m_x[0], m_x[1]);
+            std::swap(m_y[0], m_y[1]);
+            std::swap(m_z[0], m_z[1]);
+            std::swap(m_vx[0], m_vx[1]);
+            std::swap(m_vy[0], m_vy[1]);
+            std::swap(m_vz[0], m_vz[1]);
+        }
+        else
+        {
+            // Propagating two nodes would be wasted if the next update is as far away
+            direct = true;
+        }
+        m_node = node;
+    }
+
+    const Satellite::Observer observer(geo, jd);
+
+    QtConcurrent::blockingMap(m_indexes,
+                              [&](int &index) { updateSatellite(index, observer, direct, skipBelowHorizon); });
+
+    QVector<Satellite *> failed;
+    for (int i = 0; i < m_satellites.count(); i++)
+    {
+        if (m_status[i] != 0)
+            failed.append(m_satellites[i]);
+    }
+
+    return failed;
+}
+
+void SatellitePropagator::updateSatellite(int index, const Satellite::Observer &observer, bool direct,
+                                          bool skipBelowHorizon)
+{
+    const double jd = observer.jd;
+
+    if (skipBelowHorizon && m_belowFrom[index] <= jd && jd < m_belowUntil[index])
+        return;
+
+    const Satellite *satellite = m_satellites[index];
+    double position[3], velocity[3];
+
+    if (direct)
+    {
+        m_status[index] = satellite->propagate(jd, position, velocity);
+        if (m_status[index] != 0)
+            return;
+    }
+    else
+    {
+        for (int k = 0; k < 2; k++)
+        {
+            const double nodeJD = (m_node + k) / NODES_PER_DAY;
+            if (m_nodeJD[k][index] == nodeJD)
+                continue;
+
+            m_status[index] = satellite->propagate(nodeJD, position, velocity);
+            if (m_status[index] != 0)
+                return;
+
+            m_x[k][index]      = position[0];
+            m_y[k][index]      = position[1];
+            m_z[k][index]      = position[2];
+            m_vx[k][index]     = velocity[0];
+            m_vy[k][index]     = velocity[1];
+            m_vz[k][index]     = velocity[2];
+            m_nodeJD[k][index] = nodeJD;
+        }
+
+        interpolate(index, jd, position, velocity);
+    }
+
+    if (skipBelowHorizon)
+    {
+        // The position is still set below, so that the satellite is hidden until it is looked at again
+        const double slack = geocentricAngle(position, observer.position) - m_horizon[index] - HORIZON_MARGIN;
+        if (slack > 0)
+        {
+            m_belowFrom[index]  = jd;
+            m_belowUntil[index] = jd + slack / m_rate[index];
+        }
+    }
+
+    m_satellites[index]->setPosition(position, velocity, observer);
+}
+
+void SatellitePropagator::interpolate(int index, double jd, double position[3], double velocity[3]) const
+{
+    // Cubic Hermite polynomial matching the positions and velocities at both nodes, time in seconds
+    const double h  = 86400.0 / NODES_PER_DAY;
+    const double s  = (jd - m_nodeJD[0][index]) * NODES_PER_DAY;
+    const double s2 = s * s, s3 = s2 * s;
+
+    const double h00 = 2 * s3 - 3 * s2 + 1, h01 = 3 * s2 - 2 * s3;
+    const double h10 = (s3 - 2 * s2 + s) * h, h11 = (s3 - s2) * h;
+    const double d00 = 6 * (s2 - s) / h;
+    const double d10 = 3 * s2 - 4 * s + 1, d11 = 3 * s2 - 2 * s;
+
+    const QVector<double> *p[3] = { m_x, m_y, m_z };
+    const QVector<double> *v[3] = { m_vx, m_vy, m_vz };
+
+    for (int c = 0; c < 3; c++)
+    {
+        const double p0 = p[c][0][index], p1 = p[c][1][index];
+        const double v0 = v[c][0][index], v1 = v[c][1][index];
+
+        position[c] = h00 * p0 + h10 * v0 + h01 * p1 + h11 * v1;
+        velocity[c] = d00 * (p0 - p1) + d10 * v0 + d11 * v1;
+    }
+}
+
+QVector<SatellitePropagator::Pass> SatellitePropagator::predictPasses(const Satellite *satellite,
+                                                                      const GeoLocation *geo, double startJD,
+                                                                      double endJD)
+{
+    QVector<Pass> passes;
+
+    // GeoLocation::LMST() is not const
+    GeoLocation location(*geo);
+
+    double horizon, rate;
+    bounds(satellite, horizon, rate);
+
+    // Elevation in radians, NaN if the position cannot be calculated. Slack is the angle the satellite must still
+    // cover to be near the horizon.
+    auto elevation = [&](double jd, double *slack) {
+        double position[3], velocity[3], azimuth, altitude, range;
+
+        if (satellite->propagate(jd, position, velocity) != 0)
+            return double(NAN);
+
+        const Satellite::Observer observer(&location, jd);
+        observer.toHorizontal(position, azimuth, altitude, range);
+
+        if (slack)
+            *slack = geocentricAngle(position, observer.position) - horizon - HORIZON_MARGIN;
+        return altitude;
+    };
+
+    // Bisection between a date the satellite is below the horizon and a date it is above
+    auto crossing = [&](double below, double above) {
+        while (fabs(above - below) > PASS_PRECISION)
+        {
+            const double middle = (below + above) / 2;
+            if (elevation(middle, nullptr) >= 0)
+                above = middle;
+            else
+                below = middle;
+        }
+        return (below + above) / 2;
+    };
+
+    // Golden section search of the highest elevation around the best sample
+    auto culminate = [&](Pass &pass) {
+        const double ratio = (sqrt(5.0) - 1) / 2;
+        double a = qMax(pass.aos, pass.culmination - PASS_STEP), b = qMin(pass.los, pass.culmination + PASS_STEP);
+        double c = b - ratio * (b - a), d = a + ratio * (b - a);
+        double fc = elevation(c, nullptr), fd = elevation(d, nullptr);
+
+        while (b - a > PASS_PRECISION)
+        {
+            if (fc > fd)
+            {
+                b  = d;
+                d  = c;
+                fd = fc;
+                c  = b - ratio * (b - a);
+                fc = elevation(c, nullptr);
+            }
+            else
+            {
+                a  = c;
+                c  = d;
+                fc = fd;
+                d  = a + ratio * (b - a);
+                fd = elevation(d, nullptr);
+            }
+        }
+
+        const double jd = (a + b) / 2, best = elevation(jd, nullptr);
+        if (best > pass.maxElevation)
+        {
+            pass.culmination  = jd;
+            pass.maxElevation = best;
+        }
+        pass.maxElevation /= DEG2RAD;
+    };
+
+    Pass pass { 0, 0, 0, 0 };
+    bool up         = false;
+    double previous = startJD, jd = startJD;
+
+    while (true)
+    {
+        double slack         = 0;
+        const double current = elevation(jd, &slack);
+        if (std::isnan(current))
+        {
+            // The satellite decayed, a pass ends at the last position
+            jd = previous;
+            break;
+        }
+
+        if (current >= 0)
+        {
+            if (!up)
+            {
+                up                = true;
+                pass.aos          = jd == startJD ? jd : crossing(previous, jd);
+                pass.culmination  = jd;
+                pass.maxElevation = current;
+            }
+            else if (current > pass.maxElevation)
+            {
+                pass.culmination  = jd;
+                pass.maxElevation = current;
+            }
+        }
+        else if (up)
+        {
+            up       = false;
+            pass.los = crossing(jd, previous);
+            culminate(pass);
+            passes.append(pass);
+        }
+
+        if (jd >= endJD)
+            break;
+
+        // Below the horizon, the satellite cannot rise before it covers the slack
+        double step = PASS_STEP;
+        if (!up && slack > 0)
+            step = qMax(step, slack / rate);
+
+        previous = jd;
+        jd       = qMin(jd + step, endJD);
+    }
+
+    if (up)
+    {
+        pass.los = jd;
+        culminate(pass);
+        passes.append(pass);
+    }
+
+    return passes;
+}
+
+QVector<QVector<SatellitePropagator::Pass>> SatellitePropagator::predictPasses(const GeoLocation *geo,
+                                                                               double startJD, double endJD) const
+{
+    QVector<QVector<Pass>> passes(m_satellites.count());
+    QVector<int> indexes = m_indexes;
+
+    QtConcurrent::blockingMap(indexes, [&](int &index) {
+        passes[index] = predictPasses(m_satellites[index], geo, startJD, endJD);
+    });
+
+    return passes;
+}
@@ -0,0 +1,131 @@
+/***************************************************************************
+                  satellitepropagator.h  -  K Desktop Planetarium
+                             -------------------
+    begin                : Sun 18 Oct 2026
+    copyright            : (C) 2026 by KStars Developers
+ ***************************************************************************/
+
+/***************************************************************************
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ ***************************************************************************/
+
+#pragma once
+
+#include "satellite.h"
+
+#include <QVector>
+
+class GeoLocation;
+
+/**
+ * @class SatellitePropagator
+ *
+ * Updates the positions of many satellites at once.
+ *
+ * Satellite::updatePos() runs SGP4 and the observer geometry of one satellite on every sky update. The propagator
+ * evaluates SGP4 at nodes one minute apart, shared by all satellites, and keeps the ECI positions and velocities at
+ * the two nodes around the current time in one array per coordinate. A sky update interpolates between them with a
+ * cubic Hermite polynomial, which stays within a meter of SGP4 for low orbits, and only computes the observer
+ * geometry. New nodes are propagated for all satellites in parallel when the clock leaves the interval; if it jumps
+ * further away, the satellites are propagated directly at the current time until the clock slows down again.
+ *
+ * Satellites below the horizon may be skipped: seen from the center of the Earth, the angle between a satellite and
+ * the observer cannot shrink faster than the mean motion at perigee plus the rotation of the Earth, so a satellite
+ * is not looked at again until it could have reached the horizon. The same bound lets predictPasses() step over the
+ * hours a satellite spends below the horizon.
+ *
+ * @short Batch SGP4 propagation and pass prediction for satellites
+ */
+class SatellitePropagator
+{
+  public:
+    /** Pass of a satellite above the horizon of an observer */
+    struct Pass
+    {
+        /// Julian date (UTC) of the acquisition of signal, when the satellite rises
+        double aos;
+        /// Julian date (UTC) of the loss of signal, when the satellite sets
+        double los;
+        /// Julian date (UTC) of the highest elevation
+        double culmination;
+        /// Highest elevation in degrees, without refraction
+        double maxElevation;
+    };
+
+    /**
+     * @short Set the satellites to update, the cache is kept if the list did not change
+     * @param satellites Satellites to update
+     */
+    void setSatellites(const QVector<Satellite *> &satellites);
+
+    /** @return Satellites being updated */
+    const QVector<Satellite *> &satellites() const { return m_satellites; }
+
+    /**
+     * @short Update the positions of all satellites
+     * @param geo Location of the observer
+     * @param jd Current Julian date (UTC) of the sky map
+     * @param skipBelowHorizon True if satellites below the horizon are not drawn. The position of a skipped
+     * satellite is not updated, it stays below the horizon and not visible.
+     * @return Satellites whose position cannot be calculated
+     */
+    QVector<Satellite *> update(GeoLocation *geo, double jd, bool skipBelowHorizon);
+
+    /**
+     * @short Predict the passes of a satellite
+     * @param satellite Satellite
+     * @param geo Location of the observer
+     * @param startJD Julian date (UTC) of the beginning of the interval
+     * @param endJD Julian date (UTC) of the end of the interval
+     * @return Passes overlapping the interval, in order. AOS and LOS are clipped to the interval, passes shorter
+     * than a minute may be missed.
+     */
+    static QVector<Pass> predictPasses(const Satellite *satellite, const GeoLocation *geo, double startJD,
+                                       double endJD);
+
+    /**
+     * @short Predict the passes of all satellites in parallel, e.g. for the night
+     * @return Passes of each satellite, in the order of satellites()
+     * @see predictPasses(const Satellite *, const GeoLocation *, double, double)
+     */
+    QVector<QVector<Pass>> predictPasses(const GeoLocation *geo, double startJD, double endJD) const;
+
+  private:
+    /**
+     * @short Bounds of the motion of a satellite relative to an observer
+     * @param horizon Geocentric angle between the horizon of any observer and the satellite at apogee, in radians
+     * @param rate Upper bound of the angular velocity of the satellite relative to the observer, in radians per day
+     */
+    static void bounds(const Satellite *satellite, double &horizon, double &rate);
+
+    /// Propagate the satellite at index, fill the nodes it misses and update or skip it
+    void updateSatellite(int index, const Satellite::Observer &observer, bool direct, bool skipBelowHorizon);
+
+    /// Interpolate the position and velocity of the satellite at index between the nodes
+    void interpolate(int index, double jd, double position[3], double velocity[3]) const;
+
+    QVector<Satellite *> m_satellites;
+    /// Indexes of the satellites, the sequence mapped in parallel
+    QVector<int> m_indexes;
+
+    /// Index of the first current node in minutes since the origin of Julian dates, shared by all satellites
+    qint64 m_node { 0 };
+    /// For each satellite, Julian dates at which the node slots were propagated
+    QVector<double> m_nodeJD[2];
+    /// ECI positions in km and velocities in km/s of each satellite at the nodes
+    QVector<double> m_x[2], m_y[2], m_z[2], m_vx[2], m_vy[2], m_vz[2];
+    /// Error code of the last propagation of each satellite
+    QVector<int> m_status;
+
+    /// Motion bounds of each satellite, see bounds()
+    QVector<double> m_horizon, m_rate;
+    /// Julian dates between which each satellite is known to stay below the horizon
+    QVector<double> m_belowFrom, m_belowUntil;
+    /// Location the satellites were skipped for
+    double m_latitude { 0 }, m_longitude { 0 };
+};
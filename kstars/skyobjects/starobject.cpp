@@ -234,6 +234,29 @@ void StarObject::init(const DeepStarData *stardata)
     lastPrecessJD          = J2000;
 }
 
+void StarObject::init(double ra, double dec, float mag, const char *sptype, double pmra, double pmdec, float bMag,
+                      float vMag)
+{
+    setType(SkyObject::STAR);
+    setMag(mag);
+    setRA0(ra / 15.0);
+    setDec0(dec);
+    setRA(ra0());
+    setDec(dec0());
+    SpType[0]    = sptype[0];
+    SpType[1]    = sptype[1];
+    PM_RA        = pmra;
+    PM_Dec       = pmdec;
+    Parallax     = 0.0;
+    Multiplicity = 0;
+    Variability  = 0;
+    updateID = updateNumID = 0;
+    HD                     = 0;
+    B                      = bMag;
+    V                      = vMag;
+    lastPrecessJD          = J2000;
+}
+
 void StarObject::setNames(const QString &name, const QString &name2)
 {
     QString lname;
@@ -115,6 +115,20 @@ class StarObject : public SkyObject
          */
     void init(const DeepStarData *stardata);
 
+    /**
+         *@short  Initializes an unnamed StarObject from the fields kept by a compact StarBlock
+         *
+         *@param  ra       J2000.0 right ascension in degrees
+         *@param  dec      J2000.0 declination in degrees
+         *@param  mag      Magnitude
+         *@param  sptype   Pointer to the two characters of the spectral type
+         *@param  pmra     Proper motion in RA, milliarcseconds per year
+         *@param  pmdec    Proper motion in Dec, milliarcseconds per year
+         *@param  bMag     B magnitude
+         *@param  vMag     V magnitude
+         */
+    void init(double ra, double dec, float mag, const char *sptype, double pmra, double pmdec, float bMag, float vMag);
+
     /**
          *@short  Sets the name, genetive name, and long name
          *
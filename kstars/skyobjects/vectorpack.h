@@ -0,0 +1,166 @@
+/***************************************************************************
+                      vectorpack.h  -  K Desktop Planetarium
+                             -------------------
+    begin                : Sun 18 Oct 2026
+    copyright            : (C) 2026 by KStars Developers
+ ***************************************************************************/
+
+/***************************************************************************
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ ***************************************************************************/
+
+#pragma once
+
+#include <cmath>
+
+#if defined(__AVX__)
+#include <immintrin.h>
+#define BATCH_USE_AVX
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define BATCH_USE_SSE2
+#endif
+
+/*
+ * Each pack type provides the same set of operations on one (scalar), two (SSE2) or four
+ * (AVX) doubles, so that the batch kernels are written only once. The vector width is
+ * chosen at compile time, VectorPack is the widest pack of the target.
+ *
+ * load() and store() need addresses aligned to the pack size, loadu() and storeu() do not.
+ */
+struct ScalarPack
+{
+    typedef double type;
+    typedef bool mask;
+    enum { width = 1 };
+    static inline type load(const double *p) { return *p; }
+    static inline void store(double *p, type v) { *p = v; }
+    static inline type loadu(const double *p) { return *p; }
+    static inline void storeu(double *p, type v) { *p = v; }
+    static inline type set1(double x) { return x; }
+    static inline type add(type a, type b) { return a + b; }
+    static inline type sub(type a, type b) { return a - b; }
+    static inline type mul(type a, type b) { return a * b; }
+    static inline type div(type a, type b) { return a / b; }
+    static inline type sqrt(type a) { return std::sqrt(a); }
+    static inline type round(type a) { return std::nearbyint(a); }
+    static inline type maxOf(type a, type b) { return (a > b ? a : b); }
+    static inline mask ge(type a, type b) { return a >= b; }
+    static inline mask eq(type a, type b) { return a == b; }
+    static inline mask orMask(mask a, mask b) { return a || b; }
+    static inline type select(mask m, type a, type b) { return (m ? a : b); }
+};
+
+#ifdef BATCH_USE_SSE2
+struct SSE2Pack
+{
+    typedef __m128d type;
+    typedef __m128d mask;
+    enum { width = 2 };
+    static inline type load(const double *p) { return _mm_load_pd(p); }
+    static inline void store(double *p, type v) { _mm_store_pd(p, v); }
+    static inline type loadu(const double *p) { return _mm_loadu_pd(p); }
+    static inline void storeu(double *p, type v) { _mm_storeu_pd(p, v); }
+    static inline type set1(double x) { return _mm_set1_pd(x); }
+    static inline type add(type a, type b) { return _mm_add_pd(a, b); }
+    static inline type sub(type a, type b) { return _mm_sub_pd(a, b); }
+    static inline type mul(type a, type b) { return _mm_mul_pd(a, b); }
+    static inline type div(type a, type b) { return _mm_div_pd(a, b); }
+    static inline type sqrt(type a) { return _mm_sqrt_pd(a); }
+    // SSE2 has no rounding instruction: adding 1.5 * 2^52 leaves no fractional bits, for |a| < 2^51
+    static inline type round(type a)
+    {
+        const __m128d magic = _mm_set1_pd(6755399441055744.0);
+        return _mm_sub_pd(_mm_add_pd(a, magic), magic);
+    }
+    static inline type maxOf(type a, type b) { return _mm_max_pd(a, b); }
+    static inline mask ge(type a, type b) { return _mm_cmpge_pd(a, b); }
+    static inline mask eq(type a, type b) { return _mm_cmpeq_pd(a, b); }
+    static inline mask orMask(mask a, mask b) { return _mm_or_pd(a, b); }
+    static inline type select(mask m, type a, type b) { return _mm_or_pd(_mm_and_pd(m, a), _mm_andnot_pd(m, b)); }
+};
+typedef SSE2Pack VectorPack;
+#endif
+
+#ifdef BATCH_USE_AVX
+struct AVXPack
+{
+    typedef __m256d type;
+    typedef __m256d mask;
+    enum { width = 4 };
+    static inline type load(const double *p) { return _mm256_load_pd(p); }
+    static inline void store(double *p, type v) { _mm256_store_pd(p, v); }
+    static inline type loadu(const double *p) { return _mm256_loadu_pd(p); }
+    static inline void storeu(double *p, type v) { _mm256_storeu_pd(p, v); }
+    static inline type set1(double x) { return _mm256_set1_pd(x); }
+    static inline type add(type a, type b) { return _mm256_add_pd(a, b); }
+    static inline type sub(type a, type b) { return _mm256_sub_pd(a, b); }
+    static inline type mul(type a, type b) { return _mm256_mul_pd(a, b); }
+    static inline type div(type a, type b) { return _mm256_div_pd(a, b); }
+    static inline type sqrt(type a) { return _mm256_sqrt_pd(a); }
+    static inline type round(type a) { return _mm256_round_pd(a, _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC); }
+    static inline type maxOf(type a, type b) { return _mm256_max_pd(a, b); }
+    static inline mask ge(type a, type b) { return _mm256_cmp_pd(a, b, _CMP_GE_OQ); }
+    static inline mask eq(type a, type b) { return _mm256_cmp_pd(a, b, _CMP_EQ_OQ); }
+    static inline mask orMask(mask a, mask b) { return _mm256_or_pd(a, b); }
+    static inline type select(mask m, type a, type b) { return _mm256_blendv_pd(b, a, m); }
+};
+typedef AVXPack VectorPack;
+#endif
+
+#if !defined(BATCH_USE_SSE2) && !defined(BATCH_USE_AVX)
+typedef ScalarPack VectorPack;
+#endif
+
+/**
+ * Sine and cosine of each value of x. The argument is reduced to [-pi/4, pi/4] around the nearest multiple of pi/2,
+ * with pi/2 split in two constants, and the Taylor series are exact to double precision on that interval. NaN stays
+ * NaN, and |x| must stay below 2^51 for the SSE2 rounding.
+ */
+template <class P>
+inline void vectorSinCos(typename P::type x, typename P::type &sinX, typename P::type &cosX)
+{
+    typedef typename P::type V;
+
+    const V zero = P::set1(0.0);
+
+    V k  = P::round(P::mul(x, P::set1(2.0 / M_PI)));
+    V r  = P::sub(P::sub(x, P::mul(k, P::set1(1.5707963267948966))), P::mul(k, P::set1(6.123233995736766e-17)));
+    V r2 = P::mul(r, r);
+
+    V s = P::set1(-1.0 / 1307674368000.0);
+    s   = P::add(P::mul(s, r2), P::set1(1.0 / 6227020800.0));
+    s   = P::add(P::mul(s, r2), P::set1(-1.0 / 39916800.0));
+    s   = P::add(P::mul(s, r2), P::set1(1.0 / 362880.0));
+    s   = P::add(P::mul(s, r2), P::set1(-1.0 / 5040.0));
+    s   = P::add(P::mul(s, r2), P::set1(1.0 / 120.0));
+    s   = P::add(P::mul(s, r2), P::set1(-1.0 / 6.0));
+    s   = P::add(P::mul(P::mul(s, r2), r), r);
+
+    V c = P::set1(1.0 / 20922789888000.0);
+    c   = P::add(P::mul(c, r2), P::set1(-1.0 / 87178291200.0));
+    c   = P::add(P::mul(c, r2), P::set1(1.0 / 479001600.0));
+    c   = P::add(P::mul(c, r2), P::set1(-1.0 / 3628800.0));
+    c   = P::add(P::mul(c, r2), P::set1(1.0 / 40320.0));
+    c   = P::add(P::mul(c, r2), P::set1(-1.0 / 720.0));
+    c   = P::add(P::mul(c, r2), P::set1(1.0 / 24.0));
+    c   = P::add(P::mul(c, r2), P::set1(-0.5));
+    c   = P::add(P::mul(c, r2), P::set1(1.0));
+
+    // Quadrant of x, k modulo 4 in [-2, 2]
+    V q         = P::sub(k, P::mul(P::set1(4.0), P::round(P::mul(k, P::set1(0.25)))));
+    auto plus1  = P::eq(q, P::set1(1.0));
+    auto minus1 = P::eq(q, P::set1(-1.0));
+    auto half   = P::orMask(P::eq(q, P::set1(2.0)), P::eq(q, P::set1(-2.0)));
+    auto swap   = P::orMask(plus1, minus1);
+
+    V sinV = P::select(swap, c, s);
+    V cosV = P::select(swap, s, c);
+    sinX   = P::select(P::orMask(half, minus1), P::sub(zero, sinV), sinV);
+    cosX   = P::select(P::orMask(half, plus1), P::sub(zero, cosV), cosV);
+}
@@ -46,6 +46,23 @@ void SkyPainter::setSizeMagLimit(float sizeMagLim)
     m_sizeMagLim = sizeMagLim;
 }
 
+void SkyPainter::drawPointSources(PointSourceBatch &batch)
+{
+    batch.drawn.resize(batch.count());
+    for (int i = 0; i < batch.count(); ++i)
+        batch.drawn[i] = drawPointSource(batch.locs[i], batch.mags[i], batch.sps[i]);
+}
+
+void SkyPainter::drawDeepSkyObjects(DeepSkyObject *const *objs, int count, bool drawImage, bool *drawn)
+{
+    for (int i = 0; i < count; ++i)
+    {
+        bool objDrawn = drawDeepSkyObject(objs[i], drawImage);
+        if (drawn)
+            drawn[i] = objDrawn;
+    }
+}
+
 float SkyPainter::starWidth(float mag) const
 {
     //adjust maglimit for ZoomLevel
@@ -22,6 +22,7 @@
 
 #include <QList>
 #include <QPainter>
+#include <QVector>
 
 #include "skycomponents/typedef.h"
 
@@ -38,6 +39,36 @@ class SkyObject;
 class SkyPoint;
 class Supernova;
 
+/**
+ * @short Point sources gathered to be drawn at once with SkyPainter::drawPointSources().
+ * The buffers keep their capacity when cleared, so a component can reuse the same batch for every frame.
+ */
+struct PointSourceBatch
+{
+    void clear()
+    {
+        locs.clear();
+        mags.clear();
+        sps.clear();
+        drawn.clear();
+    }
+
+    void append(SkyPoint *loc, float mag, char sp)
+    {
+        locs.append(loc);
+        mags.append(mag);
+        sps.append(sp);
+    }
+
+    int count() const { return locs.size(); }
+
+    QVector<SkyPoint *> locs;
+    QVector<float> mags;
+    QVector<char> sps;
+    /// Set by SkyPainter::drawPointSources(): whether each source was drawn
+    QVector<bool> drawn;
+};
+
 /**
  * @short Draws things on the sky, without regard to backend.
  * This class serves as an interface to draw objects onto the sky without
@@ -129,6 +160,14 @@ class SkyPainter
      */
     virtual bool drawPointSource(SkyPoint *loc, float mag, char sp = 'A') = 0;
 
+    /**
+     * @short Draw many point sources at once.
+     * The default implementation calls drawPointSource() for each source, painters may project the whole batch
+     * with Projector::toScreenBatch() instead.
+     * @param batch the sources to draw, batch.drawn is set to whether each of them was drawn
+     */
+    virtual void drawPointSources(PointSourceBatch &batch);
+
     /**
      * @short Draw a deep sky object
      * @param obj the object to draw
@@ -137,6 +176,16 @@ class SkyPainter
      */
     virtual bool drawDeepSkyObject(DeepSkyObject *obj, bool drawImage = false) = 0;
 
+    /**
+     * @short Draw many deep sky objects at once.
+     * The default implementation calls drawDeepSkyObject() for each object.
+     * @param objs the objects to draw
+     * @param count the number of objects
+     * @param drawImage if true, try to draw the images of the objects
+     * @param drawn if not nullptr, array of @p count bools set to whether each object was drawn
+     */
+    virtual void drawDeepSkyObjects(DeepSkyObject *const *objs, int count, bool drawImage, bool *drawn = nullptr);
+
     /**
      * @short Draw a planet
      * @param planet the planet to draw
@@ -88,6 +88,36 @@ const int nSPclasses = 7;
 QPixmap *imageCache[nSPclasses][nStarSizes] = { { nullptr } };
 
 std::unique_ptr<QPixmap> visibleSatPixmap, invisibleSatPixmap;
+
+// Project at once the points that pass the visibility check of the projector, and call draw(index, position) for
+// each of them that is on the visible hemisphere and on screen.
+template <class T, class Draw>
+void drawProjected(const Projector *proj, T *const *points, int count, Draw draw)
+{
+    QVector<int> indexes;
+    QVector<T *> visiblePoints;
+    indexes.reserve(count);
+    visiblePoints.reserve(count);
+    for (int i = 0; i < count; ++i)
+    {
+        if (proj->checkVisibility(points[i]))
+        {
+            indexes.append(i);
+            visiblePoints.append(points[i]);
+        }
+    }
+
+    QVector<Vector2f> screen(visiblePoints.size());
+    QVector<bool> visible(visiblePoints.size());
+    proj->toScreenBatch(visiblePoints.constData(), visiblePoints.size(), screen.data(), visible.data());
+
+    for (int j = 0; j < visiblePoints.size(); ++j)
+    {
+        QPointF pos = KSUtils::vecToPoint(screen[j]);
+        if (visible[j] && proj->onScreen(pos))
+            draw(indexes[j], pos);
+    }
+}
 }
 
 int SkyQPainter::starColorMode           = 0;
@@ -297,21 +327,26 @@ void SkyQPainter::drawSkyLine(SkyPoint *a, SkyPoint *b)
 void SkyQPainter::drawSkyPolyline(LineList *list, SkipHashList *skipList, LineListLabel *label)
 {
     SkyList *points = list->points();
-    bool isVisible, isVisibleLast;
+    if (points->isEmpty())
+        return;
 
-    QPointF oLast = m_proj->toScreen(points->first().get(), true, &isVisibleLast);
+    //Project all the points of the line at once
+    QVector<Vector2f> screen(points->size());
+    QVector<bool> visible(points->size());
+    m_proj->toScreenBatch(points->constBegin(), points->size(), screen.data(), visible.data(), true);
+
+    QPointF oLast = KSUtils::vecToPoint(screen[0]);
     // & with the result of checkVisibility to clip away things below horizon
-    isVisibleLast &= m_proj->checkVisibility(points->first().get());
-    QPointF oThis, oThis2;
+    bool isVisibleLast = visible[0] && m_proj->checkVisibility(points->first().get());
 
     for (int j = 1; j < points->size(); j++)
     {
         SkyPoint *pThis = points->at(j).get();
 
-        oThis2 = oThis = m_proj->toScreen(pThis, true, &isVisible);
+        QPointF oThis = KSUtils::vecToPoint(screen[j]);
         // & with the result of checkVisibility to clip away things below horizon
-        isVisible &= m_proj->checkVisibility(pThis);
-        bool doSkip = false;
+        bool isVisible = visible[j] && m_proj->checkVisibility(pThis);
+        bool doSkip    = false;
         if (skipList)
         {
             doSkip = skipList->skip(j);
@@ -340,23 +375,30 @@ void SkyQPainter::drawSkyPolyline(LineList *list, SkipHashList *skipList, LineLi
             }
         }
 
-        oLast         = oThis2;
+        oLast         = oThis;
         isVisibleLast = isVisible;
     }
 }
 
 void SkyQPainter::drawSkyPolygon(LineList *list, bool forceClip)
 {
-    bool isVisible  = false, isVisibleLast;
     SkyList *points = list->points();
+    if (points->isEmpty())
+        return;
+
+    //Project all the points of the polygon at once, unclipped polygons are not refracted
     QPolygonF polygon;
+    QVector<Vector2f> screen(points->size());
+    QVector<bool> visible(points->size());
+    m_proj->toScreenBatch(points->constBegin(), points->size(), screen.data(), visible.data(), forceClip);
 
     if (forceClip == false)
     {
+        bool isVisible = false;
         for (int i = 0; i < points->size(); ++i)
         {
-            polygon << m_proj->toScreen(points->at(i).get(), false, &isVisibleLast);
-            isVisible |= isVisibleLast;
+            polygon << KSUtils::vecToPoint(screen[i]);
+            isVisible |= visible[i];
         }
 
         // If 1+ points are visible, draw it
@@ -367,16 +409,15 @@ void SkyQPainter::drawSkyPolygon(LineList *list, bool forceClip)
     }
 
     SkyPoint *pLast = points->last().get();
-    QPointF oLast   = m_proj->toScreen(pLast, true, &isVisibleLast);
     // & with the result of checkVisibility to clip away things below horizon
-    isVisibleLast &= m_proj->checkVisibility(pLast);
+    bool isVisibleLast = visible.last() && m_proj->checkVisibility(pLast);
 
     for (int i = 0; i < points->size(); ++i)
     {
         SkyPoint *pThis = points->at(i).get();
-        QPointF oThis   = m_proj->toScreen(pThis, true, &isVisible);
+        QPointF oThis   = KSUtils::vecToPoint(screen[i]);
         // & with the result of checkVisibility to clip away things below horizon
-        isVisible &= m_proj->checkVisibility(pThis);
+        bool isVisible = visible[i] && m_proj->checkVisibility(pThis);
 
         if (isVisible && isVisibleLast)
         {
@@ -395,7 +436,6 @@ void SkyQPainter::drawSkyPolygon(LineList *list, bool forceClip)
         }
 
         pLast         = pThis;
-        oLast         = oThis;
         isVisibleLast = isVisible;
     }
 
@@ -552,6 +592,15 @@ bool SkyQPainter::drawPointSource(SkyPoint *loc, float mag, char sp)
     }
 }
 
+void SkyQPainter::drawPointSources(PointSourceBatch &batch)
+{
+    batch.drawn.fill(false, batch.count());
+    drawProjected(m_proj, batch.locs.constData(), batch.count(), [&](int i, const QPointF &pos) {
+        drawPointSource(pos, starWidth(batch.mags[i]), batch.sps[i]);
+        batch.drawn[i] = true;
+    });
+}
+
 void SkyQPainter::drawPointSource(const QPointF &pos, float size, char sp)
 {
     int isize = qMin(static_cast<int>(size), 14);
@@ -644,6 +693,23 @@ bool SkyQPainter::drawDeepSkyObject(DeepSkyObject *obj, bool drawImage)
     if (!visible || !m_proj->onScreen(pos))
         return false;
 
+    drawDeepSkyObject(pos, obj, drawImage);
+    return true;
+}
+
+void SkyQPainter::drawDeepSkyObjects(DeepSkyObject *const *objs, int count, bool drawImage, bool *drawn)
+{
+    if (drawn)
+        std::fill(drawn, drawn + count, false);
+    drawProjected(m_proj, objs, count, [&](int i, const QPointF &pos) {
+        drawDeepSkyObject(pos, objs[i], drawImage);
+        if (drawn)
+            drawn[i] = true;
+    });
+}
+
+void SkyQPainter::drawDeepSkyObject(const QPointF &pos, DeepSkyObject *obj, bool drawImage)
+{
     // if size is 0.0 set it to 1.0, this are normally stars (type 0 and 1)
     // if we use size 0.0 the star wouldn't be drawn
     float majorAxis = obj->a();
@@ -663,8 +729,6 @@ bool SkyQPainter::drawDeepSkyObject(DeepSkyObject *obj, bool drawImage)
 
     //Draw Symbol
     drawDeepSkySymbol(pos, obj->type(), size, obj->e(), positionAngle);
-
-    return true;
 }
 
 bool SkyQPainter::drawDeepSkyImage(const QPointF &pos, DeepSkyObject *obj, float positionAngle)
@@ -86,7 +86,9 @@ class SkyQPainter : public SkyPainter, public QPainter
                          LineListLabel *label = nullptr) override;
     void drawSkyPolygon(LineList *list, bool forceClip = true) override;
     bool drawPointSource(SkyPoint *loc, float mag, char sp = 'A') override;
+    void drawPointSources(PointSourceBatch &batch) override;
     bool drawDeepSkyObject(DeepSkyObject *obj, bool drawImage = false) override;
+    void drawDeepSkyObjects(DeepSkyObject *const *objs, int count, bool drawImage, bool *drawn = nullptr) override;
     bool drawPlanet(KSPlanetBase *planet) override;
     void drawObservingList(const QList<SkyObject *> &obs) override;
     void drawFlags() override;
@@ -101,6 +103,8 @@ class SkyQPainter : public SkyPainter, public QPainter
     bool drawHips() override;
 
   private:
+    /// Draw the image and the symbol of a deep sky object projected at pos
+    void drawDeepSkyObject(const QPointF &pos, DeepSkyObject *obj, bool drawImage);
     virtual bool drawDeepSkyImage(const QPointF &pos, DeepSkyObject *obj, float positionAngle);
 
     QPaintDevice *m_pd { nullptr };